@@ -0,0 +1,100 @@
+//************************************************************
+//************************************************************
+//  Archive.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Cold storage for departed sailings and their reservations.
+//
+//    Archiving moves every sailing that departed before a cutoff
+//    (day of month, hour) out of sailings.dat, together with its
+//    reservations, into one compressed read-only segment:
+//
+//      archive/seg-000001.arc   header + PackBits-compressed
+//                               Sailingrec rows, then their
+//                               ReservationRec rows
+//      archive/catalog.dat      one ArchiveEntry per archived
+//                               sailing: ID, segment, booking count
+//
+//    The working files then hold only upcoming sailings, so scans
+//    and the capacity table scale with the schedule rather than
+//    the season. Archived data is read only on request: lookups
+//    consult the small catalog and decompress just the segment
+//    they need.
+//
+//    Sailing IDs carry no month, so an ID can recur; queries
+//    return the most recently archived sailing with that ID.
+//************************************************************
+//************************************************************
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+#pragma pack(push, 1)
+struct ArchiveEntry
+{
+    char          sailingID[16];    // space-padded, as written
+    std::uint32_t segment;          // archive/seg-<segment>.arc
+    std::uint32_t reservations;     // bookings archived with it
+};
+#pragma pack(pop)
+
+class Archive
+{
+public:
+    static constexpr const char *DIR = "archive";
+    static constexpr const char *CATALOG = "archive/catalog.dat";
+
+    //------------------------------------------------------------
+    // Move sailings departing before (day, hour) of the month, and
+    // their reservations, into a new segment and delete them from
+    // the working files. Archived IDs are appended to `archived`.
+    // Returns how many were archived, or -1 if the segment could
+    // not be written (working files untouched).
+    // Preconditions : no other thread is using the data files.
+    static int archiveDeparted(
+        int day,                            // IN: 1-31
+        int hour,                           // IN: 0-23
+        std::vector<SailingID> &archived    // OUT
+    );
+
+    //------------------------------------------------------------
+    // Archived sailing with this ID (case-insensitive, like the
+    // two queries below, so all three agree on the entry).
+    static bool findSailing(
+        const SailingID &sailingID,     // IN
+        Sailingrec &result              // OUT
+    );
+
+    //------------------------------------------------------------
+    // Bookings archived with a sailing (case-insensitive ID), or
+    // -1 if it is not archived. Answered from the catalog.
+    static int countReservations(
+        const SailingID &sailingID      // IN
+    );
+
+    //------------------------------------------------------------
+    // Reservations archived with a sailing (case-insensitive ID).
+    static bool readReservations(
+        const SailingID &sailingID,             // IN
+        std::vector<ReservationRec> &rows       // OUT
+    );
+
+    //------------------------------------------------------------
+    // Every archived sailing, oldest segment first.
+    static std::vector<Sailingrec> sailings();
+};
+
+} // namespace FerrySys
+
+#endif // ARCHIVE_H
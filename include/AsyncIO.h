@@ -0,0 +1,73 @@
+//************************************************************
+//************************************************************
+//  AsyncIO.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Batched read engines used by BinaryFileOps for random
+//    record lookups. A caller hands over hundreds of (offset,
+//    length, buffer) requests at once and gets them back when
+//    all have completed.
+//
+//    • IoUringReader : submits the whole batch through io_uring
+//                      (Linux), reaping completions as they land
+//    • PreadReader   : fallback; spreads pread() calls over the
+//                      shared worker pool
+//
+//    makeBatchReader() picks io_uring when the kernel allows it
+//    and falls back otherwise. FERRY_IO_ENGINE=pread forces the
+//    fallback.
+//************************************************************
+//************************************************************
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace FerrySys
+{
+
+// One read in a batch
+struct ReadRequest
+{
+    std::uint64_t offset = 0;       // IN : byte offset in file
+    std::size_t   length = 0;       // IN : bytes to read
+    void         *buffer = nullptr; // IN : destination (length bytes)
+    std::int64_t  result = 0;       // OUT: bytes read, or -errno
+};
+
+class BatchReader
+{
+public:
+    virtual ~BatchReader() = default;
+
+    //------------------------------------------------------------
+    // Issue every request against `fd` and wait for all of them.
+    // Preconditions : fd open for reading; buffers stay valid.
+    // Postconditions: each request's result is set; returns true
+    //                 only if every request read `length` bytes.
+    virtual bool readBatch(
+        int fd,                                 // IN: open file
+        std::vector<ReadRequest> &requests      // IN/OUT
+    ) = 0;
+
+    //------------------------------------------------------------
+    // Engine name for diagnostics ("io_uring" / "pread").
+    virtual const char *name() const = 0;
+};
+
+//------------------------------------------------------------
+// Best available engine for this process.
+std::unique_ptr<BatchReader> makeBatchReader();
+
+//------------------------------------------------------------
+// Shared engine used by BinaryFileOps::readRecordsBatch.
+BatchReader &defaultBatchReader();
+
+} // namespace FerrySys
+
+#endif // ASYNCIO_H
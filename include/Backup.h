@@ -0,0 +1,71 @@
+//************************************************************
+//************************************************************
+//  Backup.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Online backup of the data directory (`ferry backup <dir>`):
+//    a copy of every data file as it stood at one instant, taken
+//    while terminals and ferryd keep running.
+//
+//    The copy is made under a WriteGate::Pause, so no change is
+//    half done in it. Each file is cloned (FICLONE reflink, an
+//    instant copy-on-write share) where the file system allows,
+//    otherwise copied in the kernel with copy_file_range; writes
+//    are held back only for as long as that takes, and the
+//    copies are flushed to disk after writes resume.
+//
+//    The data set is the four .dat files, sailings.idx, the
+//    .free lists and .snap index snapshots, and the
+//    reservations/, lsm/ and archive/ directories. Temporary and
+//    .migrated files are left out. Indexes are checked against
+//    their data file's generation on open as usual, so the copy
+//    is used as is: to restore, stop every terminal and copy it
+//    back over the data directory.
+//************************************************************
+//************************************************************
+
+#ifndef BACKUP_H
+#define BACKUP_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+struct BackupResult
+{
+    bool        ok = false;
+    std::size_t files = 0;
+    std::size_t bytes = 0;
+    std::size_t cloned = 0;         // files copied by reflink
+    double      pausedMs = 0.0;     // how long writes were held back
+};
+
+class Backup
+{
+public:
+    //------------------------------------------------------------
+    // Copy the data set of the current directory into `destDir`,
+    // which is created and must not already hold files.
+    // `whilePaused`, if given, runs once the copy is made and
+    // before writes resume (Replica::seed() marks its log position
+    // there).
+    // Postconditions: on failure, destDir may hold a partial copy.
+    static BackupResult create(
+        const std::string &destDir,                     // IN
+        const std::function<void()> &whilePaused = {}   // IN
+    );
+
+    //------------------------------------------------------------
+    // Paths (relative to the current directory) of the data set
+    // as it is now.
+    static std::vector<std::string> dataFiles();
+};
+
+} // namespace FerrySys
+
+#endif // BACKUP_H
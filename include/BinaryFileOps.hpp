@@ -13,10 +13,17 @@
 //   • Search = linear scan (caller-supplied predicate).
 //   • Delete = overwrite target record with last record, then truncate file
 //              by 1 record. (Spec: simple unsorted deletion model.)
+//   • Tombstone delete = flip the record's status byte to REC_DEAD in place;
+//              dead rows are skipped by readers and dropped later by
+//              compaction (see Compaction.h).
 //
 // These utilities are record-size agnostic: you pass the record byte size and
 // a raw byte buffer. Higher-level encode/decode is done by the caller
 // (e.g., see VehicleRecord.hpp).
+//
+// A data file may start with a FileHeader (see DataFile.h). The path-based
+// helpers detect it and number records from the first byte after it; the
+// fstream-based ones treat the whole file as records.
 // ---------------------------------------------------------------------------
 
 #include <cstddef>
@@ -24,9 +31,58 @@
 #include <string>
 #include <functional>
 #include <iosfwd>
+#include <vector>
 
 namespace FerrySys
 {
+    // Status byte values shared by every record format. Legacy files written
+    // before the status byte existed hold 0 there, i.e. live.
+    constexpr std::uint8_t REC_LIVE = 0x00;
+    constexpr std::uint8_t REC_DEAD = 0xFF;
+
+    // Fixed header at the start of the four data files. Integers are in host
+    // byte order; endianMark reads back as FILE_ENDIAN_MARK only on a host of
+    // the writer's byte order. liveRows + deadRows always equals the records
+    // after the header.
+    constexpr char          FILE_MAGIC[4] = { 'F', 'D', 'A', 'T' };
+    constexpr std::size_t   FILE_HEADER_BYTES = 64;
+    constexpr std::uint32_t FILE_ENDIAN_MARK = 0x01020304;
+    constexpr std::uint16_t FILE_SCHEMA_VERSION = 1;   // DataFile::SCHEMA_VERSION
+
+    struct FileHeader
+    {
+        char          magic[4];         // FILE_MAGIC
+        std::uint16_t version;          // schema version of the record layout
+        std::uint16_t headerBytes;      // FILE_HEADER_BYTES
+        std::uint32_t recordSize;       // bytes per record
+        std::uint32_t endianMark;       // FILE_ENDIAN_MARK
+        std::uint64_t liveRows;
+        std::uint64_t deadRows;         // tombstoned rows not yet compacted
+        std::uint64_t generation;       // bumped whenever a record slot changes
+        std::uint32_t statusOffset;     // where each record's status byte sits
+        std::uint32_t appendRun;        // latest generation bumps that were all appends
+        std::uint8_t  reserved[16];     // zero
+    };
+    static_assert(sizeof(FileHeader) == FILE_HEADER_BYTES, "header is one fixed block");
+
+    // dataOffset() of a file that starts with FILE_MAGIC but whose header
+    // does not describe it; nothing in such a file may be read as a record.
+    constexpr std::size_t BAD_HEADER = static_cast<std::size_t>(-1);
+
+    // Bytes before the first record: FILE_HEADER_BYTES if the file starts
+    // with a header this build can read, 0 if it does not start with
+    // FILE_MAGIC (legacy headerless file, or empty), BAD_HEADER otherwise:
+    // another schema version, byte order or header size, a record size of
+    // 0 or other than `recordSize` (when given), or row counts the file is
+    // too short to hold.
+    std::size_t dataOffset(int fd, std::size_t recordSize = 0);
+    std::size_t dataOffset(const std::string &path, std::size_t recordSize = 0);
+
+    // Position a freshly opened stream at its first record; returns the
+    // offset skipped (as dataOffset). On BAD_HEADER the stream is left
+    // failed, so every read from it fails.
+    std::size_t skipHeader(std::istream &in, std::size_t recordSize = 0);
+
     // Open an existing binary file for update (in/out), creating it if missing.
     // Returns open fstream object (by value) in binary mode positioned at end.
     // Throws std::ios_base::failure on open errors if exceptions enabled;
@@ -59,6 +115,33 @@ namespace FerrySys
     // Returns recordCount() if not found (caller can treat as npos).
     std::size_t linearSearch(std::fstream &fs, std::size_t recordSize,
                              const std::function<bool(std::size_t, const void*)> &predicate);
+
+    // Single-pass filter: copy the header and every record for which `remove`
+    // returns false to a temp file, fsync it and rename it over `path`, so a
+    // crash leaves either the old file or the new one. The file is left alone
+    // when nothing matches. `removed` receives the number of records dropped.
+    // Returns false on I/O error.
+    bool removeRecordsIf(const std::string &path, std::size_t recordSize,
+                         const std::function<bool(const void*)> &remove,
+                         std::size_t &removed);
+
+    // Single-pass tombstone: for every live record matching `match`, set the
+    // byte at `statusOffset` to REC_DEAD (a one-byte write per match; nothing
+    // moves). `marked` receives the number of records flipped; if
+    // `markedSlots` is given, their record indices are appended to it.
+    // Returns false on I/O error.
+    bool tombstoneRecordsIf(const std::string &path, std::size_t recordSize,
+                            std::size_t statusOffset,
+                            const std::function<bool(const void*)> &match,
+                            std::size_t &marked,
+                            std::vector<std::size_t> *markedSlots = nullptr);
+
+    // Batched random read: fetch the records at `indices` in one submission
+    // (io_uring where available, otherwise parallel pread; see AsyncIO.h).
+    // outBytes receives indices.size() * recordSize bytes, in indices order.
+    // Returns false if the file cannot be opened or any index is past EOF.
+    bool readRecordsBatch(const std::string &path, std::size_t recordSize,
+                          const std::vector<std::size_t> &indices, void *outBytes);
 }
 
 #endif // BINARY_FILE_OPS_HPP
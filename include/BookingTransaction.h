@@ -0,0 +1,98 @@
+//************************************************************
+//************************************************************
+//  BookingTransaction.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Books several (vehicle, sailing) pairs as a unit: every
+//    reservation is made, or none is. Used for fleet groups (many
+//    vehicles, one sailing) and round trips / multi-leg journeys
+//    (one vehicle, several sailings), or any mix.
+//
+//    commit() works on the whole set at once:
+//      1. one findVehicles() for every license (a vehicle on
+//         file is booked as stored, a new one is written with
+//         the booking)
+//      2. one CapacityTable::reserveGroup() per sailing (leg) for
+//         its total lane space; if a leg is full, the legs
+//         already taken are released
+//      3. one writeVehicles() for the new vehicles and one
+//         writeReservations() for every booking on every leg
+//      4. one persist() per sailing of its remaining space (if
+//         that fails the rows are undone: STORAGE_FAILED)
+//    inside a single WriteGate::Hold, so a backup or replica
+//    seed sees all of it or none of it. A failing step undoes
+//    the ones before it: the space is released and the new
+//    vehicles are deleted. Sailings are checked in the in-memory
+//    sailing table, so no file is scanned once per leg.
+//************************************************************
+//************************************************************
+
+#ifndef BOOKINGTRANSACTION_H
+#define BOOKINGTRANSACTION_H
+
+#include "CommonTypes.h"
+#include "VehicleRecord.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace FerrySys
+{
+
+// Why a commit was refused
+enum class BookingError
+{
+    NONE,
+    EMPTY,                  // no vehicles added
+    DUPLICATE_VEHICLE,      // a license added twice on one sailing
+    UNKNOWN_SAILING,
+    SAILING_FULL,           // not enough lane space on a sailing
+    ALREADY_BOOKED,         // a vehicle already holds this sailing
+    STORAGE_FAILED          // a read or write failed (or read-only replica)
+};
+
+class BookingTransaction
+{
+public:
+    BookingTransaction() = default;
+    explicit BookingTransaction(
+        const SailingID &sailingID      // IN: sailing for add(vehicle)
+    );
+
+    //------------------------------------------------------------
+    // Add a booking of `vehicle` on `sailingID` (or the sailing
+    // given to the constructor). Its phone and dimensions are only
+    // used if the license is not on file yet.
+    void add(const VehicleRecord &vehicle);
+    void add(const VehicleRecord &vehicle, const SailingID &sailingID);
+
+    std::size_t size() const { return bookings.size(); }
+
+    //------------------------------------------------------------
+    // Book every vehicle added (see the file comment).
+    // Postconditions: true and every reservation made, or false,
+    //                 nothing changed and error() says why.
+    bool commit();
+
+    BookingError error() const { return failure; }
+
+    // The sailing that was full or unknown (empty otherwise)
+    const SailingID &failedSailing() const { return failedAt; }
+
+    // Text for the menus, e.g. "not enough lane space"
+    static const char *describe(BookingError error);
+
+private:
+    bool fail(BookingError error, const SailingID &sailingID = SailingID());
+
+    SailingID                  defaultSailing;
+    std::vector<std::pair<VehicleRecord, SailingID>> bookings;
+    BookingError               failure = BookingError::NONE;
+    SailingID                  failedAt;
+};
+
+} // namespace FerrySys
+
+#endif // BOOKINGTRANSACTION_H
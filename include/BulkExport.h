@@ -0,0 +1,106 @@
+//************************************************************
+//************************************************************
+//  BulkExport.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Writes a table, or a view joining several, as CSV or JSON
+//    (`ferry export`), for reporting and for systems downstream
+//    of the ferry office. The tables and their columns:
+//
+//      vessels       name,laneHCL,laneLCL
+//      sailings      sailingID,vesselName,remainingHCL,remainingLCL
+//      vehicles      license,phone,length,height
+//      reservations  license,sailingID,checkedIn
+//      bookings      sailingID,vesselName,license,phone,length,
+//                    height,checkedIn
+//
+//    bookings is every reservation with its sailing's vessel and
+//    its vehicle's phone and dimensions (empty / null if the
+//    vehicle is gone). CSV has a column line first and is
+//    accepted back by BulkImport for vessels and vehicles; JSON
+//    is one array of objects, one per line.
+//
+//    Records are read a chunk at a time straight from the data
+//    files and formatted on the scan pool (ParallelScan.h) with
+//    std::to_chars into one buffer per chunk. Buffers are written
+//    in file order with large writes while the next chunks are
+//    being formatted, so output order is the file's and memory
+//    is bounded by two windows of a few chunks per worker.
+//
+//    Reservations in the partitioned or LSM layout are read
+//    through StorageBackend for every sailing on file.
+//************************************************************
+//************************************************************
+
+#ifndef BULKEXPORT_H
+#define BULKEXPORT_H
+
+#include <cstddef>
+#include <string>
+
+namespace FerrySys
+{
+
+enum class ExportKind
+{
+    VESSELS,
+    SAILINGS,
+    VEHICLES,
+    RESERVATIONS,
+    BOOKINGS
+};
+
+enum class ExportFormat
+{
+    CSV,
+    JSON
+};
+
+struct ExportResult
+{
+    bool        ok = false;         // every record read and written
+    std::size_t rows = 0;           // records written
+    std::size_t bytes = 0;          // output size
+};
+
+class BulkExport
+{
+public:
+    static constexpr std::size_t CHUNK_RECORDS = 16384;     // format unit
+
+    //------------------------------------------------------------
+    // Write `kind` as `format` to `outPath` (truncated first), or
+    // to standard output if outPath is "-".
+    // Postconditions: ok is false if a data file cannot be read
+    //                 or the output cannot be written.
+    static ExportResult run(
+        ExportKind kind,                    // IN
+        ExportFormat format,                // IN
+        const std::string &outPath          // IN
+    );
+
+    //------------------------------------------------------------
+    // "vessels" / "sailings" / "vehicles" / "reservations" /
+    // "bookings"
+    static const char *kindName(ExportKind kind);
+    static bool parseKind(
+        const std::string &text,            // IN
+        ExportKind &kind                    // OUT
+    );
+
+    //------------------------------------------------------------
+    // "csv" / "json"
+    static bool parseFormat(
+        const std::string &text,            // IN
+        ExportFormat &format                // OUT
+    );
+
+    //------------------------------------------------------------
+    // Column line for `kind` (as in the table above).
+    static const char *columns(ExportKind kind);
+};
+
+} // namespace FerrySys
+
+#endif // BULKEXPORT_H
@@ -0,0 +1,100 @@
+//************************************************************
+//************************************************************
+//  BulkImport.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Loads vessels, sailings, vehicles or reservations from a
+//    CSV file (`ferry import`), for partner and legacy data that
+//    would otherwise be typed in through the menus. One row per
+//    line, in these columns:
+//
+//      vessels       name,laneHCL,laneLCL
+//      sailings      sailingID,vesselName
+//      vehicles      license,phone,length,height
+//      reservations  license,sailingID
+//
+//    A first line naming the columns is skipped, as are blank
+//    lines and lines starting with '#'. Fields may be quoted.
+//
+//    The file is mapped and cut into line-aligned chunks that are
+//    parsed on the scan pool (ParallelScan.h) straight into
+//    records. Each round of chunks is then checked as a batch:
+//    vehicle and reservation keys against the index snapshots
+//    (IndexSnapshot.h), vessels and sailings against one scan of
+//    their small files, and every key against the rest of the
+//    input. Accepted records are appended to the data file in
+//    large blocks with one header update per round. A sailing
+//    takes its vessel's lane lengths; a reservation takes lane
+//    space through CapacityTable, so a full sailing rejects the
+//    rest of its rows.
+//
+//    Rejected rows go to the reject file as
+//      <line>,<reason>,<the line as read>
+//    and nothing else about the import is affected by them.
+//
+//    Reservations in the partitioned or LSM layout are written
+//    one at a time through FileIO_Reservations. Like every tool
+//    that writes the data files, not safe against another
+//    process using them at the same time.
+//************************************************************
+//************************************************************
+
+#ifndef BULKIMPORT_H
+#define BULKIMPORT_H
+
+#include <cstddef>
+#include <string>
+
+namespace FerrySys
+{
+
+enum class ImportKind
+{
+    VESSELS,
+    SAILINGS,
+    VEHICLES,
+    RESERVATIONS
+};
+
+struct ImportResult
+{
+    bool        ok = false;         // input read, accepted rows all written
+    std::size_t rows = 0;           // data lines in the input
+    std::size_t imported = 0;
+    std::size_t rejected = 0;       // lines written to the reject file
+};
+
+class BulkImport
+{
+public:
+    static constexpr std::size_t CHUNK_BYTES = 1 << 20;         // parse unit
+    static constexpr std::size_t ROUND_BYTES = 64 << 20;        // checked and written together
+
+    //------------------------------------------------------------
+    // Import `csvPath` as `kind`, writing rejected rows to
+    // `rejectPath` (truncated first).
+    // Postconditions: ok is false if the input or reject file
+    //                 cannot be opened or a write failed.
+    static ImportResult run(
+        ImportKind kind,                    // IN
+        const std::string &csvPath,         // IN
+        const std::string &rejectPath       // IN
+    );
+
+    //------------------------------------------------------------
+    // "vessels" / "sailings" / "vehicles" / "reservations"
+    static const char *kindName(ImportKind kind);
+    static bool parseKind(
+        const std::string &text,            // IN
+        ImportKind &kind                    // OUT
+    );
+
+    //------------------------------------------------------------
+    // Column line for `kind` (as in the table above).
+    static const char *columns(ImportKind kind);
+};
+
+} // namespace FerrySys
+
+#endif // BULKIMPORT_H
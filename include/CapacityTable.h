@@ -0,0 +1,211 @@
+//************************************************************
+//************************************************************
+//  CapacityTable.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Table of remaining lane space per sailing, held as atomic
+//    fixed-point centimetres. Booking reserves space with a
+//    compare-and-swap, so a vehicle is only accepted if the space
+//    is still there at the instant it is taken; there is no window
+//    between "check" and "deduct".
+//
+//    Other terminals, ferryd and imports book the same sailings
+//    from their own processes, so the table lives in
+//    sailings.space in the data directory, mapped shared by every
+//    process. Its counters are the authority on remaining space:
+//    a booking in any process is one compare-and-swap on them,
+//    with no lock and no file I/O. sailings.dat keeps a copy that
+//    persist() brings up to date once the booking is written. The
+//    MEMORY engine keeps the table in anonymous memory instead.
+//
+//    • reserve()/reserveGroup()/release() are lock-free
+//    • add()/remove() (sailing create/delete) and the first use of
+//      a sailing are serialized (flock() on sailings.space)
+//    • persist() writes a sailing's counters back through the
+//      storage engine (StorageBackend.h); one writer per sailing
+//      at a time, and a process that finds one busy leaves its
+//      change to it instead of waiting
+//************************************************************
+//************************************************************
+
+#ifndef CAPACITYTABLE_H
+#define CAPACITYTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CommonTypes.h"
+
+namespace FerrySys
+{
+
+// Lane a booking was taken from
+enum class Lane : std::uint8_t
+{
+    NONE,   // nothing reserved
+    HCL,    // high-ceiling lane
+    LCL     // low-ceiling lane
+};
+
+// One vehicle's share of a group booking (CapacityTable::reserveGroup)
+struct LaneRequest
+{
+    std::int32_t spaceCm = 0;           // IN: see vehicleSpaceCm
+    bool         highCeiling = false;   // IN: vehicle needs HCL
+    Lane         lane = Lane::NONE;     // OUT: lane assigned
+};
+
+class CapacityTable
+{
+public:
+    static constexpr std::size_t  INITIAL_SLOTS     = 4096; // first level (power of two); grows by doubling
+    static constexpr std::int32_t PARKING_BUFFER_CM = 50;   // gap behind each vehicle
+
+    //------------------------------------------------------------
+    // Attach to the table in the current directory and fill it from
+    // `sailings.dat` (and vessel capacities). Sailings already in
+    // sailings.space keep their counters; any left unwritten by a
+    // process that died are written back, and space changed on file
+    // by other means (a restored backup) is taken on.
+    // Postconditions: every sailing on file has a slot.
+    static void load();
+
+    //------------------------------------------------------------
+    // Detach from the table (used by shutdown and tests): the
+    // MEMORY engine's table is dropped, sailings.space stays for the
+    // other processes. The next call attaches again.
+    // Preconditions : no other thread is using the table.
+    static void clear();
+
+    //------------------------------------------------------------
+    // Register a sailing. Capacities bound release(); pass 0 for
+    // "unknown" (no upper bound).
+    // Postconditions: false if the sailing is already present (or,
+    //                 reported on stderr, the table cannot be
+    //                 opened or grown).
+    static bool add(
+        SailingID sailingID,        // IN: sailing
+        float remainingHCL,         // IN: free HCL (m)
+        float remainingLCL,         // IN: free LCL (m)
+        float capacityHCL,          // IN: vessel HCL (m), 0 = unbounded
+        float capacityLCL           // IN: vessel LCL (m), 0 = unbounded
+    );
+
+    //------------------------------------------------------------
+    // Forget a sailing (after it is deleted).
+    static bool remove(
+        SailingID sailingID         // IN: sailing
+    );
+
+    //------------------------------------------------------------
+    // Atomically take `lengthCm` of lane space. High-ceiling
+    // vehicles must use HCL; others prefer LCL and fall back to
+    // HCL. Sailings not yet in the table are loaded from file.
+    // Postconditions: true and `lane` set if space was taken.
+    static bool reserve(
+        SailingID sailingID,        // IN: sailing
+        std::int32_t lengthCm,      // IN: space needed (cm)
+        bool highCeiling,           // IN: vehicle needs HCL
+        Lane &lane                  // OUT: lane the space came from
+    );
+
+    //------------------------------------------------------------
+    // Take space for a whole group on one sailing, all or none.
+    // Lanes are assigned as reserve() would, in order (the LCL
+    // until it runs out, then HCL), and the group's total for each
+    // lane is then taken with one compare-and-swap per lane.
+    // Postconditions: true and every `lane` set, or false with
+    //                 nothing taken and every `lane` NONE.
+    static bool reserveGroup(
+        SailingID sailingID,                    // IN: sailing
+        std::vector<LaneRequest> &requests      // IN/OUT
+    );
+
+    //------------------------------------------------------------
+    // Return space taken by reserve() to the given lane.
+    static void release(
+        SailingID sailingID,        // IN: sailing
+        std::int32_t lengthCm,      // IN: space to return (cm)
+        Lane lane                   // IN: lane it was taken from
+    );
+
+    //------------------------------------------------------------
+    // Return space for a booking whose lane was not recorded:
+    // HCL for high vehicles, otherwise LCL up to its capacity and
+    // HCL for any overflow.
+    static void releaseVehicle(
+        SailingID sailingID,        // IN: sailing
+        std::int32_t lengthCm,      // IN: space to return (cm)
+        bool highCeiling            // IN: vehicle needs HCL
+    );
+
+    //------------------------------------------------------------
+    // Snapshot of remaining space in metres.
+    static bool remaining(
+        SailingID sailingID,        // IN: sailing
+        float &remainingHCL,        // OUT: metres
+        float &remainingLCL         // OUT: metres
+    );
+
+    //------------------------------------------------------------
+    // Write the sailing's counters to `sailings.dat`. If another
+    // thread or process is writing this sailing back already, return
+    // at once: that writer checks again before it finishes and
+    // writes this change too.
+    // Postconditions: false if the sailing is not on file or the
+    //                 write failed (the change stays pending for
+    //                 the next persist()).
+    static bool persist(
+        SailingID sailingID         // IN: sailing
+    );
+
+    //------------------------------------------------------------
+    // Changes to sailings.dat counted in sailings.space, so every
+    // process can tell with one load whether its copy of the file
+    // is current (SailingTable.h). `attachment` differs after the
+    // table is attached again (clear(), another directory), when
+    // the count may start elsewhere.
+    struct SailingsVersion
+    {
+        std::uint64_t attachment = 0;
+        std::uint64_t changes = 0;
+    };
+
+    //------------------------------------------------------------
+    // Read the count, or bump it after a change to sailings.dat
+    // (`before` receives the count the change followed). False if
+    // sailings.space cannot be used.
+    static bool sailingsVersion(
+        SailingsVersion &now        // OUT
+    );
+    static bool noteSailingsChanged(
+        SailingsVersion &before     // OUT
+    );
+
+    //------------------------------------------------------------
+    // The same count for changes to how this directory's updates
+    // are replicated: the mutation log created or replaced
+    // (MutationLog.h). MutationLog and Replica keep what they last
+    // found on disk until it moves. False if sailings.space cannot
+    // be used or is not shared (MEMORY engine).
+    static bool replicationVersion(
+        SailingsVersion &now        // OUT
+    );
+    static void noteReplicationChanged();
+
+    //------------------------------------------------------------
+    // Space a vehicle of `lengthM` metres occupies, in centimetres.
+    static std::int32_t vehicleSpaceCm(
+        std::int32_t lengthM        // IN: vehicle length (m)
+    );
+
+    //------------------------------------------------------------
+    // Fixed-point conversions (1 unit = 1 cm).
+    static std::int32_t toCentimetres(float metres);
+    static float        toMetres(std::int32_t centimetres);
+};
+
+} // namespace FerrySys
+
+#endif // CAPACITYTABLE_H
@@ -11,9 +11,13 @@
 // basic STL
 #include <string>
 
+#include "FixedString.h"
+
 //------------------------------------------------------------
 // Simple aliases used across all modules.
-typedef std::string SailingID;      // IN : unique sailing identifier
+// Sailing IDs keep to 15 characters so the 16-byte id field of a
+// sailing record always ends in a NUL.
+typedef FerrySys::FixedString<15> SailingID;   // IN : unique sailing identifier ("CCC:DD:HH")
 typedef unsigned int  ReservationID;  // IN : unique reservation identifier
 
 #endif // COMMONTYPES_H
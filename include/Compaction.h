@@ -0,0 +1,130 @@
+//************************************************************
+//************************************************************
+//  Compaction.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Dead-row bookkeeping and compaction for the four data
+//    files.
+//
+//    Deletes only flip a record's status byte to REC_DEAD, so a
+//    cancellation is one in-place write. Dead rows stay in the
+//    file (every reader skips them) until compaction rewrites
+//    the file without them in one pass and then runs the
+//    table's rebuild hooks, so indexes that store record slots
+//    can be rebuilt.
+//
+//    Compaction is triggered when a table's dead rows reach
+//    DEAD_RATIO_THRESHOLD of its rows (and at least
+//    MIN_DEAD_ROWS), and unconditionally at module shutdown().
+//    Vehicles and reservations refill dead slots on insert (see
+//    FreeList.h), so under steady churn they rarely get there.
+//    It must run when no other thread is using the data files:
+//    the UI runs it between menu actions; ferryd queues it on
+//    its pool under the exclusive data lock.
+//
+//    Dead-row ratios are published as Metrics gauges; compaction
+//    time appears as the "Compactor::compact" operation.
+//************************************************************
+//************************************************************
+
+#ifndef COMPACTION_H
+#define COMPACTION_H
+
+#include <cstddef>
+#include <functional>
+
+namespace FerrySys
+{
+
+enum class Table
+{
+    VEHICLES,
+    RESERVATIONS,
+    SAILINGS,
+    VESSELS,
+    COUNT
+};
+
+// Where a table lives and where its status byte sits
+struct TableLayout
+{
+    const char  *file;
+    std::size_t  recordSize;
+    std::size_t  statusOffset;
+};
+
+struct TableStats
+{
+    const char *file = "";
+    std::size_t rows = 0;          // including dead rows
+    std::size_t dead = 0;
+    double      deadRatio = 0.0;
+};
+
+class Compactor
+{
+public:
+    static constexpr double      DEAD_RATIO_THRESHOLD = 0.25;
+    static constexpr std::size_t MIN_DEAD_ROWS = 64;
+
+    //------------------------------------------------------------
+    // Record that `count` rows of `table` were just tombstoned.
+    static void noteDead(
+        Table table,                    // IN
+        std::size_t count = 1           // IN
+    );
+
+    //------------------------------------------------------------
+    // Record that a dead row of `table` was overwritten by an
+    // insert (free-slot reuse, see FreeList.h).
+    static void noteReused(
+        Table table                     // IN
+    );
+
+    //------------------------------------------------------------
+    // True if any table has passed the dead-row threshold.
+    static bool compactionDue();
+
+    //------------------------------------------------------------
+    // Compact every table that has passed the threshold.
+    // Preconditions : no other thread is using the data files.
+    static void compactIfNeeded();
+
+    //------------------------------------------------------------
+    // Rewrite `table` without its dead rows, then run its rebuild
+    // hooks. Returns the number of rows dropped (no-op when the
+    // table has none).
+    // Preconditions : no other thread is using the data files.
+    static std::size_t compact(
+        Table table                     // IN
+    );
+
+    //------------------------------------------------------------
+    // File name, record size and status-byte offset of `table`.
+    static const TableLayout &layout(
+        Table table                     // IN
+    );
+
+    //------------------------------------------------------------
+    // Current row / dead-row counts for `table`.
+    static TableStats stats(
+        Table table                     // IN
+    );
+
+    //------------------------------------------------------------
+    // Run `hook` after every compaction of `table` (index rebuild).
+    static void onCompacted(
+        Table table,                    // IN
+        std::function<void()> hook      // IN
+    );
+
+    //------------------------------------------------------------
+    // Forget cached file headers; they are read again on next use
+    // (after files were replaced outside FileIO).
+    static void resetCounts();
+};
+
+} // namespace FerrySys
+
+#endif // COMPACTION_H
@@ -0,0 +1,130 @@
+//************************************************************
+//************************************************************
+//  DataFile.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    The versioned header at the start of vehicles.dat,
+//    reservations.dat, sailings.dat and vessels.dat (FileHeader
+//    in BinaryFileOps.hpp): magic, schema version, record size,
+//    status-byte offset, byte-order marker, live and dead row
+//    counts and a generation number.
+//
+//    Opening a table reads and checks the header once, so row
+//    and dead-row counts cost nothing afterwards (Compactor no
+//    longer scans for them). A file from another schema version,
+//    record size or byte order is refused with a message rather
+//    than misread, as is one whose row counts do not fit its
+//    size or that ends in a partial record. Every reader checks
+//    the header the same way (dataOffset in BinaryFileOps.hpp)
+//    and reads nothing from a file it refuses. A legacy
+//    headerless file is upgraded on open:
+//    the header and the old records are written to a temp file
+//    that is renamed over the original, and the directory synced.
+//
+//    The generation changes whenever a record slot is filled or
+//    moved (append, free-slot reuse, compaction, upgrade), so an
+//    index that stores slots keeps the generation it was built
+//    at and knows it is stale with one comparison (see
+//    SailingIndex.h). A new file starts its generations at the
+//    creation time in microseconds, so a file that is deleted
+//    and recreated never repeats an old file's numbers.
+//    appendRun counts how many of the latest bumps were appends
+//    only; an index at most that many generations behind is
+//    brought up to date from the records past the rows it
+//    covers (see IndexSnapshot.h).
+//
+//    FileIO and the storage engines call note*() after every
+//    change; the header is rewritten in place (one 64-byte
+//    write). Row totals are taken from the file size when a
+//    header is rewritten, so only dead rows are really counted.
+//    Every call reads the header from the file, under an OFD
+//    lock on its bytes (exclusive from an update's read to its
+//    write), so counts and generations changed by another
+//    process are seen at once and never overwritten. Thread-safe.
+//************************************************************
+//************************************************************
+
+#ifndef DATAFILE_H
+#define DATAFILE_H
+
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FerrySys
+{
+
+class DataFile
+{
+public:
+    static constexpr std::uint16_t SCHEMA_VERSION = FILE_SCHEMA_VERSION;
+
+    //------------------------------------------------------------
+    // Check `table`'s header, upgrading a headerless file. With
+    // `create`, a missing or empty file is created with a fresh
+    // header. Returns false (and prints why) if the file cannot
+    // be used; a missing file is not an error.
+    static bool open(
+        Table table,                    // IN
+        bool create = false             // IN
+    );
+
+    //------------------------------------------------------------
+    // Open every table (module initialize).
+    static bool openAll();
+
+    //------------------------------------------------------------
+    // Copy of `table`'s header. Returns false if the file is
+    // missing or unusable.
+    static bool header(
+        Table table,                    // IN
+        FileHeader &out                 // OUT
+    );
+
+    //------------------------------------------------------------
+    // Counts from the header (0 if the file is missing).
+    static std::size_t rows(Table table);       // live + dead
+    static std::size_t deadRows(Table table);
+    static std::uint64_t generation(Table table);
+
+    //------------------------------------------------------------
+    // Header upkeep after a change to `table`'s file.
+    static void noteAppended(Table table, std::size_t count = 1);
+    static void noteDead(Table table, std::size_t count = 1);
+    static void noteReused(Table table, std::size_t count = 1);
+    static void noteCompacted(Table table);     // no dead rows left
+
+    //------------------------------------------------------------
+    // Give `path` (headerless, `recordSize`-byte records) a header,
+    // counting dead rows from the byte at `statusOffset`. No-op if
+    // it already has one. Returns false on I/O error (file left as
+    // it was). Holds an exclusive flock on `<path>.lock` throughout,
+    // so processes opening the same legacy file upgrade it once.
+    static bool upgrade(
+        const std::string &path,        // IN
+        std::size_t recordSize,         // IN
+        std::size_t statusOffset        // IN
+    );
+
+    //------------------------------------------------------------
+    // Drop cached headers; they are read again on next use (after
+    // files were replaced outside FileIO).
+    static void forget();
+
+private:
+    //------------------------------------------------------------
+    // upgrade() with the lock held
+    static bool upgradeLocked(
+        const std::string &path,        // IN
+        std::size_t recordSize,         // IN
+        std::size_t statusOffset        // IN
+    );
+};
+
+} // namespace FerrySys
+
+#endif // DATAFILE_H
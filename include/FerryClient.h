@@ -0,0 +1,89 @@
+//************************************************************
+//************************************************************
+//  FerryClient.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Thin client for the `ferryd` daemon. Mirrors the business
+//    layer calls a terminal needs (Vessel, Sailing, Reservation)
+//    but sends them over the daemon socket instead of touching
+//    the .dat files directly.
+//
+//    • One call = one frame with a single request
+//    • call() sends a whole batch in one round trip
+//************************************************************
+//************************************************************
+
+#ifndef FERRYCLIENT_H
+#define FERRYCLIENT_H
+
+#include <string>
+#include <vector>
+#include "CommonTypes.h"
+#include "FerryProtocol.h"
+#include "VehicleRecord.hpp"
+
+namespace FerrySys
+{
+
+class FerryClient
+{
+public:
+    FerryClient() = default;
+    ~FerryClient();
+
+    FerryClient(const FerryClient &) = delete;
+    FerryClient &operator=(const FerryClient &) = delete;
+
+    //------------------------------------------------------------
+    // Connect to a running daemon.
+    // Postconditions: returns false if the socket is unreachable.
+    bool connect(
+        const std::string &socketPath = Proto::DEFAULT_SOCKET  // IN
+    );
+
+    //------------------------------------------------------------
+    // Close the connection (also done by the destructor).
+    void disconnect();
+
+    bool isConnected() const { return fd >= 0; }
+
+    //------------------------------------------------------------
+    // Build a blank request for `op` (all text fields space-padded).
+    static Proto::RequestRec makeRequest(
+        Proto::OpCode op                // IN: operation
+    );
+
+    //------------------------------------------------------------
+    // Send a batch and wait for its responses (one round trip).
+    // Preconditions : 1..MAX_BATCH requests, connected.
+    // Postconditions: responses[i] answers requests[i].
+    bool call(
+        const std::vector<Proto::RequestRec> &requests,  // IN
+        std::vector<Proto::ResponseRec> &responses       // OUT
+    );
+
+    // Single-request conveniences (false on refusal or I/O error)
+    bool ping();
+    bool vehicleExists(const LicensePlate &licensePlate);
+    bool sailingExists(SailingID sailingID);
+    bool getRemainingSpace(SailingID sailingID, float &remainingHCL, float &remainingLCL);
+    int  countReservations(SailingID sailingID);
+    bool reservationExists(const LicensePlate &licensePlate, SailingID sailingID);
+    bool newCustomerReservation(const VehicleRecord &vehicle, SailingID sailingID);
+    bool returningCustomerReservation(const LicensePlate &licensePlate, SailingID sailingID);
+    bool deleteReservation(const LicensePlate &licensePlate, SailingID sailingID);
+    bool checkinVehicle(const LicensePlate &licensePlate, SailingID sailingID);
+
+    // Replica lag (false if the daemon is not a follower)
+    bool replicaLag(long &records, double &seconds);
+
+private:
+    bool callOne(const Proto::RequestRec &req, Proto::ResponseRec &res);
+
+    int fd = -1;
+};
+
+} // namespace FerrySys
+
+#endif // FERRYCLIENT_H
@@ -0,0 +1,188 @@
+//************************************************************
+//************************************************************
+//  FerryProtocol.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Wire format spoken between the `ferryd` reservation daemon
+//    and its thin clients over a Unix domain socket.
+//
+//    Same philosophy as the .dat files: every message is built
+//    from fixed-length, space-padded binary records, so neither
+//    side ever parses text.
+//
+//      frame    = FrameHeader + count * RequestRec   (client -> server)
+//      reply    = FrameHeader + count * ResponseRec  (server -> client)
+//
+//    A frame carries a *batch* of operations. The server runs
+//    the whole batch under one lock acquisition and answers
+//    with one response record per request, in order.
+//************************************************************
+//************************************************************
+
+#ifndef FERRYPROTOCOL_H
+#define FERRYPROTOCOL_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "VehicleRecord.hpp"
+
+namespace FerrySys
+{
+namespace Proto
+{
+    //------------------------------------------------------------
+    // Frame constants
+    constexpr std::uint32_t FRAME_MAGIC   = 0x31595246; // "FRY1" little-endian
+    constexpr std::size_t   MAX_BATCH     = 256;        // requests per frame
+    constexpr const char   *DEFAULT_SOCKET = "ferryd.sock";
+
+    //------------------------------------------------------------
+    // Operations served by the daemon
+    enum class OpCode : std::uint8_t
+    {
+        PING = 0,
+
+        // Vessel
+        VESSEL_CREATE,          // vesselName, arg0 = HCL, arg1 = LCL
+        VESSEL_DELETE,          // vesselName
+        VESSEL_EXISTS,          // vesselName
+
+        // Sailing
+        SAILING_CREATE,         // city, vesselName, date, time
+        SAILING_DELETE,         // sailingID
+        SAILING_EXISTS,         // sailingID
+        SAILING_SPACE,          // sailingID -> hcl, lcl
+        SAILING_COUNT,          // sailingID -> value = reservations
+
+        // Reservation
+        RESERVE_NEW,            // license, phone, arg0 = length, arg1 = height, sailingID
+        RESERVE_RETURNING,      // license, sailingID
+        RESERVATION_DELETE,     // license, sailingID
+        RESERVATION_EXISTS,     // license, sailingID
+        CHECKIN,                // license, sailingID
+        VEHICLE_EXISTS,         // license
+
+        // Replication
+        REPLICA_STATUS,         // -> value = records behind, hcl = seconds behind
+
+        OP_COUNT
+    };
+
+    //------------------------------------------------------------
+    // Per-request outcome
+    enum class Status : std::uint8_t
+    {
+        OK = 0,         // operation succeeded / predicate true
+        FAILED,         // operation refused / predicate false
+        BAD_REQUEST,    // unknown opcode or malformed frame
+        READ_ONLY       // update sent to a replica (see Replica.h)
+    };
+
+#pragma pack(push, 1)
+    //------------------------------------------------------------
+    // Frame header (8 bytes)
+    struct FrameHeader
+    {
+        std::uint32_t magic;        // FRAME_MAGIC
+        std::uint16_t count;        // number of records that follow
+        std::uint16_t reserved;     // 0
+    };
+
+    //------------------------------------------------------------
+    // Request record (89 bytes). Unused fields are space-padded.
+    struct RequestRec
+    {
+        std::uint8_t op;                      // OpCode
+        char         license[VEH_LIC_CHARS];  // 10 chars
+        char         phone[VEH_PHONE_CHARS];  // 14 chars
+        char         sailingID[16];           // ttt:dd:hh
+        char         vesselName[25];
+        char         city[3];
+        char         date[8];                 // YY-MM-DD
+        char         time[4];                 // HHMM
+        std::int32_t arg0;
+        std::int32_t arg1;
+    };
+
+    //------------------------------------------------------------
+    // Response record (14 bytes)
+    struct ResponseRec
+    {
+        std::uint8_t op;            // echo of request OpCode
+        std::uint8_t status;        // Status
+        std::int32_t value;         // op-specific (enum result, count)
+        float        hcl;           // remaining HCL (SAILING_SPACE)
+        float        lcl;           // remaining LCL (SAILING_SPACE)
+    };
+#pragma pack(pop)
+
+    //------------------------------------------------------------
+    // True for operations that never modify the data files;
+    // the server runs all-read batches under a shared lock.
+    inline bool isReadOnly(OpCode op)
+    {
+        switch (op)
+        {
+            case OpCode::PING:
+            case OpCode::VESSEL_EXISTS:
+            case OpCode::SAILING_EXISTS:
+            case OpCode::SAILING_SPACE:
+            case OpCode::SAILING_COUNT:
+            case OpCode::RESERVATION_EXISTS:
+            case OpCode::VEHICLE_EXISTS:
+            case OpCode::REPLICA_STATUS:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    //------------------------------------------------------------
+    // Blocking helpers: transfer exactly `len` bytes on a socket.
+    // Return false on EOF or error (EINTR is retried). A peer that
+    // hangs up yields false rather than SIGPIPE where supported.
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    inline bool sendAll(int fd, const void *buf, std::size_t len)
+    {
+        const char *p = static_cast<const char*>(buf);
+        while (len > 0)
+        {
+            ssize_t n = ::send(fd, p, len, SEND_FLAGS);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p   += n;
+            len -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    inline bool recvAll(int fd, void *buf, std::size_t len)
+    {
+        char *p = static_cast<char*>(buf);
+        while (len > 0)
+        {
+            ssize_t n = ::read(fd, p, len);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p   += n;
+            len -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+} // namespace Proto
+} // namespace FerrySys
+
+#endif // FERRYPROTOCOL_H
@@ -0,0 +1,108 @@
+//************************************************************
+//************************************************************
+//  FerryServer.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Declares the FerryServer class behind the `ferryd` daemon.
+//    The server owns the data files for the lifetime of the
+//    process and serves Vessel, Sailing and Reservation
+//    operations to many check-in terminals at once.
+//
+//    • One poll() loop accepts connections and reads frames
+//      without blocking, into a buffer per connection
+//    • A whole frame is handed to a worker ThreadPool, which runs
+//      its batch and writes the reply; a terminal that stops part
+//      way through a frame (FRAME_TIMEOUT_MS) or does not take its
+//      reply (SEND_TIMEOUT_MS) is disconnected, so no worker ever
+//      waits on a terminal
+//    • Batches that only read share the data lock; a batch with
+//      any mutation holds it exclusively for the whole batch
+//    • Started in a replica directory (see Replica.h) it is a
+//      follower: updates are answered READ_ONLY and a thread
+//      applies the primary's log under the exclusive lock
+//************************************************************
+//************************************************************
+
+#ifndef FERRYSERVER_H
+#define FERRYSERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FerryProtocol.h"
+#include "ThreadPool.h"
+
+namespace FerrySys
+{
+
+class FerryServer
+{
+public:
+    static constexpr int APPLY_INTERVAL_MS = 50;   // follower log polling
+    static constexpr int FRAME_TIMEOUT_MS = 2000;  // from a frame's first byte to its last
+    static constexpr int SEND_TIMEOUT_MS = 2000;   // for a reply to be taken
+
+    //------------------------------------------------------------
+    // Configure the server; nothing is opened until run().
+    FerryServer(
+        const std::string &socketPath,  // IN: Unix socket path
+        std::size_t workerCount         // IN: worker threads (0 = auto)
+    );
+
+    ~FerryServer();
+
+    //------------------------------------------------------------
+    // Bind the socket, initialize the business modules and serve
+    // until requestStop() is called.
+    // Preconditions : socket path is writable.
+    // Postconditions: returns false if the socket could not be
+    //                 bound; modules are shut down on return.
+    bool run();
+
+    //------------------------------------------------------------
+    // Ask run() to return. Async-signal-safe.
+    void requestStop();
+
+    //------------------------------------------------------------
+    // Execute one batch against the business layer. Exposed so the
+    // dispatch logic can be exercised without a socket.
+    // Postconditions: responses has one record per request.
+    void executeBatch(
+        const std::vector<Proto::RequestRec> &requests,   // IN
+        std::vector<Proto::ResponseRec> &responses        // OUT
+    );
+
+private:
+    void serveFrame(int fd, const std::vector<Proto::RequestRec> &requests);
+    void rearm(int fd);
+    Proto::ResponseRec execute(const Proto::RequestRec &req);
+    void applyLoop();
+
+    std::string         socketPath;
+    ThreadPool          pool;
+    int                 listenFd = -1;
+    int                 wakePipe[2] = { -1, -1 };
+    std::atomic<bool>   stopping{ false };
+
+    // Guards the data files: shared for read-only batches.
+    std::shared_mutex   dataLock;
+    std::atomic<bool>   compactionQueued{ false };
+    std::atomic<bool>   checkpointQueued{ false };
+
+    // Follower mode: set by run() in a replica directory.
+    bool                follower = false;
+    std::thread         applier;
+
+    // Sockets finished by a worker and waiting to rejoin poll().
+    std::mutex          readyLock;
+    std::vector<int>    readyFds;
+};
+
+} // namespace FerrySys
+
+#endif // FERRYSERVER_H
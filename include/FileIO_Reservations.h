@@ -10,7 +10,13 @@
 //   • Calculating available space for a sailing
 //
 // Reservations are stored with fixed-length fields:
-//   License = 10 chars, SailingID = 16 chars, CheckedIn = bool
+//   License = 10 chars, SailingID = 16 chars, Status = 1 byte
+// The status byte was the old CheckedIn bool, so existing files read as
+// booked (0) / checked in (1). Deletes set it to REC_DEAD in place.
+//
+// The same records can instead be stored one file per sailing
+// (ReservationStorage::PARTITIONED) or in a log-structured store
+// (ReservationStorage::LSM); every operation below works in any mode.
 // ---------------------------------------------------------------------------
 
 #ifndef FILEIO_RESERVATIONS_H
@@ -19,7 +25,13 @@
 #include "VehicleRecord.hpp"     // for encodeField/decodeField helpers
 #include "FileIO_VehicleRecord.h"
 #include "FileIO_Sailings.h"
+#include "BinaryFileOps.hpp"     // REC_LIVE / REC_DEAD
+#include "CommonTypes.h"        // SailingID
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Fixed-length reservation record layout
@@ -29,12 +41,20 @@ struct ReservationRec
 {
     char licenseplate[FerrySys::VEH_LIC_CHARS]; // 10 chars
     char sailingID[16];                         // 16 chars
-    bool checkedIn;                             // 1 byte
+    std::uint8_t status;                        // RES_BOOKED / RES_CHECKED_IN / REC_DEAD
 };
 #pragma pack(pop)
 
-// Alias for sailing ID type
-using SailingID = std::string;
+constexpr std::uint8_t RES_BOOKED     = FerrySys::REC_LIVE;
+constexpr std::uint8_t RES_CHECKED_IN = 0x01;
+
+// Where reservations are kept
+enum class ReservationStorage
+{
+    FLAT,           // one reservations.dat for every sailing
+    PARTITIONED,    // one file per sailing (see ReservationPartitions.h)
+    LSM             // memtable + sorted runs (see ReservationLSM.h)
+};
 
 class FileIO_Reservations
 {
@@ -47,20 +67,44 @@ public:
                                    SailingID &sailingID,
                                    bool &checkedIn);
 
-    // Append new reservation to file
+    // Store new reservation (fills a cancelled slot if one is free,
+    // otherwise appends)
     static bool writeReservation(const std::string &licensePlate,
                                  SailingID sailingID);
 
+    // Store several reservations, all or none: refused if any key is
+    // already booked or appears twice. The flat file is checked with
+    // one batched read and written with one append; the other
+    // layouts write one at a time and remove them again on a refusal.
+    static bool writeReservations(const std::vector<std::pair<std::string, SailingID>> &bookings);
+
     // Mark reservation as checked-in
     static bool writeCheckin(const std::string &licensePlate,
                              SailingID sailingID);
 
-    // Delete specific reservation
+    // Delete specific reservation (tombstoned in place)
     static bool deleteReservation(const std::string &licensePlate,
                                   SailingID sailingID);
 
-    // Count reservations for a specific sailing
-    static int countReservationsForSailing(SailingID sailingID);
+    // Tombstone every reservation on any of the given sailings in a single
+    // pass (cascade for sailing deletion). Returns rows removed.
+    static int deleteReservationsForSailings(const std::vector<SailingID> &sailingIDs);
+
+    // Every live reservation on any of the given sailings (case-insensitive
+    // IDs), e.g. to archive them
+    static bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                            std::vector<ReservationRec> &rows);
+
+    // Count reservations for a specific sailing (-1 if reservations.dat
+    // cannot be read). With includeArchive, a sailing that is no longer
+    // in sailings.dat is answered from the archive (see Archive.h).
+    static int countReservationsForSailing(SailingID sailingID,
+                                           bool includeArchive = false);
+
+    // Count reservations for every sailing in one parallel pass
+    // (keys are upper-cased sailing IDs); false if the file cannot
+    // be read
+    static bool countReservationsBySailing(std::unordered_map<std::string, int> &counts);
 
     // Check if a reservation already exists for a given license and sailing
     static bool reservationExists(const std::string &licensePlate,
@@ -69,6 +113,24 @@ public:
 
     // Compute total available space (HCL + LCL) for a sailing
     static int spaceAvailable(SailingID sailingID);
+
+    // Storage mode in use. Chosen on first use: FERRY_RES_STORAGE=flat,
+    // =partitioned or =lsm if set, otherwise PARTITIONED when a partition
+    // catalog exists, LSM when an LSM manifest exists. Choosing PARTITIONED
+    // or LSM moves an existing reservations.dat into that store.
+    static ReservationStorage storageMode();
+
+    // Switch storage mode (switching to PARTITIONED or LSM migrates the
+    // flat file)
+    static void setStorageMode(ReservationStorage mode);
+
+    // Split reservations.dat into per-sailing partitions; the flat file is
+    // kept as reservations.dat.migrated. Returns rows moved, -1 on error.
+    static int migrateToPartitions();
+
+    // Load reservations.dat into the LSM store; the flat file is kept as
+    // reservations.dat.migrated. Returns rows moved, -1 on error.
+    static int migrateToLSM();
 };
 
 #endif // FILEIO_RESERVATIONS_H
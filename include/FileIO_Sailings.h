@@ -10,14 +10,19 @@
 //      • Fixed-length Vessel name
 //      • Remaining lane space for HCL and LCL vehicles
 //
+//    Sailings are indexed by (city, day, hour) in sailings.idx
+//    (see SailingIndex.h).
 //************************************************************
 //************************************************************
 
 #ifndef FILEIO_SAILINGS_H
 #define FILEIO_SAILINGS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <string>
+#include <vector>
 #include "CommonTypes.h"
 
 //------------------------------------------------------------
@@ -26,9 +31,11 @@
 struct Sailingrec {
     char id[16];                  // Fixed-length Sailing ID (e.g., "YYZ:23:12")
     char VesselName[25];          // Fixed-length Vessel name
+    unsigned char status;         // REC_LIVE / REC_DEAD (was alignment padding)
     float remainingHCL;  // Remaining high-ceiling lane length
     float remainingLCL;  // Remaining low-ceiling lane length
 };
+static_assert(sizeof(Sailingrec) == 52, "status byte must reuse the padding");
 
 class FileIO_Sailings
 {
@@ -49,25 +56,66 @@ public:
         float remainingLCL
     );
 
-    // Delete sailing by ID (cascades reservation deletion)
+    // Delete sailing by ID (tombstoned; cascades reservation deletion)
     static bool deleteSailing(
         SailingID sailingIDtoDelete
     );
 
-    // Find sailing record by ID
+    // Delete every sailing departing on a day of the month ("DD"),
+    // cascading their reservations in one pass over reservations.dat.
+    // Removed IDs are appended to `removed`; returns how many.
+    static int deleteSailingsOnDay(
+        const std::string &day,
+        std::vector<SailingID> &removed
+    );
+
+    // Delete every sailing to an arrival city (route), cascading
+    // their reservations in one pass. Returns how many were removed.
+    static int deleteSailingsToCity(
+        const std::string &city,
+        std::vector<SailingID> &removed
+    );
+
+    // Delete the listed sailings, cascading their reservations in one
+    // pass. Removed IDs are appended to `removed`; returns how many.
+    static int deleteSailings(
+        const std::vector<SailingID> &sailingIDs,
+        std::vector<SailingID> &removed
+    );
+
+    // Find sailing record by ID. With includeArchive, a sailing no
+    // longer in sailings.dat is looked up in the archive (Archive.h).
     static bool findSailing(
         SailingID sailingID,
-        Sailingrec &result
+        Sailingrec &result,
+        bool includeArchive = false
     );
 
-    // Display formatted status of single sailing
-    static bool sailingstatus(
-        SailingID sailingID
+    // Returns all sailings (none, with an error printed, if
+    // sailings.dat cannot be read)
+   static std::vector<Sailingrec> Sailingreport();
+
+    // Sailings to an arrival city, limited to one day of the month
+    // ("DD") unless `day` is empty, ordered by day and hour
+    static std::vector<Sailingrec> sailingsToCity(
+        const std::string &city,
+        const std::string &day
     );
 
-    // Returns all sailings
-   static std::vector<Sailingrec> Sailingreport();
 
+    // Up to `max` sailings to `city` from `day`/`hour` on with
+    // `spaceCm` free (see StorageBackend::availableSailings),
+    // answered from SailingTable's route trees. Returns false if
+    // the table cannot be read.
+    static bool availableSailings(
+        const std::string &city,
+        int day,
+        int hour,
+        std::int32_t spaceCm,
+        bool highCeiling,
+        std::size_t max,
+        std::vector<Sailingrec> &result
+    );
 
     // Check if sailing exists by ID
     static bool Sailingexist(
@@ -81,6 +129,10 @@ public:
         float &remainingLCL
     );
 
+    // The three space updates below read the record again from
+    // the file under a write lock on it, so updates from several
+    // processes take turns instead of overwriting each other.
+
     // Update remaining space dynamically after reservation changes
     static bool updateSailingSpace(
         SailingID sailingID,
@@ -89,6 +141,24 @@ public:
         int amount
     );
 
+    // Overwrite remaining space with absolute values
+    // (write-back path for the in-memory capacity table)
+    static bool setRemainingSpace(
+        SailingID sailingID,
+        float remainingHCL,
+        float remainingLCL
+    );
+
+    // Add deltas (metres) to the remaining space as stored in the
+    // file right now and return the result
+    static bool adjustRemainingSpace(
+        SailingID sailingID,
+        float deltaHCL,
+        float deltaLCL,
+        float &remainingHCL,
+        float &remainingLCL
+    );
+
 };
 
 #endif // FILEIO_SAILINGS_H
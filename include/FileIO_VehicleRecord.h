@@ -17,6 +17,7 @@
 
 #include "VehicleRecord.hpp" // This already defines VEH_LIC_CHARS, VEH_PHONE_CHARS, VEH_REC_BYTES
 #include <string>
+#include <vector>
 
 namespace FerrySys
 {
@@ -24,20 +25,38 @@ namespace FerrySys
 class FileIO_VehicleRecord
 {
 public:
-    // Append a new vehicle record to vehicles.dat
+    // Store a new vehicle record in vehicles.dat (reuses a deleted slot
+    // when one is free, otherwise appends)
     static bool writeVehicle(const VehicleRecord &vehicle);
 
+    // Store several new vehicles with one append (group bookings).
+    // Deleted slots are not reused. Duplicates are the caller's check.
+    static bool writeVehicles(const std::vector<VehicleRecord> &vehicles);
+
     // Find a vehicle by license plate (returns decoded record in result)
     static bool findVehicle(const std::string &license, VehicleRecord &result);
 
+    // Find several vehicles with one batched read of their index
+    // candidates (one scan if the index is unavailable). found[i]
+    // says whether result[i] was filled.
+    static bool findVehicles(const std::vector<std::string> &licenses,
+                             std::vector<VehicleRecord> &result,
+                             std::vector<char> &found);
+
     // Check if vehicle exists by license
     static bool vehicleExists(const std::string &license);
 
-    // Delete a vehicle by license (safe file rewrite)
+    // Delete a vehicle by license (tombstoned in place)
     static bool deleteVehicle(const std::string &license);
 
     // List all vehicles in vehicles.dat (formatted debug output)
     static void listVehicles();
+
+    // Read the vehicles stored at the given record slots with one batched
+    // submission (random lookups for check-in batches and index rebuilds)
+    // A tombstoned slot comes back with an empty license.
+    static bool readVehiclesAt(const std::vector<std::size_t> &slots,
+                               std::vector<VehicleRecord> &result);
 };
 
 } // namespace FerrySys
@@ -28,9 +28,11 @@
 // ------------------------------------------------------------
 struct Vesselrec {
     char vesselName[25];       // Vessel name (null-terminated)
+    unsigned char status;      // REC_LIVE / REC_DEAD (was alignment padding)
     unsigned short laneHCL;    // High-ceiling lane length (m)
     unsigned short laneLCL;    // Low-ceiling lane length (m)
 };
+static_assert(sizeof(Vesselrec) == 30, "status byte must reuse the padding");
 
 class FileIO_Vessel
 {
@@ -62,7 +64,7 @@ public:
     );
 
     //------------------------------------------------------------
-    // Remove a vessel by name (rewrite file without it).
+    // Remove a vessel by name (status byte flipped in place).
     // Preconditions : vessel is not in use by a sailing.
     // Postconditions: returns true if removed, false otherwise.
     static bool deleteVessel(
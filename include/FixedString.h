@@ -0,0 +1,137 @@
+//************************************************************
+//************************************************************
+//  FixedString.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    FixedString<N>: a string of at most N characters stored
+//    inline (N chars, a terminating NUL and a length byte), for
+//    the fields whose width the record files already fix:
+//    license plates (10), phone numbers (14) and sailing IDs
+//    (16). It is trivially copyable, so structs holding it are
+//    plain data, and copying, comparing or hashing one never
+//    allocates.
+//
+//    Converts implicitly from const char*, std::string_view and
+//    std::string; longer input is truncated to N characters, as
+//    the record fields truncate it. Converts implicitly to
+//    std::string_view (and to std::string where an API still
+//    takes one). Comparison is byte-wise and case-sensitive,
+//    like std::string.
+//************************************************************
+//************************************************************
+
+#ifndef FIXEDSTRING_H
+#define FIXEDSTRING_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace FerrySys
+{
+
+template <std::size_t N>
+class FixedString
+{
+    static_assert(N > 0 && N < 256, "length is kept in one byte");
+
+public:
+    static constexpr std::size_t CAPACITY = N;
+
+    constexpr FixedString() noexcept = default;
+    constexpr FixedString(const char *s) noexcept { assign(s ? std::string_view(s) : std::string_view()); }
+    constexpr FixedString(std::string_view s) noexcept { assign(s); }
+    FixedString(const std::string &s) noexcept { assign(s); }
+
+    //------------------------------------------------------------
+    // Access
+    constexpr std::size_t size() const noexcept { return len; }
+    constexpr std::size_t length() const noexcept { return len; }
+    constexpr bool empty() const noexcept { return len == 0; }
+    constexpr const char *data() const noexcept { return chars; }
+    constexpr const char *c_str() const noexcept { return chars; }
+    constexpr const char *begin() const noexcept { return chars; }
+    constexpr const char *end() const noexcept { return chars + len; }
+    constexpr char operator[](std::size_t i) const noexcept { return chars[i]; }
+
+    constexpr std::string_view view() const noexcept { return std::string_view(chars, len); }
+    constexpr operator std::string_view() const noexcept { return view(); }
+    std::string str() const { return std::string(chars, len); }
+    operator std::string() const { return str(); }
+
+    constexpr std::string_view substr(std::size_t pos, std::size_t count = std::string_view::npos) const
+    {
+        return view().substr(pos, count);
+    }
+
+    //------------------------------------------------------------
+    // FNV-1a over the characters (what std::hash uses)
+    constexpr std::size_t hash() const noexcept
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        for (std::size_t i = 0; i < len; ++i)
+        {
+            h ^= static_cast<unsigned char>(chars[i]);
+            h *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(h);
+    }
+
+    //------------------------------------------------------------
+    // Comparison
+    friend constexpr bool operator==(const FixedString &a, const FixedString &b) noexcept
+    {
+        return a.view() == b.view();
+    }
+    friend constexpr bool operator==(const FixedString &a, std::string_view b) noexcept
+    {
+        return a.view() == b;
+    }
+    friend constexpr bool operator==(const FixedString &a, const char *b) noexcept
+    {
+        return a.view() == std::string_view(b);
+    }
+    friend bool operator==(const FixedString &a, const std::string &b) noexcept
+    {
+        return a.view() == std::string_view(b);
+    }
+    friend constexpr std::strong_ordering operator<=>(const FixedString &a, const FixedString &b) noexcept
+    {
+        return a.view() <=> b.view();
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const FixedString &s)
+    {
+        return out << s.view();
+    }
+
+private:
+    constexpr void assign(std::string_view s) noexcept
+    {
+        len = static_cast<std::uint8_t>(s.size() < N ? s.size() : N);
+        for (std::size_t i = 0; i <= N; ++i)
+            chars[i] = i < len ? s[i] : '\0';
+    }
+
+    char         chars[N + 1] = {};
+    std::uint8_t len = 0;
+};
+
+} // namespace FerrySys
+
+template <std::size_t N>
+struct std::hash<FerrySys::FixedString<N>>
+{
+    std::size_t operator()(const FerrySys::FixedString<N> &s) const noexcept
+    {
+        return s.hash();
+    }
+};
+
+#endif // FIXEDSTRING_H
@@ -0,0 +1,71 @@
+//************************************************************
+//************************************************************
+//  FlatFileBackend.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    StorageBackend over the FileIO_* classes: the .dat files
+//    read and written with fstream, with every existing
+//    accelerator (sailings.idx, free lists, parallel scans,
+//    partitioned / LSM reservations). This is the default engine
+//    and behaves exactly as the FileIO_* calls it forwards to.
+//************************************************************
+//************************************************************
+
+#ifndef FLATFILEBACKEND_H
+#define FLATFILEBACKEND_H
+
+#include "StorageBackend.h"
+
+namespace FerrySys
+{
+
+class FlatFileBackend : public StorageBackend
+{
+public:
+    BackendKind kind() const override { return BackendKind::FLAT_FILE; }
+
+    bool writeVehicle(const VehicleRecord &vehicle) override;
+    bool findVehicle(const LicensePlate &license, VehicleRecord &result) override;
+    bool deleteVehicle(const LicensePlate &license) override;
+    bool findVehicles(const std::vector<LicensePlate> &licenses,
+                      std::vector<VehicleRecord> &result, std::vector<char> &found) override;
+    bool writeVehicles(const std::vector<VehicleRecord> &vehicles) override;
+
+    bool writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL) override;
+    bool findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL) override;
+    bool deleteVessel(const std::string &vesselName) override;
+
+    bool writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                      float remainingHCL, float remainingLCL) override;
+    bool findSailing(const SailingID &sailingID, Sailingrec &result) override;
+    bool setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL) override;
+    bool adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                              float &remainingHCL, float &remainingLCL) override;
+    std::vector<Sailingrec> sailings() override;
+    std::vector<Sailingrec> sailingsToCity(const std::string &city, const std::string &day) override;
+    std::vector<Sailingrec> availableSailings(const std::string &city, int day, int hour,
+                                              std::int32_t spaceCm, bool highCeiling,
+                                              std::size_t max) override;
+    int deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed) override;
+    int deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed) override;
+    int deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed) override;
+
+    bool writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings) override;
+    bool checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    int  countReservations(const SailingID &sailingID) override;
+    bool countReservationsBySailing(std::unordered_map<std::string, int> &counts) override;
+    bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                     std::vector<ReservationRec> &rows) override;
+
+    void open() override;
+    void compact(Table table) override;
+    void close() override;
+};
+
+} // namespace FerrySys
+
+#endif // FLATFILEBACKEND_H
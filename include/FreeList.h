@@ -0,0 +1,82 @@
+//************************************************************
+//************************************************************
+//  FreeList.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Persistent lists of vacated record slots, so inserts into
+//    vehicles.dat and reservations.dat fill holes left by
+//    deletes before appending.
+//
+//    Each list is a side file next to its data file
+//    (vehicles.free, reservations.free) holding uint32 slot
+//    numbers, used as a stack: a tombstone delete pushes its
+//    slot, an insert pops the most recent one and overwrites
+//    it. A popped slot is re-checked against the data file and
+//    skipped unless it still holds a dead record, so a stale or
+//    hand-edited list can never overwrite a live row.
+//    Compaction moves every slot, so it clears the list.
+//
+//    push and pop take an exclusive flock on the side file from
+//    reading it through the truncate, so processes sharing the
+//    data directory never pop the same slot. Only VEHICLES and
+//    RESERVATIONS keep a list; the other tables ignore these
+//    calls.
+//************************************************************
+//************************************************************
+
+#ifndef FREELIST_H
+#define FREELIST_H
+
+#include "Compaction.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FerrySys
+{
+
+class FreeList
+{
+public:
+    //------------------------------------------------------------
+    // Remember `slots` of `table` as free (just tombstoned).
+    static void push(
+        Table table,                            // IN
+        const std::vector<std::size_t> &slots   // IN
+    );
+
+    //------------------------------------------------------------
+    // Take a free slot of `table` that still holds a dead record.
+    // Returns false (slot untouched) when the list has none.
+    static bool pop(
+        Table table,                    // IN
+        std::size_t &slot               // OUT
+    );
+
+    //------------------------------------------------------------
+    // Overwrite a free dead slot of `table` with `record` (one
+    // full record of the table's size). Returns false when no slot
+    // was free or the write failed; the caller then appends.
+    static bool fill(
+        Table table,                    // IN
+        const void *record              // IN
+    );
+
+    //------------------------------------------------------------
+    // Number of slots currently listed for `table`.
+    static std::size_t size(
+        Table table                     // IN
+    );
+
+    //------------------------------------------------------------
+    // Drop every listed slot of `table`.
+    static void clear(
+        Table table                     // IN
+    );
+};
+
+} // namespace FerrySys
+
+#endif // FREELIST_H
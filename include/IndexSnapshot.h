@@ -0,0 +1,147 @@
+//************************************************************
+//************************************************************
+//  IndexSnapshot.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Hash indexes over vehicles.dat and the flat reservations.dat,
+//    kept in snapshot files that are mapped and used in place:
+//
+//      vehicles.lic.snap       license plate -> vehicle slot
+//      reservations.key.snap   (license, sailing) -> reservation slot
+//      reservations.sid.snap   sailing -> every reservation slot
+//
+//    Reservation keys are upper-cased, as the flat file matches
+//    them. A snapshot holds an open-addressing table of 64-bit
+//    key hashes, each naming a run of slots, and a Bloom filter
+//    that answers most lookups of absent keys from one cache
+//    line. Nothing is decoded at startup: opening a snapshot is
+//    one mmap and a header check, whatever the data size.
+//
+//    Each snapshot records the data-file generation it was built
+//    from (see DataFile.h) and how many slots it covers. Inserts
+//    made since then go to an in-memory overlay through
+//    noteInsert(); while the overlay has seen every change,
+//    snapshot + overlay matches the file's current generation.
+//    If the generations are apart but every change since was an
+//    append (another process or engine adding rows), the next
+//    lookup reads just the new slots into the overlay. Anything
+//    else (compaction, slot reuse elsewhere) makes it rebuild the
+//    snapshot with one parallel scan. The overlay is merged
+//    into a new snapshot when it reaches OVERLAY_MERGE_ROWS and
+//    at close().
+//
+//    Deletes do not touch the indexes: callers re-check each
+//    returned slot against its record, so an entry can point at
+//    a dead or reused row but never hide a live one. Deleting a
+//    snapshot file is always safe. Thread-safe.
+//************************************************************
+//************************************************************
+
+#ifndef INDEXSNAPSHOT_H
+#define INDEXSNAPSHOT_H
+
+#include "Compaction.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace FerrySys
+{
+
+enum class KeyIndex
+{
+    VEHICLE_LICENSE,
+    RESERVATION_KEY,
+    RESERVATION_SAILING,
+    COUNT
+};
+
+// Index shape, for tests and the metrics dump
+struct SnapshotStats
+{
+    bool          mapped = false;
+    std::size_t   keys = 0;             // distinct key hashes in the snapshot
+    std::size_t   entries = 0;          // slots in the snapshot
+    std::size_t   overlay = 0;          // slots added since
+    std::uint64_t generation = 0;       // data generation reflected
+    std::size_t   builds = 0;           // full rebuilds by this process
+};
+
+class IndexSnapshot
+{
+public:
+    static constexpr std::uint32_t VERSION = 2;
+    static constexpr std::size_t   OVERLAY_MERGE_ROWS = 65536;
+
+    //------------------------------------------------------------
+    // Candidate slots for a key. Returns false if the index is
+    // unavailable (caller falls back to a scan).
+    static bool findVehicle(
+        std::string_view license,           // IN
+        std::vector<std::size_t> &slots     // OUT
+    );
+    static bool findReservation(
+        std::string_view licensePlate,      // IN (any case)
+        std::string_view sailingID,         // IN (any case)
+        std::vector<std::size_t> &slots     // OUT
+    );
+    static bool findSailingReservations(
+        std::string_view sailingID,         // IN (any case)
+        std::vector<std::size_t> &slots     // OUT
+    );
+
+    //------------------------------------------------------------
+    // Batch forms for bulk loads: the candidate slots of every key
+    // as (position in the input, slot) pairs, appended to `hits`,
+    // with one freshness check for the whole batch.
+    using Hits = std::vector<std::pair<std::size_t, std::size_t>>;
+    static bool findVehicles(
+        const std::vector<std::string_view> &licenses,      // IN
+        Hits &hits                                          // OUT
+    );
+    static bool findReservations(
+        const std::vector<std::pair<std::string_view, std::string_view>> &keys,  // IN: (license, sailing)
+        Hits &hits                                          // OUT
+    );
+
+    //------------------------------------------------------------
+    // Record that `slot` of `table` now holds `record` (call after
+    // the DataFile note for that write). Tables without an index
+    // are ignored.
+    static void noteInsert(
+        Table table,                    // IN
+        std::size_t slot,               // IN
+        const void *record              // IN: one record
+    );
+
+    //------------------------------------------------------------
+    // The same for `count` records appended together at
+    // `firstSlot` with one DataFile::noteAppended().
+    static void noteInserts(
+        Table table,                    // IN
+        std::size_t firstSlot,          // IN
+        const void *records,            // IN: `count` records, back to back
+        std::size_t count               // IN
+    );
+
+    //------------------------------------------------------------
+    // Map every snapshot whose data file exists, rebuilding stale
+    // ones (module initialize).
+    static void open();
+
+    //------------------------------------------------------------
+    // Merge overlays into new snapshots and unmap them. The next
+    // call maps them again.
+    static void close();
+
+    static const char *path(KeyIndex index);
+    static SnapshotStats stats(KeyIndex index);
+};
+
+} // namespace FerrySys
+
+#endif // INDEXSNAPSHOT_H
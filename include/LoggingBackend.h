@@ -0,0 +1,94 @@
+//************************************************************
+//************************************************************
+//  LoggingBackend.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Wraps the FLAT_FILE and MMAP engines (see
+//    StorageBackend::current()) to add replication:
+//
+//      primary   each update runs under a MutationLog::Writer
+//                and, if it succeeds, is appended to
+//                mutations.log (when logging is on, see
+//                MutationLog.h) before the Writer ends; if the
+//                record cannot be written the update returns
+//                false with a message. While logging is on this
+//                serializes every update in the directory, across
+//                threads and processes; reads run as before
+//      follower  in a replica directory (replica.pos present,
+//                see Replica.h) updates are refused; the replica
+//                is changed only by Replica::catchUp(), which
+//                writes through engine()
+//
+//    Reads go straight to the wrapped engine.
+//************************************************************
+//************************************************************
+
+#ifndef LOGGINGBACKEND_H
+#define LOGGINGBACKEND_H
+
+#include "MutationLog.h"
+#include "StorageBackend.h"
+
+#include <memory>
+
+namespace FerrySys
+{
+
+class LoggingBackend : public StorageBackend
+{
+public:
+    explicit LoggingBackend(
+        std::unique_ptr<StorageBackend> inner   // IN: engine to wrap
+    );
+
+    BackendKind kind() const override { return inner->kind(); }
+    StorageBackend &engine() override { return *inner; }
+
+    bool writeVehicle(const VehicleRecord &vehicle) override;
+    bool findVehicle(const LicensePlate &license, VehicleRecord &result) override;
+    bool deleteVehicle(const LicensePlate &license) override;
+    bool findVehicles(const std::vector<LicensePlate> &licenses,
+                      std::vector<VehicleRecord> &result, std::vector<char> &found) override;
+    bool writeVehicles(const std::vector<VehicleRecord> &vehicles) override;
+
+    bool writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL) override;
+    bool findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL) override;
+    bool deleteVessel(const std::string &vesselName) override;
+
+    bool writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                      float remainingHCL, float remainingLCL) override;
+    bool findSailing(const SailingID &sailingID, Sailingrec &result) override;
+    bool setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL) override;
+    bool adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                              float &remainingHCL, float &remainingLCL) override;
+    std::vector<Sailingrec> sailings() override;
+    std::vector<Sailingrec> sailingsToCity(const std::string &city, const std::string &day) override;
+    std::vector<Sailingrec> availableSailings(const std::string &city, int day, int hour,
+                                              std::int32_t spaceCm, bool highCeiling,
+                                              std::size_t max) override;
+    int deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed) override;
+    int deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed) override;
+    int deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed) override;
+
+    bool writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings) override;
+    bool checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    int  countReservations(const SailingID &sailingID) override;
+    bool countReservationsBySailing(std::unordered_map<std::string, int> &counts) override;
+    bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                     std::vector<ReservationRec> &rows) override;
+
+    void open() override { inner->open(); }
+    void compact(Table table) override { inner->compact(table); }
+    void close() override { inner->close(); }
+
+private:
+    std::unique_ptr<StorageBackend> inner;
+};
+
+} // namespace FerrySys
+
+#endif // LOGGINGBACKEND_H
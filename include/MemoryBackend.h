@@ -0,0 +1,69 @@
+//************************************************************
+//************************************************************
+//  MemoryBackend.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    StorageBackend held entirely in process memory: hash maps
+//    for vehicles and vessels, an ordered map for sailings, and
+//    reservations grouped by upper-cased sailing ID. Nothing is
+//    read from or written to disk, and everything is lost on
+//    exit, so tests and benchmarks can run the business layer
+//    without files or I/O noise.
+//************************************************************
+//************************************************************
+
+#ifndef MEMORYBACKEND_H
+#define MEMORYBACKEND_H
+
+#include "StorageBackend.h"
+#include "FileIO_Vessel.h"
+
+#include <map>
+#include <shared_mutex>
+
+namespace FerrySys
+{
+
+class MemoryBackend : public StorageBackend
+{
+public:
+    BackendKind kind() const override { return BackendKind::MEMORY; }
+
+    bool writeVehicle(const VehicleRecord &vehicle) override;
+    bool findVehicle(const LicensePlate &license, VehicleRecord &result) override;
+    bool deleteVehicle(const LicensePlate &license) override;
+
+    bool writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL) override;
+    bool findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL) override;
+    bool deleteVessel(const std::string &vesselName) override;
+
+    bool writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                      float remainingHCL, float remainingLCL) override;
+    bool findSailing(const SailingID &sailingID, Sailingrec &result) override;
+    bool setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL) override;
+    std::vector<Sailingrec> sailings() override;
+    int deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed) override;
+
+    bool writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    int  countReservations(const SailingID &sailingID) override;
+    bool countReservationsBySailing(std::unordered_map<std::string, int> &counts) override;
+    bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                     std::vector<ReservationRec> &rows) override;
+
+private:
+    using Bookings = std::map<LicensePlate, ReservationRec>;   // by upper-cased license
+
+    std::shared_mutex                                 lock;
+    std::unordered_map<LicensePlate, VehicleRecord>   vehicles;
+    std::unordered_map<std::string, Vesselrec>        vessels;
+    std::map<SailingID, Sailingrec>                   sailingRows;
+    std::unordered_map<SailingID, Bookings>           reservations;   // by upper-cased sailing ID
+};
+
+} // namespace FerrySys
+
+#endif // MEMORYBACKEND_H
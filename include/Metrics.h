@@ -0,0 +1,189 @@
+//************************************************************
+//************************************************************
+//  Metrics.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Lightweight in-process instrumentation: per-operation
+//    latency histograms plus I/O counters.
+//
+//    • Every thread records into its own block, so the hot path
+//      is a clock read and a few uncontended relaxed stores; no
+//      locks and no shared cache lines
+//    • Histograms are log-linear (HDR style): 16 linear
+//      sub-buckets per power of two, i.e. ~6% value precision
+//      from 1 ns up to ~9 minutes
+//    • Counters: file opens, bytes read/written, records
+//      scanned and index hits/misses. Records scanned inside a
+//      FERRY_METRIC_SCOPE are also charged to that operation (and
+//      to every enclosing one), which shows which calls walk
+//      whole files
+//    • Gauges: named point-in-time values set by maintenance
+//      code (e.g. dead-row ratio per data file)
+//
+//    snapshot() merges all thread blocks; dump() prints a table.
+//    Building with -DFERRY_NO_METRICS compiles the timers out
+//    (the scopes still open trace spans unless FERRY_NO_TRACE).
+//************************************************************
+//************************************************************
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Trace.h"
+
+namespace FerrySys
+{
+
+enum class Counter
+{
+    FILE_OPENS,
+    BYTES_READ,
+    BYTES_WRITTEN,
+    RECORDS_SCANNED,
+    INDEX_HITS,
+    INDEX_MISSES,
+    ROWS_COMPACTED,
+    COUNT
+};
+
+// Merged statistics for one operation
+struct OpStats
+{
+    std::string   name;
+    std::uint64_t calls = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs = 0;
+    std::uint64_t p50Ns = 0;
+    std::uint64_t p90Ns = 0;
+    std::uint64_t p99Ns = 0;
+    std::uint64_t recordsScanned = 0;   // inclusive of nested operations
+};
+
+struct MetricsSnapshot
+{
+    std::vector<OpStats> ops;           // sorted by total time, largest first
+    std::uint64_t counters[static_cast<int>(Counter::COUNT)] = {};
+    std::vector<std::pair<std::string, double>> gauges;   // sorted by name
+
+    std::uint64_t counter(Counter c) const { return counters[static_cast<int>(c)]; }
+    const OpStats *find(const std::string &name) const;
+};
+
+class Metrics
+{
+public:
+    static constexpr int MAX_OPS = 128;
+    static constexpr const char *DUMP_FILE = "metrics.txt";   // written at shutdown
+
+    //------------------------------------------------------------
+    // Id for an operation name (same name -> same id).
+    // Called once per call site through FERRY_METRIC_SCOPE.
+    static int registerOp(
+        const char *name                // IN: static string, e.g. "Vessel::CreateVessel"
+    );
+
+    //------------------------------------------------------------
+    // Record one completed call of operation `op`.
+    static void recordLatency(
+        int op,                         // IN: id from registerOp
+        std::uint64_t nanos,            // IN: elapsed time (ns)
+        std::uint64_t recordsScanned    // IN: records read during the call
+    );
+
+    //------------------------------------------------------------
+    // Bump a counter on the calling thread.
+    static void add(
+        Counter c,                      // IN
+        std::uint64_t amount = 1        // IN
+    );
+
+    //------------------------------------------------------------
+    // Convenience for scan loops: one record of `bytes` read.
+    static void recordRead(std::size_t bytes)
+    {
+        add(Counter::RECORDS_SCANNED);
+        add(Counter::BYTES_READ, bytes);
+    }
+
+    //------------------------------------------------------------
+    // Set a named gauge (rare updates; takes a lock).
+    static void setGauge(
+        const std::string &name,        // IN: e.g. "reservations.dat dead ratio"
+        double value                    // IN
+    );
+
+    //------------------------------------------------------------
+    // Records scanned so far by the calling thread.
+    static std::uint64_t threadRecordsScanned();
+
+    //------------------------------------------------------------
+    // Merge every thread's block. Safe while other threads record;
+    // in-flight updates may or may not be included.
+    static MetricsSnapshot snapshot();
+
+    //------------------------------------------------------------
+    // Print the snapshot as a table (latencies in microseconds).
+    static void dump(std::ostream &out);
+
+    //------------------------------------------------------------
+    // dump() into `path` (overwritten). False if it cannot be opened.
+    static bool dumpToFile(const std::string &path);
+};
+
+//------------------------------------------------------------
+// RAII timer behind FERRY_METRIC_SCOPE.
+class MetricScope
+{
+public:
+    explicit MetricScope(int op)
+        : op(op),
+          scannedAtStart(Metrics::threadRecordsScanned()),
+          start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~MetricScope()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        Metrics::recordLatency(op,
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            Metrics::threadRecordsScanned() - scannedAtStart);
+    }
+
+    MetricScope(const MetricScope &) = delete;
+    MetricScope &operator=(const MetricScope &) = delete;
+
+private:
+    int                                   op;
+    std::uint64_t                         scannedAtStart;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace FerrySys
+
+#define FERRY_METRIC_CAT2(a, b) a##b
+#define FERRY_METRIC_CAT(a, b)  FERRY_METRIC_CAT2(a, b)
+
+// Both forms also open a trace span of the same name (see Trace.h).
+#ifdef FERRY_NO_METRICS
+#define FERRY_METRIC_SCOPE(name) FERRY_TRACE_SPAN(name)
+#else
+// Time the rest of the enclosing block as operation `name`.
+#define FERRY_METRIC_SCOPE(name)                                              \
+    FERRY_TRACE_SPAN(name);                                                   \
+    static const int FERRY_METRIC_CAT(ferryMetricOp_, __LINE__) =             \
+        ::FerrySys::Metrics::registerOp(name);                                \
+    ::FerrySys::MetricScope FERRY_METRIC_CAT(ferryMetricScope_, __LINE__)(    \
+        FERRY_METRIC_CAT(ferryMetricOp_, __LINE__))
+#endif
+
+#endif // METRICS_H
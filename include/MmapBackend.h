@@ -0,0 +1,106 @@
+//************************************************************
+//************************************************************
+//  MmapBackend.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    StorageBackend over the .dat files mapped into memory
+//    (MAP_SHARED, read/write). Record formats, tombstones, free
+//    lists and compaction are those of the flat files, so data
+//    written by one engine is read by the other.
+//
+//    Each table is mapped once, with room to grow; lookups scan
+//    the mapping and updates (check-in, remaining space,
+//    tombstones) are plain stores into it. Appends go through
+//    pwrite() at the end of the file, and a mapping is widened
+//    when the file outgrows it. Before each call the file is
+//    stat()ed, so a table shrunk by compaction, grown by
+//    FileIO_* writers or replaced on disk is picked up.
+//
+//    Reservations always live in reservations.dat. Sailing
+//    appends do not touch sailings.idx; the index notices the
+//    new row count and rebuilds on its next lookup.
+//************************************************************
+//************************************************************
+
+#ifndef MMAPBACKEND_H
+#define MMAPBACKEND_H
+
+#include "StorageBackend.h"
+
+#include <cstddef>
+#include <mutex>
+#include <sys/types.h>
+
+namespace FerrySys
+{
+
+class MmapBackend : public StorageBackend
+{
+public:
+    MmapBackend() = default;
+    MmapBackend(const MmapBackend &) = delete;
+    MmapBackend &operator=(const MmapBackend &) = delete;
+    ~MmapBackend() override;
+
+    BackendKind kind() const override { return BackendKind::MMAP; }
+
+    bool writeVehicle(const VehicleRecord &vehicle) override;
+    bool findVehicle(const LicensePlate &license, VehicleRecord &result) override;
+    bool deleteVehicle(const LicensePlate &license) override;
+
+    bool writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL) override;
+    bool findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL) override;
+    bool deleteVessel(const std::string &vesselName) override;
+
+    bool writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                      float remainingHCL, float remainingLCL) override;
+    bool findSailing(const SailingID &sailingID, Sailingrec &result) override;
+    bool setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL) override;
+    std::vector<Sailingrec> sailings() override;
+    int deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed) override;
+
+    bool writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    bool reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID) override;
+    int  countReservations(const SailingID &sailingID) override;
+    bool countReservationsBySailing(std::unordered_map<std::string, int> &counts) override;
+    bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                     std::vector<ReservationRec> &rows) override;
+
+    void compact(Table table) override;
+    void close() override;
+
+private:
+    // One mapped table
+    struct Mapping
+    {
+        int            fd = -1;
+        ino_t          inode = 0;
+        unsigned char *map = nullptr;   // whole file, header first
+        unsigned char *base = nullptr;  // first record
+        std::size_t    bytes = 0;       // whole records after the header
+        std::size_t    capacity = 0;    // bytes mapped
+    };
+
+    //------------------------------------------------------------
+    // Map `table` (creating its file) or bring the mapping up to
+    // date with the file. Returns false on I/O error.
+    bool attach(Table table);
+
+    //------------------------------------------------------------
+    // Store `record` in a free dead slot, else append it.
+    bool insert(Table table, const void *record);
+
+    //------------------------------------------------------------
+    // Unmap and close `m`.
+    static void release(Mapping &m);
+
+    std::mutex lock;
+    Mapping    maps[static_cast<int>(Table::COUNT)];
+};
+
+} // namespace FerrySys
+
+#endif // MMAPBACKEND_H
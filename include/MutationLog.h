@@ -0,0 +1,195 @@
+//************************************************************
+//************************************************************
+//  MutationLog.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    The primary's record of every change, for replicas (see
+//    Replica.h). mutations.log in the data directory is a plain
+//    sequence of fixed-size MutationRec records, one per
+//    StorageBackend update, appended in the order the updates
+//    happened. A record's LSN (log sequence number) is its
+//    1-based position in the log as first written, so "applied
+//    up to LSN n" is all a replica needs to remember.
+//
+//    Logging is on exactly when mutations.log exists: it is
+//    created when the first replica is seeded, and every
+//    terminal and ferryd then appends to it (LoggingBackend.h).
+//    create() and trim() bump a count in sailings.space
+//    (CapacityTable::replicationVersion); a thread that found no
+//    log looks again only after it moves, so a log made by hand
+//    is seen by processes started afterwards.
+//
+//    An update runs inside a Writer, which holds an exclusive
+//    flock on the log from before the change until its records
+//    are appended, so the log order is the order of the updates
+//    in every process. The price is that, while logging is on,
+//    updates run one at a time across every thread and process
+//    using the directory: a Writer takes a process-wide mutex and
+//    the flock, and holds both for the whole update. A record is
+//    one O_APPEND write; a partial record at the end (a crash or
+//    failed write mid-append) is never read and is cut off by
+//    the next append.
+//
+//    trim() drops the records every replica has applied
+//    (Replica::checkpoint()): the rest are copied to a new file
+//    after a LOG_BASE record holding the LSN they follow, which
+//    replaces the log with a rename. LSNs do not change.
+//************************************************************
+//************************************************************
+
+#ifndef MUTATIONLOG_H
+#define MUTATIONLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+enum class MutationOp : std::uint8_t
+{
+    LOG_BASE = 0,           // first record of a trimmed log: arg0, arg1 = low, high
+                            // 32 bits of the LSN before the next record (never read)
+    VEHICLE_WRITE,          // license, phone, arg0 = length, arg1 = height
+    VEHICLE_DELETE,         // license
+    VESSEL_WRITE,           // vesselName, arg0 = laneHCL, arg1 = laneLCL
+    VESSEL_DELETE,          // vesselName
+    SAILING_WRITE,          // sailingID, vesselName, hcl, lcl
+    SAILING_SPACE,          // sailingID, hcl, lcl (remaining, absolute)
+    SAILING_DELETE,         // sailingID (with its reservations)
+    RESERVATION_WRITE,      // license, sailingID
+    RESERVATION_CHECKIN,    // license, sailingID
+    RESERVATION_DELETE      // license, sailingID
+};
+
+#pragma pack(push, 1)
+struct MutationRec
+{
+    std::int64_t  timeUs;           // when the primary made the change (µs since epoch)
+    std::uint8_t  op;               // MutationOp
+    char          license[10];      // null-padded text fields
+    char          phone[14];
+    char          sailingID[16];
+    char          vesselName[25];
+    std::int32_t  arg0;
+    std::int32_t  arg1;
+    float         hcl;
+    float         lcl;
+};
+#pragma pack(pop)
+static_assert(sizeof(MutationRec) == 90, "log records are fixed-size");
+
+class MutationLog
+{
+public:
+    static constexpr const char *LOG_FILE = "mutations.log";
+
+    //------------------------------------------------------------
+    // A record for `op` stamped with the current time, text
+    // fields empty.
+    static MutationRec make(
+        MutationOp op                   // IN
+    );
+
+    //------------------------------------------------------------
+    // Store `text` in a null-padded record field.
+    template <std::size_t N>
+    static void setField(char (&field)[N], const std::string &text)
+    {
+        std::size_t n = text.size() < N ? text.size() : N;
+        for (std::size_t i = 0; i < N; ++i)
+            field[i] = i < n ? text[i] : '\0';
+    }
+
+    //------------------------------------------------------------
+    // Text of a null-padded record field.
+    template <std::size_t N>
+    static std::string field(const char (&field)[N])
+    {
+        std::size_t n = 0;
+        while (n < N && field[n] != '\0')
+            ++n;
+        return std::string(field, n);
+    }
+
+    //------------------------------------------------------------
+    // Exclusive hold on this directory's log, in this process and
+    // every other one, for one update and the records it appends
+    // (scoped). Take it inside the update's WriteGate::Hold and
+    // before changing anything. Writers nest; while logging is
+    // off a Writer does nothing (one load, see above).
+    class Writer
+    {
+    public:
+        Writer();
+        ~Writer();
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+    private:
+        bool locked = false;            // this Writer took the lock
+    };
+
+    //------------------------------------------------------------
+    // Append `rec` to this directory's log if logging is on
+    // (inside its own Writer if the caller has none).
+    // Postconditions: false only if the log exists and the record
+    //                 could not be written whole; the log is left
+    //                 as it was.
+    static bool append(
+        const MutationRec &rec          // IN
+    );
+
+    //------------------------------------------------------------
+    // Create this directory's log if it does not exist (turns
+    // logging on).
+    static bool create();
+
+    //------------------------------------------------------------
+    // LSN of the last whole record in the log at `path` (0 if
+    // empty or missing).
+    static std::uint64_t lastLsn(
+        const std::string &path         // IN
+    );
+
+    //------------------------------------------------------------
+    // LSN the first record in the log at `path` follows (0 if it
+    // was never trimmed, or is missing).
+    static std::uint64_t baseLsn(
+        const std::string &path         // IN
+    );
+
+    //------------------------------------------------------------
+    // Up to `max` records after `afterLsn`, in order.
+    // Postconditions: false if the log cannot be read or was
+    //                 trimmed past `afterLsn`.
+    static bool read(
+        const std::string &path,        // IN
+        std::uint64_t afterLsn,         // IN
+        std::size_t max,                // IN
+        std::vector<MutationRec> &out   // OUT
+    );
+
+    //------------------------------------------------------------
+    // Drop this directory's records up to `keepAfterLsn` (at
+    // most to the end of the log).
+    // Preconditions : no Writer on this thread appends after it.
+    // Postconditions: records dropped, or -1 if the log could
+    //                 not be rewritten (it is left as it was).
+    static long trim(
+        std::uint64_t keepAfterLsn      // IN
+    );
+
+    //------------------------------------------------------------
+    // Close the log; it is looked for again in the current
+    // directory by the next append().
+    // Preconditions : no thread is inside a Writer.
+    static void reset();
+};
+
+} // namespace FerrySys
+
+#endif // MUTATIONLOG_H
@@ -0,0 +1,219 @@
+//************************************************************
+//************************************************************
+//  ParallelScan.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Parallel full-table scans over the fixed-length .dat files.
+//
+//    Because every record has the same size, a file splits into
+//    record-aligned chunks by index arithmetic alone. Each chunk
+//    is read with one bulk read and visited on the shared
+//    work-stealing pool; every chunk fills its own partial
+//    result, and the partials are merged in file order at the
+//    end, so results are deterministic.
+//
+//    Records are numbered from the end of the file header when
+//    there is one (see DataFile.h). A scan that cannot read its
+//    whole file (unreadable header, read error) says so rather
+//    than returning what it got; only a file that shrinks while
+//    it is scanned ends early without failing.
+//
+//    Ready-made partials: counters (any integer), TopK and
+//    HashPartitions. Small files are scanned inline.
+//************************************************************
+//************************************************************
+
+#ifndef PARALLELSCAN_H
+#define PARALLELSCAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BinaryFileOps.hpp"
+#include "Metrics.h"
+#include "ThreadPool.h"
+
+namespace FerrySys
+{
+    constexpr std::size_t SCAN_MIN_PARALLEL  = 8192;    // records; smaller files scan inline
+    constexpr std::size_t SCAN_CHUNK_RECORDS = 65536;   // upper bound per chunk
+    constexpr std::size_t SCAN_CHUNKS_PER_WORKER = 4;   // slack for work stealing
+
+    // Record-aligned slice of a file
+    struct ScanChunk
+    {
+        std::size_t first;  // index of first record
+        std::size_t count;  // number of records
+    };
+
+    //------------------------------------------------------------
+    // Pool shared by every parallel scan (one worker per core).
+    ThreadPool &scanPool();
+
+    //------------------------------------------------------------
+    // Whole records in `path` after its header, if it has one (0 if
+    // the file is missing).
+    std::size_t fileRecordCount(
+        const std::string &path,        // IN: data file
+        std::size_t recordSize          // IN: bytes per record
+    );
+
+    //------------------------------------------------------------
+    // Split [0, totalRecords) into record-aligned chunks sized for
+    // `workers` threads, none over SCAN_CHUNK_RECORDS.
+    std::vector<ScanChunk> splitRecords(
+        std::size_t totalRecords,       // IN
+        std::size_t workers             // IN
+    );
+
+    //------------------------------------------------------------
+    // Read one chunk into `buf` with a single bulk read. Returns
+    // false if the file cannot be opened or read; a chunk the file
+    // now ends inside (it shrank) keeps its whole records and
+    // returns true.
+    bool readChunk(
+        const std::string &path,        // IN: data file
+        std::size_t recordSize,         // IN: bytes per record
+        std::size_t dataStart,          // IN: offset of record 0 (see dataOffset)
+        const ScanChunk &chunk,         // IN: slice to read
+        std::vector<unsigned char> &buf // OUT: up to chunk.count * recordSize bytes
+    );
+
+    //------------------------------------------------------------
+    // Scan every record of `path` in parallel.
+    //   onRecord(Partial &, std::size_t index, const unsigned char *bytes)
+    //   merge(Partial &into, Partial &&from)   -- called in file order
+    // `result` comes in as the starting partial (every chunk starts
+    // from a copy) and goes out merged with every chunk's partial.
+    // Returns false if the header is unreadable or a chunk could not
+    // be read; `result` then misses records and must not be used.
+    template <class Partial, class RecordFn, class MergeFn>
+    bool parallelScan(const std::string &path,
+                      std::size_t recordSize,
+                      Partial &result,
+                      RecordFn onRecord,
+                      MergeFn merge)
+    {
+        FERRY_TRACE_SPAN("parallelScan");
+        std::size_t start = dataOffset(path, recordSize);
+        if (start == BAD_HEADER)
+            return false;
+        std::size_t total = fileRecordCount(path, recordSize);
+        std::vector<ScanChunk> chunks = splitRecords(total, scanPool().size());
+        std::vector<Partial> partials(chunks.size(), result);
+        std::vector<char> failed(chunks.size(), 0);
+
+        // Charged to the calling thread so enclosing metric scopes see it
+        Metrics::add(Counter::FILE_OPENS, chunks.size());
+        Metrics::add(Counter::RECORDS_SCANNED, total);
+        Metrics::add(Counter::BYTES_READ, total * recordSize);
+
+        auto scanChunk = [&](std::size_t c) {
+            FERRY_TRACE_SPAN("parallelScan/chunk");
+            std::vector<unsigned char> buf;
+            if (!readChunk(path, recordSize, start, chunks[c], buf))
+            {
+                failed[c] = 1;
+                return;
+            }
+            std::size_t n = buf.size() / recordSize;
+            for (std::size_t i = 0; i < n; ++i)
+                onRecord(partials[c], chunks[c].first + i, buf.data() + i * recordSize);
+        };
+
+        if (chunks.size() <= 1)
+        {
+            for (std::size_t c = 0; c < chunks.size(); ++c)
+                scanChunk(c);
+        }
+        else
+        {
+            TaskGroup group(scanPool());
+            for (std::size_t c = 0; c < chunks.size(); ++c)
+                group.run([&scanChunk, c] { scanChunk(c); });
+            group.wait();
+        }
+
+        if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+            return false;
+        for (Partial &p : partials)
+            merge(result, std::move(p));
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Partial: keep the K largest items under `Less`.
+    template <class T, class Less = std::less<T>>
+    struct TopK
+    {
+        std::size_t    k = 0;
+        std::vector<T> heap;    // min-heap on Less (smallest kept item at front)
+        Less           less{};
+
+        explicit TopK(std::size_t k = 0) : k(k) {}
+
+        void offer(const T &item)
+        {
+            auto greater = [this](const T &a, const T &b) { return less(b, a); };
+            if (heap.size() < k)
+            {
+                heap.push_back(item);
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+            else if (k > 0 && less(heap.front(), item))
+            {
+                std::pop_heap(heap.begin(), heap.end(), greater);
+                heap.back() = item;
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+
+        void merge(TopK &&other)
+        {
+            for (const T &item : other.heap)
+                offer(item);
+        }
+
+        // Items from largest to smallest
+        std::vector<T> sorted() const
+        {
+            std::vector<T> out = heap;
+            std::sort(out.begin(), out.end(), [this](const T &a, const T &b) { return less(b, a); });
+            return out;
+        }
+    };
+
+    //------------------------------------------------------------
+    // Partial: route items into `n` buckets by hash so later
+    // stages (joins, exports) can work bucket by bucket.
+    template <class T>
+    struct HashPartitions
+    {
+        std::vector<std::vector<T>> parts;
+
+        explicit HashPartitions(std::size_t n = 1) : parts(n ? n : 1) {}
+
+        void add(std::size_t hash, T item)
+        {
+            parts[hash % parts.size()].push_back(std::move(item));
+        }
+
+        void merge(HashPartitions &&other)
+        {
+            for (std::size_t i = 0; i < parts.size() && i < other.parts.size(); ++i)
+            {
+                auto &dst = parts[i];
+                auto &src = other.parts[i];
+                dst.insert(dst.end(),
+                           std::make_move_iterator(src.begin()),
+                           std::make_move_iterator(src.end()));
+            }
+        }
+    };
+}
+
+#endif // PARALLELSCAN_H
@@ -0,0 +1,112 @@
+//************************************************************
+//************************************************************
+//  Replica.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Read replicas: follower data directories that trail a
+//    primary by applying its mutation log (MutationLog.h), so
+//    status queries, reports and manifests can be served
+//    from a copy instead of the files bookings are written to.
+//
+//      seed      `ferry replica <dir>` in the primary directory:
+//                an online backup (Backup.h) into <dir>, plus
+//                replica.pos naming the primary and the log
+//                position the copy stands at, and lists <dir> in
+//                the primary's replicas.list. Seeding turns the
+//                primary's log on.
+//      apply     ferryd started in <dir> sees replica.pos,
+//                refuses updates and applies the primary's log
+//                continuously (catchUp()); a terminal started
+//                there is read-only
+//      lag       status(): records and seconds behind, also
+//                served by ferryd as REPLICA_STATUS
+//      trim      checkpoint() in the primary drops the log records
+//                every listed replica has applied; a replica whose
+//                directory is gone, or that now follows another
+//                primary, leaves the list
+//
+//    The log is read straight from the primary directory, so a
+//    follower must be on the same host (or a shared file
+//    system). Applying is idempotent: a record re-applied after a
+//    crash between applying and saving the position is skipped
+//    or stores the same values again. Archive segments are not
+//    replicated; archived sailings simply leave the follower.
+//************************************************************
+//************************************************************
+
+#ifndef REPLICA_H
+#define REPLICA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FerrySys
+{
+
+struct ReplicaStatus
+{
+    bool          follower = false;     // this directory is a replica
+    std::string   primaryDir;
+    std::uint64_t appliedLsn = 0;
+    std::uint64_t primaryLsn = 0;       // last record in the primary's log
+    double        lagSeconds = 0.0;     // age of the oldest unapplied change
+};
+
+class Replica
+{
+public:
+    static constexpr const char *POSITION_FILE = "replica.pos";
+    static constexpr const char *REPLICAS_FILE = "replicas.list";   // in the primary
+    static constexpr std::size_t APPLY_BATCH   = 4096;          // records per catchUp()
+    static constexpr std::size_t CHECKPOINT_RECORDS = 65536;    // least worth trimming
+
+    //------------------------------------------------------------
+    // True if the current directory is a follower. Each thread
+    // keeps its answer until the replication count in
+    // sailings.space moves, so replica.pos made or removed by hand
+    // is seen by processes started afterwards.
+    static bool isFollower();
+
+    //------------------------------------------------------------
+    // Seed a follower of the current directory in `followerDir`
+    // (new or empty).
+    // Postconditions: false, with a message on stderr, on failure.
+    static bool seed(
+        const std::string &followerDir  // IN
+    );
+
+    //------------------------------------------------------------
+    // In a follower: apply up to `max` records of the primary's
+    // log and save the new position.
+    // Postconditions: records applied, or -1 if the position or
+    //                 the log cannot be read or saved.
+    static long catchUp(
+        std::size_t max = APPLY_BATCH   // IN
+    );
+
+    //------------------------------------------------------------
+    // True if the current directory's log file has grown by
+    // CHECKPOINT_RECORDS since the last checkpoint() here (one
+    // stat).
+    static bool checkpointDue();
+
+    //------------------------------------------------------------
+    // In a primary: trim the log up to the slowest listed
+    // replica, if that drops at least `minRecords`. A replica
+    // still being seeded keeps the whole log.
+    // Postconditions: records dropped, or -1 with a message on
+    //                 stderr on failure.
+    static long checkpoint(
+        std::size_t minRecords = CHECKPOINT_RECORDS     // IN
+    );
+
+    //------------------------------------------------------------
+    // Position and lag of the current directory.
+    static ReplicaStatus status();
+};
+
+} // namespace FerrySys
+
+#endif // REPLICA_H
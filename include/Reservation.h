@@ -17,8 +17,12 @@
 #ifndef RESERVATION_H
 #define RESERVATION_H
 
+#include <cstddef>
 #include <string>
+#include <vector>
+#include "BookingTransaction.h"
 #include "CommonTypes.h"
+#include "FileIO_Sailings.h"  // for Sailingrec
 #include "VehicleRecord.hpp"  // for VehicleRecord type
 
 class Reservation
@@ -32,29 +36,61 @@ public:
 
     // Returning customer reservation
     static bool returningCustomerReservation(
-        const std::string &licensePlate,          //IN:LicensePlate
-        SailingID sailingID                       //IN:sailingID
+        const FerrySys::LicensePlate &licensePlate,  //IN:LicensePlate
+        SailingID sailingID                          //IN:sailingID
+    );
+
+    // Group (fleet) reservation: every vehicle on one sailing, or
+    // none (see BookingTransaction.h). New vehicles are registered.
+    static bool groupReservation(
+        const std::vector<FerrySys::VehicleRecord> &vehicles, //IN:the group
+        SailingID sailingID,                                //IN:sailingID
+        FerrySys::BookingError &error                       //OUT:why it failed
+    );
+
+    // Round trip / multi-leg reservation: the vehicle on every
+    // sailing, or on none. A vehicle on file is booked as stored.
+    static bool multiLegReservation(
+        const FerrySys::VehicleRecord &vehicle,             //IN:vehicle record
+        const std::vector<SailingID> &sailingIDs,           //IN:legs, in order
+        FerrySys::BookingError &error,                      //OUT:why it failed
+        SailingID &failedLeg                                //OUT:leg that was full/unknown
     );
 
     // Delete reservation
     static bool deleteReservation(
-        const std::string &licensePlate,         //IN:LicensePlate
-        SailingID sailingID                      //IN:sailingID
+        const FerrySys::LicensePlate &licensePlate,  //IN:LicensePlate
+        SailingID sailingID                          //IN:sailingID
     );
 
     // Check-in vehicle
     static bool checkinVehicle(
-        const std::string &licensePlate,         //IN:LicensePlate
-        SailingID sailingID                      //IN:sailingID
+        const FerrySys::LicensePlate &licensePlate,  //IN:LicensePlate
+        SailingID sailingID                          //IN:sailingID
     );
 
     // Utilities
     static bool isVehicleExist(
-        const std::string &licensePlate         //IN:LicensePlate
+        const FerrySys::LicensePlate &licensePlate   //IN:LicensePlate
     );
 
     static bool isSailingIDExist(
-        SailingID sailingID                      //IN:sailingID
+        SailingID sailingID                          //IN:sailingID
+    );
+
+    // Whether a vehicle must use the high-ceiling lane
+    static bool isHighCeiling(
+        const FerrySys::VehicleRecord &vehicle      //IN:vehicle record
+    );
+
+    // Earliest sailings to `city` departing at or after `day`/`hour`
+    // that still have room for `vehicle` (at most `max`)
+    static std::vector<Sailingrec> nextAvailable(
+        const FerrySys::VehicleRecord &vehicle,     //IN:vehicle record
+        const std::string &city,                    //IN:arrival city
+        int day,                                    //IN:day of month
+        int hour,                                   //IN:hour
+        std::size_t max                             //IN:how many to list
     );
 
     static void initialize();
@@ -0,0 +1,139 @@
+//************************************************************
+//************************************************************
+//  ReservationLSM.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Log-structured reservation storage for write-heavy booking
+//    peaks. Bookings, check-ins and cancellations never search
+//    a file; they are appended to a write-ahead log and applied
+//    to an in-memory sorted table (the memtable):
+//
+//      lsm/wal.log            ReservationRec per change, replayed
+//                             into the memtable on startup
+//      lsm/run-000001.sst     immutable run: rows sorted by
+//                             (sailing ID, license), fence keys
+//                             (first key of every block) and a
+//                             Bloom filter over the keys
+//      lsm/manifest.dat       live run numbers, oldest first
+//
+//    When the memtable is full it is written out as a new run
+//    and the log is emptied. A cancellation is a row with status
+//    REC_DEAD that hides older copies; a background thread
+//    merges the runs into one when there are too many, dropping
+//    hidden rows and cancellations as it goes.
+//
+//    A point lookup checks the memtable, then each run newest
+//    first; a run's Bloom filter skips it without I/O when it
+//    cannot hold the key, otherwise its fence keys name the one
+//    block to read. Rows of one sailing are contiguous in every
+//    run, so per-sailing counts read only the blocks they need.
+//
+//    FileIO_Reservations dispatches here when its storage mode is
+//    LSM; callers use FileIO_Reservations, not this class. All
+//    functions are thread-safe, but the store is single-process:
+//    the memtable, run numbers and manifest live in the process
+//    that opened it, which holds an exclusive flock on lsm/LOCK
+//    until close(). In any other process every call fails (with
+//    one message) until then; processes that must share the
+//    store go through ferryd.
+//************************************************************
+//************************************************************
+
+#ifndef RESERVATIONLSM_H
+#define RESERVATIONLSM_H
+
+#include "FileIO_Reservations.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FerrySys
+{
+
+// Store shape, for tests and the metrics dump
+struct LSMStats
+{
+    std::size_t memtableRows = 0;
+    std::size_t walRows = 0;
+    std::size_t runs = 0;
+    std::size_t runRows = 0;        // all rows in runs, shadowed ones included
+};
+
+class ReservationLSM
+{
+public:
+    static constexpr const char *DIR = "lsm";
+    static constexpr const char *MANIFEST = "lsm/manifest.dat";
+
+    static constexpr std::size_t MEMTABLE_ROWS = 4096;  // flush threshold
+    static constexpr std::size_t BLOCK_ROWS = 64;       // rows per fence
+    static constexpr std::size_t MERGE_AT = 4;          // runs before merging
+
+    //------------------------------------------------------------
+    // True if an LSM store exists in the working directory.
+    static bool present();
+
+    //------------------------------------------------------------
+    // FileIO_Reservations operations. IDs and licenses are
+    // case-insensitive except in exists(), which matches exactly
+    // like the flat-file version.
+    static bool write(const std::string &licensePlate, const SailingID &sailingID);
+    static bool checkin(const std::string &licensePlate, const SailingID &sailingID);
+    static bool remove(const std::string &licensePlate, const SailingID &sailingID);
+    static bool exists(const std::string &licensePlate, const SailingID &sailingID);
+    static int  count(const SailingID &sailingID);
+
+    //------------------------------------------------------------
+    // Live rows of one sailing, in license order.
+    static bool read(
+        const SailingID &sailingID,             // IN
+        std::vector<ReservationRec> &rows       // OUT (appended)
+    );
+
+    //------------------------------------------------------------
+    // Cancel every row of `sailingIDs`; returns rows cancelled.
+    static int dropSailings(
+        const std::vector<SailingID> &sailingIDs    // IN
+    );
+
+    //------------------------------------------------------------
+    // Live reservation count per sailing (upper-cased IDs).
+    static std::unordered_map<std::string, int> countAll();
+
+    //------------------------------------------------------------
+    // Sequential read of every live row, in key order, from a
+    // snapshot taken at the first call after resetCursor().
+    static bool next(std::string &licensePlate, SailingID &sailingID, bool &checkedIn);
+    static void resetCursor();
+
+    //------------------------------------------------------------
+    // Load the live rows of the flat file `flatPath` (a row
+    // already in the store is kept), flush them to a run and
+    // rename the file to `flatPath`.migrated. Returns rows
+    // moved, or -1 on I/O error (flat file left in place).
+    static int migrate(
+        const std::string &flatPath     // IN
+    );
+
+    //------------------------------------------------------------
+    // Write the memtable out as a run now.
+    static bool flush();
+
+    //------------------------------------------------------------
+    // Merge every run into one on the calling thread.
+    static bool compact();
+
+    //------------------------------------------------------------
+    // Stop the merge thread, flush and release the store. The
+    // next call reopens it from disk.
+    static void close();
+
+    static LSMStats stats();
+};
+
+} // namespace FerrySys
+
+#endif // RESERVATIONLSM_H
@@ -0,0 +1,96 @@
+//************************************************************
+//************************************************************
+//  ReservationPartitions.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Partitioned reservation storage: one fixed-record file per
+//    sailing under reservations/, plus a catalog of the sailings
+//    that have a partition.
+//
+//      reservations/catalog.dat     16-byte upper-cased sailing IDs
+//      reservations/YVR-29-14.dat   ReservationRec rows of YVR:29:14
+//
+//    Partitions hold only live rows: a cancellation swap-deletes
+//    (last row moves into the hole, file shrinks by one record),
+//    so a sailing's reservation count is its file size divided by
+//    the record size, and every per-sailing operation touches one
+//    small file. Deleting a sailing unlinks its partition.
+//
+//    FileIO_Reservations dispatches here when its storage mode is
+//    PARTITIONED; callers use FileIO_Reservations, not this class.
+//    Writers are serialized by the caller, as for reservations.dat.
+//************************************************************
+//************************************************************
+
+#ifndef RESERVATIONPARTITIONS_H
+#define RESERVATIONPARTITIONS_H
+
+#include "FileIO_Reservations.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FerrySys
+{
+
+class ReservationPartitions
+{
+public:
+    static constexpr const char *DIR = "reservations";
+    static constexpr const char *CATALOG = "reservations/catalog.dat";
+
+    //------------------------------------------------------------
+    // True if a partition catalog exists in the working directory.
+    static bool present();
+
+    //------------------------------------------------------------
+    // Partition file of a sailing (IDs are case-insensitive).
+    static std::string partitionPath(
+        const SailingID &sailingID      // IN
+    );
+
+    //------------------------------------------------------------
+    // FileIO_Reservations operations, one partition each.
+    static bool write(const std::string &licensePlate, const SailingID &sailingID);
+    static bool checkin(const std::string &licensePlate, const SailingID &sailingID);
+    static bool remove(const std::string &licensePlate, const SailingID &sailingID);
+    static bool exists(const std::string &licensePlate, const SailingID &sailingID);
+    static int  count(const SailingID &sailingID);
+
+    //------------------------------------------------------------
+    // Every row of one sailing's partition.
+    static bool read(
+        const SailingID &sailingID,             // IN
+        std::vector<ReservationRec> &rows       // OUT
+    );
+
+    //------------------------------------------------------------
+    // Unlink the partitions of `sailingIDs`; returns rows dropped.
+    static int dropSailings(
+        const std::vector<SailingID> &sailingIDs    // IN
+    );
+
+    //------------------------------------------------------------
+    // Reservation count per catalogued sailing (upper-cased IDs).
+    static std::unordered_map<std::string, int> countAll();
+
+    //------------------------------------------------------------
+    // Sequential read across all partitions, in catalog order.
+    static bool next(std::string &licensePlate, SailingID &sailingID, bool &checkedIn);
+    static void resetCursor();
+
+    //------------------------------------------------------------
+    // Split the live rows of the flat file `flatPath` into
+    // partitions (rows already present in a partition are kept
+    // once), then rename it to `flatPath`.migrated. Returns rows
+    // moved, or -1 on I/O error (flat file left in place).
+    static int migrate(
+        const std::string &flatPath     // IN
+    );
+};
+
+} // namespace FerrySys
+
+#endif // RESERVATIONPARTITIONS_H
@@ -41,7 +41,24 @@ public:
         SailingID sailingID               // IN: Sailing ID
     );
 
-    // Print single sailing status
+    // Delete every sailing departing on a date, with their reservations
+    static int DeleteSailingsOnDate(
+        const std::string &Date           // IN: Date (YY-MM-DD)
+    );
+
+    // Delete every sailing on a route (arrival city), with their reservations
+    static int DeleteSailingsToCity(
+        const std::string &ArrivalCity    // IN: Arrival city (3-letter code)
+    );
+
+    // Move sailings departed before (day, hour) of the month, with
+    // their reservations, to the archive; returns how many, or -1
+    static int ArchiveDeparted(
+        int day,                          // IN: Day of month (1-31)
+        int hour                          // IN: Hour (0-23)
+    );
+
+    // Print single sailing status (archived sailings included)
     static bool printStatus(
         SailingID sailingID               // IN: Sailing ID
     );
@@ -0,0 +1,101 @@
+//************************************************************
+//************************************************************
+//  SailingIndex.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    On-disk B+tree over sailings.dat, stored in sailings.idx,
+//    ordered by (arrival city, day, hour).
+//
+//    The key packs the characters of a "CCC:DD:HH" sailing ID
+//    into a uint64 so that numeric order is (city, day, hour)
+//    order; the value is the sailing's record slot. A point
+//    lookup reads one page per tree level (two levels cover
+//    ~100k sailings); a range lookup then walks the linked
+//    leaves.
+//
+//    Page 0 is a header that records the sailings.dat
+//    generation (see DataFile.h) the tree reflects. If the data
+//    file's generation has moved on without the tree (compaction,
+//    a missed insert, files replaced outside FileIO), the next
+//    lookup bulk-builds a fresh tree from sailings.dat.
+//    Deletes erase their entry lazily (no rebalancing), and
+//    callers re-check each returned slot against the record, so
+//    an entry can point at a dead row but never hide a live one.
+//
+//    Lookups may run concurrently; insert/erase/build are
+//    serialized internally and, like every sailings.dat write,
+//    must not race other writers (see Compaction.h).
+//************************************************************
+//************************************************************
+
+#ifndef SAILINGINDEX_H
+#define SAILINGINDEX_H
+
+#include "CommonTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+class SailingIndex
+{
+public:
+    static constexpr std::size_t PAGE_BYTES = 4096;
+    static constexpr const char *INDEX_FILE = "sailings.idx";
+
+    //------------------------------------------------------------
+    // Sort key of a sailing ID (city, day, hour).
+    static std::uint64_t keyOf(
+        const SailingID &sailingID      // IN
+    );
+
+    //------------------------------------------------------------
+    // Slots whose key matches `sailingID`. Returns false if the
+    // index is unavailable (caller falls back to a scan).
+    static bool find(
+        const SailingID &sailingID,         // IN
+        std::vector<std::size_t> &slots     // OUT
+    );
+
+    //------------------------------------------------------------
+    // Slots of sailings to `city`, limited to `day` ("DD") unless
+    // it is empty, in (day, hour) order. Returns false if the index
+    // is unavailable.
+    static bool range(
+        const std::string &city,            // IN
+        const std::string &day,             // IN
+        std::vector<std::size_t> &slots     // OUT
+    );
+
+    //------------------------------------------------------------
+    // Record that `sailingID` was appended at record `slot`
+    // (after DataFile::noteAppended for that append).
+    static void insert(
+        const SailingID &sailingID,     // IN
+        std::size_t slot                // IN
+    );
+
+    //------------------------------------------------------------
+    // Drop the entry for `sailingID` at `slot` (tombstoned).
+    static void erase(
+        const SailingID &sailingID,     // IN
+        std::size_t slot                // IN
+    );
+
+    //------------------------------------------------------------
+    // Bulk-build sailings.idx from the live rows of sailings.dat.
+    static bool build();
+
+    //------------------------------------------------------------
+    // Discard sailings.idx; the next lookup rebuilds it.
+    static void invalidate();
+};
+
+} // namespace FerrySys
+
+#endif // SAILINGINDEX_H
@@ -0,0 +1,121 @@
+//************************************************************
+//************************************************************
+//  SailingTable.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    The live rows of sailings.dat held in memory as columns, so
+//    Sailingexist, findSailing and getRemainingSpace (called
+//    several times per booking) never read the file:
+//
+//      ids      16-byte IDs, zero-padded, in one 16-byte-aligned
+//               array; a lookup compares the whole column with
+//               SSE2 (x86-64) or NEON (ARM), four IDs per step,
+//               with a plain 8-byte compare elsewhere
+//      hcl/lcl  remaining space, one float column each
+//      slots    record slot in sailings.dat
+//      vessels  vessel names (cold; findSailing and reports)
+//
+//    A thousand sailings take 16 KB of IDs, so a lookup stays in
+//    L1/L2 cache. Rows keep file order.
+//
+//    The table is loaded on first use and FileIO_Sailings writes
+//    through it: every append, tombstone and space update goes to
+//    the file and then to the table, and bumps a change count
+//    that every process shares through sailings.space
+//    (CapacityTable.h). A lookup compares that count with the
+//    one the table last matched (one atomic load, no system
+//    call) and reloads when another process or thread has
+//    changed the file since. Compaction, bulk import and the
+//    mmap engine, which change the file without writing through,
+//    call forget().
+//
+//    available() answers "the next sailings to this city with
+//    room for this vehicle" from one max segment tree per route
+//    (arrival city), leaves ordered by day and hour. A space
+//    update changes one leaf and its O(log n) ancestors; a query
+//    descends only into subtrees with room, O(log n) per sailing
+//    returned. Adding or deleting sailings rebuilds the routes on
+//    the next query.
+//
+//    Lookups run concurrently; loads and updates are serialized.
+//************************************************************
+//************************************************************
+
+#ifndef SAILINGTABLE_H
+#define SAILINGTABLE_H
+
+#include "CommonTypes.h"
+#include "FileIO_Sailings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+class SailingTable
+{
+public:
+    //------------------------------------------------------------
+    // Look up live sailing `sailingID` (exact match).
+    // Postconditions: false if sailings.dat cannot be read (the
+    //                 caller falls back to the file); otherwise
+    //                 `found` is set, and `result` and `slot` too
+    //                 if it was found.
+    static bool find(
+        const SailingID &sailingID,     // IN
+        bool &found,                    // OUT
+        Sailingrec &result,             // OUT
+        std::size_t &slot               // OUT
+    );
+
+    //------------------------------------------------------------
+    // Every live sailing in file order. Returns false if
+    // sailings.dat cannot be read.
+    static bool rows(
+        std::vector<Sailingrec> &out    // OUT
+    );
+
+    //------------------------------------------------------------
+    // Up to `max` live sailings to `city` departing at or after
+    // day `day`, hour `hour`, earliest first, with `spaceCm` free
+    // in the HCL (`highCeiling`) or in either lane (otherwise).
+    // Returns false if sailings.dat cannot be read.
+    static bool available(
+        const std::string &city,        // IN: arrival city, e.g. "VIC"
+        int day,                        // IN: day of month
+        int hour,                       // IN
+        std::int32_t spaceCm,           // IN: see CapacityTable::vehicleSpaceCm
+        bool highCeiling,               // IN
+        std::size_t max,                // IN
+        std::vector<Sailingrec> &out    // OUT
+    );
+
+    //------------------------------------------------------------
+    // Write-through after FileIO_Sailings changed sailings.dat.
+    static void noteWritten(const Sailingrec &rec, std::size_t slot);
+    static void noteSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL);
+    static void noteDeleted(const std::vector<SailingID> &sailingIDs);
+
+    //------------------------------------------------------------
+    // sailings.dat changed without a write-through (compaction,
+    // import, a memory mapping, another program): bump the shared
+    // count so every process, this one included, loads again.
+    static void forget();
+
+    //------------------------------------------------------------
+    // Row of `sailingID` among `count` packed 16-byte IDs, or
+    // `count` if absent. Exposed for tests.
+    static std::size_t scan(
+        const char *ids,                // IN: 16-byte aligned
+        std::size_t count,              // IN
+        const SailingID &sailingID      // IN
+    );
+};
+
+} // namespace FerrySys
+
+#endif // SAILINGTABLE_H
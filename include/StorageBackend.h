@@ -0,0 +1,188 @@
+//************************************************************
+//************************************************************
+//  StorageBackend.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    The storage engine behind Vessel, Sailing and Reservation.
+//
+//    The business modules (and the UI, ferryd, CapacityTable
+//    and Archive) read and write vehicles, vessels, sailings and
+//    reservations only through StorageBackend::current(), so the
+//    engine can be swapped without touching them:
+//
+//      FLAT_FILE  the FileIO_* classes: fstream access to the .dat
+//                 files, sailings.idx, free lists and the
+//                 reservation storage modes (default)
+//      MMAP       the same .dat files mapped into memory; lookups
+//                 are scans of the mapping, updates are stores
+//                 into it, so no call reopens a file
+//      MEMORY     containers only, nothing touches disk; for
+//                 tests and benchmarks
+//
+//    FLAT_FILE and MMAP share the file formats (and tombstones,
+//    free lists and compaction), so either can open the other's
+//    data. MMAP always uses reservations.dat (not the partitioned
+//    or LSM layouts).
+//
+//    FLAT_FILE and MMAP are wrapped in a LoggingBackend, which
+//    feeds mutations.log for replicas (see Replica.h).
+//
+//    The engine is chosen once at startup: select(), or else
+//    FERRY_STORAGE=flat|mmap|memory on first use of current().
+//    Matching rules are the flat files': vehicle licenses, vessel
+//    names and sailing IDs exactly; reservations by
+//    case-insensitive license and sailing ID, except
+//    reservationExists(), which is exact.
+//************************************************************
+//************************************************************
+
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include "CommonTypes.h"
+#include "Compaction.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "VehicleRecord.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FerrySys
+{
+
+enum class BackendKind
+{
+    FLAT_FILE,
+    MMAP,
+    MEMORY
+};
+
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() = default;
+
+    virtual BackendKind kind() const = 0;
+
+    //------------------------------------------------------------
+    // Vehicles
+    virtual bool writeVehicle(const VehicleRecord &vehicle) = 0;
+    virtual bool findVehicle(const LicensePlate &license, VehicleRecord &result) = 0;
+    virtual bool deleteVehicle(const LicensePlate &license) = 0;
+
+    // Several vehicles at once (group bookings); engines may do
+    // each in one pass. findVehicles sets found[i] when result[i]
+    // was filled; writeVehicles writes all or none.
+    virtual bool findVehicles(const std::vector<LicensePlate> &licenses,
+                              std::vector<VehicleRecord> &result, std::vector<char> &found);
+    virtual bool writeVehicles(const std::vector<VehicleRecord> &vehicles);
+
+    //------------------------------------------------------------
+    // Vessels
+    virtual bool writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL) = 0;
+    virtual bool findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL) = 0;
+    virtual bool deleteVessel(const std::string &vesselName) = 0;
+
+    //------------------------------------------------------------
+    // Sailings
+    virtual bool writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                              float remainingHCL, float remainingLCL) = 0;
+    virtual bool findSailing(const SailingID &sailingID, Sailingrec &result) = 0;
+    virtual bool setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL) = 0;
+
+    // Add deltas (metres) to the remaining space as stored now,
+    // which another process may have changed, and return the new
+    // values. The default is findSailing() then
+    // setRemainingSpace().
+    virtual bool adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                                      float &remainingHCL, float &remainingLCL);
+
+    // Every live sailing
+    virtual std::vector<Sailingrec> sailings() = 0;
+
+    // Sailings to `city` on `day` ("DD"), ordered by ID
+    virtual std::vector<Sailingrec> sailingsToCity(const std::string &city, const std::string &day);
+
+    // Up to `max` sailings to `city` departing at or after `day`
+    // (of the month) and `hour`, earliest first, that still have
+    // `spaceCm` (CapacityTable::vehicleSpaceCm) in the HCL, or for
+    // a vehicle that is not `highCeiling`, in either lane
+    virtual std::vector<Sailingrec> availableSailings(const std::string &city, int day, int hour,
+                                                      std::int32_t spaceCm, bool highCeiling,
+                                                      std::size_t max);
+
+    // Delete sailings and cascade to their reservations. IDs
+    // deleted are appended to `removed`; returns how many.
+    virtual int deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed) = 0;
+    virtual int deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed);
+    virtual int deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed);
+
+    //------------------------------------------------------------
+    // Reservations
+    virtual bool writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID) = 0;
+
+    // Several (license, sailing) bookings, all or none: refused if
+    // any is already booked
+    virtual bool writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings);
+    virtual bool checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID) = 0;
+    virtual bool deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID) = 0;
+    virtual bool reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID) = 0;
+    virtual int  countReservations(const SailingID &sailingID) = 0;
+
+    // Counts per sailing (upper-cased IDs); false if the reservations
+    // could not all be read
+    virtual bool countReservationsBySailing(std::unordered_map<std::string, int> &counts) = 0;
+
+    // Live rows of several sailings, appended to `rows`
+    virtual bool readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                             std::vector<ReservationRec> &rows) = 0;
+
+    //------------------------------------------------------------
+    // Lifecycle: open() at module initialize, compact() and
+    // close() at shutdown. Defaults do nothing.
+    virtual void open() {}
+    virtual void compact(Table table) { (void)table; }
+    virtual void close() {}
+
+    //------------------------------------------------------------
+    // The engine that does the work, under any wrapper (see
+    // LoggingBackend.h). Replica::catchUp() writes through it.
+    virtual StorageBackend &engine() { return *this; }
+
+    //------------------------------------------------------------
+    // Shorthands
+    bool vehicleExists(const LicensePlate &license);
+    bool vesselExists(const std::string &vesselName);
+    bool sailingExists(const SailingID &sailingID);
+    bool deleteSailing(const SailingID &sailingID);
+
+    //------------------------------------------------------------
+    // The engine in use, created on first call from FERRY_STORAGE
+    // (default FLAT_FILE).
+    static StorageBackend &current();
+
+    //------------------------------------------------------------
+    // Replace the engine in use.
+    // Preconditions : no other thread is using the backend.
+    static void select(
+        BackendKind kind    // IN
+    );
+
+    //------------------------------------------------------------
+    // "flat" / "mmap" / "memory"
+    static const char *kindName(BackendKind kind);
+    static bool parseKind(
+        const std::string &text,    // IN
+        BackendKind &kind           // OUT
+    );
+};
+
+} // namespace FerrySys
+
+#endif // STORAGEBACKEND_H
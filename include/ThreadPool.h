@@ -0,0 +1,128 @@
+//************************************************************
+//************************************************************
+//  ThreadPool.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Fixed-size work-stealing pool shared by the reservation
+//    daemon and the parallel file scans.
+//
+//    • Each worker owns a deque; jobs submitted from a worker go
+//      to its own deque, jobs from outside are dealt round-robin
+//    • A worker takes from the front of its own deque and, when
+//      empty, steals from the back of another worker's deque
+//    • TaskGroup lets a caller wait for a batch of jobs while
+//      helping to run them, so waiting inside a job never
+//      deadlocks the pool
+//************************************************************
+//************************************************************
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FerrySys
+{
+
+class ThreadPool
+{
+public:
+    //------------------------------------------------------------
+    // Start the pool.
+    // Preconditions : none (0 means one worker per hardware thread).
+    // Postconditions: workers are running and waiting for jobs.
+    explicit ThreadPool(
+        std::size_t workerCount = 0     // IN: number of worker threads
+    );
+
+    //------------------------------------------------------------
+    // Drain remaining jobs and join all workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    //------------------------------------------------------------
+    // Queue a job for execution on a worker thread.
+    // Preconditions : shutdown() has not been called.
+    // Postconditions: job will run exactly once; returns false if
+    //                 the pool is already stopping.
+    bool submit(
+        std::function<void()> job       // IN: work to run
+    );
+
+    //------------------------------------------------------------
+    // Run one queued job on the calling thread, if any.
+    // Postconditions: returns false if every deque was empty.
+    bool runPending();
+
+    //------------------------------------------------------------
+    // Stop accepting jobs, finish queued ones and join workers.
+    // Postconditions: safe to call more than once.
+    void shutdown();
+
+    //------------------------------------------------------------
+    // Number of worker threads owned by the pool.
+    std::size_t size() const { return workers.size(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex                        lock;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    void workerLoop(std::size_t self);
+    bool popLocal(std::size_t self, std::function<void()> &job);
+    bool steal(std::size_t self, std::function<void()> &job);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread>                workers;
+    std::atomic<std::size_t>                nextQueue{ 0 };
+    std::atomic<std::size_t>                queued{ 0 };
+
+    // Idle workers sleep here until a job is submitted.
+    std::mutex                              sleepLock;
+    std::condition_variable                 wake;
+    bool                                    stopping = false;
+};
+
+//------------------------------------------------------------
+// Completion latch for a batch of pool jobs.
+//------------------------------------------------------------
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool &pool) : pool(pool) {}
+
+    //------------------------------------------------------------
+    // Queue a job that counts towards wait(). Runs inline if the
+    // pool is shutting down.
+    void run(std::function<void()> job);
+
+    //------------------------------------------------------------
+    // Block until every job passed to run() has finished, running
+    // queued pool jobs on this thread in the meantime.
+    void wait();
+
+private:
+    void done();
+
+    ThreadPool              &pool;
+    std::atomic<std::size_t> pending{ 0 };
+    std::mutex               lock;
+    std::condition_variable  finished;
+};
+
+} // namespace FerrySys
+
+#endif // THREADPOOL_H
@@ -0,0 +1,117 @@
+//************************************************************
+//************************************************************
+//  Trace.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Scoped trace spans written as Chrome trace-event JSON, for
+//    viewing a real session in chrome://tracing or Perfetto.
+//
+//    • Tracing is off unless FERRY_TRACE=<file.json> is set
+//      (or Trace::start() is called); when off, a span costs
+//      one relaxed load and a branch
+//    • Each thread appends finished spans to its own fixed ring
+//      buffer (no locks); a full ring overwrites its oldest
+//      spans, so the file holds the most recent
+//      RING_EVENTS spans per thread
+//    • flush() writes every ring to the file; the UI and ferryd
+//      call it on shutdown
+//    • Building with -DFERRY_NO_TRACE removes the spans entirely
+//
+//    Span names must be string literals (only the pointer is
+//    stored).
+//************************************************************
+//************************************************************
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FerrySys
+{
+
+class Trace
+{
+public:
+    static constexpr std::size_t RING_EVENTS = 16384;  // per thread
+
+    //------------------------------------------------------------
+    // True when spans are being recorded.
+    static bool enabled()
+    {
+        return on.load(std::memory_order_relaxed);
+    }
+
+    //------------------------------------------------------------
+    // Turn tracing on, writing to `path` at flush().
+    // (Done automatically at startup when FERRY_TRACE is set.)
+    static void start(
+        const std::string &path         // IN: output JSON file
+    );
+
+    //------------------------------------------------------------
+    // Monotonic clock in nanoseconds since the process started.
+    static std::uint64_t nowNs();
+
+    //------------------------------------------------------------
+    // Append one finished span to the calling thread's ring.
+    static void record(
+        const char *name,               // IN: string literal
+        std::uint64_t startNs,          // IN: from nowNs()
+        std::uint64_t durationNs        // IN
+    );
+
+    //------------------------------------------------------------
+    // Write all recorded spans as Chrome trace JSON.
+    // Preconditions : call when other threads are idle (shutdown);
+    //                 spans recorded during the flush may be torn.
+    // Postconditions: file rewritten; false if tracing is off or
+    //                 the file cannot be opened.
+    static bool flush();
+
+private:
+    static std::atomic<bool> on;
+};
+
+//------------------------------------------------------------
+// RAII span behind FERRY_TRACE_SPAN.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : name(name), start(Trace::enabled() ? Trace::nowNs() : 0)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (start != 0)
+            Trace::record(name, start, Trace::nowNs() - start);
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char   *name;
+    std::uint64_t start;    // 0 = not recording
+};
+
+} // namespace FerrySys
+
+#define FERRY_TRACE_CAT2(a, b) a##b
+#define FERRY_TRACE_CAT(a, b)  FERRY_TRACE_CAT2(a, b)
+
+#ifdef FERRY_NO_TRACE
+#define FERRY_TRACE_SPAN(name) do {} while (0)
+#else
+// Trace the rest of the enclosing block as span `name`.
+#define FERRY_TRACE_SPAN(name) \
+    ::FerrySys::TraceSpan FERRY_TRACE_CAT(ferryTraceSpan_, __LINE__)(name)
+#endif
+
+#endif // TRACE_H
@@ -29,6 +29,35 @@ public:
     // Clean up resources before program exit
     static void shutdown();
 
+    // `ferry import`: load a CSV file of vessels, sailings, vehicles
+    // or reservations (see BulkImport.h). Returns the exit status.
+    static int runImport(
+        const std::string &kind,        // IN: vessels|sailings|vehicles|reservations
+        const std::string &csvPath,     // IN: input file
+        const std::string &rejectPath   // IN: where rejected rows go
+    );
+
+    // `ferry export`: write a table or the bookings view as CSV or
+    // JSON (see BulkExport.h). Returns the exit status.
+    static int runExport(
+        const std::string &kind,        // IN: vessels|sailings|vehicles|reservations|bookings
+        const std::string &format,      // IN: csv|json
+        const std::string &outPath      // IN: output file, "-" for standard output
+    );
+
+    // `ferry backup`: copy the data directory while others keep
+    // writing (see Backup.h). Returns the exit status.
+    static int runBackup(
+        const std::string &destDir      // IN: new or empty directory
+    );
+
+    // `ferry replica`: seed a read replica of the data directory,
+    // or report the lag of one already seeded (see Replica.h).
+    // Returns the exit status.
+    static int runReplica(
+        const std::string &followerDir  // IN: new, empty or replica directory
+    );
+
 private:
     // Submenu handlers
     static void vesselMenu();
@@ -15,6 +15,8 @@
 #include <string>
 #include <string_view>
 #include <cstring> // for memset, memcpy
+#include <type_traits>
+#include "FixedString.h"
 
 namespace FerrySys
 {
@@ -25,13 +27,22 @@ namespace FerrySys
     constexpr std::size_t VEH_PHONE_CHARS = 14;   // Phone number max chars
     constexpr std::size_t VEH_REC_BYTES   = 32;   // Total record size in bytes
 
+    // The record has no spare byte, so the first license byte doubles as the
+    // status byte: a live record holds a printable character there, a deleted
+    // one holds REC_DEAD (0xFF, see BinaryFileOps.hpp).
+    constexpr std::size_t VEH_STATUS_OFFSET = 0;
+
+    // Fixed-width field types (inline storage, no heap)
+    using LicensePlate = FixedString<VEH_LIC_CHARS>;
+    using PhoneNumber  = FixedString<VEH_PHONE_CHARS>;
+
     // -----------------------------------------------------------------------
     // Struct: VehicleRecord
     // -----------------------------------------------------------------------
     struct VehicleRecord
     {
-        std::string license;     // Trimmed to <=10 chars when encoded
-        std::string phone;       // Trimmed to <=14 chars when encoded
+        LicensePlate license;    // <=10 chars, as on disk
+        PhoneNumber  phone;      // <=14 chars, as on disk
         std::int32_t length_m = 0;
         std::int32_t height_m = 0;
 
@@ -40,6 +51,7 @@ namespace FerrySys
             return (height_m > 200) || (length_m > 700);
         }
     };
+    static_assert(std::is_trivially_copyable_v<VehicleRecord>, "VehicleRecord must stay plain data");
 
     // -----------------------------------------------------------------------
     // Raw 32-byte vehicle record
@@ -49,20 +61,26 @@ namespace FerrySys
     // -----------------------------------------------------------------------
     // Shared helper: encode/decode fixed-length string fields (space-padded)
     // -----------------------------------------------------------------------
-    inline void encodeField(const std::string &src, unsigned char *dest, std::size_t len)
+    inline void encodeField(std::string_view src, unsigned char *dest, std::size_t len)
     {
         std::memset(dest, ' ', len);
         std::size_t n = (src.size() < len) ? src.size() : len;
         std::memcpy(dest, src.data(), n);
     }
 
-    inline std::string decodeField(const unsigned char *src, std::size_t len)
+    // Field contents without the padding, viewed in place (no copy)
+    inline std::string_view fieldView(const unsigned char *src, std::size_t len)
     {
-        std::string s(reinterpret_cast<const char*>(src), len);
-        while (!s.empty() && s.back() == ' ') s.pop_back();
+        std::string_view s(reinterpret_cast<const char*>(src), len);
+        while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
         return s;
     }
 
+    inline std::string decodeField(const unsigned char *src, std::size_t len)
+    {
+        return std::string(fieldView(src, len));
+    }
+
     // Encode full vehicle record to raw bytes
     void encodeVehicle(const VehicleRecord &in, VehicleRaw &out) noexcept;
 
@@ -0,0 +1,87 @@
+//************************************************************
+//************************************************************
+//  WriteGate.h
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Lets a backup stop every writer, in this process and in
+//    every other terminal or ferryd using the same data
+//    directory, at a point where no change is half done.
+//
+//    Every change to the data files (each StorageBackend update,
+//    compaction, archiving, an import round, an LSM merge) runs
+//    inside a Hold. A Pause waits until no Hold is active in any
+//    process, and keeps new ones from starting until it ends.
+//
+//    Two lock files in the data directory carry this across
+//    processes with flock():
+//      backup.lock   turnstile: a Hold passes through it (shared,
+//                    released at once); a Pause keeps it
+//                    exclusive, so writers queue here
+//      writes.lock   a process holds it shared while any of its
+//                    threads is inside a Hold; a Pause takes it
+//                    exclusive once the writers have drained
+//    A Pause is therefore never starved by a busy ferryd, and a
+//    Hold costs a few uncontended flock() calls.
+//
+//    Holds nest: a Hold inside a Hold on the same thread does
+//    nothing. If the lock files cannot be created (read-only
+//    directory) a Hold does nothing and a Pause fails.
+//************************************************************
+//************************************************************
+
+#ifndef WRITEGATE_H
+#define WRITEGATE_H
+
+namespace FerrySys
+{
+
+class WriteGate
+{
+public:
+    static constexpr const char *TURNSTILE_FILE = "backup.lock";
+    static constexpr const char *GATE_FILE = "writes.lock";
+
+    //------------------------------------------------------------
+    // A change to the data files in progress (scoped). Blocks
+    // while a Pause is held.
+    class Hold
+    {
+    public:
+        Hold();
+        ~Hold();
+        Hold(const Hold &) = delete;
+        Hold &operator=(const Hold &) = delete;
+    };
+
+    //------------------------------------------------------------
+    // Writes stopped everywhere (scoped). Blocks until current
+    // Holds end.
+    // Preconditions : the calling thread is not inside a Hold.
+    class Pause
+    {
+    public:
+        Pause();
+        ~Pause();
+        Pause(const Pause &) = delete;
+        Pause &operator=(const Pause &) = delete;
+
+        // False if the lock files could not be locked
+        bool held() const { return locked; }
+
+    private:
+        int  turnstileFd = -1;
+        int  gateFd = -1;
+        bool locked = false;
+    };
+
+    //------------------------------------------------------------
+    // Close this process's lock files; they are opened again, in
+    // the current directory, by the next Hold.
+    // Preconditions : no thread is inside a Hold.
+    static void reset();
+};
+
+} // namespace FerrySys
+
+#endif // WRITEGATE_H
@@ -0,0 +1,400 @@
+//************************************************************
+//************************************************************
+//  Archive.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements archive segments and their catalog.
+//
+//    Segments are compressed with PackBits: a control byte n in
+//    0..127 is followed by n+1 literal bytes; n in 129..255 means
+//    "repeat the next byte 257-n times". Records are mostly
+//    space and NUL padding, so long runs are common.
+//
+//    A segment is written to a temp file, fsynced and renamed
+//    into place (and the directory fsynced) before the catalog
+//    names it, and the catalog append is fsynced before the
+//    working files are touched, so a crash can leave an unlisted
+//    segment (ignored) but never lose a sailing.
+//************************************************************
+//************************************************************
+
+#include "Archive.h"
+#include "Metrics.h"
+#include "StorageBackend.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr char          MAGIC[4] = { 'F', 'A', 'R', 'C' };
+    constexpr std::uint32_t VERSION = 1;
+
+    struct SegmentHeader
+    {
+        char          magic[4];
+        std::uint32_t version;
+        std::uint32_t sailings;
+        std::uint32_t reservations;
+        std::uint64_t rawBytes;
+        std::uint64_t packedBytes;
+    };
+
+    std::string upper(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return s;
+    }
+
+    std::string segmentPath(std::uint32_t segment)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/seg-%06u.arc", segment);
+        return std::string(Archive::DIR) + name;
+    }
+
+    bool syncPath(const std::string &path, bool directory)
+    {
+        int fd = ::open(path.c_str(), (directory ? O_RDONLY | O_DIRECTORY : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    std::string entryID(const ArchiveEntry &e)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(e.sailingID), sizeof(e.sailingID));
+    }
+
+    //------------------------------------------------------------
+    // PackBits encode / decode
+    void packBits(const unsigned char *in, std::size_t n, std::vector<unsigned char> &out)
+    {
+        std::size_t i = 0;
+        while (i < n)
+        {
+            std::size_t run = 1;
+            while (i + run < n && run < 128 && in[i + run] == in[i])
+                ++run;
+            if (run >= 3)
+            {
+                out.push_back(static_cast<unsigned char>(257 - run));
+                out.push_back(in[i]);
+                i += run;
+                continue;
+            }
+
+            // Literals up to the next run of three (or 128 bytes)
+            std::size_t start = i;
+            while (i < n && i - start < 128)
+            {
+                if (i + 2 < n && in[i] == in[i + 1] && in[i] == in[i + 2])
+                    break;
+                ++i;
+            }
+            out.push_back(static_cast<unsigned char>(i - start - 1));
+            out.insert(out.end(), in + start, in + i);
+        }
+    }
+
+    bool unpackBits(const unsigned char *in, std::size_t n, std::vector<unsigned char> &out)
+    {
+        std::size_t i = 0;
+        while (i < n)
+        {
+            unsigned char c = in[i++];
+            if (c < 128)
+            {
+                std::size_t len = c + 1u;
+                if (i + len > n)
+                    return false;
+                out.insert(out.end(), in + i, in + i + len);
+                i += len;
+            }
+            else if (c > 128)
+            {
+                if (i >= n)
+                    return false;
+                out.insert(out.end(), 257u - c, in[i++]);
+            }
+        }
+        return true;
+    }
+
+    std::vector<ArchiveEntry> readCatalog()
+    {
+        std::vector<ArchiveEntry> entries;
+        std::ifstream in(Archive::CATALOG, std::ios::binary);
+        Metrics::add(Counter::FILE_OPENS);
+        ArchiveEntry e{};
+        while (in.read(reinterpret_cast<char*>(&e), sizeof(e)))
+        {
+            Metrics::recordRead(sizeof(e));
+            entries.push_back(e);
+        }
+        return entries;
+    }
+
+    //------------------------------------------------------------
+    // Newest catalog entry whose ID matches under `same`
+    template <class Same>
+    bool latestEntry(Same same, ArchiveEntry &found)
+    {
+        std::vector<ArchiveEntry> entries = readCatalog();
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        {
+            if (same(entryID(*it)))
+            {
+                found = *it;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readSegment(std::uint32_t segment,
+                     std::vector<Sailingrec> &sailings,
+                     std::vector<ReservationRec> &reservations)
+    {
+        std::ifstream in(segmentPath(segment), std::ios::binary);
+        Metrics::add(Counter::FILE_OPENS);
+        SegmentHeader h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+            std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION ||
+            h.rawBytes != h.sailings * sizeof(Sailingrec) + h.reservations * sizeof(ReservationRec))
+            return false;
+
+        std::vector<unsigned char> packed(h.packedBytes), raw;
+        if (!in.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size())))
+            return false;
+        Metrics::add(Counter::BYTES_READ, sizeof(h) + packed.size());
+        raw.reserve(h.rawBytes);
+        if (!unpackBits(packed.data(), packed.size(), raw) || raw.size() != h.rawBytes)
+            return false;
+
+        sailings.resize(h.sailings);
+        reservations.resize(h.reservations);
+        std::size_t sailingBytes = h.sailings * sizeof(Sailingrec);
+        std::memcpy(sailings.data(), raw.data(), sailingBytes);
+        std::memcpy(reservations.data(), raw.data() + sailingBytes, h.reservations * sizeof(ReservationRec));
+        Metrics::add(Counter::RECORDS_SCANNED, h.sailings + h.reservations);
+        return true;
+    }
+
+    std::uint32_t nextSegment()
+    {
+        std::uint32_t last = 0;
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator(Archive::DIR, ec))
+        {
+            unsigned n = 0;
+            if (std::sscanf(entry.path().filename().c_str(), "seg-%u.arc", &n) == 1)
+                last = std::max<std::uint32_t>(last, n);
+        }
+        return last + 1;
+    }
+
+    //------------------------------------------------------------
+    // Departure (day, hour) of a "CCC:DD:HH" ID
+    bool departure(const std::string &id, int &day, int &hour)
+    {
+        if (id.size() < 9 || id[3] != ':' || id[6] != ':')
+            return false;
+        for (int pos : { 4, 5, 7, 8 })
+        {
+            if (!std::isdigit(static_cast<unsigned char>(id[pos])))
+                return false;
+        }
+        day = (id[4] - '0') * 10 + (id[5] - '0');
+        hour = (id[7] - '0') * 10 + (id[8] - '0');
+        return true;
+    }
+}
+
+int Archive::archiveDeparted(int day, int hour, std::vector<SailingID> &archived)
+{
+    FERRY_METRIC_SCOPE("Archive::archiveDeparted");
+    WriteGate::Hold hold;
+
+    // 1. Departed sailings and their reservations
+    std::vector<Sailingrec> departed;
+    std::vector<SailingID> ids;
+    StorageBackend &store = StorageBackend::current();
+    for (const Sailingrec &rec : store.sailings())
+    {
+        std::string id(rec.id, strnlen(rec.id, sizeof(rec.id)));
+        int d = 0, h = 0;
+        if (departure(id, d, h) && (d < day || (d == day && h < hour)))
+        {
+            departed.push_back(rec);
+            ids.push_back(id);
+        }
+    }
+    if (departed.empty())
+        return 0;
+
+    std::vector<ReservationRec> bookings;
+    if (!store.readReservationsForSailings(ids, bookings))
+        return -1;
+
+    // 2. Segment: temp file, then rename into place
+    std::vector<unsigned char> raw(departed.size() * sizeof(Sailingrec) +
+                                   bookings.size() * sizeof(ReservationRec));
+    std::memcpy(raw.data(), departed.data(), departed.size() * sizeof(Sailingrec));
+    std::memcpy(raw.data() + departed.size() * sizeof(Sailingrec), bookings.data(),
+                bookings.size() * sizeof(ReservationRec));
+    std::vector<unsigned char> packed;
+    packBits(raw.data(), raw.size(), packed);
+
+    std::error_code ec;
+    fs::create_directories(DIR, ec);
+    std::uint32_t segment = nextSegment();
+    std::string path = segmentPath(segment);
+    std::string tmp = path + ".tmp";
+    {
+        SegmentHeader h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.sailings = static_cast<std::uint32_t>(departed.size());
+        h.reservations = static_cast<std::uint32_t>(bookings.size());
+        h.rawBytes = raw.size();
+        h.packedBytes = packed.size();
+
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        Metrics::add(Counter::FILE_OPENS);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+        out.close();
+        if (!out || !syncPath(tmp, false))
+        {
+            fs::remove(tmp, ec);
+            return -1;
+        }
+        Metrics::add(Counter::BYTES_WRITTEN, sizeof(h) + packed.size());
+    }
+    fs::rename(tmp, path, ec);
+    if (ec || !syncPath(DIR, true) || !syncPath(".", true))
+    {
+        fs::remove(ec ? tmp : path, ec);
+        return -1;
+    }
+
+    // 3. Catalog, with booking counts so counts never need the segment
+    std::unordered_map<std::string, std::uint32_t> perSailing;
+    for (const auto &rec : bookings)
+        ++perSailing[upper(decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), 16))];
+    {
+        std::vector<ArchiveEntry> entries(ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            encodeField(ids[i], reinterpret_cast<unsigned char*>(entries[i].sailingID), sizeof(entries[i].sailingID));
+            entries[i].segment = segment;
+            entries[i].reservations = perSailing[upper(ids[i])];
+        }
+        std::ofstream out(CATALOG, std::ios::binary | std::ios::app);
+        Metrics::add(Counter::FILE_OPENS);
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(ArchiveEntry)));
+        out.close();
+        if (!out)
+            return -1;      // segment stays unlisted; working files untouched
+        Metrics::add(Counter::BYTES_WRITTEN, entries.size() * sizeof(ArchiveEntry));
+    }
+    if (!syncPath(CATALOG, false) || !syncPath(DIR, true))
+        return -1;          // listed but maybe not durable: keep the working rows
+
+    // 4. Drop them from the working files
+    std::size_t before = archived.size();
+    store.deleteSailings(ids, archived);
+    return static_cast<int>(archived.size() - before);
+}
+
+bool Archive::findSailing(const SailingID &sailingID, Sailingrec &result)
+{
+    FERRY_METRIC_SCOPE("Archive::findSailing");
+    std::string id = upper(sailingID);
+    ArchiveEntry entry{};
+    if (!latestEntry([&](const std::string &e) { return upper(e) == id; }, entry))
+        return false;
+
+    std::vector<Sailingrec> sailings;
+    std::vector<ReservationRec> reservations;
+    if (!readSegment(entry.segment, sailings, reservations))
+        return false;
+    for (const auto &rec : sailings)
+    {
+        if (upper(std::string(rec.id, strnlen(rec.id, sizeof(rec.id)))) == id)
+        {
+            result = rec;
+            return true;
+        }
+    }
+    return false;
+}
+
+int Archive::countReservations(const SailingID &sailingID)
+{
+    std::string id = upper(sailingID);
+    ArchiveEntry entry{};
+    if (!latestEntry([&](const std::string &e) { return upper(e) == id; }, entry))
+        return -1;
+    return static_cast<int>(entry.reservations);
+}
+
+bool Archive::readReservations(const SailingID &sailingID, std::vector<ReservationRec> &rows)
+{
+    FERRY_METRIC_SCOPE("Archive::readReservations");
+    std::string id = upper(sailingID);
+    ArchiveEntry entry{};
+    if (!latestEntry([&](const std::string &e) { return upper(e) == id; }, entry))
+        return false;
+
+    std::vector<Sailingrec> sailings;
+    std::vector<ReservationRec> reservations;
+    if (!readSegment(entry.segment, sailings, reservations))
+        return false;
+    for (const auto &rec : reservations)
+    {
+        if (upper(decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), 16)) == id)
+            rows.push_back(rec);
+    }
+    return true;
+}
+
+std::vector<Sailingrec> Archive::sailings()
+{
+    FERRY_METRIC_SCOPE("Archive::sailings");
+    std::vector<Sailingrec> all;
+    std::uint32_t lastSegment = 0;
+    for (const auto &entry : readCatalog())
+    {
+        if (entry.segment == lastSegment)
+            continue;       // entries of one segment are contiguous
+        lastSegment = entry.segment;
+
+        std::vector<Sailingrec> sailings;
+        std::vector<ReservationRec> reservations;
+        if (readSegment(entry.segment, sailings, reservations))
+            all.insert(all.end(), sailings.begin(), sailings.end());
+    }
+    return all;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,349 @@
+//************************************************************
+//************************************************************
+//  AsyncIO.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the io_uring and pread batch read engines.
+//
+//    The io_uring engine talks to the kernel directly through
+//    the io_uring_setup/io_uring_enter system calls (no
+//    liburing dependency). It uses IORING_OP_READV, which every
+//    io_uring kernel supports. One ring is shared per engine and
+//    guarded by a mutex; a batch larger than the ring is fed in
+//    ring-sized waves. Each io_uring_enter submits every entry
+//    between the kernel's SQ head and our tail, so entries left
+//    by an interrupted or partial submit go with the next call.
+//************************************************************
+//************************************************************
+
+#include "AsyncIO.h"
+#include "ParallelScan.h"   // scanPool()
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FERRY_HAVE_IO_URING 1
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace FerrySys
+{
+
+// ============================================================
+// pread fallback: split the batch across the worker pool
+// ============================================================
+class PreadReader : public BatchReader
+{
+public:
+    bool readBatch(int fd, std::vector<ReadRequest> &requests) override
+    {
+        constexpr std::size_t PER_JOB = 32;
+
+        auto readRange = [fd, &requests](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                ReadRequest &r = requests[i];
+                std::size_t done = 0;
+                while (done < r.length)
+                {
+                    ssize_t n = ::pread(fd, static_cast<char*>(r.buffer) + done,
+                                        r.length - done,
+                                        static_cast<off_t>(r.offset + done));
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        break;
+                    done += static_cast<std::size_t>(n);
+                }
+                r.result = static_cast<std::int64_t>(done);
+            }
+        };
+
+        if (requests.size() <= PER_JOB)
+        {
+            readRange(0, requests.size());
+        }
+        else
+        {
+            TaskGroup group(scanPool());
+            for (std::size_t first = 0; first < requests.size(); first += PER_JOB)
+            {
+                std::size_t last = std::min(first + PER_JOB, requests.size());
+                group.run([&readRange, first, last] { readRange(first, last); });
+            }
+            group.wait();
+        }
+        return allComplete(requests);
+    }
+
+    const char *name() const override { return "pread"; }
+
+    static bool allComplete(const std::vector<ReadRequest> &requests)
+    {
+        for (const ReadRequest &r : requests)
+        {
+            if (r.result != static_cast<std::int64_t>(r.length))
+                return false;
+        }
+        return true;
+    }
+};
+
+#ifdef FERRY_HAVE_IO_URING
+// ============================================================
+// io_uring engine
+// ============================================================
+class IoUringReader : public BatchReader
+{
+public:
+    static constexpr unsigned RING_ENTRIES = 256;
+
+    IoUringReader() = default;
+
+    ~IoUringReader() override
+    {
+        if (sqes)
+            ::munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing)
+            ::munmap(cqRing, cqRingSize);
+        if (sqRing)
+            ::munmap(sqRing, sqRingSize);
+        if (ringFd >= 0)
+            ::close(ringFd);
+    }
+
+    //------------------------------------------------------------
+    // Create and map the ring; false if the kernel refuses
+    bool open()
+    {
+        io_uring_params p{};
+        ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, RING_ENTRIES, &p));
+        if (ringFd < 0)
+            return false;
+
+        sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED)
+        {
+            sqRing = nullptr;
+            return false;
+        }
+        if (single)
+        {
+            cqRing = sqRing;
+        }
+        else
+        {
+            cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED)
+            {
+                cqRing = nullptr;
+                return false;
+            }
+        }
+
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        void *m = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (m == MAP_FAILED)
+            return false;
+        sqes = static_cast<io_uring_sqe*>(m);
+
+        char *sq = static_cast<char*>(sqRing);
+        sqHead  = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sqTail  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask  = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        sqEntries = p.sq_entries;
+
+        char *cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes   = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+        // Probe once: some sandboxes allow setup but block enter.
+        return ::syscall(__NR_io_uring_enter, ringFd, 0, 0, 0, nullptr, 0) >= 0;
+    }
+
+    bool readBatch(int fd, std::vector<ReadRequest> &requests) override
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        std::vector<iovec> iovs(requests.size());
+        std::size_t next = 0;       // next request to place in the ring
+        std::size_t inFlight = 0;   // placed and not yet completed
+        std::size_t completed = 0;
+        unsigned tail = *sqTail;
+        bool broken = false;
+
+        for (ReadRequest &r : requests)
+            r.result = 0;
+
+        while (completed < requests.size())
+        {
+            // Fill free submission slots
+            while (next < requests.size() && inFlight < sqEntries)
+            {
+                ReadRequest &r = requests[next];
+                iovs[next] = { r.buffer, r.length };
+
+                unsigned idx = tail & sqMask;
+                io_uring_sqe &sqe = sqes[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode    = IORING_OP_READV;
+                sqe.fd        = fd;
+                sqe.addr      = reinterpret_cast<std::uint64_t>(&iovs[next]);
+                sqe.len       = 1;
+                sqe.off       = r.offset;
+                sqe.user_data = next;
+                sqArray[idx]  = idx;
+
+                ++tail;
+                ++next;
+                ++inFlight;
+            }
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+            // Everything between the kernel's head and our tail: an
+            // interrupted or partial submit leaves entries for the
+            // next call
+            unsigned unsubmitted = tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            long rc = ::syscall(__NR_io_uring_enter, ringFd, unsubmitted, 1,
+                                IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                broken = true;
+                break;
+            }
+            reap(requests, inFlight, completed);
+        }
+
+        if (broken)
+            drain(requests, next, tail, inFlight, completed);
+
+        // Short reads (rare on regular files) and requests the ring
+        // never took are finished with pread
+        for (ReadRequest &r : requests)
+        {
+            while (r.result >= 0 && r.result < static_cast<std::int64_t>(r.length))
+            {
+                ssize_t n = ::pread(fd, static_cast<char*>(r.buffer) + r.result,
+                                    r.length - static_cast<std::size_t>(r.result),
+                                    static_cast<off_t>(r.offset + r.result));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                r.result += n;
+            }
+        }
+        return PreadReader::allComplete(requests);
+    }
+
+    const char *name() const override { return "io_uring"; }
+
+private:
+    //------------------------------------------------------------
+    // Take every completion that has landed
+    void reap(std::vector<ReadRequest> &requests, std::size_t &inFlight, std::size_t &completed)
+    {
+        unsigned head = *cqHead;
+        while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+        {
+            const io_uring_cqe &cqe = cqes[head & cqMask];
+            requests[cqe.user_data].result = cqe.res;
+            ++head;
+            --inFlight;
+            ++completed;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    //------------------------------------------------------------
+    // io_uring_enter failed outright: take back the entries the
+    // kernel has not consumed (left for pread) and wait for the
+    // ones it has, which still point at our buffers
+    void drain(std::vector<ReadRequest> &requests, std::size_t next, unsigned &tail,
+               std::size_t &inFlight, std::size_t &completed)
+    {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        unsigned unsubmitted = tail - head;
+        tail = head;
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+        inFlight -= unsubmitted;
+        for (std::size_t i = next - unsubmitted; i < next; ++i)
+            requests[i].result = 0;
+
+        while (inFlight > 0)
+        {
+            long rc = ::syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                break;
+            reap(requests, inFlight, completed);
+        }
+    }
+
+    std::mutex    lock;
+    int           ringFd = -1;
+    void         *sqRing = nullptr;
+    void         *cqRing = nullptr;
+    std::size_t   sqRingSize = 0;
+    std::size_t   cqRingSize = 0;
+    std::size_t   sqesSize = 0;
+    io_uring_sqe *sqes = nullptr;
+    io_uring_cqe *cqes = nullptr;
+    unsigned     *sqHead = nullptr;
+    unsigned     *sqTail = nullptr;
+    unsigned     *sqArray = nullptr;
+    unsigned      sqMask = 0;
+    unsigned      sqEntries = 0;
+    unsigned     *cqHead = nullptr;
+    unsigned     *cqTail = nullptr;
+    unsigned      cqMask = 0;
+};
+#endif // FERRY_HAVE_IO_URING
+
+// ============================================================
+// Engine selection
+// ============================================================
+std::unique_ptr<BatchReader> makeBatchReader()
+{
+#ifdef FERRY_HAVE_IO_URING
+    const char *forced = std::getenv("FERRY_IO_ENGINE");
+    if (!forced || std::string(forced) != "pread")
+    {
+        auto ring = std::make_unique<IoUringReader>();
+        if (ring->open())
+            return ring;
+    }
+#endif
+    return std::make_unique<PreadReader>();
+}
+
+BatchReader &defaultBatchReader()
+{
+    static std::unique_ptr<BatchReader> reader = makeBatchReader();
+    return *reader;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,219 @@
+//************************************************************
+//************************************************************
+//  Backup.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the online backup: list the data set and copy
+//    each file (reflink, else copy_file_range, else read/write)
+//    under a WriteGate::Pause, then fsync the copies.
+//************************************************************
+//************************************************************
+
+#include "Backup.h"
+#include "Metrics.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char *const DATA_DIRS[] = { "reservations", "lsm", "archive" };
+    const char *const DATA_EXTENSIONS[] = { ".dat", ".idx", ".free", ".snap" };
+
+    constexpr std::size_t COPY_BUFFER_BYTES = 1 << 20;
+
+    bool isDataFile(const fs::path &path)
+    {
+        std::string ext = path.extension().string();
+        return std::find(std::begin(DATA_EXTENSIONS), std::end(DATA_EXTENSIONS), ext) != std::end(DATA_EXTENSIONS);
+    }
+
+    bool writeAll(int fd, const char *data, std::size_t size)
+    {
+        std::size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = ::write(fd, data + done, size - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Copy `from` (size bytes) to the new file `to`. Sets cloned
+    // if it was a reflink.
+    bool copyFile(const std::string &from, const std::string &to, std::size_t &size, bool &cloned)
+    {
+        int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0)
+            return errno == ENOENT;             // gone since listed (a run merged away)
+        int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (out < 0)
+        {
+            ::close(in);
+            return false;
+        }
+        Metrics::add(Counter::FILE_OPENS, 2);
+
+        struct stat st{};
+        bool ok = ::fstat(in, &st) == 0;
+        size = ok ? static_cast<std::size_t>(st.st_size) : 0;
+        cloned = ok && ::ioctl(out, FICLONE, in) == 0;
+
+        std::size_t done = 0;
+        if (ok && !cloned)
+        {
+            // In-kernel copy; falls back below where the kernel or
+            // file system does not support it
+            while (done < size)
+            {
+                ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, size - done, 0);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += static_cast<std::size_t>(n);
+            }
+        }
+        if (ok && !cloned && done < size)
+        {
+            std::vector<char> buf(COPY_BUFFER_BYTES);
+            while (ok && done < size)
+            {
+                ssize_t n = ::pread(in, buf.data(), std::min(buf.size(), size - done), static_cast<off_t>(done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                ok = n > 0 && ::lseek(out, static_cast<off_t>(done), SEEK_SET) >= 0 &&
+                     writeAll(out, buf.data(), static_cast<std::size_t>(n));
+                if (ok)
+                    done += static_cast<std::size_t>(n);
+            }
+        }
+        Metrics::add(Counter::BYTES_READ, size);
+        Metrics::add(Counter::BYTES_WRITTEN, cloned ? 0 : size);
+
+        ::close(in);
+        ok = ::close(out) == 0 && ok;
+        return ok;
+    }
+
+    bool syncPath(const std::string &path, bool directory)
+    {
+        int fd = ::open(path.c_str(), (directory ? O_RDONLY | O_DIRECTORY : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+}
+
+// ============================================================
+// Data set
+// ============================================================
+std::vector<std::string> Backup::dataFiles()
+{
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(".", ec))
+    {
+        if (entry.is_regular_file(ec) && isDataFile(entry.path()))
+            files.push_back(entry.path().filename().string());
+    }
+    for (const char *dir : DATA_DIRS)
+    {
+        for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec))
+        {
+            if (it->is_regular_file(ec) && it->path().extension() != ".tmp")
+                files.push_back(it->path().lexically_normal().string());
+        }
+        ec.clear();
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// ============================================================
+// Backup
+// ============================================================
+BackupResult Backup::create(const std::string &destDir, const std::function<void()> &whilePaused)
+{
+    FERRY_METRIC_SCOPE("Backup::create");
+    BackupResult result;
+    std::error_code ec;
+    fs::create_directories(destDir, ec);
+    if (ec || !fs::is_empty(destDir, ec))
+    {
+        std::cerr << "Error: " << destDir << " must be a new or empty directory.\n";
+        return result;
+    }
+
+    std::vector<std::string> copied;
+    {
+        WriteGate::Pause pause;
+        if (!pause.held())
+        {
+            std::cerr << "Error: cannot lock " << WriteGate::GATE_FILE << " to pause writes.\n";
+            return result;
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        result.ok = true;
+        for (const std::string &file : dataFiles())
+        {
+            std::string to = (fs::path(destDir) / file).string();
+            fs::create_directories(fs::path(to).parent_path(), ec);
+            std::size_t size = 0;
+            bool cloned = false;
+            if (!copyFile(file, to, size, cloned))
+            {
+                std::cerr << "Error: cannot copy " << file << " to " << to << ".\n";
+                result.ok = false;
+                break;
+            }
+            if (!fs::exists(to, ec))
+                continue;
+            copied.push_back(to);
+            ++result.files;
+            result.bytes += size;
+            result.cloned += cloned ? 1 : 0;
+        }
+        if (result.ok && whilePaused)
+            whilePaused();
+        result.pausedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Durable once this returns; writers are already running again
+    for (const std::string &file : copied)
+        result.ok = syncPath(file, false) && result.ok;
+    for (const char *dir : DATA_DIRS)
+    {
+        std::string path = (fs::path(destDir) / dir).string();
+        if (fs::exists(path, ec))
+            result.ok = syncPath(path, true) && result.ok;
+    }
+    result.ok = syncPath(destDir, true) && result.ok;
+    return result;
+}
+
+} // namespace FerrySys
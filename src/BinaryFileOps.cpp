@@ -13,13 +13,19 @@
 // ---------------------------------------------------------------------------
 
 #include "BinaryFileOps.hpp"
+#include "AsyncIO.h"
+#include "Metrics.h"
 
 #include <fstream>
+#include <string>
 #include <functional>
 #include <filesystem>
-#include <filesystem>
 #include <vector>
 #include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace FerrySys
 {
@@ -39,9 +45,79 @@ namespace FerrySys
             create.close();
             fs.open(path, ios::in | ios::out | ios::binary);
         }
+        Metrics::add(Counter::FILE_OPENS);
         return fs;
     }
 
+    // Whether `h`, at the front of a `fileBytes`-byte file, describes it.
+    // A partial record at the end is let through here, since an append in
+    // progress looks the same; DataFile::open refuses a file left that way.
+    static bool headerFits(const FileHeader &h, std::uint64_t fileBytes, std::size_t recordSize)
+    {
+        return h.endianMark == FILE_ENDIAN_MARK &&
+               h.version == FILE_SCHEMA_VERSION &&
+               h.headerBytes == FILE_HEADER_BYTES &&
+               h.recordSize != 0 &&
+               (recordSize == 0 || h.recordSize == recordSize) &&
+               fileBytes >= FILE_HEADER_BYTES &&
+               h.liveRows + h.deadRows <= (fileBytes - FILE_HEADER_BYTES) / h.recordSize;
+    }
+
+    std::size_t dataOffset(int fd, std::size_t recordSize)
+    {
+        FileHeader h{};
+        ssize_t n = ::pread(fd, &h, sizeof(h), 0);
+        if (n < static_cast<ssize_t>(sizeof(FILE_MAGIC)) ||
+            std::memcmp(h.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+        {
+            return 0;
+        }
+        struct stat st{};
+        if (n != static_cast<ssize_t>(sizeof(h)) || ::fstat(fd, &st) != 0 ||
+            !headerFits(h, static_cast<std::uint64_t>(st.st_size), recordSize))
+        {
+            return BAD_HEADER;
+        }
+        return FILE_HEADER_BYTES;
+    }
+
+    std::size_t dataOffset(const std::string &path, std::size_t recordSize)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        std::size_t offset = dataOffset(fd, recordSize);
+        ::close(fd);
+        return offset;
+    }
+
+    std::size_t skipHeader(std::istream &in, std::size_t recordSize)
+    {
+        FileHeader h{};
+        std::size_t offset = 0;
+        in.read(reinterpret_cast<char*>(&h), sizeof(h));
+        std::streamsize got = in.gcount();
+        if (got >= static_cast<std::streamsize>(sizeof(FILE_MAGIC)) &&
+            std::memcmp(h.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0)
+        {
+            in.clear();
+            in.seekg(0, ios::end);
+            std::streamoff bytes = in.tellg();
+            if (got != static_cast<std::streamsize>(sizeof(h)) || bytes < 0 ||
+                !headerFits(h, static_cast<std::uint64_t>(bytes), recordSize))
+            {
+                in.setstate(ios::failbit);
+                return BAD_HEADER;
+            }
+            offset = FILE_HEADER_BYTES;
+        }
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offset), ios::beg);
+        return offset;
+    }
+
     std::size_t recordCount(fstream &fs, std::size_t recordSize)
     {
         fs.clear();
@@ -68,6 +144,7 @@ namespace FerrySys
         }
         fs.read(static_cast<char*>(outBytes),
                 static_cast<std::streamsize>(recordSize));
+        Metrics::recordRead(recordSize);
         return fs.good();
     }
 
@@ -82,6 +159,7 @@ namespace FerrySys
         }
         fs.write(static_cast<const char*>(inBytes),
                  static_cast<std::streamsize>(recordSize));
+        Metrics::add(Counter::BYTES_WRITTEN, recordSize);
         fs.flush();
         return fs.good();
     }
@@ -97,6 +175,7 @@ namespace FerrySys
         }
         fs.write(static_cast<const char*>(inBytes),
                  static_cast<std::streamsize>(recordSize));
+        Metrics::add(Counter::BYTES_WRITTEN, recordSize);
         fs.flush();
         return fs.good();
     }
@@ -161,4 +240,229 @@ namespace FerrySys
         }
         return count; // not found
     }
+
+    // fsync a file or directory; false if it cannot be opened or synced
+    static bool syncPath(const std::string &path, bool directory)
+    {
+        int fd = ::open(path.c_str(), directory ? (O_RDONLY | O_DIRECTORY) : O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    bool removeRecordsIf(const std::string &path, std::size_t recordSize,
+                         const std::function<bool(const void*)> &remove,
+                         std::size_t &removed)
+    {
+        FERRY_TRACE_SPAN("BinaryFileOps::removeRecordsIf");
+        removed = 0;
+        int in = ::open(path.c_str(), O_RDONLY);
+        if (in < 0)
+        {
+            return false;
+        }
+        Metrics::add(Counter::FILE_OPENS);
+
+        // One temp file per process, so two compactions never share one
+        const std::string tmp = path + ".compact." + std::to_string(::getpid());
+        int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0)
+        {
+            ::close(in);
+            return false;
+        }
+        Metrics::add(Counter::FILE_OPENS);
+
+        constexpr std::size_t BLOCK_RECORDS = 4096;
+        const std::size_t header = dataOffset(in, recordSize);
+        std::vector<unsigned char> block(BLOCK_RECORDS * recordSize);
+        std::vector<unsigned char> kept;
+        kept.reserve(BLOCK_RECORDS * recordSize);
+        FileHeader h{};
+        std::uint64_t keptRows = 0;
+        off_t readPos = static_cast<off_t>(header);
+        bool  ok = header != BAD_HEADER;
+
+        // Room for the header; it is written last, counting what was kept
+        if (ok && header > 0 &&
+            (::pread(in, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+             ::lseek(out, static_cast<off_t>(header), SEEK_SET) != static_cast<off_t>(header)))
+        {
+            ok = false;
+        }
+
+        while (ok)
+        {
+            ssize_t n = ::pread(in, block.data(), BLOCK_RECORDS * recordSize, readPos);
+            if (n < 0)
+            {
+                ok = false;
+                break;
+            }
+            std::size_t records = static_cast<std::size_t>(n) / recordSize;
+            if (records == 0)
+            {
+                break;
+            }
+            readPos += static_cast<off_t>(records * recordSize);
+            Metrics::add(Counter::RECORDS_SCANNED, records);
+            Metrics::add(Counter::BYTES_READ, records * recordSize);
+
+            kept.clear();
+            for (std::size_t i = 0; i < records; ++i)
+            {
+                const unsigned char *rec = block.data() + i * recordSize;
+                if (remove(rec))
+                {
+                    ++removed;
+                    continue;
+                }
+                kept.insert(kept.end(), rec, rec + recordSize);
+                ++keptRows;
+            }
+            if (!kept.empty() &&
+                ::write(out, kept.data(), kept.size()) != static_cast<ssize_t>(kept.size()))
+            {
+                ok = false;
+                break;
+            }
+            Metrics::add(Counter::BYTES_WRITTEN, kept.size());
+        }
+        ::close(in);
+
+        // Nothing dropped: leave the original file as it is
+        if (!ok || removed == 0)
+        {
+            ::close(out);
+            ::unlink(tmp.c_str());
+            return ok;
+        }
+
+        // Whatever is left counts as live until the caller says otherwise
+        if (header > 0)
+        {
+            h.liveRows = keptRows;
+            h.deadRows = 0;
+            ok = ::pwrite(out, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+        }
+
+        // The new file is durable before it replaces the old one, and the
+        // rename is durable before the caller forgets what it removed
+        ok = ::fsync(out) == 0 && ok;
+        ok = ::close(out) == 0 && ok;
+        if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        std::string dir = fs::path(path).parent_path().string();
+        return syncPath(dir.empty() ? "." : dir, true);
+    }
+
+    bool tombstoneRecordsIf(const std::string &path, std::size_t recordSize,
+                            std::size_t statusOffset,
+                            const std::function<bool(const void*)> &match,
+                            std::size_t &marked,
+                            std::vector<std::size_t> *markedSlots)
+    {
+        FERRY_TRACE_SPAN("BinaryFileOps::tombstoneRecordsIf");
+        marked = 0;
+        int fd = ::open(path.c_str(), O_RDWR);
+        if (fd < 0)
+        {
+            return false;
+        }
+        Metrics::add(Counter::FILE_OPENS);
+
+        constexpr std::size_t BLOCK_RECORDS = 4096;
+        std::vector<unsigned char> block(BLOCK_RECORDS * recordSize);
+        const unsigned char dead = REC_DEAD;
+        const std::size_t header = dataOffset(fd, recordSize);
+        const off_t base = static_cast<off_t>(header);
+        off_t readPos = base;
+        bool  ok = header != BAD_HEADER;
+
+        while (ok)
+        {
+            ssize_t n = ::pread(fd, block.data(), block.size(), readPos);
+            if (n < 0)
+            {
+                ok = false;
+                break;
+            }
+            std::size_t records = static_cast<std::size_t>(n) / recordSize;
+            if (records == 0)
+            {
+                break;
+            }
+            Metrics::add(Counter::RECORDS_SCANNED, records);
+            Metrics::add(Counter::BYTES_READ, records * recordSize);
+
+            for (std::size_t i = 0; i < records; ++i)
+            {
+                const unsigned char *rec = block.data() + i * recordSize;
+                if (rec[statusOffset] == REC_DEAD || !match(rec))
+                {
+                    continue;
+                }
+                off_t at = readPos + static_cast<off_t>(i * recordSize + statusOffset);
+                if (::pwrite(fd, &dead, 1, at) != 1)
+                {
+                    ok = false;
+                    break;
+                }
+                Metrics::add(Counter::BYTES_WRITTEN, 1);
+                ++marked;
+                if (markedSlots)
+                {
+                    markedSlots->push_back(static_cast<std::size_t>(readPos - base) / recordSize + i);
+                }
+            }
+            readPos += static_cast<off_t>(records * recordSize);
+        }
+
+        ::close(fd);
+        return ok;
+    }
+
+    bool readRecordsBatch(const std::string &path, std::size_t recordSize,
+                          const std::vector<std::size_t> &indices, void *outBytes)
+    {
+        if (indices.empty())
+        {
+            return true;
+        }
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        Metrics::add(Counter::FILE_OPENS);
+        Metrics::add(Counter::BYTES_READ, indices.size() * recordSize);
+
+        FERRY_TRACE_SPAN("BinaryFileOps::readRecordsBatch");
+        const std::uint64_t base = dataOffset(fd, recordSize);
+        if (base == BAD_HEADER)
+        {
+            ::close(fd);
+            return false;
+        }
+        std::vector<ReadRequest> requests(indices.size());
+        unsigned char *out = static_cast<unsigned char*>(outBytes);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            requests[i].offset = base + static_cast<std::uint64_t>(indices[i]) * recordSize;
+            requests[i].length = recordSize;
+            requests[i].buffer = out + i * recordSize;
+        }
+
+        bool ok = defaultBatchReader().readBatch(fd, requests);
+        ::close(fd);
+        return ok;
+    }
 } // namespace FerrySys
@@ -0,0 +1,200 @@
+//************************************************************
+//************************************************************
+//  BookingTransaction.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements booking commits: validate, take each leg's lane
+//    space, write vehicles and reservations in batches, and undo
+//    what was done if a later step fails.
+//************************************************************
+//************************************************************
+
+#include "BookingTransaction.h"
+#include "CapacityTable.h"
+#include "Metrics.h"
+#include "Reservation.h"
+#include "StorageBackend.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace FerrySys
+{
+
+namespace
+{
+    // Reservations match case-insensitively (FileIO_Reservations)
+    std::string upper(std::string_view text)
+    {
+        std::string out(text);
+        for (char &c : out)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return out;
+    }
+}
+
+BookingTransaction::BookingTransaction(const SailingID &sailingID)
+    : defaultSailing(sailingID)
+{
+}
+
+void BookingTransaction::add(const VehicleRecord &vehicle)
+{
+    add(vehicle, defaultSailing);
+}
+
+void BookingTransaction::add(const VehicleRecord &vehicle, const SailingID &sailingID)
+{
+    bookings.emplace_back(vehicle, sailingID);
+}
+
+bool BookingTransaction::fail(BookingError error, const SailingID &sailingID)
+{
+    failure = error;
+    failedAt = sailingID;
+    return false;
+}
+
+const char *BookingTransaction::describe(BookingError error)
+{
+    switch (error)
+    {
+        case BookingError::NONE:              return "booked";
+        case BookingError::EMPTY:             return "no vehicles to book";
+        case BookingError::DUPLICATE_VEHICLE: return "a vehicle is listed twice on one sailing";
+        case BookingError::UNKNOWN_SAILING:   return "sailing does not exist";
+        case BookingError::SAILING_FULL:      return "not enough lane space on the sailing";
+        case BookingError::ALREADY_BOOKED:    return "a vehicle is already reserved on this sailing";
+        case BookingError::STORAGE_FAILED:    return "the data files could not be updated";
+    }
+    return "unknown error";
+}
+
+// ============================================================
+// Commit
+// ============================================================
+bool BookingTransaction::commit()
+{
+    FERRY_METRIC_SCOPE("BookingTransaction::commit");
+    failure = BookingError::NONE;
+    failedAt = SailingID();
+    if (bookings.empty())
+        return fail(BookingError::EMPTY);
+
+    // Each license once; each (license, sailing) at most once
+    std::vector<LicensePlate> licenses;
+    std::unordered_map<std::string, std::size_t> vehicleOf;     // license -> licenses[]
+    std::unordered_set<std::string> keys;
+    for (const auto &[vehicle, sailingID] : bookings)
+    {
+        if (!keys.insert(upper(vehicle.license) + '\n' + upper(sailingID)).second)
+            return fail(BookingError::DUPLICATE_VEHICLE, sailingID);
+        if (vehicleOf.emplace(vehicle.license.str(), licenses.size()).second)
+            licenses.push_back(vehicle.license);
+    }
+
+    StorageBackend &store = StorageBackend::current();
+    WriteGate::Hold hold;
+
+    // 1. Which vehicles are on file (booked with their stored dimensions)
+    std::vector<VehicleRecord> onFile;
+    std::vector<char> found;
+    if (!store.findVehicles(licenses, onFile, found))
+        return fail(BookingError::STORAGE_FAILED);
+    std::vector<VehicleRecord> fresh;
+    for (const auto &[vehicle, sailingID] : bookings)
+    {
+        std::size_t v = vehicleOf[vehicle.license.str()];
+        if (found[v])
+            continue;
+        onFile[v] = vehicle;
+        found[v] = 1;
+        fresh.push_back(vehicle);
+    }
+
+    // 2. Each leg's lane space in one step, legs in the order first added
+    std::vector<SailingID> legs;
+    std::vector<std::vector<LaneRequest>> lanes;
+    for (const auto &[vehicle, sailingID] : bookings)
+    {
+        std::size_t leg = std::find(legs.begin(), legs.end(), sailingID) - legs.begin();
+        if (leg == legs.size())
+        {
+            legs.push_back(sailingID);
+            lanes.emplace_back();
+        }
+        const VehicleRecord &stored = onFile[vehicleOf[vehicle.license.str()]];
+        LaneRequest request;
+        request.spaceCm = CapacityTable::vehicleSpaceCm(stored.length_m);
+        request.highCeiling = Reservation::isHighCeiling(stored);
+        lanes[leg].push_back(request);
+    }
+
+    std::size_t taken = 0;
+    auto releaseSpace = [&] {
+        for (std::size_t leg = 0; leg < taken; ++leg)
+        {
+            for (const LaneRequest &lane : lanes[leg])
+                CapacityTable::release(legs[leg], lane.spaceCm, lane.lane);
+        }
+    };
+    for (; taken < legs.size(); ++taken)
+    {
+        if (!store.sailingExists(legs[taken]))
+        {
+            releaseSpace();
+            return fail(BookingError::UNKNOWN_SAILING, legs[taken]);
+        }
+        if (!CapacityTable::reserveGroup(legs[taken], lanes[taken]))
+        {
+            releaseSpace();
+            return fail(BookingError::SAILING_FULL, legs[taken]);
+        }
+    }
+
+    // 3. New vehicles, then every reservation on every leg
+    if (!store.writeVehicles(fresh))
+    {
+        releaseSpace();
+        return fail(BookingError::STORAGE_FAILED);
+    }
+    std::vector<std::pair<LicensePlate, SailingID>> rows;
+    for (const auto &[vehicle, sailingID] : bookings)
+        rows.emplace_back(vehicle.license, sailingID);
+    if (!store.writeReservations(rows))
+    {
+        for (const VehicleRecord &vehicle : fresh)
+            store.deleteVehicle(vehicle.license);
+        releaseSpace();
+        for (const auto &row : rows)
+        {
+            if (store.reservationExists(row.first, row.second))
+                return fail(BookingError::ALREADY_BOOKED, row.second);
+        }
+        return fail(BookingError::STORAGE_FAILED);
+    }
+
+    // 4. Remaining space back to sailings.dat; a booking whose space
+    //    could not be recorded is undone rather than left on file
+    for (const SailingID &leg : legs)
+    {
+        if (CapacityTable::persist(leg))
+            continue;
+        for (const auto &row : rows)
+            store.deleteReservation(row.first, row.second);
+        for (const VehicleRecord &vehicle : fresh)
+            store.deleteVehicle(vehicle.license);
+        releaseSpace();
+        return fail(BookingError::STORAGE_FAILED, leg);
+    }
+    return true;
+}
+
+} // namespace FerrySys
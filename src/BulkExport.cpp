@@ -0,0 +1,590 @@
+//************************************************************
+//************************************************************
+//  BulkExport.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the CSV / JSON export.
+//
+//    A table is a Source: the records after a data file's header,
+//    or (reservations outside the flat layout) rows collected in
+//    memory. It is cut into CHUNK_RECORDS pieces, taken a window
+//    of a few chunks per pool worker at a time:
+//      1. every chunk of the window is read with one bulk read and
+//         formatted on the scan pool into its own text buffer
+//      2. while the next window is formatted, this one's buffers
+//         are written out in order
+//    Formatting appends to the buffer directly (std::to_chars for
+//    numbers), with no streams or locale involved.
+//************************************************************
+//************************************************************
+
+#include "BulkExport.h"
+#include "BinaryFileOps.hpp"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "FileIO_Vessel.h"
+#include "Metrics.h"
+#include "ParallelScan.h"
+#include "StorageBackend.h"
+#include "VehicleRecord.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string_view>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FerrySys
+{
+
+namespace
+{
+    const char *const KIND_NAMES[] = { "vessels", "sailings", "vehicles", "reservations", "bookings" };
+    const char *const KIND_COLUMNS[] = {
+        "name,laneHCL,laneLCL",
+        "sailingID,vesselName,remainingHCL,remainingLCL",
+        "license,phone,length,height",
+        "license,sailingID,checkedIn",
+        "sailingID,vesselName,license,phone,length,height,checkedIn",
+    };
+    constexpr int KIND_COUNT = 5;
+
+    constexpr std::size_t WINDOW_PER_WORKER = 2;    // chunks formatted per worker per window
+    constexpr std::size_t BYTES_PER_RECORD = 64;    // first guess at a chunk buffer's size
+
+    std::string_view cString(const char *s, std::size_t max)
+    {
+        return std::string_view(s, strnlen(s, max));
+    }
+
+    std::string upper(std::string_view s)
+    {
+        std::string out(s);
+        std::transform(out.begin(), out.end(), out.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return out;
+    }
+
+    // ============================================================
+    // Formatting
+    // ============================================================
+
+    //------------------------------------------------------------
+    // Appends one record's fields to a chunk buffer as a CSV line
+    // or a JSON object. Each JSON object is preceded by ",\n";
+    // the writer drops the very first comma.
+    class RecordWriter
+    {
+    public:
+        RecordWriter(ExportFormat format, std::string &out) : json(format == ExportFormat::JSON), out(out) {}
+
+        void begin()
+        {
+            first = true;
+            if (json)
+                out.append(",\n{", 3);
+        }
+
+        void end()
+        {
+            out.push_back(json ? '}' : '\n');
+        }
+
+        void text(const char *key, std::string_view value)
+        {
+            field(key);
+            if (json)
+                jsonString(value);
+            else
+                csvField(value);
+        }
+
+        template <class Number>
+        void number(const char *key, Number value)
+        {
+            field(key);
+            char buf[32];
+            auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, ec == std::errc() ? ptr : buf);
+        }
+
+        void flag(const char *key, bool value)
+        {
+            field(key);
+            if (json)
+                out.append(value ? "true" : "false");
+            else
+                out.push_back(value ? '1' : '0');
+        }
+
+        // No value: an empty CSV field, JSON null
+        void none(const char *key)
+        {
+            field(key);
+            if (json)
+                out.append("null", 4);
+        }
+
+    private:
+        void field(const char *key)
+        {
+            if (!first)
+                out.push_back(',');
+            first = false;
+            if (json)
+            {
+                out.push_back('"');
+                out.append(key);
+                out.append("\":", 2);
+            }
+        }
+
+        // Quoted if BulkImport would otherwise read it differently
+        void csvField(std::string_view value)
+        {
+            bool quote = !value.empty() &&
+                         (value.front() == ' ' || value.front() == '\t' || value.front() == '#' ||
+                          value.back() == ' ' || value.back() == '\t' ||
+                          value.find_first_of(",\"\r\n") != std::string_view::npos);
+            if (!quote)
+            {
+                out.append(value);
+                return;
+            }
+            out.push_back('"');
+            for (char c : value)
+            {
+                if (c == '"')
+                    out.push_back('"');
+                out.push_back(c);
+            }
+            out.push_back('"');
+        }
+
+        void jsonString(std::string_view value)
+        {
+            static const char HEX[] = "0123456789abcdef";
+            out.push_back('"');
+            for (char c : value)
+            {
+                unsigned char u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\')
+                {
+                    out.push_back('\\');
+                    out.push_back(c);
+                }
+                else if (u < 0x20)
+                {
+                    out.append("\\u00", 4);
+                    out.push_back(HEX[u >> 4]);
+                    out.push_back(HEX[u & 0xF]);
+                }
+                else
+                    out.push_back(c);
+            }
+            out.push_back('"');
+        }
+
+        bool         json;
+        bool         first = true;
+        std::string &out;
+    };
+
+    //------------------------------------------------------------
+    // Record formatters: write the record at `bytes` unless it is
+    // deleted; return whether it was written
+    bool formatVessel(RecordWriter &w, const unsigned char *bytes)
+    {
+        Vesselrec rec;
+        std::memcpy(&rec, bytes, sizeof(rec));
+        if (rec.status == REC_DEAD)
+            return false;
+        w.begin();
+        w.text("name", cString(rec.vesselName, sizeof(rec.vesselName)));
+        w.number("laneHCL", rec.laneHCL);
+        w.number("laneLCL", rec.laneLCL);
+        w.end();
+        return true;
+    }
+
+    bool formatSailing(RecordWriter &w, const unsigned char *bytes)
+    {
+        Sailingrec rec;
+        std::memcpy(&rec, bytes, sizeof(rec));
+        if (rec.status == REC_DEAD)
+            return false;
+        w.begin();
+        w.text("sailingID", cString(rec.id, sizeof(rec.id)));
+        w.text("vesselName", cString(rec.VesselName, sizeof(rec.VesselName)));
+        w.number("remainingHCL", rec.remainingHCL);
+        w.number("remainingLCL", rec.remainingLCL);
+        w.end();
+        return true;
+    }
+
+    bool formatVehicle(RecordWriter &w, const unsigned char *bytes)
+    {
+        if (bytes[VEH_STATUS_OFFSET] == REC_DEAD)
+            return false;
+        VehicleRaw raw;
+        VehicleRecord rec;
+        std::memcpy(raw.data(), bytes, VEH_REC_BYTES);
+        decodeVehicle(raw, rec);
+        w.begin();
+        w.text("license", rec.license.view());
+        w.text("phone", rec.phone.view());
+        w.number("length", rec.length_m);
+        w.number("height", rec.height_m);
+        w.end();
+        return true;
+    }
+
+    std::string_view licenseOf(const ReservationRec &rec)
+    {
+        return fieldView(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    }
+
+    std::string_view sailingOf(const ReservationRec &rec)
+    {
+        return fieldView(reinterpret_cast<const unsigned char*>(rec.sailingID), sizeof(rec.sailingID));
+    }
+
+    bool formatReservation(RecordWriter &w, const unsigned char *bytes)
+    {
+        ReservationRec rec;
+        std::memcpy(&rec, bytes, sizeof(rec));
+        if (rec.status == REC_DEAD)
+            return false;
+        w.begin();
+        w.text("license", licenseOf(rec));
+        w.text("sailingID", sailingOf(rec));
+        w.flag("checkedIn", rec.status == RES_CHECKED_IN);
+        w.end();
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // The bookings view: sailings by upper-cased ID (reservations
+    // match them case-insensitively), vehicles by license
+    struct BookingJoin
+    {
+        std::unordered_map<std::string, Sailingrec>    sailings;
+        std::unordered_map<std::string, VehicleRecord> vehicles;
+
+        // False if vehicles.dat cannot be read in full
+        bool load()
+        {
+            for (const auto &rec : StorageBackend::current().sailings())
+                sailings.emplace(upper(cString(rec.id, sizeof(rec.id))), rec);
+
+            using Map = std::unordered_map<std::string, VehicleRecord>;
+            return parallelScan("vehicles.dat", VEH_REC_BYTES, vehicles,
+                [](Map &part, std::size_t, const unsigned char *bytes) {
+                    if (bytes[VEH_STATUS_OFFSET] == REC_DEAD)
+                        return;
+                    VehicleRaw raw;
+                    VehicleRecord rec;
+                    std::memcpy(raw.data(), bytes, VEH_REC_BYTES);
+                    decodeVehicle(raw, rec);
+                    part.emplace(rec.license.str(), rec);
+                },
+                [](Map &out, Map &&part) { out.merge(part); });
+        }
+
+        bool format(RecordWriter &w, const unsigned char *bytes) const
+        {
+            ReservationRec rec;
+            std::memcpy(&rec, bytes, sizeof(rec));
+            if (rec.status == REC_DEAD)
+                return false;
+            std::string_view license = licenseOf(rec);
+            auto sailing = sailings.find(upper(sailingOf(rec)));
+            auto vehicle = vehicles.find(std::string(license));
+
+            w.begin();
+            w.text("sailingID", sailingOf(rec));
+            if (sailing != sailings.end())
+                w.text("vesselName", cString(sailing->second.VesselName, sizeof(sailing->second.VesselName)));
+            else
+                w.none("vesselName");
+            w.text("license", license);
+            if (vehicle != vehicles.end())
+            {
+                w.text("phone", vehicle->second.phone.view());
+                w.number("length", vehicle->second.length_m);
+                w.number("height", vehicle->second.height_m);
+            }
+            else
+            {
+                w.none("phone");
+                w.none("length");
+                w.none("height");
+            }
+            w.flag("checkedIn", rec.status == RES_CHECKED_IN);
+            w.end();
+            return true;
+        }
+    };
+
+    // ============================================================
+    // Sources and output
+    // ============================================================
+
+    //------------------------------------------------------------
+    // The records of one table
+    struct Source
+    {
+        std::string                path;        // data file, or empty if in memory
+        std::size_t                recordSize = 0;
+        std::size_t                start = 0;   // offset of record 0 in the file
+        std::size_t                total = 0;
+        std::vector<unsigned char> memory;
+
+        static Source file(const std::string &path, std::size_t recordSize)
+        {
+            Source src;
+            src.path = path;
+            src.recordSize = recordSize;
+            src.start = dataOffset(path, recordSize);
+            src.total = fileRecordCount(path, recordSize);
+            return src;
+        }
+
+        //--------------------------------------------------------
+        // Records of `chunk`: read into `buf`, or pointed at in
+        // memory. nullptr if the read failed.
+        const unsigned char *fetch(const ScanChunk &chunk, std::vector<unsigned char> &buf) const
+        {
+            if (path.empty())
+                return memory.data() + chunk.first * recordSize;
+            if (!readChunk(path, recordSize, start, chunk, buf) || buf.size() != chunk.count * recordSize)
+                return nullptr;
+            return buf.data();
+        }
+    };
+
+    //------------------------------------------------------------
+    // Every reservation, from reservations.dat or (partitioned /
+    // LSM layouts) through the backend for each sailing on file
+    Source reservationSource()
+    {
+        if (StorageBackend::current().kind() == BackendKind::MMAP ||
+            FileIO_Reservations::storageMode() == ReservationStorage::FLAT)
+            return Source::file("reservations.dat", sizeof(ReservationRec));
+
+        std::vector<SailingID> ids;
+        for (const auto &rec : StorageBackend::current().sailings())
+            ids.emplace_back(cString(rec.id, sizeof(rec.id)));
+        std::vector<ReservationRec> rows;
+        StorageBackend::current().readReservationsForSailings(ids, rows);
+
+        Source src;
+        src.recordSize = sizeof(ReservationRec);
+        src.total = rows.size();
+        src.memory.resize(rows.size() * sizeof(ReservationRec));
+        if (!rows.empty())
+            std::memcpy(src.memory.data(), rows.data(), src.memory.size());
+        return src;
+    }
+
+    bool writeAll(int fd, const char *data, std::size_t size)
+    {
+        std::size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = ::write(fd, data + done, size - done);
+            if (n <= 0)
+                return false;
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    struct ChunkText
+    {
+        std::string text;
+        std::size_t rows = 0;
+        bool        ok = true;
+    };
+
+    //------------------------------------------------------------
+    // The window loop (see the file comment). formatRecord(w,
+    // bytes) returns whether it wrote the record.
+    template <class FormatFn>
+    ExportResult exportAll(const Source &src, ExportKind kind, ExportFormat format, int fd, FormatFn formatRecord)
+    {
+        ExportResult result;
+        result.ok = src.start != BAD_HEADER;
+        bool json = format == ExportFormat::JSON;
+        bool wroteRecord = false;
+
+        auto put = [&](const char *data, std::size_t size) {
+            if (size == 0)
+                return;
+            result.ok = result.ok && writeAll(fd, data, size);
+            result.bytes += size;
+        };
+
+        std::string head = json ? std::string("[") : std::string(BulkExport::columns(kind)) + "\n";
+        put(head.data(), head.size());
+
+        std::size_t chunkCount = (src.total + BulkExport::CHUNK_RECORDS - 1) / BulkExport::CHUNK_RECORDS;
+        std::size_t window = std::max<std::size_t>(1, scanPool().size() * WINDOW_PER_WORKER);
+        Metrics::add(Counter::RECORDS_SCANNED, src.total);
+        if (!src.path.empty())
+        {
+            Metrics::add(Counter::FILE_OPENS, chunkCount);
+            Metrics::add(Counter::BYTES_READ, src.total * src.recordSize);
+        }
+
+        auto formatChunk = [&](std::size_t c, ChunkText &out) {
+            FERRY_TRACE_SPAN("BulkExport::format");
+            ScanChunk chunk{ c * BulkExport::CHUNK_RECORDS,
+                             std::min(BulkExport::CHUNK_RECORDS, src.total - c * BulkExport::CHUNK_RECORDS) };
+            std::vector<unsigned char> buf;
+            const unsigned char *records = src.fetch(chunk, buf);
+            if (!records)
+            {
+                out.ok = false;
+                return;
+            }
+            out.text.reserve(chunk.count * BYTES_PER_RECORD);
+            RecordWriter w(format, out.text);
+            for (std::size_t i = 0; i < chunk.count; ++i)
+                out.rows += formatRecord(w, records + i * src.recordSize) ? 1 : 0;
+        };
+
+        auto writeWindow = [&](std::vector<ChunkText> &texts) {
+            FERRY_TRACE_SPAN("BulkExport::write");
+            for (ChunkText &t : texts)
+            {
+                result.ok = result.ok && t.ok;
+                std::size_t skip = (json && !wroteRecord && !t.text.empty()) ? 1 : 0;     // leading ','
+                put(t.text.data() + skip, t.text.size() - skip);
+                wroteRecord = wroteRecord || !t.text.empty();
+                result.rows += t.rows;
+                std::string().swap(t.text);
+            }
+        };
+
+        // Format window k + 1 on the pool while window k is written
+        std::vector<ChunkText> current, next;
+        for (std::size_t first = 0; first < chunkCount || !current.empty();)
+        {
+            std::size_t count = std::min(window, chunkCount - first);
+            next.assign(count, ChunkText{});
+            {
+                TaskGroup group(scanPool());
+                for (std::size_t c = 0; c < count; ++c)
+                    group.run([&formatChunk, &next, first, c] { formatChunk(first + c, next[c]); });
+                writeWindow(current);
+                group.wait();
+            }
+            first += count;
+            current.swap(next);
+        }
+
+        const char *tail = json ? (wroteRecord ? "\n]\n" : "]\n") : "";
+        put(tail, std::strlen(tail));
+        return result;
+    }
+}
+
+// ============================================================
+// Export
+// ============================================================
+ExportResult BulkExport::run(ExportKind kind, ExportFormat format, const std::string &outPath)
+{
+    FERRY_METRIC_SCOPE("BulkExport::run");
+    bool toStdout = outPath == "-";
+    int fd = toStdout ? STDOUT_FILENO : ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error: cannot write " << outPath << "\n";
+        return ExportResult{};
+    }
+    if (toStdout)
+        std::cout.flush();
+    else
+        Metrics::add(Counter::FILE_OPENS);
+
+    ExportResult result;
+    switch (kind)
+    {
+        case ExportKind::VESSELS:
+            result = exportAll(Source::file("vessels.dat", sizeof(Vesselrec)), kind, format, fd, formatVessel);
+            break;
+        case ExportKind::SAILINGS:
+            result = exportAll(Source::file("sailings.dat", sizeof(Sailingrec)), kind, format, fd, formatSailing);
+            break;
+        case ExportKind::VEHICLES:
+            result = exportAll(Source::file("vehicles.dat", VEH_REC_BYTES), kind, format, fd, formatVehicle);
+            break;
+        case ExportKind::RESERVATIONS:
+            result = exportAll(reservationSource(), kind, format, fd, formatReservation);
+            break;
+        case ExportKind::BOOKINGS:
+        {
+            BookingJoin join;
+            if (!join.load())
+            {
+                std::cerr << "Error: cannot read vehicles.dat\n";
+                break;
+            }
+            result = exportAll(reservationSource(), kind, format, fd,
+                               [&join](RecordWriter &w, const unsigned char *bytes) { return join.format(w, bytes); });
+            break;
+        }
+    }
+    Metrics::add(Counter::BYTES_WRITTEN, result.bytes);
+
+    if (!toStdout && ::close(fd) != 0)
+        result.ok = false;
+    return result;
+}
+
+// ============================================================
+// Names
+// ============================================================
+const char *BulkExport::kindName(ExportKind kind)
+{
+    return KIND_NAMES[static_cast<int>(kind)];
+}
+
+const char *BulkExport::columns(ExportKind kind)
+{
+    return KIND_COLUMNS[static_cast<int>(kind)];
+}
+
+bool BulkExport::parseKind(const std::string &text, ExportKind &kind)
+{
+    for (int k = 0; k < KIND_COUNT; ++k)
+    {
+        if (text == KIND_NAMES[k])
+        {
+            kind = static_cast<ExportKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BulkExport::parseFormat(const std::string &text, ExportFormat &format)
+{
+    if (text == "csv")
+        format = ExportFormat::CSV;
+    else if (text == "json")
+        format = ExportFormat::JSON;
+    else
+        return false;
+    return true;
+}
+
+} // namespace FerrySys
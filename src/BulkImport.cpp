@@ -0,0 +1,1099 @@
+//************************************************************
+//************************************************************
+//  BulkImport.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the CSV import.
+//
+//    run() maps the input and cuts it into CHUNK_BYTES pieces
+//    ending on a newline. Chunks are taken ROUND_BYTES at a
+//    time; for each round:
+//      1. every chunk is parsed on the scan pool into Rows (line
+//         number, text, record or reject reason)
+//      2. the importer for the table checks the round's rows in
+//         input order, with index lookups batched per round
+//      3. accepted records are appended in one write
+//      4. rejected rows are written to the reject file
+//    Memory is bounded by a round, not by the input.
+//************************************************************
+//************************************************************
+
+#include "BulkImport.h"
+#include "BinaryFileOps.hpp"
+#include "CapacityTable.h"
+#include "Compaction.h"
+#include "DataFile.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "FileIO_Vessel.h"
+#include "IndexSnapshot.h"
+#include "Metrics.h"
+#include "MutationLog.h"
+#include "ParallelScan.h"
+#include "Replica.h"
+#include "Reservation.h"
+#include "SailingTable.h"
+#include "VehicleRecord.hpp"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace FerrySys
+{
+
+namespace
+{
+    const char *const KIND_NAMES[] = { "vessels", "sailings", "vehicles", "reservations" };
+    const char *const KIND_COLUMNS[] = {
+        "name,laneHCL,laneLCL",
+        "sailingID,vesselName",
+        "license,phone,length,height",
+        "license,sailingID",
+    };
+
+    constexpr std::size_t  MAX_FIELDS = 4;
+    constexpr unsigned     MAX_LANE_M = 9999;       // as the vessel menu allows
+    constexpr unsigned     MAX_DIMENSION_M = 9999;
+    constexpr std::size_t  MIN_PART_KEYS = 4096;    // index lookups per pool job
+    constexpr char         KEY_SEPARATOR = '\x1f';
+
+    using Fields = std::array<std::string_view, MAX_FIELDS>;
+    using Hits = IndexSnapshot::Hits;
+
+    //------------------------------------------------------------
+    // One data line of the input
+    template <class Rec>
+    struct Row
+    {
+        std::size_t      line = 0;          // 1-based line number
+        std::string_view text;              // as read, for the reject file
+        const char      *reject = nullptr;  // reason, or nullptr if accepted
+        Rec              rec{};
+    };
+
+    template <class Rec>
+    struct ParsedChunk
+    {
+        std::vector<Row<Rec>> rows;         // line numbers within the chunk
+        std::size_t           lines = 0;
+    };
+
+    struct Span
+    {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    //------------------------------------------------------------
+    // The input file, mapped read-only
+    struct MappedInput
+    {
+        const char  *data = nullptr;
+        std::size_t  size = 0;
+
+        bool open(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+            Metrics::add(Counter::FILE_OPENS);
+            struct stat st{};
+            bool ok = ::fstat(fd, &st) == 0;
+            size = ok ? static_cast<std::size_t>(st.st_size) : 0;
+            if (ok && size > 0)
+            {
+                void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ok = map != MAP_FAILED;
+                if (ok)
+                {
+                    data = static_cast<const char*>(map);
+                    ::madvise(map, size, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+            return ok;
+        }
+
+        ~MappedInput()
+        {
+            if (data)
+                ::munmap(const_cast<char*>(data), size);
+        }
+    };
+
+    //------------------------------------------------------------
+    // Run fn(0) .. fn(n - 1) on the scan pool and wait
+    template <class Fn>
+    void parallelFor(std::size_t n, Fn fn)
+    {
+        if (n <= 1)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                fn(i);
+            return;
+        }
+        TaskGroup group(scanPool());
+        for (std::size_t i = 0; i < n; ++i)
+            group.run([&fn, i] { fn(i); });
+        group.wait();
+    }
+
+    // ============================================================
+    // Parsing
+    // ============================================================
+
+    //------------------------------------------------------------
+    // Chunks of about CHUNK_BYTES, each ending after a newline
+    std::vector<Span> splitChunks(const char *data, std::size_t size)
+    {
+        std::vector<Span> chunks;
+        std::size_t pos = 0;
+        while (pos < size)
+        {
+            std::size_t end = std::min(size, pos + BulkImport::CHUNK_BYTES);
+            if (end < size)
+            {
+                const void *nl = std::memchr(data + end, '\n', size - end);
+                end = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - data) + 1 : size;
+            }
+            chunks.push_back({ pos, end });
+            pos = end;
+        }
+        return chunks;
+    }
+
+    std::string_view trim(std::string_view s)
+    {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+            s.remove_suffix(1);
+        return s;
+    }
+
+    //------------------------------------------------------------
+    // Split a line at commas into trimmed fields; a field may be
+    // wrapped in double quotes (which are removed). Returns the
+    // field count, MAX_FIELDS + 1 if there are more, or -1 for an
+    // unbalanced quote.
+    int splitFields(std::string_view line, Fields &out)
+    {
+        int n = 0;
+        std::size_t pos = 0;
+        while (true)
+        {
+            while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'))
+                ++pos;
+            std::string_view field;
+            std::size_t end;
+            if (pos < line.size() && line[pos] == '"')
+            {
+                std::size_t close = line.find('"', pos + 1);
+                if (close == std::string_view::npos)
+                    return -1;
+                field = line.substr(pos + 1, close - pos - 1);
+                end = line.find(',', close + 1);
+                std::size_t stop = (end == std::string_view::npos) ? line.size() : end;
+                if (!trim(line.substr(close + 1, stop - close - 1)).empty())
+                    return -1;
+            }
+            else
+            {
+                end = line.find(',', pos);
+                field = trim(line.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos));
+            }
+
+            if (n == static_cast<int>(MAX_FIELDS))
+                return MAX_FIELDS + 1;
+            out[n++] = field;
+            if (end == std::string_view::npos)
+                return n;
+            pos = end + 1;
+        }
+    }
+
+    bool printable(std::string_view s)
+    {
+        return std::all_of(s.begin(), s.end(), [](unsigned char c) { return c >= 0x20 && c < 0x7F; });
+    }
+
+    bool parseUnsigned(std::string_view s, unsigned max, unsigned &out)
+    {
+        const char *end = s.data() + s.size();
+        auto [ptr, ec] = std::from_chars(s.data(), end, out);
+        return ec == std::errc() && ptr == end && !s.empty() && out <= max;
+    }
+
+    // "ttt:dd:hh", as the sailing menus take it
+    bool validSailingID(std::string_view id)
+    {
+        return id.size() == 9 && id[3] == ':' && id[6] == ':' && printable(id) &&
+               std::isdigit(static_cast<unsigned char>(id[4])) && std::isdigit(static_cast<unsigned char>(id[5])) &&
+               std::isdigit(static_cast<unsigned char>(id[7])) && std::isdigit(static_cast<unsigned char>(id[8]));
+    }
+
+    bool validName(std::string_view s, std::size_t maxChars)
+    {
+        return !s.empty() && s.size() <= maxChars && printable(s);
+    }
+
+    std::string upper(std::string_view s)
+    {
+        std::string out(s);
+        std::transform(out.begin(), out.end(), out.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return out;
+    }
+
+    //------------------------------------------------------------
+    // Fields -> record, or the reason the row is rejected
+    const char *parseRecord(const Fields &f, int n, Vesselrec &rec)
+    {
+        unsigned hcl = 0, lcl = 0;
+        if (n != 3)
+            return "expected 3 fields";
+        if (!validName(f[0], sizeof(rec.vesselName) - 1))
+            return "vessel name must be 1-24 characters";
+        if (!parseUnsigned(f[1], MAX_LANE_M, hcl) || !parseUnsigned(f[2], MAX_LANE_M, lcl))
+            return "lane lengths must be 0-9999";
+        std::memcpy(rec.vesselName, f[0].data(), f[0].size());
+        rec.status = REC_LIVE;
+        rec.laneHCL = static_cast<unsigned short>(hcl);
+        rec.laneLCL = static_cast<unsigned short>(lcl);
+        return nullptr;
+    }
+
+    const char *parseRecord(const Fields &f, int n, Sailingrec &rec)
+    {
+        if (n != 2)
+            return "expected 2 fields";
+        if (!validSailingID(f[0]))
+            return "sailing ID must be ttt:dd:hh";
+        if (!validName(f[1], sizeof(rec.VesselName) - 1))
+            return "vessel name must be 1-24 characters";
+        std::memcpy(rec.id, f[0].data(), f[0].size());
+        std::memcpy(rec.VesselName, f[1].data(), f[1].size());
+        rec.status = REC_LIVE;
+        return nullptr;
+    }
+
+    const char *parseRecord(const Fields &f, int n, VehicleRecord &rec)
+    {
+        unsigned length = 0, height = 0;
+        if (n != 4)
+            return "expected 4 fields";
+        if (!validName(f[0], VEH_LIC_CHARS))
+            return "license must be 1-10 characters";
+        if (!validName(f[1], VEH_PHONE_CHARS))
+            return "phone must be 1-14 characters";
+        if (!parseUnsigned(f[2], MAX_DIMENSION_M, length) || length == 0 ||
+            !parseUnsigned(f[3], MAX_DIMENSION_M, height) || height == 0)
+            return "length and height must be 1-9999";
+        rec.license = f[0];
+        rec.phone = f[1];
+        rec.length_m = static_cast<std::int32_t>(length);
+        rec.height_m = static_cast<std::int32_t>(height);
+        return nullptr;
+    }
+
+    // A reservation row keeps the space it took until it is written
+    struct ReservationRow
+    {
+        ReservationRec rec;
+        Lane           lane;
+        std::int32_t   spaceCm;
+    };
+
+    const char *parseRecord(const Fields &f, int n, ReservationRow &row)
+    {
+        if (n != 2)
+            return "expected 2 fields";
+        if (!validName(f[0], VEH_LIC_CHARS))
+            return "license must be 1-10 characters";
+        if (!validSailingID(f[1]))
+            return "sailing ID must be ttt:dd:hh";
+        encodeField(f[0], reinterpret_cast<unsigned char*>(row.rec.licenseplate), VEH_LIC_CHARS);
+        encodeField(f[1], reinterpret_cast<unsigned char*>(row.rec.sailingID), sizeof(row.rec.sailingID));
+        row.rec.status = RES_BOOKED;
+        row.lane = Lane::NONE;
+        return nullptr;
+    }
+
+    //------------------------------------------------------------
+    // Parse one chunk. Blank lines, '#' lines and (at the start of
+    // the file) a line naming the columns are not rows.
+    template <class Rec>
+    void parseChunk(std::string_view chunk, bool fileStart, std::string_view firstColumn, ParsedChunk<Rec> &out)
+    {
+        std::size_t pos = 0;
+        while (pos < chunk.size())
+        {
+            std::size_t nl = chunk.find('\n', pos);
+            std::size_t end = (nl == std::string_view::npos) ? chunk.size() : nl;
+            std::string_view line = chunk.substr(pos, end - pos);
+            pos = end + 1;
+            ++out.lines;
+
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            std::string_view content = trim(line);
+            if (content.empty() || content.front() == '#')
+                continue;
+
+            Fields fields;
+            int n = splitFields(line, fields);
+            if (fileStart && out.lines == 1 && n > 0 && upper(fields[0]) == upper(firstColumn))
+                continue;
+
+            Row<Rec> row;
+            row.line = out.lines;
+            row.text = line;
+            row.reject = (n < 0) ? "unbalanced quote" : parseRecord(fields, n, row.rec);
+            out.rows.push_back(row);
+        }
+    }
+
+    // ============================================================
+    // Batch checks against the data files
+    // ============================================================
+
+    //------------------------------------------------------------
+    // Candidate slots for every key from an IndexSnapshot batch
+    // lookup, split across the pool. False if the index is
+    // unavailable.
+    template <class Key, class Find>
+    bool indexHits(const std::vector<Key> &keys, Find find, Hits &hits)
+    {
+        std::size_t parts = std::min(scanPool().size(), keys.size() / MIN_PART_KEYS + 1);
+        std::vector<Hits> partHits(parts);
+        std::vector<char> ok(parts, 0);
+        parallelFor(parts, [&](std::size_t p) {
+            std::size_t begin = keys.size() * p / parts;
+            std::size_t end = keys.size() * (p + 1) / parts;
+            std::vector<Key> slice(keys.begin() + begin, keys.begin() + end);
+            ok[p] = find(slice, partHits[p]);
+            for (auto &hit : partHits[p])
+                hit.first += begin;
+        });
+        for (std::size_t p = 0; p < parts; ++p)
+        {
+            if (!ok[p])
+                return false;
+            hits.insert(hits.end(), partHits[p].begin(), partHits[p].end());
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Without the index: one scan of `path`, pairing each record
+    // whose key (recordKey) is among `keys` with their positions.
+    // False if the file cannot be read in full.
+    template <class RecordKey>
+    bool scanHits(const char *path, std::size_t recordSize,
+                  const std::vector<std::string> &keys, RecordKey recordKey, Hits &hits)
+    {
+        std::unordered_map<std::string, std::vector<std::size_t>> wanted;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            wanted[keys[i]].push_back(i);
+
+        hits.clear();
+        return parallelScan(path, recordSize, hits,
+            [&](Hits &part, std::size_t slot, const unsigned char *bytes) {
+                auto it = wanted.find(recordKey(bytes));
+                if (it == wanted.end())
+                    return;
+                for (std::size_t pos : it->second)
+                    part.emplace_back(pos, slot);
+            },
+            [](Hits &out, Hits &&part) { out.insert(out.end(), part.begin(), part.end()); });
+    }
+
+    //------------------------------------------------------------
+    // Read every hit's record in one batch and pass it to
+    // check(position, bytes)
+    template <class Check>
+    bool checkHits(const char *path, std::size_t recordSize, const Hits &hits, Check check)
+    {
+        std::vector<std::size_t> slots;
+        slots.reserve(hits.size());
+        for (const auto &hit : hits)
+            slots.push_back(hit.second);
+        std::vector<unsigned char> bytes(slots.size() * recordSize);
+        if (!readRecordsBatch(path, recordSize, slots, bytes.data()))
+            return false;
+        for (std::size_t i = 0; i < hits.size(); ++i)
+            check(hits[i].first, bytes.data() + i * recordSize);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // The live vehicle with each license (exact match). False if
+    // vehicles.dat cannot be read.
+    bool lookupVehicles(const std::vector<std::string_view> &licenses,
+                        std::vector<VehicleRecord> &vehicles, std::vector<char> &found)
+    {
+        vehicles.assign(licenses.size(), VehicleRecord{});
+        found.assign(licenses.size(), 0);
+        if (licenses.empty())
+            return true;
+
+        Hits hits;
+        if (!indexHits(licenses, IndexSnapshot::findVehicles, hits))
+        {
+            std::vector<std::string> keys(licenses.begin(), licenses.end());
+            auto recordKey = [](const unsigned char *bytes) { return decodeField(bytes, VEH_LIC_CHARS); };
+            if (!scanHits("vehicles.dat", VEH_REC_BYTES, keys, recordKey, hits))
+                return false;
+        }
+        return checkHits("vehicles.dat", VEH_REC_BYTES, hits, [&](std::size_t i, const unsigned char *bytes) {
+            if (bytes[VEH_STATUS_OFFSET] == REC_DEAD || fieldView(bytes, VEH_LIC_CHARS) != licenses[i])
+                return;
+            VehicleRaw raw;
+            std::memcpy(raw.data(), bytes, VEH_REC_BYTES);
+            decodeVehicle(raw, vehicles[i]);
+            found[i] = 1;
+        });
+    }
+
+    std::string reservationKey(std::string_view licensePlate, std::string_view sailingID)
+    {
+        return upper(licensePlate) + KEY_SEPARATOR + upper(sailingID);
+    }
+
+    //------------------------------------------------------------
+    // Whether each (license, sailing) is already booked in the
+    // flat reservations.dat (case-insensitive, as it matches).
+    // False if the file cannot be read.
+    bool lookupReservations(const std::vector<std::pair<std::string_view, std::string_view>> &keys,
+                            std::vector<char> &booked)
+    {
+        booked.assign(keys.size(), 0);
+        if (keys.empty())
+            return true;
+
+        auto keyOf = [](const ReservationRec &rec) {
+            return reservationKey(fieldView(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS),
+                                  fieldView(reinterpret_cast<const unsigned char*>(rec.sailingID), sizeof(rec.sailingID)));
+        };
+
+        Hits hits;
+        if (!indexHits(keys, IndexSnapshot::findReservations, hits))
+        {
+            std::vector<std::string> wanted;
+            for (const auto &key : keys)
+                wanted.push_back(reservationKey(key.first, key.second));
+            auto recordKey = [&](const unsigned char *bytes) {
+                return keyOf(*reinterpret_cast<const ReservationRec*>(bytes));
+            };
+            if (!scanHits("reservations.dat", sizeof(ReservationRec), wanted, recordKey, hits))
+                return false;
+        }
+        return checkHits("reservations.dat", sizeof(ReservationRec), hits, [&](std::size_t i, const unsigned char *bytes) {
+            ReservationRec rec;
+            std::memcpy(&rec, bytes, sizeof(rec));
+            if (rec.status != REC_DEAD && keyOf(rec) == reservationKey(keys[i].first, keys[i].second))
+                booked[i] = 1;
+        });
+    }
+
+    //------------------------------------------------------------
+    // Append `count` records (`bytes`) to `table`'s file, all or
+    // none: a write that fails part way is cut off again, so no
+    // torn record is left, and the header only counts records
+    // once they are all in. The cut is skipped (and reported) if
+    // another process appended after us, since the tail is then
+    // no longer ours alone.
+    bool appendRecords(Table table, const std::vector<unsigned char> &bytes, std::size_t count)
+    {
+        if (count == 0)
+            return true;
+        FERRY_TRACE_SPAN("BulkImport::append");
+        const char *file = Compactor::layout(table).file;
+        if (!DataFile::open(table, true))
+            return false;
+        int fd = ::open(file, O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        Metrics::add(Counter::FILE_OPENS);
+        struct stat before{};
+        if (::fstat(fd, &before) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        std::size_t done = 0;
+        while (done < bytes.size())
+        {
+            ssize_t n = ::write(fd, bytes.data() + done, bytes.size() - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<std::size_t>(n);
+        }
+        Metrics::add(Counter::BYTES_WRITTEN, done);
+        bool ok = done == bytes.size();
+        if (!ok && done > 0)
+        {
+            struct stat after{};
+            if (::fstat(fd, &after) != 0 || after.st_size != before.st_size + static_cast<off_t>(done) ||
+                ::ftruncate(fd, before.st_size) != 0)
+                std::cerr << "Error: cannot cut a partial write off " << file << ".\n";
+        }
+        ::close(fd);
+        if (ok)
+            DataFile::noteAppended(table, count);
+        return ok;
+    }
+
+    //------------------------------------------------------------
+    // A round whose append failed: none of its accepted rows went
+    // in, so they are rejected and not counted
+    template <class Rec>
+    void appendFailed(std::vector<Row<Rec>> &rows, std::size_t &written)
+    {
+        for (auto &row : rows)
+        {
+            if (!row.reject)
+                row.reject = "not written (file error)";
+        }
+        written = 0;
+    }
+
+    //------------------------------------------------------------
+    // A round whose rows could not be checked against the files:
+    // none of them is written. Returns false for check() to pass on.
+    template <class Rec>
+    bool checkFailed(std::vector<Row<Rec>> &rows)
+    {
+        for (auto &row : rows)
+        {
+            if (!row.reject)
+                row.reject = "not checked (file error)";
+        }
+        return false;
+    }
+
+    template <class Rec>
+    std::string_view sailingOf(const Rec &rec)
+    {
+        return std::string_view(rec.id, strnlen(rec.id, sizeof(rec.id)));
+    }
+
+    //------------------------------------------------------------
+    // False, with a message, if a written row's log record was lost
+    bool logged(bool ok)
+    {
+        if (!ok)
+            std::cerr << "Error: imported rows were saved but not written to "
+                      << MutationLog::LOG_FILE << "; seed the replicas again.\n";
+        return ok;
+    }
+
+    //------------------------------------------------------------
+    // Appended rows skip the storage engine, so they are logged
+    // for replicas here: one record per row written, from `make`
+    // (inside the round's MutationLog::Writer)
+    template <class Rec, class Make>
+    bool logRows(const std::vector<Row<Rec>> &rows, Make make)
+    {
+        bool ok = true;
+        for (const auto &row : rows)
+        {
+            if (!row.reject)
+                ok &= MutationLog::append(make(row.rec));
+        }
+        return logged(ok);
+    }
+
+    //------------------------------------------------------------
+    // Live names (vessels) or IDs (sailings) on file. False if the
+    // file cannot be read in full.
+    template <class Rec>
+    bool loadByName(const char *path, std::unordered_map<std::string, Rec> &names)
+    {
+        using Map = std::unordered_map<std::string, Rec>;
+        names.clear();
+        return parallelScan(path, sizeof(Rec), names,
+            [](Map &part, std::size_t, const unsigned char *bytes) {
+                Rec rec;
+                std::memcpy(&rec, bytes, sizeof(rec));
+                if (rec.status == REC_DEAD)
+                    return;
+                std::string_view name;
+                if constexpr (std::is_same_v<Rec, Vesselrec>)
+                    name = std::string_view(rec.vesselName, strnlen(rec.vesselName, sizeof(rec.vesselName)));
+                else
+                    name = sailingOf(rec);
+                part.emplace(std::string(name), rec);
+            },
+            [](Map &out, Map &&part) { out.merge(part); });
+    }
+
+    // ============================================================
+    // Importers: check(rows) sets reject reasons (every row's, and
+    // returns false, if the files cannot be read), write(rows)
+    // stores the rest and returns how many were written
+    // ============================================================
+    struct VesselImport
+    {
+        using Rec = Vesselrec;
+        std::unordered_map<std::string, Vesselrec> names;
+        bool loaded = loadByName("vessels.dat", names);
+
+        bool check(std::vector<Row<Rec>> &rows)
+        {
+            if (!loaded)
+                return checkFailed(rows);
+            for (auto &row : rows)
+            {
+                std::string name(row.rec.vesselName, strnlen(row.rec.vesselName, sizeof(row.rec.vesselName)));
+                if (!row.reject && !names.emplace(name, row.rec).second)
+                    row.reject = "vessel already exists";
+            }
+            return true;
+        }
+
+        bool write(std::vector<Row<Rec>> &rows, std::size_t &written)
+        {
+            std::vector<unsigned char> bytes;
+            for (const auto &row : rows)
+            {
+                if (row.reject)
+                    continue;
+                const auto *p = reinterpret_cast<const unsigned char*>(&row.rec);
+                bytes.insert(bytes.end(), p, p + sizeof(row.rec));
+                ++written;
+            }
+            if (!appendRecords(Table::VESSELS, bytes, written))
+            {
+                appendFailed(rows, written);
+                return false;
+            }
+            bool ok = logRows(rows, [](const Rec &rec) {
+                MutationRec m = MutationLog::make(MutationOp::VESSEL_WRITE);
+                MutationLog::setField(m.vesselName, std::string(rec.vesselName, strnlen(rec.vesselName, sizeof(rec.vesselName))));
+                m.arg0 = rec.laneHCL;
+                m.arg1 = rec.laneLCL;
+                return m;
+            });
+            return ok;
+        }
+
+        void finish() {}
+    };
+
+    struct SailingImport
+    {
+        using Rec = Sailingrec;
+        std::unordered_map<std::string, Vesselrec>  vessels;
+        std::unordered_map<std::string, Sailingrec> ids;
+        bool loaded = loadByName("vessels.dat", vessels) && loadByName("sailings.dat", ids);
+
+        bool check(std::vector<Row<Rec>> &rows)
+        {
+            if (!loaded)
+                return checkFailed(rows);
+            for (auto &row : rows)
+            {
+                if (row.reject)
+                    continue;
+                auto vessel = vessels.find(std::string(row.rec.VesselName, strnlen(row.rec.VesselName, sizeof(row.rec.VesselName))));
+                if (vessel == vessels.end())
+                {
+                    row.reject = "unknown vessel";
+                    continue;
+                }
+                row.rec.remainingHCL = vessel->second.laneHCL;
+                row.rec.remainingLCL = vessel->second.laneLCL;
+                if (!ids.emplace(std::string(sailingOf(row.rec)), row.rec).second)
+                    row.reject = "sailing already exists";
+            }
+            return true;
+        }
+
+        bool write(std::vector<Row<Rec>> &rows, std::size_t &written)
+        {
+            std::vector<unsigned char> bytes;
+            for (const auto &row : rows)
+            {
+                if (row.reject)
+                    continue;
+                const auto *p = reinterpret_cast<const unsigned char*>(&row.rec);
+                bytes.insert(bytes.end(), p, p + sizeof(row.rec));
+                ++written;
+            }
+            bool appended = appendRecords(Table::SAILINGS, bytes, written);
+            SailingTable::forget();
+            if (!appended)
+            {
+                appendFailed(rows, written);
+                return false;
+            }
+            bool ok = logRows(rows, [](const Rec &rec) {
+                MutationRec m = MutationLog::make(MutationOp::SAILING_WRITE);
+                MutationLog::setField(m.sailingID, std::string(sailingOf(rec)));
+                MutationLog::setField(m.vesselName, std::string(rec.VesselName, strnlen(rec.VesselName, sizeof(rec.VesselName))));
+                m.hcl = rec.remainingHCL;
+                m.lcl = rec.remainingLCL;
+                return m;
+            });
+            for (const auto &row : rows)
+            {
+                if (!row.reject)
+                    CapacityTable::add(SailingID(sailingOf(row.rec)), row.rec.remainingHCL, row.rec.remainingLCL,
+                                       row.rec.remainingHCL, row.rec.remainingLCL);
+            }
+            return ok;
+        }
+
+        void finish() {}
+    };
+
+    struct VehicleImport
+    {
+        using Rec = VehicleRecord;
+        std::unordered_set<std::string> seen;       // licenses accepted so far
+
+        bool check(std::vector<Row<Rec>> &rows)
+        {
+            std::vector<std::string_view> licenses;
+            for (const auto &row : rows)
+                licenses.push_back(row.rec.license.view());
+            std::vector<VehicleRecord> vehicles;
+            std::vector<char> found;
+            if (!lookupVehicles(licenses, vehicles, found))
+                return checkFailed(rows);
+
+            for (std::size_t i = 0; i < rows.size(); ++i)
+            {
+                if (rows[i].reject)
+                    continue;
+                if (found[i])
+                    rows[i].reject = "vehicle already exists";
+                else if (!seen.insert(rows[i].rec.license.str()).second)
+                    rows[i].reject = "duplicate in input";
+            }
+            return true;
+        }
+
+        bool write(std::vector<Row<Rec>> &rows, std::size_t &written)
+        {
+            std::vector<unsigned char> bytes;
+            VehicleRaw raw{};
+            for (const auto &row : rows)
+            {
+                if (row.reject)
+                    continue;
+                encodeVehicle(row.rec, raw);
+                bytes.insert(bytes.end(), raw.begin(), raw.end());
+                ++written;
+            }
+            if (!appendRecords(Table::VEHICLES, bytes, written))
+            {
+                appendFailed(rows, written);
+                return false;
+            }
+            bool ok = logRows(rows, [](const Rec &rec) {
+                MutationRec m = MutationLog::make(MutationOp::VEHICLE_WRITE);
+                MutationLog::setField(m.license, rec.license);
+                MutationLog::setField(m.phone, rec.phone);
+                m.arg0 = rec.length_m;
+                m.arg1 = rec.height_m;
+                return m;
+            });
+            return ok;
+        }
+
+        void finish() {}
+    };
+
+    struct ReservationImport
+    {
+        using Rec = ReservationRow;
+        std::unordered_map<std::string, Sailingrec> sailings;
+        bool loaded = loadByName("sailings.dat", sailings);
+        bool flat = FileIO_Reservations::storageMode() == ReservationStorage::FLAT;
+        std::unordered_set<std::string> seen;       // keys accepted so far
+        std::unordered_set<std::string> touched;    // sailings whose space changed
+
+        static std::string_view license(const Rec &row)
+        {
+            return fieldView(reinterpret_cast<const unsigned char*>(row.rec.licenseplate), VEH_LIC_CHARS);
+        }
+
+        static std::string_view sailing(const Rec &row)
+        {
+            return fieldView(reinterpret_cast<const unsigned char*>(row.rec.sailingID), sizeof(row.rec.sailingID));
+        }
+
+        static MutationRec logged(const Rec &row)
+        {
+            MutationRec m = MutationLog::make(MutationOp::RESERVATION_WRITE);
+            MutationLog::setField(m.license, std::string(license(row)));
+            MutationLog::setField(m.sailingID, std::string(sailing(row)));
+            return m;
+        }
+
+        bool check(std::vector<Row<Rec>> &rows)
+        {
+            if (!loaded)
+                return checkFailed(rows);
+            std::vector<std::string_view> licenses;
+            std::vector<std::pair<std::string_view, std::string_view>> keys;
+            for (const auto &row : rows)
+            {
+                licenses.push_back(license(row.rec));
+                keys.emplace_back(license(row.rec), sailing(row.rec));
+            }
+            std::vector<VehicleRecord> vehicles;
+            std::vector<char> found, booked;
+            if (!lookupVehicles(licenses, vehicles, found))
+                return checkFailed(rows);
+            if (flat && !lookupReservations(keys, booked))
+                return checkFailed(rows);
+            if (!flat)
+                booked.assign(rows.size(), 0);      // writeReservation refuses duplicates
+
+            // In input order, so capacity goes to the earliest rows; each
+            // sailing's space is written back once, by finish()
+            for (std::size_t i = 0; i < rows.size(); ++i)
+            {
+                Row<Rec> &row = rows[i];
+                if (row.reject)
+                    continue;
+                std::string sid(sailing(row.rec));
+                if (!found[i])
+                    row.reject = "unknown vehicle";
+                else if (sailings.find(sid) == sailings.end())
+                    row.reject = "unknown sailing";
+                else if (booked[i])
+                    row.reject = "already booked";
+                else if (seen.count(reservationKey(keys[i].first, keys[i].second)))
+                    row.reject = "duplicate in input";
+                else
+                {
+                    row.rec.spaceCm = CapacityTable::vehicleSpaceCm(vehicles[i].length_m);
+                    if (!CapacityTable::reserve(SailingID(sid), row.rec.spaceCm,
+                                                Reservation::isHighCeiling(vehicles[i]), row.rec.lane))
+                    {
+                        row.reject = "sailing full";
+                        continue;
+                    }
+                    seen.insert(reservationKey(keys[i].first, keys[i].second));
+                    touched.insert(sid);
+                }
+            }
+            return true;
+        }
+
+        bool write(std::vector<Row<Rec>> &rows, std::size_t &written)
+        {
+            if (flat)
+            {
+                std::vector<unsigned char> bytes;
+                for (const auto &row : rows)
+                {
+                    if (row.reject)
+                        continue;
+                    const auto *p = reinterpret_cast<const unsigned char*>(&row.rec.rec);
+                    bytes.insert(bytes.end(), p, p + sizeof(row.rec.rec));
+                    ++written;
+                }
+                if (!appendRecords(Table::RESERVATIONS, bytes, written))
+                {
+                    // Give back the space check() took for this round
+                    for (const auto &row : rows)
+                    {
+                        if (!row.reject)
+                            CapacityTable::release(SailingID(sailing(row.rec)), row.rec.spaceCm, row.rec.lane);
+                    }
+                    appendFailed(rows, written);
+                    return false;
+                }
+                return logRows(rows, [](const Rec &row) { return logged(row); });
+            }
+
+            // Partitioned / LSM layouts keep their own files
+            bool ok = true;
+            for (auto &row : rows)
+            {
+                if (row.reject)
+                    continue;
+                if (FileIO_Reservations::writeReservation(std::string(license(row.rec)),
+                                                          SailingID(sailing(row.rec))))
+                {
+                    ok &= MutationLog::append(logged(row.rec));
+                    ++written;
+                    continue;
+                }
+                CapacityTable::release(SailingID(sailing(row.rec)), row.rec.spaceCm, row.rec.lane);
+                row.reject = "already booked";
+            }
+            return FerrySys::logged(ok);
+        }
+
+        void finish()
+        {
+            for (const auto &sid : touched)
+                CapacityTable::persist(SailingID(sid));
+        }
+    };
+
+    //------------------------------------------------------------
+    // The round loop (see the file comment)
+    template <class Importer>
+    ImportResult importAll(ImportKind kind, const MappedInput &input, std::ostream &rejects)
+    {
+        using Rec = typename Importer::Rec;
+        ImportResult result;
+        result.ok = true;
+
+        Importer importer;
+        std::string_view text(input.data ? input.data : "", input.size);
+        std::string_view columns = BulkImport::columns(kind);
+        std::string_view firstColumn = columns.substr(0, columns.find(','));
+        std::vector<Span> chunks = splitChunks(text.data(), text.size());
+        std::size_t lineBase = 0;
+
+        for (std::size_t first = 0; first < chunks.size();)
+        {
+            std::size_t last = first + 1;
+            while (last < chunks.size() && chunks[last].end - chunks[first].begin <= BulkImport::ROUND_BYTES)
+                ++last;
+
+            std::vector<ParsedChunk<Rec>> parsed(last - first);
+            {
+                FERRY_TRACE_SPAN("BulkImport::parse");
+                parallelFor(parsed.size(), [&](std::size_t c) {
+                    const Span &span = chunks[first + c];
+                    parseChunk(text.substr(span.begin, span.end - span.begin), first + c == 0, firstColumn, parsed[c]);
+                });
+            }
+
+            std::vector<Row<Rec>> rows;
+            for (auto &chunk : parsed)
+            {
+                for (auto &row : chunk.rows)
+                {
+                    row.line += lineBase;
+                    rows.push_back(row);
+                }
+                lineBase += chunk.lines;
+            }
+            parsed.clear();
+
+            {
+                FERRY_TRACE_SPAN("BulkImport::check");
+                result.ok &= importer.check(rows);
+            }
+            std::size_t written = 0;
+            {
+                WriteGate::Hold hold;
+                MutationLog::Writer writer;
+                result.ok &= importer.write(rows, written);
+            }
+            result.rows += rows.size();
+            result.imported += written;
+
+            for (const auto &row : rows)
+            {
+                if (!row.reject)
+                    continue;
+                rejects << row.line << ',' << row.reject << ',' << row.text << '\n';
+                ++result.rejected;
+            }
+            first = last;
+        }
+
+        {
+            WriteGate::Hold hold;
+            importer.finish();
+        }
+        result.ok = result.ok && static_cast<bool>(rejects.flush());
+        return result;
+    }
+}
+
+// ============================================================
+// Import
+// ============================================================
+ImportResult BulkImport::run(ImportKind kind, const std::string &csvPath, const std::string &rejectPath)
+{
+    FERRY_METRIC_SCOPE("BulkImport::run");
+    if (Replica::isFollower())
+    {
+        std::cerr << "Error: this directory is a read-only replica.\n";
+        return ImportResult{};
+    }
+    MappedInput input;
+    if (!input.open(csvPath))
+    {
+        std::cerr << "Error: cannot read " << csvPath << "\n";
+        return ImportResult{};
+    }
+    Metrics::add(Counter::BYTES_READ, input.size);
+
+    std::ofstream rejects(rejectPath, std::ios::trunc);
+    Metrics::add(Counter::FILE_OPENS);
+    if (!rejects)
+    {
+        std::cerr << "Error: cannot write " << rejectPath << "\n";
+        return ImportResult{};
+    }
+
+    switch (kind)
+    {
+        case ImportKind::VESSELS:      return importAll<VesselImport>(kind, input, rejects);
+        case ImportKind::SAILINGS:     return importAll<SailingImport>(kind, input, rejects);
+        case ImportKind::VEHICLES:     return importAll<VehicleImport>(kind, input, rejects);
+        case ImportKind::RESERVATIONS: return importAll<ReservationImport>(kind, input, rejects);
+    }
+    return ImportResult{};
+}
+
+// ============================================================
+// Names
+// ============================================================
+const char *BulkImport::kindName(ImportKind kind)
+{
+    return KIND_NAMES[static_cast<int>(kind)];
+}
+
+const char *BulkImport::columns(ImportKind kind)
+{
+    return KIND_COLUMNS[static_cast<int>(kind)];
+}
+
+bool BulkImport::parseKind(const std::string &text, ImportKind &kind)
+{
+    for (int k = 0; k < 4; ++k)
+    {
+        if (text == KIND_NAMES[k])
+        {
+            kind = static_cast<ImportKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace FerrySys
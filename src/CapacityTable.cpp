@@ -0,0 +1,864 @@
+//************************************************************
+//************************************************************
+//  CapacityTable.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the lock-free per-sailing capacity table.
+//
+//    Slots live in open-addressed arrays ("levels") in
+//    sailings.space: a 4 KB header, then each level in turn, every
+//    level mapped shared on its own. A slot is claimed once
+//    (EMPTY -> LIVE) under the file's flock() and its key never
+//    moves afterwards, so readers in any process can probe without
+//    locking. Deleted sailings become DEAD and keep their key so
+//    probe chains stay intact; re-adding the same ID revives the
+//    slot. When every level is 3/4 full a new one twice the size
+//    is appended to the file; lookups probe the levels in order.
+//
+//    Every reserve/release bumps the slot's `changes`; a
+//    write-back copies the counters to sailings.dat and records
+//    the `changes` it covered in `written`. Write-backs of one
+//    slot are serialized by an OFD lock on the slot's first byte,
+//    taken without waiting through a descriptor of the calling
+//    thread's own, so it excludes other threads as well as other
+//    processes and is dropped if its holder dies. A writer that
+//    finds the lock taken leaves; the holder re-reads `changes`
+//    after unlocking and writes again if it moved.
+//
+//    The header also counts changes to sailings.dat, bumped after
+//    each one, which is how SailingTable in every process knows
+//    its columns are current without a system call.
+//************************************************************
+//************************************************************
+
+#include "CapacityTable.h"
+#include "Metrics.h"
+#include "StorageBackend.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+namespace
+{
+    enum SlotState : std::uint32_t { EMPTY = 0, LIVE, DEAD };
+    enum Backing : std::uint32_t { UNKNOWN = 0, ON_FILE, TABLE_ONLY };
+
+    constexpr const char   *SPACE_FILE = "sailings.space";
+    constexpr char          SPACE_MAGIC[8] = { 'F', 'E', 'R', 'R', 'Y', 'S', 'P', 'C' };
+    constexpr std::uint32_t SPACE_VERSION = 1;
+    constexpr std::size_t   HEADER_BYTES = 4096;
+
+    static_assert((CapacityTable::INITIAL_SLOTS & (CapacityTable::INITIAL_SLOTS - 1)) == 0,
+                  "table size must be a power of two");
+    constexpr int GROUP_ATTEMPTS = 8;   // reserveGroup splits before giving up
+    constexpr int MAX_LEVELS = 20;      // INITIAL_SLOTS << 19 slots in the last
+
+    // One sailing, as every process sees it. Zero bytes are a
+    // valid EMPTY slot, so new levels need no initialization.
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint32_t> state;
+        std::atomic<std::uint32_t> backing;
+        char                       id[16];
+        std::atomic<std::int32_t>  hclCm;
+        std::atomic<std::int32_t>  lclCm;
+        std::int32_t               hclCapCm;    // 0 = unbounded
+        std::int32_t               lclCapCm;
+        std::atomic<std::uint64_t> changes;     // bumped by every reserve/release
+        std::atomic<std::uint64_t> written;     // `changes` the last write-back covered
+        std::atomic<std::int32_t>  hclFileCm;   // space on file at the last write-back
+        std::atomic<std::int32_t>  lclFileCm;
+    };
+    static_assert(sizeof(Slot) == 64, "one slot per cache line");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::int32_t>::is_always_lock_free,
+                  "counters shared between processes must be lock-free");
+
+    // Page 0 of sailings.space
+    struct Header
+    {
+        char                       magic[8];
+        std::uint32_t              version;
+        std::uint32_t              slotBytes;
+        std::atomic<std::uint32_t> levels;              // levels in the file
+        std::uint32_t              reserved;
+        std::atomic<std::uint64_t> used[MAX_LEVELS];    // slots claimed per level
+        std::atomic<std::uint64_t> sailingsChanges;     // see sailingsVersion()
+        std::atomic<std::uint64_t> replicationChanges;  // see replicationVersion()
+    };
+    static_assert(sizeof(Header) <= HEADER_BYTES, "header fits its page");
+
+    std::size_t levelSlots(int l)
+    {
+        return CapacityTable::INITIAL_SLOTS << l;
+    }
+
+    off_t levelOffset(int l)
+    {
+        std::size_t before = CapacityTable::INITIAL_SLOTS * ((std::size_t{ 1 } << l) - 1);
+        return static_cast<off_t>(HEADER_BYTES + before * sizeof(Slot));
+    }
+
+    //------------------------------------------------------------
+    // This process's mapping. attach() fills it under writerLock;
+    // levels appended by any process are mapped on first sight
+    // under mapLock, and stay mapped until clear().
+    int                        spaceFd = -1;        // sailings.space, or a memfd
+    Header                    *header = nullptr;
+    std::atomic<Slot*>         levels[MAX_LEVELS] = {};
+    std::atomic<int>           levelCount{ 0 };     // levels mapped here
+    std::atomic<bool>          attached{ false };
+    bool                       onFile = false;      // sailings.space, not a memfd
+    std::atomic<std::uint64_t> attachSerial{ 0 };   // bumped per attach
+    bool                       fullReported = false;    // writer lock
+    bool                       openReported = false;
+
+    std::mutex writerLock;      // attach/clear, add/remove
+    std::mutex mapLock;         // mapping levels
+
+    bool lockFile(int fd, int op)
+    {
+        int rc;
+        do
+            rc = ::flock(fd, op);
+        while (rc != 0 && errno == EINTR);
+        return rc == 0;
+    }
+
+    //------------------------------------------------------------
+    // Map the levels the file has and this process has not yet
+    int mappedLevels()
+    {
+        int have = levelCount.load(std::memory_order_acquire);
+        int inFile = static_cast<int>(header->levels.load(std::memory_order_acquire));
+        if (have >= inFile)
+            return have;
+
+        std::lock_guard<std::mutex> guard(mapLock);
+        have = levelCount.load(std::memory_order_relaxed);
+        for (; have < inFile; ++have)
+        {
+            void *map = ::mmap(nullptr, levelSlots(have) * sizeof(Slot), PROT_READ | PROT_WRITE, MAP_SHARED,
+                               spaceFd, levelOffset(have));
+            if (map == MAP_FAILED)
+                break;
+            levels[have].store(static_cast<Slot*>(map), std::memory_order_release);
+            levelCount.store(have + 1, std::memory_order_release);
+        }
+        return have;
+    }
+
+    //------------------------------------------------------------
+    // Map the table in the current directory (a memfd for the
+    // MEMORY engine), creating its header if the file is new.
+    // False, reported once on stderr, if it cannot be opened or
+    // is not a space file.
+    bool attach()
+    {
+        if (attached.load(std::memory_order_acquire))
+            return true;
+        std::lock_guard<std::mutex> guard(writerLock);
+        if (attached.load(std::memory_order_relaxed))
+            return true;
+
+        bool shared = StorageBackend::current().kind() != BackendKind::MEMORY;
+        int fd = shared ? ::open(SPACE_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644)
+                        : ::memfd_create(SPACE_FILE, MFD_CLOEXEC);
+        bool ok = fd >= 0 && lockFile(fd, LOCK_EX);
+        struct stat st{};
+        ok = ok && ::fstat(fd, &st) == 0;
+        bool fresh = ok && st.st_size < static_cast<off_t>(HEADER_BYTES);
+        if (fresh)
+            ok = ::ftruncate(fd, static_cast<off_t>(HEADER_BYTES)) == 0;
+        void *map = ok ? ::mmap(nullptr, HEADER_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ok = map != MAP_FAILED;
+        Header *h = ok ? static_cast<Header*>(map) : nullptr;
+        if (fresh && ok)
+        {
+            std::memset(map, 0, HEADER_BYTES);
+            std::memcpy(h->magic, SPACE_MAGIC, sizeof(SPACE_MAGIC));
+            h->version = SPACE_VERSION;
+            h->slotBytes = sizeof(Slot);
+        }
+        ok = ok && std::memcmp(h->magic, SPACE_MAGIC, sizeof(SPACE_MAGIC)) == 0 &&
+             h->version == SPACE_VERSION && h->slotBytes == sizeof(Slot) &&
+             h->levels.load(std::memory_order_acquire) <= MAX_LEVELS;
+        if (fd >= 0)
+            lockFile(fd, LOCK_UN);
+
+        if (!ok)
+        {
+            if (map != MAP_FAILED)
+                ::munmap(map, HEADER_BYTES);
+            if (fd >= 0)
+                ::close(fd);
+            if (!openReported)
+                std::cerr << "Error: cannot use " << SPACE_FILE << "; no space can be booked.\n";
+            openReported = true;
+            return false;
+        }
+        spaceFd = fd;
+        header = h;
+        onFile = shared;
+        attachSerial.fetch_add(1, std::memory_order_acq_rel);
+        attached.store(true, std::memory_order_release);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // FNV-1a over the (at most 16) ID characters
+    std::size_t hashID(const SailingID &id)
+    {
+        std::uint32_t h = 2166136261u;
+        for (std::size_t i = 0; i < id.size() && i < 16; ++i)
+        {
+            h ^= static_cast<unsigned char>(id[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    bool keyEquals(const Slot &s, const SailingID &id)
+    {
+        std::size_t n = id.size() < 16 ? id.size() : 16;
+        return std::memcmp(s.id, id.data(), n) == 0 && (n == 16 || s.id[n] == '\0');
+    }
+
+    //------------------------------------------------------------
+    // Probe each level for the slot keyed `id`, LIVE or DEAD
+    // (lock-free). An ID has at most one slot in the whole table.
+    Slot *findKey(const SailingID &id, std::uint32_t &state)
+    {
+        std::size_t h = hashID(id);
+        int count = mappedLevels();
+        for (int l = 0; l < count; ++l)
+        {
+            Slot *level = levels[l].load(std::memory_order_acquire);
+            std::size_t size = levelSlots(l);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                Slot &s = level[(h + i) & (size - 1)];
+                std::uint32_t st = s.state.load(std::memory_order_acquire);
+                if (st == EMPTY)
+                    break;                  // not in this level
+                if (keyEquals(s, id))
+                {
+                    state = st;
+                    return &s;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    //------------------------------------------------------------
+    // Probe for a LIVE slot holding `id` (lock-free)
+    Slot *findLive(const SailingID &id)
+    {
+        if (!attach())
+            return nullptr;
+        std::uint32_t st = EMPTY;
+        Slot *s = findKey(id, st);
+        return s && st == LIVE ? s : nullptr;
+    }
+
+    //------------------------------------------------------------
+    // An EMPTY slot for a new ID; appends a level twice the size
+    // of the last when every level is 3/4 full (writer lock and
+    // TableLock held)
+    Slot *claimSlot(const SailingID &id)
+    {
+        std::size_t h = hashID(id);
+        for (int l = 0; l < MAX_LEVELS; ++l)
+        {
+            int count = static_cast<int>(header->levels.load(std::memory_order_acquire));
+            if (l == count)
+            {
+                if (::ftruncate(spaceFd, levelOffset(l + 1)) != 0)
+                    return nullptr;
+                header->levels.store(static_cast<std::uint32_t>(l + 1), std::memory_order_release);
+            }
+            if (mappedLevels() <= l)
+                return nullptr;
+            std::size_t size = levelSlots(l);
+            if (header->used[l].load(std::memory_order_relaxed) >= size / 4 * 3)
+                continue;
+            Slot *level = levels[l].load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                Slot &s = level[(h + i) & (size - 1)];
+                if (s.state.load(std::memory_order_relaxed) == EMPTY)
+                {
+                    header->used[l].fetch_add(1, std::memory_order_relaxed);
+                    return &s;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    //------------------------------------------------------------
+    // Take `need` from a lane counter only if it is still there
+    bool tryTake(std::atomic<std::int32_t> &lane, std::int32_t need)
+    {
+        std::int32_t cur = lane.load(std::memory_order_relaxed);
+        while (cur >= need)
+        {
+            if (lane.compare_exchange_weak(cur, cur - need,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------
+    // Give back `amount` without exceeding `cap` (0 = unbounded).
+    // Returns the portion that did not fit.
+    std::int32_t tryGive(std::atomic<std::int32_t> &lane, std::int32_t amount, std::int32_t cap)
+    {
+        std::int32_t cur = lane.load(std::memory_order_relaxed);
+        while (true)
+        {
+            std::int32_t fits = amount;
+            if (cap > 0 && cur + fits > cap)
+                fits = cap > cur ? cap - cur : 0;
+            if (fits == 0)
+                return amount;
+            if (lane.compare_exchange_weak(cur, cur + fits,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed))
+                return amount - fits;
+        }
+    }
+
+    //------------------------------------------------------------
+    // Pull one sailing (and its vessel's capacity) from storage
+    Slot *loadFromFile(const SailingID &id)
+    {
+        StorageBackend &store = StorageBackend::current();
+        Sailingrec rec{};
+        if (!store.findSailing(id, rec))
+            return nullptr;
+
+        unsigned int capHCL = 0, capLCL = 0;
+        store.findVessel(rec.VesselName, capHCL, capLCL);
+
+        CapacityTable::add(id, rec.remainingHCL, rec.remainingLCL,
+                           static_cast<float>(capHCL), static_cast<float>(capLCL));
+        return findLive(id);
+    }
+
+    //------------------------------------------------------------
+    // Table lookup with file fallback; feeds the index hit counters
+    Slot *findCached(const SailingID &id)
+    {
+        Slot *s = findLive(id);
+        if (s)
+        {
+            Metrics::add(Counter::INDEX_HITS);
+            return s;
+        }
+        Metrics::add(Counter::INDEX_MISSES);
+        return loadFromFile(id);
+    }
+
+    //------------------------------------------------------------
+    // Cross-process locks are OFD locks on sailings.space, taken
+    // through a descriptor each thread opens for itself (through
+    // /proc, so it is the same file even if the directory has
+    // changed, and again after a fork), so they exclude other
+    // threads here as well as other processes.
+    struct ThreadFd
+    {
+        int           fd = -1;
+        std::uint64_t serial = 0;       // attach it belongs to
+        pid_t         pid = 0;
+        ~ThreadFd()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    };
+    thread_local ThreadFd threadFd;
+
+    int lockFd()
+    {
+        std::uint64_t serial = attachSerial.load(std::memory_order_acquire);
+        pid_t pid = ::getpid();
+        if (threadFd.serial != serial || threadFd.pid != pid)
+        {
+            if (threadFd.fd >= 0)
+                ::close(threadFd.fd);
+            std::string self = "/proc/self/fd/" + std::to_string(spaceFd);
+            threadFd.fd = ::open(self.c_str(), O_RDWR | O_CLOEXEC);
+            threadFd.serial = serial;
+            threadFd.pid = pid;
+        }
+        return threadFd.fd;
+    }
+
+    // Lock (F_WRLCK) or unlock (F_UNLCK) one byte of the file
+    bool lockByte(int fd, off_t at, short type, bool wait)
+    {
+        struct flock range{};
+        range.l_type = type;
+        range.l_whence = SEEK_SET;
+        range.l_start = at;
+        range.l_len = 1;
+        if (fd < 0 || at < 0)
+            return false;
+        int rc;
+        do
+            rc = ::fcntl(fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &range);
+        while (rc != 0 && errno == EINTR);
+        return rc == 0;
+    }
+
+    // Byte 0 locked, for claiming slots or adding a level
+    class TableLock
+    {
+    public:
+        TableLock() : fd(lockFd()), locked(lockByte(fd, 0, F_WRLCK, true)) {}
+        ~TableLock()
+        {
+            if (locked)
+                lockByte(fd, 0, F_UNLCK, false);
+        }
+        TableLock(const TableLock &) = delete;
+        TableLock &operator=(const TableLock &) = delete;
+
+        bool held() const { return locked; }
+
+    private:
+        int  fd;
+        bool locked;
+    };
+
+    // Byte of sailings.space where `s` starts
+    off_t slotOffset(const Slot &s)
+    {
+        int count = levelCount.load(std::memory_order_acquire);
+        for (int l = 0; l < count; ++l)
+        {
+            const Slot *level = levels[l].load(std::memory_order_acquire);
+            if (&s >= level && &s < level + levelSlots(l))
+                return levelOffset(l) + static_cast<off_t>((&s - level) * sizeof(Slot));
+        }
+        return -1;
+    }
+
+    // Take (F_WRLCK) or drop (F_UNLCK) the slot's write-back lock,
+    // without waiting
+    bool lockSlot(int fd, const Slot &s, short type)
+    {
+        return lockByte(fd, slotOffset(s), type, false);
+    }
+
+    SailingID slotID(const Slot &s)
+    {
+        std::size_t n = 0;
+        while (n < sizeof(s.id) && s.id[n] != '\0')
+            ++n;
+        return SailingID(std::string(s.id, n));
+    }
+
+    //------------------------------------------------------------
+    // Copy the counters to the sailing's record (slot lock held).
+    // A sailing that is not on file is marked TABLE_ONLY and never
+    // written again.
+    bool writeSlot(Slot &s)
+    {
+        std::uint64_t seen = s.changes.load(std::memory_order_acquire);
+        std::int32_t hcl = s.hclCm.load(std::memory_order_acquire);
+        std::int32_t lcl = s.lclCm.load(std::memory_order_acquire);
+        SailingID id = slotID(s);
+        StorageBackend &store = StorageBackend::current();
+        if (!store.setRemainingSpace(id, CapacityTable::toMetres(hcl), CapacityTable::toMetres(lcl)))
+        {
+            if (s.backing.load(std::memory_order_acquire) == UNKNOWN && !store.sailingExists(id))
+                s.backing.store(TABLE_ONLY, std::memory_order_release);
+            return false;
+        }
+        s.hclFileCm.store(hcl, std::memory_order_relaxed);
+        s.lclFileCm.store(lcl, std::memory_order_relaxed);
+        s.backing.store(ON_FILE, std::memory_order_release);
+        s.written.store(seen, std::memory_order_release);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Write the slot back until `written` catches up with
+    // `changes`, or leave it to whoever holds the slot's lock
+    // (they check again after unlocking). False if a write here
+    // failed.
+    bool writeBack(Slot &s)
+    {
+        if (s.backing.load(std::memory_order_acquire) == TABLE_ONLY)
+            return false;
+        std::optional<WriteGate::Hold> hold;
+        if (StorageBackend::current().kind() != BackendKind::MEMORY)
+            hold.emplace();
+        int fd = lockFd();
+        while (s.written.load(std::memory_order_seq_cst) != s.changes.load(std::memory_order_seq_cst))
+        {
+            if (!lockSlot(fd, s, F_WRLCK))
+                return fd >= 0;
+            bool ok = s.written.load(std::memory_order_acquire) == s.changes.load(std::memory_order_acquire) ||
+                      writeSlot(s);
+            lockSlot(fd, s, F_UNLCK);
+            if (!ok)
+                return false;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // load(): bring a slot that already existed into line with
+    // `rec` as read from file. Unwritten changes are written; if
+    // the record differs from the last write-back, something other
+    // than this table changed it, and the file's space is taken
+    // unless a booking moved the counters meanwhile.
+    void reconcile(Slot &s, const Sailingrec &rec)
+    {
+        s.backing.store(ON_FILE, std::memory_order_release);
+        if (s.written.load(std::memory_order_acquire) != s.changes.load(std::memory_order_acquire))
+        {
+            writeBack(s);
+            return;
+        }
+        if (CapacityTable::toCentimetres(rec.remainingHCL) == s.hclFileCm.load(std::memory_order_relaxed) &&
+            CapacityTable::toCentimetres(rec.remainingLCL) == s.lclFileCm.load(std::memory_order_relaxed))
+            return;
+
+        int fd = lockFd();
+        if (!lockSlot(fd, s, F_WRLCK))
+            return;                             // being written back: in use
+        Sailingrec now{};
+        if (s.written.load(std::memory_order_acquire) == s.changes.load(std::memory_order_acquire) &&
+            StorageBackend::current().findSailing(slotID(s), now))
+        {
+            std::int32_t hcl = s.hclFileCm.load(std::memory_order_relaxed);
+            std::int32_t lcl = s.lclFileCm.load(std::memory_order_relaxed);
+            std::int32_t fileHCL = CapacityTable::toCentimetres(now.remainingHCL);
+            std::int32_t fileLCL = CapacityTable::toCentimetres(now.remainingLCL);
+            if (s.hclCm.compare_exchange_strong(hcl, fileHCL, std::memory_order_acq_rel))
+                s.hclFileCm.store(fileHCL, std::memory_order_relaxed);
+            if (s.lclCm.compare_exchange_strong(lcl, fileLCL, std::memory_order_acq_rel))
+                s.lclFileCm.store(fileLCL, std::memory_order_relaxed);
+        }
+        lockSlot(fd, s, F_UNLCK);
+    }
+
+    // A reserve or release moved the counters
+    void changed(Slot &s)
+    {
+        s.changes.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    //------------------------------------------------------------
+    // The compare-and-swap steps of reserve() and reserveGroup()
+    bool takeSpace(Slot &s, std::int32_t lengthCm, bool highCeiling, Lane &lane)
+    {
+        if (highCeiling)
+        {
+            if (tryTake(s.hclCm, lengthCm))
+                lane = Lane::HCL;
+        }
+        else if (tryTake(s.lclCm, lengthCm))
+        {
+            lane = Lane::LCL;
+        }
+        else if (tryTake(s.hclCm, lengthCm))
+        {
+            lane = Lane::HCL;   // LCL full, fall back to HCL
+        }
+        return lane != Lane::NONE;
+    }
+
+    bool takeGroup(Slot &s, std::vector<LaneRequest> &requests)
+    {
+        // The split depends on the free LCL, which another booking may
+        // shrink before it is taken; split again when that happens
+        for (int attempt = 0; attempt < GROUP_ATTEMPTS; ++attempt)
+        {
+            std::int32_t lclFree = s.lclCm.load(std::memory_order_acquire);
+            std::int32_t hclNeed = 0, lclNeed = 0;
+            for (LaneRequest &r : requests)
+            {
+                if (!r.highCeiling && lclNeed + r.spaceCm <= lclFree)
+                {
+                    lclNeed += r.spaceCm;
+                    r.lane = Lane::LCL;
+                }
+                else
+                {
+                    hclNeed += r.spaceCm;
+                    r.lane = Lane::HCL;
+                }
+            }
+
+            if (!tryTake(s.hclCm, hclNeed))
+                break;                                  // not enough HCL left
+            if (tryTake(s.lclCm, lclNeed))
+                return true;
+            s.hclCm.fetch_add(hclNeed, std::memory_order_acq_rel);
+        }
+
+        for (LaneRequest &r : requests)
+            r.lane = Lane::NONE;
+        return false;
+    }
+}
+
+// ============================================================
+// Conversions
+// ============================================================
+std::int32_t CapacityTable::toCentimetres(float metres)
+{
+    return static_cast<std::int32_t>(std::lround(metres * 100.0f));
+}
+
+float CapacityTable::toMetres(std::int32_t centimetres)
+{
+    return static_cast<float>(centimetres) / 100.0f;
+}
+
+std::int32_t CapacityTable::vehicleSpaceCm(std::int32_t lengthM)
+{
+    return lengthM * 100 + PARKING_BUFFER_CM;
+}
+
+// ============================================================
+// Table maintenance (writers)
+// ============================================================
+void CapacityTable::load()
+{
+    clear();
+    if (!attach())
+        return;
+    StorageBackend &store = StorageBackend::current();
+    for (const Sailingrec &rec : store.sailings())
+    {
+        std::uint32_t st = EMPTY;
+        SailingID id(std::string_view(rec.id, strnlen(rec.id, sizeof(rec.id))));
+        Slot *s = findKey(id, st);
+        if (s && st == LIVE)
+        {
+            reconcile(*s, rec);
+            continue;
+        }
+        unsigned int capHCL = 0, capLCL = 0;
+        store.findVessel(rec.VesselName, capHCL, capLCL);
+        add(id, rec.remainingHCL, rec.remainingLCL,
+            static_cast<float>(capHCL), static_cast<float>(capLCL));
+    }
+}
+
+void CapacityTable::clear()
+{
+    std::lock_guard<std::mutex> guard(writerLock);
+    std::lock_guard<std::mutex> mapGuard(mapLock);
+    if (!attached.load(std::memory_order_relaxed))
+        return;
+    int count = levelCount.load(std::memory_order_relaxed);
+    for (int l = 0; l < count; ++l)
+    {
+        ::munmap(levels[l].load(std::memory_order_relaxed), levelSlots(l) * sizeof(Slot));
+        levels[l].store(nullptr, std::memory_order_relaxed);
+    }
+    levelCount.store(0, std::memory_order_release);
+    ::munmap(header, HEADER_BYTES);
+    header = nullptr;
+    ::close(spaceFd);
+    spaceFd = -1;
+    attached.store(false, std::memory_order_release);
+}
+
+bool CapacityTable::add(SailingID sailingID,
+                        float remainingHCL,
+                        float remainingLCL,
+                        float capacityHCL,
+                        float capacityLCL)
+{
+    if (!attach())
+        return false;
+    std::lock_guard<std::mutex> guard(writerLock);
+    TableLock tableLock;
+    if (!tableLock.held())
+        return false;
+
+    std::uint32_t st = EMPTY;
+    Slot *target = findKey(sailingID, st);
+    if (target && st == LIVE)
+        return false;           // already present
+    if (!target)                // else revive the DEAD slot with this key
+        target = claimSlot(sailingID);
+    if (!target)
+    {
+        if (!fullReported)
+            std::cerr << "Error: capacity table full; sailings past this one are not tracked.\n";
+        fullReported = true;
+        return false;
+    }
+
+    std::memset(target->id, 0, sizeof(target->id));
+    std::memcpy(target->id, sailingID.data(), sailingID.size() < 16 ? sailingID.size() : 16);
+    target->hclCm.store(toCentimetres(remainingHCL), std::memory_order_relaxed);
+    target->lclCm.store(toCentimetres(remainingLCL), std::memory_order_relaxed);
+    target->hclCapCm = toCentimetres(capacityHCL);
+    target->lclCapCm = toCentimetres(capacityLCL);
+    target->backing.store(UNKNOWN, std::memory_order_relaxed);
+    target->hclFileCm.store(toCentimetres(remainingHCL), std::memory_order_relaxed);
+    target->lclFileCm.store(toCentimetres(remainingLCL), std::memory_order_relaxed);
+    target->written.store(target->changes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    target->state.store(LIVE, std::memory_order_release);
+    return true;
+}
+
+bool CapacityTable::remove(SailingID sailingID)
+{
+    if (!attach())
+        return false;
+    std::lock_guard<std::mutex> guard(writerLock);
+    TableLock tableLock;
+    if (!tableLock.held())
+        return false;
+    Slot *s = findLive(sailingID);
+    if (!s)
+        return false;
+    s->state.store(DEAD, std::memory_order_release);
+    return true;
+}
+
+// ============================================================
+// Booking path: compare-and-swap on the shared counters
+// ============================================================
+bool CapacityTable::reserve(SailingID sailingID,
+                            std::int32_t lengthCm,
+                            bool highCeiling,
+                            Lane &lane)
+{
+    FERRY_TRACE_SPAN("CapacityTable::reserve");
+    lane = Lane::NONE;
+
+    Slot *s = findCached(sailingID);
+    if (!s || !takeSpace(*s, lengthCm, highCeiling, lane))
+        return false;
+    changed(*s);
+    return true;
+}
+
+bool CapacityTable::reserveGroup(SailingID sailingID, std::vector<LaneRequest> &requests)
+{
+    FERRY_TRACE_SPAN("CapacityTable::reserveGroup");
+    for (LaneRequest &r : requests)
+        r.lane = Lane::NONE;
+
+    Slot *s = findCached(sailingID);
+    if (!s || !takeGroup(*s, requests))
+        return false;
+    changed(*s);
+    return true;
+}
+
+void CapacityTable::release(SailingID sailingID, std::int32_t lengthCm, Lane lane)
+{
+    Slot *s = findLive(sailingID);
+    if (!s || lane == Lane::NONE)
+        return;
+
+    std::atomic<std::int32_t> &counter = lane == Lane::HCL ? s->hclCm : s->lclCm;
+    counter.fetch_add(lengthCm, std::memory_order_acq_rel);
+    changed(*s);
+}
+
+void CapacityTable::releaseVehicle(SailingID sailingID,
+                                   std::int32_t lengthCm,
+                                   bool highCeiling)
+{
+    Slot *s = findCached(sailingID);
+    if (!s)
+        return;
+
+    std::int32_t rest = lengthCm;
+    if (!highCeiling)
+        rest = tryGive(s->lclCm, rest, s->lclCapCm);
+    if (rest > 0)
+        tryGive(s->hclCm, rest, s->hclCapCm);
+    changed(*s);
+}
+
+bool CapacityTable::remaining(SailingID sailingID,
+                              float &remainingHCL,
+                              float &remainingLCL)
+{
+    Slot *s = findLive(sailingID);
+    if (!s)
+        return false;
+    remainingHCL = toMetres(s->hclCm.load(std::memory_order_acquire));
+    remainingLCL = toMetres(s->lclCm.load(std::memory_order_acquire));
+    return true;
+}
+
+bool CapacityTable::persist(SailingID sailingID)
+{
+    FERRY_TRACE_SPAN("CapacityTable::persist");
+    Slot *s = findLive(sailingID);
+    return s && writeBack(*s);
+}
+
+// ============================================================
+// Shared change counts
+// ============================================================
+bool CapacityTable::sailingsVersion(SailingsVersion &now)
+{
+    if (!attach())
+        return false;
+    now.attachment = attachSerial.load(std::memory_order_acquire);
+    now.changes = header->sailingsChanges.load(std::memory_order_acquire);
+    return true;
+}
+
+bool CapacityTable::noteSailingsChanged(SailingsVersion &before)
+{
+    if (!attach())
+        return false;
+    before.attachment = attachSerial.load(std::memory_order_acquire);
+    before.changes = header->sailingsChanges.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool CapacityTable::replicationVersion(SailingsVersion &now)
+{
+    if (!attach() || !onFile)
+        return false;
+    now.attachment = attachSerial.load(std::memory_order_acquire);
+    now.changes = header->replicationChanges.load(std::memory_order_acquire);
+    return true;
+}
+
+void CapacityTable::noteReplicationChanged()
+{
+    if (attach())
+        header->replicationChanges.fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // namespace FerrySys
@@ -0,0 +1,170 @@
+//************************************************************
+//************************************************************
+//  Compaction.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements dead-row counting and compaction.
+//
+//    Row and dead-row counts are the ones in each file's header
+//    (see DataFile.h): noteDead() and noteReused() forward
+//    there, and compaction clears the dead count, so no call
+//    scans a file to count.
+//************************************************************
+//************************************************************
+
+#include "Compaction.h"
+#include "BinaryFileOps.hpp"
+#include "DataFile.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Vessel.h"
+#include "FreeList.h"
+#include "Metrics.h"
+#include "SailingTable.h"
+#include "WriteGate.h"
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FerrySys
+{
+
+namespace
+{
+    const TableLayout TABLES[static_cast<int>(Table::COUNT)] = {
+        { "vehicles.dat",     VEH_REC_BYTES,          VEH_STATUS_OFFSET },
+        { "reservations.dat", sizeof(ReservationRec), offsetof(ReservationRec, status) },
+        { "sailings.dat",     sizeof(Sailingrec),     offsetof(Sailingrec, status) },
+        { "vessels.dat",      sizeof(Vesselrec),      offsetof(Vesselrec, status) },
+    };
+
+    std::mutex hookLock;
+    std::vector<std::function<void()>> hooks[static_cast<int>(Table::COUNT)];
+
+    const TableLayout &info(Table t)
+    {
+        return TABLES[static_cast<int>(t)];
+    }
+
+    void publish(Table t)
+    {
+        TableStats s = Compactor::stats(t);
+        Metrics::setGauge(std::string(s.file) + " dead ratio", s.deadRatio);
+    }
+
+    bool overThreshold(Table t)
+    {
+        FileHeader h{};
+        if (!DataFile::header(t, h) || h.deadRows < Compactor::MIN_DEAD_ROWS)
+            return false;
+        double dead = static_cast<double>(h.deadRows);
+        double rows = static_cast<double>(h.liveRows + h.deadRows);
+        return dead >= Compactor::DEAD_RATIO_THRESHOLD * rows;
+    }
+}
+
+// ============================================================
+// Bookkeeping
+// ============================================================
+void Compactor::noteDead(Table table, std::size_t count)
+{
+    DataFile::noteDead(table, count);
+    publish(table);
+}
+
+void Compactor::noteReused(Table table)
+{
+    DataFile::noteReused(table);
+    publish(table);
+}
+
+bool Compactor::compactionDue()
+{
+    for (int t = 0; t < static_cast<int>(Table::COUNT); ++t)
+    {
+        if (overThreshold(static_cast<Table>(t)))
+            return true;
+    }
+    return false;
+}
+
+const TableLayout &Compactor::layout(Table table)
+{
+    return info(table);
+}
+
+TableStats Compactor::stats(Table table)
+{
+    const TableLayout &ti = info(table);
+    FileHeader h{};
+    DataFile::header(table, h);
+    TableStats s;
+    s.file = ti.file;
+    s.rows = static_cast<std::size_t>(h.liveRows + h.deadRows);
+    s.dead = static_cast<std::size_t>(h.deadRows);
+    s.deadRatio = s.rows ? static_cast<double>(s.dead) / static_cast<double>(s.rows) : 0.0;
+    return s;
+}
+
+void Compactor::onCompacted(Table table, std::function<void()> hook)
+{
+    std::lock_guard<std::mutex> guard(hookLock);
+    hooks[static_cast<int>(table)].push_back(std::move(hook));
+}
+
+void Compactor::resetCounts()
+{
+    DataFile::forget();
+}
+
+// ============================================================
+// Compaction
+// ============================================================
+std::size_t Compactor::compact(Table table)
+{
+    if (DataFile::deadRows(table) == 0)
+        return 0;
+
+    FERRY_METRIC_SCOPE("Compactor::compact");
+    WriteGate::Hold hold;
+    const TableLayout &ti = info(table);
+
+    std::size_t removed = 0;
+    if (!removeRecordsIf(ti.file, ti.recordSize,
+            [&ti](const void *bytes) {
+                return static_cast<const unsigned char*>(bytes)[ti.statusOffset] == REC_DEAD;
+            },
+            removed))
+    {
+        return 0;   // file missing or I/O error; counts stay as they were
+    }
+
+    DataFile::noteCompacted(table);
+    if (table == Table::SAILINGS)
+        SailingTable::forget();     // every process's columns hold the old slots
+    FreeList::clear(table);     // every listed slot has moved or gone
+    Metrics::add(Counter::ROWS_COMPACTED, removed);
+    publish(table);
+
+    std::vector<std::function<void()>> toRun;
+    {
+        std::lock_guard<std::mutex> guard(hookLock);
+        toRun = hooks[static_cast<int>(table)];
+    }
+    for (auto &hook : toRun)
+        hook();
+    return removed;
+}
+
+void Compactor::compactIfNeeded()
+{
+    for (int t = 0; t < static_cast<int>(Table::COUNT); ++t)
+    {
+        if (overThreshold(static_cast<Table>(t)))
+            compact(static_cast<Table>(t));
+    }
+}
+
+} // namespace FerrySys
@@ -0,0 +1,476 @@
+//************************************************************
+//************************************************************
+//  DataFile.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the data-file headers.
+//
+//    Each table keeps an open descriptor and the inode it was
+//    opened from. A call first stat()s the file and reopens it if
+//    it was replaced (or this is a forked child), then reads the
+//    64-byte header again under an OFD lock on its bytes, shared
+//    to read and exclusive across an update's read, change and
+//    write. Other processes' tombstones, slot reuse and
+//    generation bumps are therefore seen at once and never
+//    written back stale. The row totals are refitted to the file
+//    size, which covers appends made outside note*().
+//************************************************************
+//************************************************************
+
+#include "DataFile.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace FerrySys
+{
+
+namespace
+{
+    struct State
+    {
+        int           fd = -1;
+        pid_t         pid = 0;          // process that opened fd
+        dev_t         dev = 0;
+        ino_t         ino = 0;
+        bool          loaded = false;   // false: file missing or empty
+        bool          dirty = false;    // hdr differs from the file's copy
+        FileHeader    hdr{};
+    };
+
+    std::mutex headerLock;
+    State      states[static_cast<int>(Table::COUNT)];
+
+    FileHeader freshHeader(std::size_t recordSize, std::size_t statusOffset)
+    {
+        FileHeader h{};
+        std::memcpy(h.magic, FILE_MAGIC, sizeof(h.magic));
+        h.version = DataFile::SCHEMA_VERSION;
+        h.headerBytes = static_cast<std::uint16_t>(FILE_HEADER_BYTES);
+        h.recordSize = static_cast<std::uint32_t>(recordSize);
+        h.endianMark = FILE_ENDIAN_MARK;
+        h.statusOffset = static_cast<std::uint32_t>(statusOffset);
+        h.generation = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        return h;
+    }
+
+    //------------------------------------------------------------
+    // Empty string if `h` describes records laid out as `ti`
+    std::string mismatch(const FileHeader &h, const TableLayout &ti)
+    {
+        char why[96] = "";
+        if (h.endianMark != FILE_ENDIAN_MARK)
+            std::snprintf(why, sizeof(why), "was written on a machine of the other byte order");
+        else if (h.version != DataFile::SCHEMA_VERSION)
+            std::snprintf(why, sizeof(why), "has schema version %u, expected %u",
+                          static_cast<unsigned>(h.version), static_cast<unsigned>(DataFile::SCHEMA_VERSION));
+        else if (h.headerBytes != FILE_HEADER_BYTES)
+            std::snprintf(why, sizeof(why), "has a %u-byte header, expected %zu",
+                          static_cast<unsigned>(h.headerBytes), FILE_HEADER_BYTES);
+        else if (h.recordSize != ti.recordSize || h.statusOffset != ti.statusOffset)
+            std::snprintf(why, sizeof(why), "has %u-byte records, expected %zu",
+                          static_cast<unsigned>(h.recordSize), ti.recordSize);
+        return why;
+    }
+
+    std::size_t recordsIn(off_t bytes, std::size_t recordSize)
+    {
+        if (bytes <= static_cast<off_t>(FILE_HEADER_BYTES))
+            return 0;
+        return (static_cast<std::size_t>(bytes) - FILE_HEADER_BYTES) / recordSize;
+    }
+
+    void drop(State &s)
+    {
+        if (s.fd >= 0)
+            ::close(s.fd);
+        s = State{};
+    }
+
+    //------------------------------------------------------------
+    // OFD lock on the header bytes: F_RDLCK, F_WRLCK or F_UNLCK
+    bool lockHeader(const State &s, short type)
+    {
+        struct flock range{};
+        range.l_type = type;
+        range.l_whence = SEEK_SET;
+        range.l_start = 0;
+        range.l_len = static_cast<off_t>(FILE_HEADER_BYTES);
+        int rc;
+        do
+            rc = ::fcntl(s.fd, F_OFD_SETLKW, &range);
+        while (rc != 0 && errno == EINTR);
+        return rc == 0;
+    }
+
+    // fsync the directory holding `path`
+    bool syncParent(const std::string &path)
+    {
+        std::string dir = path.find('/') == std::string::npos ? "." : path.substr(0, path.rfind('/') + 1);
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    bool flush(State &s)
+    {
+        if (!s.dirty)
+            return true;
+        if (::pwrite(s.fd, &s.hdr, sizeof(s.hdr), 0) != static_cast<ssize_t>(sizeof(s.hdr)))
+            return false;
+        Metrics::add(Counter::BYTES_WRITTEN, sizeof(s.hdr));
+        s.dirty = false;
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Bring states[t] in line with the file (headerLock held),
+    // reading its header under a `lock` (F_RDLCK or F_WRLCK) that
+    // is still held on return while s.fd is open; see unlock().
+    // Returns false if the file is unusable; s.loaded is false
+    // afterwards if it is missing (or empty and !create).
+    bool attach(Table t, bool create, short lock)
+    {
+        State &s = states[static_cast<int>(t)];
+        const TableLayout &ti = Compactor::layout(t);
+
+        struct stat st{};
+        if (::stat(ti.file, &st) != 0)
+        {
+            drop(s);
+            if (!create)
+                return true;
+            s.fd = ::open(ti.file, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (s.fd < 0 || ::fstat(s.fd, &st) != 0)
+            {
+                drop(s);
+                return false;
+            }
+            Metrics::add(Counter::FILE_OPENS);
+            s.pid = ::getpid();
+            s.dev = st.st_dev;
+            s.ino = st.st_ino;
+        }
+
+        // A forked child shares the parent's descriptor, and with it
+        // the header lock; it opens its own
+        if (s.fd < 0 || s.dev != st.st_dev || s.ino != st.st_ino || s.pid != ::getpid())
+        {
+            drop(s);
+            s.fd = ::open(ti.file, O_RDWR | O_CLOEXEC);
+            if (s.fd < 0 || ::fstat(s.fd, &st) != 0)
+            {
+                drop(s);
+                return false;
+            }
+            Metrics::add(Counter::FILE_OPENS);
+            s.pid = ::getpid();
+            s.dev = st.st_dev;
+            s.ino = st.st_ino;
+        }
+
+        // Size as of the lock: a creator may have just written the header
+        if (!lockHeader(s, lock) || ::fstat(s.fd, &st) != 0)
+        {
+            drop(s);
+            return false;
+        }
+
+        if (st.st_size == 0)
+        {
+            s.loaded = false;
+            if (!create)
+                return true;
+            s.hdr = freshHeader(ti.recordSize, ti.statusOffset);
+            s.dirty = true;
+            s.loaded = flush(s);
+            return s.loaded;
+        }
+
+        std::size_t offset = dataOffset(s.fd, ti.recordSize);
+        if (offset == 0)
+        {
+            drop(s);
+            if (!DataFile::upgrade(ti.file, ti.recordSize, ti.statusOffset))
+            {
+                std::cerr << "Error: could not add a header to " << ti.file << "\n";
+                return false;
+            }
+            return attach(t, create, lock);
+        }
+
+        FileHeader h{};
+        if (::pread(s.fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)))
+        {
+            drop(s);
+            return false;
+        }
+        Metrics::add(Counter::BYTES_READ, sizeof(h));
+        std::string why = mismatch(h, ti);
+        if (why.empty() && offset == BAD_HEADER)
+            why = "counts more rows than it holds";
+        if (!why.empty())
+        {
+            std::cerr << "Error: " << ti.file << " " << why << "\n";
+            drop(s);
+            return false;
+        }
+
+        // Refit the totals to the file size; dead rows cannot exceed it
+        std::size_t records = recordsIn(st.st_size, ti.recordSize);
+        s.dirty = false;
+        if (h.liveRows + h.deadRows != records)
+        {
+            if (h.deadRows > records)
+                h.deadRows = records;
+            h.liveRows = records - h.deadRows;
+            s.dirty = true;
+        }
+        s.hdr = h;
+        s.loaded = true;
+        return true;
+    }
+
+    // Drop the lock attach() left held
+    void unlock(State &s)
+    {
+        if (s.fd >= 0)
+            lockHeader(s, F_UNLCK);
+    }
+
+    //------------------------------------------------------------
+    // Apply `change` to t's header as it is on file now, and write
+    // it back before another process can read it
+    template <class Change>
+    void update(Table t, Change change)
+    {
+        std::lock_guard<std::mutex> guard(headerLock);
+        State &s = states[static_cast<int>(t)];
+        if (attach(t, false, F_WRLCK) && s.loaded)
+        {
+            change(s.hdr);
+            s.dirty = true;
+            flush(s);
+        }
+        unlock(s);
+    }
+}
+
+// ============================================================
+// Open / inspect
+// ============================================================
+bool DataFile::open(Table table, bool create)
+{
+    std::lock_guard<std::mutex> guard(headerLock);
+    State &s = states[static_cast<int>(table)];
+    if (!attach(table, create, F_WRLCK))
+        return false;
+
+    // Opened before any append of ours, a partial last record is a
+    // torn write; every record appended after it would be misaligned
+    const TableLayout &ti = Compactor::layout(table);
+    struct stat st{};
+    if (s.loaded && ::fstat(s.fd, &st) == 0 &&
+        (static_cast<std::size_t>(st.st_size) - FILE_HEADER_BYTES) % ti.recordSize != 0)
+    {
+        std::cerr << "Error: " << ti.file << " ends in a partial record\n";
+        drop(s);
+        return false;
+    }
+    bool ok = flush(s);
+    unlock(s);
+    return ok;
+}
+
+bool DataFile::openAll()
+{
+    bool ok = true;
+    for (int t = 0; t < static_cast<int>(Table::COUNT); ++t)
+        ok &= open(static_cast<Table>(t));
+    return ok;
+}
+
+bool DataFile::header(Table table, FileHeader &out)
+{
+    std::lock_guard<std::mutex> guard(headerLock);
+    State &s = states[static_cast<int>(table)];
+    bool ok = attach(table, false, F_RDLCK) && s.loaded;
+    if (ok)
+        out = s.hdr;
+    unlock(s);
+    return ok;
+}
+
+std::size_t DataFile::rows(Table table)
+{
+    FileHeader h{};
+    return header(table, h) ? static_cast<std::size_t>(h.liveRows + h.deadRows) : 0;
+}
+
+std::size_t DataFile::deadRows(Table table)
+{
+    FileHeader h{};
+    return header(table, h) ? static_cast<std::size_t>(h.deadRows) : 0;
+}
+
+std::uint64_t DataFile::generation(Table table)
+{
+    FileHeader h{};
+    return header(table, h) ? h.generation : 0;
+}
+
+// ============================================================
+// Upkeep
+// ============================================================
+void DataFile::noteAppended(Table table, std::size_t count)
+{
+    // attach() has already refitted the totals to the longer file
+    (void)count;
+    update(table, [](FileHeader &h) {
+        if (h.appendRun < UINT32_MAX)
+            ++h.appendRun;
+        ++h.generation;
+    });
+}
+
+void DataFile::noteDead(Table table, std::size_t count)
+{
+    update(table, [count](FileHeader &h) {
+        std::uint64_t n = count < h.liveRows ? count : h.liveRows;
+        h.liveRows -= n;
+        h.deadRows += n;
+    });
+}
+
+void DataFile::noteReused(Table table, std::size_t count)
+{
+    update(table, [count](FileHeader &h) {
+        std::uint64_t n = count < h.deadRows ? count : h.deadRows;
+        h.deadRows -= n;
+        h.liveRows += n;
+        h.appendRun = 0;
+        ++h.generation;
+    });
+}
+
+void DataFile::noteCompacted(Table table)
+{
+    // The shorter file was refitted by attach(); what is left is live
+    update(table, [](FileHeader &h) {
+        h.liveRows += h.deadRows;
+        h.deadRows = 0;
+        h.appendRun = 0;
+        ++h.generation;
+    });
+}
+
+void DataFile::forget()
+{
+    std::lock_guard<std::mutex> guard(headerLock);
+    for (State &s : states)
+        drop(s);
+}
+
+// ============================================================
+// Legacy upgrade
+// ============================================================
+bool DataFile::upgrade(const std::string &path, std::size_t recordSize, std::size_t statusOffset)
+{
+    FERRY_METRIC_SCOPE("DataFile::upgrade");
+
+    // One upgrader at a time across processes: they share the temp
+    // file, and the second must see the first one's header
+    int lock = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock < 0)
+        return false;
+    Metrics::add(Counter::FILE_OPENS);
+    if (::flock(lock, LOCK_EX) != 0)
+    {
+        ::close(lock);
+        return false;
+    }
+    bool ok = upgradeLocked(path, recordSize, statusOffset);
+    ::close(lock);      // releases the flock
+    return ok;
+}
+
+bool DataFile::upgradeLocked(const std::string &path, std::size_t recordSize, std::size_t statusOffset)
+{
+    int in = ::open(path.c_str(), O_RDONLY);
+    if (in < 0)
+        return false;
+    Metrics::add(Counter::FILE_OPENS);
+    if (dataOffset(in) != 0)
+    {
+        ::close(in);
+        return true;
+    }
+
+    const std::string tmp = path + ".upgrade";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0)
+    {
+        ::close(in);
+        return false;
+    }
+    Metrics::add(Counter::FILE_OPENS);
+
+    // Whole records only; a torn record at the end is dropped
+    FileHeader h = freshHeader(recordSize, statusOffset);
+    constexpr std::size_t BLOCK_RECORDS = 4096;
+    std::vector<unsigned char> block(BLOCK_RECORDS * recordSize);
+    off_t readPos = 0;
+    off_t writePos = static_cast<off_t>(FILE_HEADER_BYTES);
+    bool ok = true;
+    while (ok)
+    {
+        ssize_t n = ::pread(in, block.data(), block.size(), readPos);
+        std::size_t records = n > 0 ? static_cast<std::size_t>(n) / recordSize : 0;
+        if (n < 0)
+            ok = false;
+        if (records == 0)
+            break;
+        for (std::size_t i = 0; i < records; ++i)
+        {
+            if (block[i * recordSize + statusOffset] == REC_DEAD)
+                ++h.deadRows;
+            else
+                ++h.liveRows;
+        }
+        std::size_t bytes = records * recordSize;
+        ok = ::pwrite(out, block.data(), bytes, writePos) == static_cast<ssize_t>(bytes);
+        readPos += static_cast<off_t>(bytes);
+        writePos += static_cast<off_t>(bytes);
+        Metrics::add(Counter::RECORDS_SCANNED, records);
+        Metrics::add(Counter::BYTES_READ, bytes);
+        Metrics::add(Counter::BYTES_WRITTEN, bytes);
+    }
+    ::close(in);
+
+    ok = ok && ::pwrite(out, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+    ok = ::fsync(out) == 0 && ok;
+    ::close(out);
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return syncParent(path);
+}
+
+} // namespace FerrySys
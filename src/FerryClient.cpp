@@ -0,0 +1,236 @@
+//************************************************************
+//************************************************************
+//  FerryClient.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the thin `ferryd` client: encode requests into
+//    fixed-length protocol records, send them in one frame and
+//    decode the matching responses.
+//************************************************************
+//************************************************************
+
+#include "FerryClient.h"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+using Proto::OpCode;
+using Proto::RequestRec;
+using Proto::ResponseRec;
+using Proto::Status;
+
+//------------------------------------------------------------
+// Helper: space-pad a request field
+//------------------------------------------------------------
+static void put(char *dest, std::size_t len, const std::string &src)
+{
+    encodeField(src, reinterpret_cast<unsigned char*>(dest), len);
+}
+
+FerryClient::~FerryClient()
+{
+    disconnect();
+}
+
+bool FerryClient::connect(const std::string &socketPath)
+{
+    disconnect();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+        return false;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+void FerryClient::disconnect()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+RequestRec FerryClient::makeRequest(OpCode op)
+{
+    RequestRec req;
+    std::memset(&req, ' ', sizeof(req));
+    req.op   = static_cast<std::uint8_t>(op);
+    req.arg0 = 0;
+    req.arg1 = 0;
+    return req;
+}
+
+//------------------------------------------------------------
+// One round trip for a batch of requests
+//------------------------------------------------------------
+bool FerryClient::call(const std::vector<RequestRec> &requests,
+                       std::vector<ResponseRec> &responses)
+{
+    if (fd < 0 || requests.empty() || requests.size() > Proto::MAX_BATCH)
+        return false;
+
+    Proto::FrameHeader hdr{ Proto::FRAME_MAGIC,
+                            static_cast<std::uint16_t>(requests.size()), 0 };
+    if (!Proto::sendAll(fd, &hdr, sizeof(hdr)) ||
+        !Proto::sendAll(fd, requests.data(), requests.size() * sizeof(RequestRec)))
+    {
+        disconnect();
+        return false;
+    }
+
+    Proto::FrameHeader reply{};
+    if (!Proto::recvAll(fd, &reply, sizeof(reply)) ||
+        reply.magic != Proto::FRAME_MAGIC || reply.count != hdr.count)
+    {
+        disconnect();
+        return false;
+    }
+
+    responses.resize(reply.count);
+    if (!Proto::recvAll(fd, responses.data(), reply.count * sizeof(ResponseRec)))
+    {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+bool FerryClient::callOne(const RequestRec &req, ResponseRec &res)
+{
+    std::vector<ResponseRec> out;
+    if (!call({ req }, out))
+        return false;
+    res = out.front();
+    return res.status == static_cast<std::uint8_t>(Status::OK);
+}
+
+// ============================================================
+// Single-request conveniences
+// ============================================================
+bool FerryClient::ping()
+{
+    ResponseRec res{};
+    return callOne(makeRequest(OpCode::PING), res);
+}
+
+bool FerryClient::vehicleExists(const LicensePlate &licensePlate)
+{
+    RequestRec req = makeRequest(OpCode::VEHICLE_EXISTS);
+    put(req.license, sizeof(req.license), licensePlate);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::sailingExists(SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::SAILING_EXISTS);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::getRemainingSpace(SailingID sailingID,
+                                    float &remainingHCL,
+                                    float &remainingLCL)
+{
+    RequestRec req = makeRequest(OpCode::SAILING_SPACE);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    if (!callOne(req, res))
+        return false;
+    remainingHCL = res.hcl;
+    remainingLCL = res.lcl;
+    return true;
+}
+
+int FerryClient::countReservations(SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::SAILING_COUNT);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res) ? res.value : -1;
+}
+
+bool FerryClient::reservationExists(const LicensePlate &licensePlate,
+                                    SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::RESERVATION_EXISTS);
+    put(req.license, sizeof(req.license), licensePlate);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::newCustomerReservation(const VehicleRecord &vehicle,
+                                         SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::RESERVE_NEW);
+    put(req.license, sizeof(req.license), vehicle.license);
+    put(req.phone, sizeof(req.phone), vehicle.phone);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    req.arg0 = vehicle.length_m;
+    req.arg1 = vehicle.height_m;
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::returningCustomerReservation(const LicensePlate &licensePlate,
+                                               SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::RESERVE_RETURNING);
+    put(req.license, sizeof(req.license), licensePlate);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::deleteReservation(const LicensePlate &licensePlate,
+                                    SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::RESERVATION_DELETE);
+    put(req.license, sizeof(req.license), licensePlate);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::checkinVehicle(const LicensePlate &licensePlate,
+                                 SailingID sailingID)
+{
+    RequestRec req = makeRequest(OpCode::CHECKIN);
+    put(req.license, sizeof(req.license), licensePlate);
+    put(req.sailingID, sizeof(req.sailingID), sailingID);
+    ResponseRec res{};
+    return callOne(req, res);
+}
+
+bool FerryClient::replicaLag(long &records, double &seconds)
+{
+    ResponseRec res{};
+    if (!callOne(makeRequest(OpCode::REPLICA_STATUS), res))
+        return false;
+    records = res.value;
+    seconds = res.hcl;
+    return true;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,509 @@
+//************************************************************
+//************************************************************
+//  FerryServer.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the `ferryd` request loop: accept terminals on a
+//    Unix domain socket, gather each frame in the poll loop, hand
+//    whole frames to the worker pool and dispatch each batch to
+//    the business layer.
+//************************************************************
+//************************************************************
+
+#include "FerryServer.h"
+#include "Vessel.h"
+#include "Sailing.h"
+#include "Reservation.h"
+#include "StorageBackend.h"
+#include "Metrics.h"
+#include "Compaction.h"
+#include "Replica.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+using Proto::OpCode;
+using Proto::RequestRec;
+using Proto::ResponseRec;
+using Proto::Status;
+
+//------------------------------------------------------------
+// Helper: decode a space-padded request field
+//------------------------------------------------------------
+static std::string field(const char *src, std::size_t len)
+{
+    return decodeField(reinterpret_cast<const unsigned char*>(src), len);
+}
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // The part of a frame received so far on one connection
+    struct Inbound
+    {
+        std::vector<unsigned char> bytes;
+        Clock::time_point          since;   // first byte
+    };
+
+    enum class Frame { PARTIAL, WHOLE, CLOSED };
+
+    //------------------------------------------------------------
+    // Read what has arrived of `fd`'s next frame, never blocking
+    // and never past the frame's end (a pipelined next frame stays
+    // in the socket). CLOSED on EOF, error or a bad header.
+    Frame readFrame(int fd, Inbound &in)
+    {
+        while (true)
+        {
+            std::size_t want = sizeof(Proto::FrameHeader);
+            if (in.bytes.size() >= want)
+            {
+                Proto::FrameHeader hdr{};
+                std::memcpy(&hdr, in.bytes.data(), sizeof(hdr));
+                if (hdr.magic != Proto::FRAME_MAGIC || hdr.count == 0 || hdr.count > Proto::MAX_BATCH)
+                    return Frame::CLOSED;
+                want += hdr.count * sizeof(RequestRec);
+            }
+            if (in.bytes.size() == want && want > sizeof(Proto::FrameHeader))
+                return Frame::WHOLE;
+
+            std::size_t have = in.bytes.size();
+            in.bytes.resize(want);
+            ssize_t n = ::recv(fd, in.bytes.data() + have, want - have, MSG_DONTWAIT);
+            in.bytes.resize(have + (n > 0 ? static_cast<std::size_t>(n) : 0));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return Frame::PARTIAL;
+            if (n <= 0)
+                return Frame::CLOSED;
+            if (have == 0)
+                in.since = Clock::now();
+        }
+    }
+}
+
+FerryServer::FerryServer(const std::string &path, std::size_t workerCount)
+    : socketPath(path), pool(workerCount)
+{
+}
+
+FerryServer::~FerryServer()
+{
+    pool.shutdown();
+    if (applier.joinable())
+        applier.join();
+    if (wakePipe[0] >= 0) ::close(wakePipe[0]);
+    if (wakePipe[1] >= 0) ::close(wakePipe[1]);
+}
+
+//------------------------------------------------------------
+// Wake the poll loop so run() notices the stop flag
+//------------------------------------------------------------
+void FerryServer::requestStop()
+{
+    stopping.store(true);
+    if (wakePipe[1] >= 0)
+    {
+        char b = 0;
+        (void)!::write(wakePipe[1], &b, 1);
+    }
+}
+
+//------------------------------------------------------------
+// Main loop
+//------------------------------------------------------------
+bool FerryServer::run()
+{
+    if (::pipe(wakePipe) != 0)
+        return false;
+    ::fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        return false;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Error: socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(socketPath.c_str());
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0)
+    {
+        std::cerr << "Error: Unable to bind " << socketPath << "\n";
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    ::fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+    Vessel::initialize();
+    Sailing::initialize();
+    Reservation::initialize();
+
+    follower = Replica::isFollower();
+    if (follower)
+        applier = std::thread([this] { applyLoop(); });
+
+    std::vector<int>    idle;   // sockets currently owned by poll()
+    std::vector<pollfd> fds;
+    std::unordered_map<int, Inbound> partial;   // idle sockets part way through a frame
+
+    while (!stopping.load())
+    {
+        fds.clear();
+        fds.push_back({ listenFd, POLLIN, 0 });
+        fds.push_back({ wakePipe[0], POLLIN, 0 });
+        for (int fd : idle)
+            fds.push_back({ fd, POLLIN, 0 });
+
+        // Wake for the first partial frame to run out of time
+        int timeout = -1;
+        Clock::time_point now = Clock::now();
+        for (const auto &[fd, in] : partial)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                in.since + std::chrono::milliseconds(FRAME_TIMEOUT_MS) - now).count();
+            int ms = static_cast<int>(std::max<decltype(left)>(left, 0) + 1);
+            timeout = timeout < 0 ? ms : std::min(timeout, ms);
+        }
+
+        if (::poll(fds.data(), fds.size(), timeout) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (stopping.load())
+            break;
+
+        // Readable clients are read here; a whole frame moves its
+        // socket to a worker, which rearms it after replying. A
+        // frame still unfinished after FRAME_TIMEOUT_MS is dropped
+        // with its connection.
+        now = Clock::now();
+        std::vector<int> stillIdle;
+        for (std::size_t i = 2; i < fds.size(); ++i)
+        {
+            int fd = fds[i].fd;
+            Frame frame = Frame::PARTIAL;
+            if (fds[i].revents != 0)
+                frame = readFrame(fd, partial[fd]);
+            auto it = partial.find(fd);
+            if (frame == Frame::PARTIAL && it != partial.end() && !it->second.bytes.empty() &&
+                now - it->second.since >= std::chrono::milliseconds(FRAME_TIMEOUT_MS))
+                frame = Frame::CLOSED;
+
+            if (frame == Frame::WHOLE)
+            {
+                std::vector<RequestRec> requests(
+                    (it->second.bytes.size() - sizeof(Proto::FrameHeader)) / sizeof(RequestRec));
+                std::memcpy(requests.data(), it->second.bytes.data() + sizeof(Proto::FrameHeader),
+                            requests.size() * sizeof(RequestRec));
+                partial.erase(it);
+                pool.submit([this, fd, requests = std::move(requests)] { serveFrame(fd, requests); });
+            }
+            else if (frame == Frame::CLOSED)
+            {
+                if (it != partial.end())
+                    partial.erase(it);
+                ::close(fd);
+            }
+            else
+            {
+                if (it != partial.end() && it->second.bytes.empty())
+                    partial.erase(it);
+                stillIdle.push_back(fd);
+            }
+        }
+
+        // Sockets handed back by workers rejoin the idle set.
+        if (fds[1].revents & POLLIN)
+        {
+            char drain[64];
+            while (::read(wakePipe[0], drain, sizeof(drain)) > 0)
+            {
+            }
+            std::lock_guard<std::mutex> guard(readyLock);
+            stillIdle.insert(stillIdle.end(), readyFds.begin(), readyFds.end());
+            readyFds.clear();
+        }
+        idle.swap(stillIdle);
+
+        if (fds[0].revents & POLLIN)
+        {
+            while (true)
+            {
+                int client = ::accept(listenFd, nullptr, nullptr);
+                if (client < 0)
+                    break;
+                timeval limit{ SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000 };
+                ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+                idle.push_back(client);
+            }
+        }
+    }
+
+    pool.shutdown();
+    if (applier.joinable())
+        applier.join();
+    for (int fd : idle)
+        ::close(fd);
+    {
+        std::lock_guard<std::mutex> guard(readyLock);
+        for (int fd : readyFds)
+            ::close(fd);
+        readyFds.clear();
+    }
+    ::close(listenFd);
+    listenFd = -1;
+    ::unlink(socketPath.c_str());
+
+    Reservation::shutdown();
+    Sailing::shutdown();
+    Vessel::shutdown();
+    FerrySys::Metrics::dumpToFile(FerrySys::Metrics::DUMP_FILE);
+    FerrySys::Trace::flush();
+    return true;
+}
+
+//------------------------------------------------------------
+// Follower: apply the primary's log until stopped; straight on
+// while a full batch comes back, else poll every interval
+//------------------------------------------------------------
+void FerryServer::applyLoop()
+{
+    while (!stopping.load())
+    {
+        long applied;
+        {
+            std::unique_lock<std::shared_mutex> guard(dataLock);
+            applied = Replica::catchUp();
+        }
+        if (applied < static_cast<long>(Replica::APPLY_BATCH))
+            std::this_thread::sleep_for(std::chrono::milliseconds(APPLY_INTERVAL_MS));
+    }
+}
+
+//------------------------------------------------------------
+// Worker: execute one frame, reply (giving up on a terminal that
+// does not take it within SEND_TIMEOUT_MS), hand socket back
+//------------------------------------------------------------
+void FerryServer::serveFrame(int fd, const std::vector<RequestRec> &requests)
+{
+    std::vector<ResponseRec> responses;
+    executeBatch(requests, responses);
+
+    Proto::FrameHeader reply{ Proto::FRAME_MAGIC, static_cast<std::uint16_t>(requests.size()), 0 };
+    if (!Proto::sendAll(fd, &reply, sizeof(reply)) ||
+        !Proto::sendAll(fd, responses.data(), responses.size() * sizeof(ResponseRec)))
+    {
+        ::close(fd);
+        return;
+    }
+
+    rearm(fd);
+}
+
+//------------------------------------------------------------
+// Return a socket to the poll loop
+//------------------------------------------------------------
+void FerryServer::rearm(int fd)
+{
+    {
+        std::lock_guard<std::mutex> guard(readyLock);
+        readyFds.push_back(fd);
+    }
+    char b = 1;
+    (void)!::write(wakePipe[1], &b, 1);
+}
+
+//------------------------------------------------------------
+// Run a batch under a single lock acquisition
+//------------------------------------------------------------
+void FerryServer::executeBatch(const std::vector<RequestRec> &requests,
+                               std::vector<ResponseRec> &responses)
+{
+    FERRY_TRACE_SPAN("FerryServer::executeBatch");
+    // A follower runs no updates, so its batches always share
+    bool readOnly = follower || std::all_of(requests.begin(), requests.end(),
+        [](const RequestRec &r) { return Proto::isReadOnly(static_cast<OpCode>(r.op)); });
+
+    responses.clear();
+    responses.reserve(requests.size());
+
+    if (readOnly)
+    {
+        std::shared_lock<std::shared_mutex> guard(dataLock);
+        for (const auto &req : requests)
+            responses.push_back(execute(req));
+    }
+    else
+    {
+        std::unique_lock<std::shared_mutex> guard(dataLock);
+        for (const auto &req : requests)
+            responses.push_back(execute(req));
+
+        // Tombstones past the threshold: compact in the background,
+        // once the exclusive lock is free again
+        if (FerrySys::Compactor::compactionDue() && !compactionQueued.exchange(true))
+        {
+            pool.submit([this] {
+                std::unique_lock<std::shared_mutex> lock(dataLock);
+                FerrySys::Compactor::compactIfNeeded();
+                compactionQueued.store(false);
+            });
+        }
+
+        // A grown mutation log: drop what every replica has applied
+        if (FerrySys::Replica::checkpointDue() && !checkpointQueued.exchange(true))
+        {
+            pool.submit([this] {
+                FerrySys::Replica::checkpoint();
+                checkpointQueued.store(false);
+            });
+        }
+    }
+}
+
+//------------------------------------------------------------
+// Dispatch a single request to the business / FileIO layer
+//------------------------------------------------------------
+ResponseRec FerryServer::execute(const RequestRec &req)
+{
+    ResponseRec res{};
+    res.op = req.op;
+
+    auto ok = [&res](bool b) { res.status = static_cast<std::uint8_t>(b ? Status::OK : Status::FAILED); };
+
+    if (follower && !Proto::isReadOnly(static_cast<OpCode>(req.op)) && req.op < static_cast<std::uint8_t>(OpCode::OP_COUNT))
+    {
+        res.status = static_cast<std::uint8_t>(Status::READ_ONLY);
+        return res;
+    }
+
+    std::string license = field(req.license, sizeof(req.license));
+    std::string sailing = field(req.sailingID, sizeof(req.sailingID));
+    std::string vessel  = field(req.vesselName, sizeof(req.vesselName));
+
+    switch (static_cast<OpCode>(req.op))
+    {
+        case OpCode::PING:
+            ok(true);
+            break;
+
+        case OpCode::VESSEL_CREATE:
+        {
+            VesselStatus s = Vessel::CreateVessel(vessel,
+                                                  static_cast<unsigned int>(req.arg0),
+                                                  static_cast<unsigned int>(req.arg1));
+            res.value = static_cast<std::int32_t>(s);
+            ok(s == VesselStatus::SUCCESS);
+            break;
+        }
+        case OpCode::VESSEL_DELETE:
+        {
+            VesselStatus s = Vessel::DeleteVessel(vessel);
+            res.value = static_cast<std::int32_t>(s);
+            ok(s == VesselStatus::SUCCESS);
+            break;
+        }
+        case OpCode::VESSEL_EXISTS:
+            ok(Vessel::isVesselExist(vessel));
+            break;
+
+        case OpCode::SAILING_CREATE:
+        {
+            SailingStatus s = Sailing::CreateSailing(field(req.city, sizeof(req.city)),
+                                                     vessel,
+                                                     field(req.date, sizeof(req.date)),
+                                                     field(req.time, sizeof(req.time)));
+            res.value = static_cast<std::int32_t>(s);
+            ok(s == SailingStatus::SUCCESS);
+            break;
+        }
+        case OpCode::SAILING_DELETE:
+            ok(Sailing::DeleteSailing(sailing));
+            break;
+        case OpCode::SAILING_EXISTS:
+            ok(StorageBackend::current().sailingExists(sailing));
+            break;
+        case OpCode::SAILING_SPACE:
+        {
+            Sailingrec rec{};
+            bool found = StorageBackend::current().findSailing(sailing, rec);
+            if (found)
+            {
+                res.hcl = rec.remainingHCL;
+                res.lcl = rec.remainingLCL;
+            }
+            ok(found);
+            break;
+        }
+        case OpCode::SAILING_COUNT:
+            res.value = StorageBackend::current().countReservations(sailing);
+            ok(res.value >= 0);
+            break;
+
+        case OpCode::RESERVE_NEW:
+        {
+            VehicleRecord v;
+            v.license  = license;
+            v.phone    = field(req.phone, sizeof(req.phone));
+            v.length_m = req.arg0;
+            v.height_m = req.arg1;
+            ok(Reservation::newCustomerReservation(v, sailing));
+            break;
+        }
+        case OpCode::RESERVE_RETURNING:
+            ok(Reservation::returningCustomerReservation(license, sailing));
+            break;
+        case OpCode::RESERVATION_DELETE:
+            ok(Reservation::deleteReservation(license, sailing));
+            break;
+        case OpCode::RESERVATION_EXISTS:
+            ok(StorageBackend::current().reservationExists(license, sailing));
+            break;
+        case OpCode::CHECKIN:
+            ok(Reservation::checkinVehicle(license, sailing));
+            break;
+        case OpCode::VEHICLE_EXISTS:
+            ok(Reservation::isVehicleExist(license));
+            break;
+
+        case OpCode::REPLICA_STATUS:
+        {
+            ReplicaStatus s = Replica::status();
+            res.value = static_cast<std::int32_t>(s.primaryLsn > s.appliedLsn ? s.primaryLsn - s.appliedLsn : 0);
+            res.hcl = static_cast<float>(s.lagSeconds);
+            ok(s.follower);
+            break;
+        }
+
+        default:
+            res.status = static_cast<std::uint8_t>(Status::BAD_REQUEST);
+            break;
+    }
+    return res;
+}
+
+} // namespace FerrySys
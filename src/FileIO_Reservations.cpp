@@ -3,23 +3,43 @@
 // CMPT 276 – Assignment 4 (Fahad Y)
 //
 // Implements binary I/O for ferry reservations:
-//   • Appending new reservations
-//   • Searching and deleting by license + sailing ID
+//   • Storing new reservations (reusing cancelled slots)
+//   • Searching and deleting (tombstoning) by license + sailing ID
 //   • Marking reservations as checked-in
 //   • Counting reservations per sailing
 //   • Computing available space per sailing
 //
 // Uses packed 27-byte struct to ensure consistent reads/writes.
 // License and Sailing ID comparisons are case-insensitive.
+// Flat-file lookups go through the hash indexes in IndexSnapshot.h when
+// they are available and fall back to a scan otherwise.
+// Rows whose status byte is REC_DEAD are skipped by every reader, refilled
+// by new bookings (see FreeList.h) and otherwise removed by compaction
+// (see Compaction.h).
 // ---------------------------------------------------------------------------
 
 #include "FileIO_Reservations.h"
+#include "Metrics.h"
 #include "FileIO_VehicleRecord.h"
 #include "FileIO_Sailings.h"
+#include "ParallelScan.h"
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+#include "DataFile.h"
+#include "FreeList.h"
+#include "IndexSnapshot.h"
+#include "ReservationPartitions.h"
+#include "ReservationLSM.h"
+#include "Archive.h"
 #include <fstream>
 #include <iostream>
-#include <cstdio>     // remove, rename
+#include <cstddef>    // offsetof
 #include <algorithm>  // transform for case-insensitive compare
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
 
 // ============================================================
 // Helper: Convert string to uppercase (case-insensitive compare)
@@ -33,11 +53,221 @@ static std::string toUpper(const std::string &s)
 }
 
 // ============================================================
-// Reset sequential read (no persistent pointer in this design)
+// Helper: open the flat file positioned at its first record
+// ============================================================
+static std::ifstream openFlatFile()
+{
+    std::ifstream file("reservations.dat", std::ios::binary);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (file)
+        FerrySys::skipHeader(file, sizeof(ReservationRec));
+    return file;
+}
+
+// ============================================================
+// Helper: live flat-file row matching (license, sailing) and its
+// slot, from the key index or a scan. `exact` compares the
+// fields as stored instead of case-insensitively.
+// ============================================================
+static bool locateFlat(const std::string &licensePlate, const std::string &sailingID,
+                       bool exact, ReservationRec &result, std::size_t &slot)
+{
+    std::ifstream file = openFlatFile();
+    if (!file) return false;
+    std::size_t base = static_cast<std::size_t>(file.tellg());
+
+    std::string searchLicense = toUpper(licensePlate);
+    std::string searchID = toUpper(sailingID);
+    auto matches = [&](ReservationRec &rec) {
+        if (rec.status == FerrySys::REC_DEAD)
+            return false;
+        std::string lic = FerrySys::decodeField(
+            reinterpret_cast<unsigned char*>(rec.licenseplate),
+            FerrySys::VEH_LIC_CHARS);
+        std::string sid = FerrySys::decodeField(
+            reinterpret_cast<unsigned char*>(rec.sailingID),
+            16);
+        if (exact)
+            return lic == licensePlate && sid == sailingID;
+        return toUpper(lic) == searchLicense && toUpper(sid) == searchID;
+    };
+
+    ReservationRec rec{};
+    std::vector<std::size_t> candidates;
+    if (FerrySys::IndexSnapshot::findReservation(licensePlate, sailingID, candidates))
+    {
+        for (std::size_t candidate : candidates)
+        {
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(base + candidate * sizeof(rec)));
+            if (!file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+                continue;
+            FerrySys::Metrics::recordRead(sizeof(rec));
+            if (matches(rec))
+            {
+                result = rec;
+                slot = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Index unavailable: linear scan
+    for (std::size_t i = 0; file.read(reinterpret_cast<char*>(&rec), sizeof(rec)); ++i)
+    {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (matches(rec))
+        {
+            result = rec;
+            slot = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================
+// Helper: overwrite the flat-file row at `slot`
+// ============================================================
+static bool rewriteFlat(std::size_t slot, const ReservationRec &rec)
+{
+    std::fstream file("reservations.dat",
+                      std::ios::binary | std::ios::in | std::ios::out);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (!file) return false;
+    std::size_t base = FerrySys::skipHeader(file, sizeof(rec));
+    if (base == FerrySys::BAD_HEADER) return false;
+
+    file.seekp(static_cast<std::streamoff>(base + slot * sizeof(rec)));
+    file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(rec));
+    return static_cast<bool>(file);
+}
+
+// ============================================================
+// Helper: live flat-file rows of one sailing from the sailing
+// index. Returns false if the index is unavailable.
+// ============================================================
+static bool indexedSailingRows(const std::string &sailingID, std::vector<ReservationRec> &rows)
+{
+    std::vector<std::size_t> slots;
+    if (!FerrySys::IndexSnapshot::findSailingReservations(sailingID, slots))
+        return false;
+    std::vector<ReservationRec> found(slots.size());
+    if (!slots.empty() &&
+        !FerrySys::readRecordsBatch("reservations.dat", sizeof(ReservationRec), slots, found.data()))
+        return false;
+
+    std::string searchID = toUpper(sailingID);
+    for (const auto &rec : found)
+    {
+        if (rec.status != FerrySys::REC_DEAD &&
+            toUpper(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec.sailingID), 16)) == searchID)
+            rows.push_back(rec);
+    }
+    return true;
+}
+
+// ============================================================
+// Storage mode (resolved once, see storageMode())
+// ============================================================
+namespace
+{
+    const char *const FLAT_FILE = "reservations.dat";
+    constexpr int MODE_UNKNOWN = -1;
+    std::atomic<int> modeValue{ MODE_UNKNOWN };
+    std::mutex       modeLock;
+
+    bool partitioned()
+    {
+        return FileIO_Reservations::storageMode() == ReservationStorage::PARTITIONED;
+    }
+
+    bool lsm()
+    {
+        return FileIO_Reservations::storageMode() == ReservationStorage::LSM;
+    }
+
+    // Above this many sailings one scan is cheaper than lookups
+    constexpr std::size_t SAILING_LOOKUP_LIMIT = 8;
+
+    // Flat-file slots mean nothing once the rows have moved
+    void forgetFlatSlots(int moved)
+    {
+        if (moved >= 0)
+        {
+            FerrySys::FreeList::clear(FerrySys::Table::RESERVATIONS);
+            FerrySys::Compactor::resetCounts();
+        }
+    }
+}
+
+ReservationStorage FileIO_Reservations::storageMode()
+{
+    int mode = modeValue.load(std::memory_order_acquire);
+    if (mode != MODE_UNKNOWN)
+        return static_cast<ReservationStorage>(mode);
+
+    std::lock_guard<std::mutex> guard(modeLock);
+    mode = modeValue.load(std::memory_order_acquire);
+    if (mode != MODE_UNKNOWN)
+        return static_cast<ReservationStorage>(mode);
+
+    ReservationStorage chosen = ReservationStorage::FLAT;
+    const char *env = std::getenv("FERRY_RES_STORAGE");
+    if (env && std::strcmp(env, "partitioned") == 0)
+        chosen = ReservationStorage::PARTITIONED;
+    else if (env && std::strcmp(env, "lsm") == 0)
+        chosen = ReservationStorage::LSM;
+    else if (!env && FerrySys::ReservationPartitions::present())
+        chosen = ReservationStorage::PARTITIONED;
+    else if (!env && FerrySys::ReservationLSM::present())
+        chosen = ReservationStorage::LSM;
+
+    if (chosen == ReservationStorage::PARTITIONED)
+        migrateToPartitions();
+    else if (chosen == ReservationStorage::LSM)
+        migrateToLSM();
+    modeValue.store(static_cast<int>(chosen), std::memory_order_release);
+    return chosen;
+}
+
+void FileIO_Reservations::setStorageMode(ReservationStorage mode)
+{
+    std::lock_guard<std::mutex> guard(modeLock);
+    if (mode == ReservationStorage::PARTITIONED)
+        migrateToPartitions();
+    else if (mode == ReservationStorage::LSM)
+        migrateToLSM();
+    modeValue.store(static_cast<int>(mode), std::memory_order_release);
+}
+
+int FileIO_Reservations::migrateToPartitions()
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::migrateToPartitions");
+    int moved = FerrySys::ReservationPartitions::migrate(FLAT_FILE);
+    forgetFlatSlots(moved);
+    return moved;
+}
+
+int FileIO_Reservations::migrateToLSM()
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::migrateToLSM");
+    int moved = FerrySys::ReservationLSM::migrate(FLAT_FILE);
+    forgetFlatSlots(moved);
+    return moved;
+}
+
+// ============================================================
+// Reset sequential read (flat mode keeps no pointer; partitioned
+// mode restarts from the first partition, LSM mode re-snapshots)
 // ============================================================
 void FileIO_Reservations::reset()
 {
-    // Each getNextReservation opens its own stream; nothing to reset
+    FerrySys::ReservationPartitions::resetCursor();
+    FerrySys::ReservationLSM::resetCursor();
 }
 
 // ============================================================
@@ -47,21 +277,30 @@ bool FileIO_Reservations::getNextReservation(std::string &licensePlate,
                                              SailingID &sailingID,
                                              bool &checkedIn)
 {
-    static std::ifstream file("reservations.dat", std::ios::binary);
+    FERRY_METRIC_SCOPE("FileIO_Reservations::getNextReservation");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::next(licensePlate, sailingID, checkedIn);
+    if (lsm())
+        return FerrySys::ReservationLSM::next(licensePlate, sailingID, checkedIn);
+
+    static std::ifstream file = openFlatFile();
 
     if (!file)
         return false;
 
     ReservationRec rec{};
-    if (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
     {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
         licensePlate = FerrySys::decodeField(
             reinterpret_cast<unsigned char*>(rec.licenseplate),
             FerrySys::VEH_LIC_CHARS);
         sailingID = FerrySys::decodeField(
             reinterpret_cast<unsigned char*>(rec.sailingID),
             16);
-        checkedIn = rec.checkedIn;
+        checkedIn = rec.status == RES_CHECKED_IN;
         return true;
     }
 
@@ -69,39 +308,29 @@ bool FileIO_Reservations::getNextReservation(std::string &licensePlate,
 }
 
 // ============================================================
-// Append new reservation to file
+// Store new reservation: reuse a cancelled slot or append
 // ============================================================
 bool FileIO_Reservations::writeReservation(const std::string &licensePlate,
                                            SailingID sailingID)
 {
-    // Check duplicate reservation
-    std::ifstream checkFile("reservations.dat", std::ios::binary);
-    if (checkFile)
-    {
-        ReservationRec rec{};
-        std::string searchLicense = toUpper(licensePlate);
-        std::string searchID = toUpper(sailingID);
+    FERRY_METRIC_SCOPE("FileIO_Reservations::writeReservation");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::write(licensePlate, sailingID);
+    if (lsm())
+        return FerrySys::ReservationLSM::write(licensePlate, sailingID);
 
-        while (checkFile.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
-        {
-            std::string currentLicense = toUpper(FerrySys::decodeField(
-                reinterpret_cast<unsigned char*>(rec.licenseplate),
-                FerrySys::VEH_LIC_CHARS));
-            std::string currentID = toUpper(FerrySys::decodeField(
-                reinterpret_cast<unsigned char*>(rec.sailingID),
-                16));
+    if (!FerrySys::DataFile::open(FerrySys::Table::RESERVATIONS, true))
+        return false;
 
-            if (currentLicense == searchLicense && currentID == searchID)
-            {
-                return false; // Duplicate found
-            }
-        }
+    // Check duplicate reservation
+    {
+        FERRY_TRACE_SPAN("FileIO_Reservations::writeReservation/duplicateScan");
+        ReservationRec existing{};
+        std::size_t slot = 0;
+        if (locateFlat(licensePlate, sailingID, false, existing, slot))
+            return false; // Duplicate found
     }
 
-    // Append reservation
-    std::ofstream file("reservations.dat", std::ios::binary | std::ios::app);
-    if (!file) return false;
-
     ReservationRec rec{};
     FerrySys::encodeField(licensePlate,
                           reinterpret_cast<unsigned char*>(rec.licenseplate),
@@ -109,127 +338,349 @@ bool FileIO_Reservations::writeReservation(const std::string &licensePlate,
     FerrySys::encodeField(sailingID,
                           reinterpret_cast<unsigned char*>(rec.sailingID),
                           16);
-    rec.checkedIn = false;
+    rec.status = RES_BOOKED;
+
+    // Fill a cancelled slot if one is free
+    if (FerrySys::FreeList::fill(FerrySys::Table::RESERVATIONS, &rec))
+        return true;
+
+    // Append reservation
+    FERRY_TRACE_SPAN("FileIO_Reservations::writeReservation/append");
+    std::size_t slot = FerrySys::DataFile::rows(FerrySys::Table::RESERVATIONS);
+    std::ofstream file("reservations.dat", std::ios::binary | std::ios::app);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (!file) return false;
 
     file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(rec));
+    file.close();
+    FerrySys::DataFile::noteAppended(FerrySys::Table::RESERVATIONS);
+    FerrySys::IndexSnapshot::noteInsert(FerrySys::Table::RESERVATIONS, slot, &rec);
     return true;
 }
 
 
 // ============================================================
-// Mark reservation as checked-in
+// Store several reservations, all or none
 // ============================================================
-bool FileIO_Reservations::writeCheckin(const std::string &licensePlate,
-                                       SailingID sailingID)
+bool FileIO_Reservations::writeReservations(const std::vector<std::pair<std::string, SailingID>> &bookings)
 {
-    std::fstream file("reservations.dat",
-                      std::ios::binary | std::ios::in | std::ios::out);
-    if (!file)
-        return false;
+    FERRY_METRIC_SCOPE("FileIO_Reservations::writeReservations");
+    if (bookings.empty())
+        return true;
 
-    ReservationRec rec{};
-    std::string searchLicense = toUpper(licensePlate);
-    std::string searchID = toUpper(sailingID);
+    // A key twice in the batch is a duplicate of itself
+    auto keyOf = [](const std::string &license, const std::string &sailingID) {
+        return toUpper(license) + '\n' + toUpper(sailingID);
+    };
+    std::unordered_set<std::string> keys;
+    for (const auto &booking : bookings)
+    {
+        if (!keys.insert(keyOf(booking.first, booking.second)).second)
+            return false;
+    }
 
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+    if (partitioned() || lsm())
     {
-        std::string currentLicense = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.licenseplate),
-            FerrySys::VEH_LIC_CHARS));
-        std::string currentID = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.sailingID),
-            16));
+        for (std::size_t i = 0; i < bookings.size(); ++i)
+        {
+            if (writeReservation(bookings[i].first, bookings[i].second))
+                continue;
+            while (i-- > 0)
+                deleteReservation(bookings[i].first, bookings[i].second);
+            return false;
+        }
+        return true;
+    }
 
-        if (currentLicense == searchLicense && currentID == searchID)
+    if (!FerrySys::DataFile::open(FerrySys::Table::RESERVATIONS, true))
+        return false;
+
+    // Already booked? Every index candidate in one batched read
+    {
+        FERRY_TRACE_SPAN("FileIO_Reservations::writeReservations/duplicateCheck");
+        std::vector<std::pair<std::string_view, std::string_view>> wanted;
+        for (const auto &booking : bookings)
+            wanted.emplace_back(booking.first, booking.second.view());
+        FerrySys::IndexSnapshot::Hits hits;
+        if (FerrySys::IndexSnapshot::findReservations(wanted, hits))
         {
-            rec.checkedIn = true;
-            file.seekp(-static_cast<int>(sizeof(rec)), std::ios::cur);
-            file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
-            return true;
+            std::vector<std::size_t> slots;
+            for (const auto &hit : hits)
+                slots.push_back(hit.second);
+            std::vector<ReservationRec> rows(slots.size());
+            if (!FerrySys::readRecordsBatch("reservations.dat", sizeof(ReservationRec), slots, rows.data()))
+                return false;
+            for (ReservationRec &rec : rows)
+            {
+                if (rec.status == FerrySys::REC_DEAD)
+                    continue;
+                std::string lic = FerrySys::decodeField(reinterpret_cast<unsigned char*>(rec.licenseplate),
+                                                        FerrySys::VEH_LIC_CHARS);
+                std::string sid = FerrySys::decodeField(reinterpret_cast<unsigned char*>(rec.sailingID), 16);
+                if (keys.count(keyOf(lic, sid)))
+                    return false;
+            }
+        }
+        else
+        {
+            // Index unavailable: one lookup each
+            for (const auto &booking : bookings)
+            {
+                ReservationRec existing{};
+                std::size_t slot = 0;
+                if (locateFlat(booking.first, booking.second, false, existing, slot))
+                    return false;
+            }
         }
     }
 
-    return false;
+    std::vector<ReservationRec> recs(bookings.size());
+    for (std::size_t i = 0; i < bookings.size(); ++i)
+    {
+        FerrySys::encodeField(bookings[i].first,
+                              reinterpret_cast<unsigned char*>(recs[i].licenseplate),
+                              FerrySys::VEH_LIC_CHARS);
+        FerrySys::encodeField(bookings[i].second,
+                              reinterpret_cast<unsigned char*>(recs[i].sailingID),
+                              16);
+        recs[i].status = RES_BOOKED;
+    }
+
+    FERRY_TRACE_SPAN("FileIO_Reservations::writeReservations/append");
+    std::size_t slot = FerrySys::DataFile::rows(FerrySys::Table::RESERVATIONS);
+    std::ofstream file("reservations.dat", std::ios::binary | std::ios::app);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (!file) return false;
+
+    file.write(reinterpret_cast<const char*>(recs.data()),
+               static_cast<std::streamsize>(recs.size() * sizeof(ReservationRec)));
+    file.close();
+    if (!file) return false;
+    FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, recs.size() * sizeof(ReservationRec));
+    FerrySys::DataFile::noteAppended(FerrySys::Table::RESERVATIONS, recs.size());
+    FerrySys::IndexSnapshot::noteInserts(FerrySys::Table::RESERVATIONS, slot, recs.data(), recs.size());
+    return true;
+}
+
+// ============================================================
+// Mark reservation as checked-in
+// ============================================================
+bool FileIO_Reservations::writeCheckin(const std::string &licensePlate,
+                                       SailingID sailingID)
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::writeCheckin");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::checkin(licensePlate, sailingID);
+    if (lsm())
+        return FerrySys::ReservationLSM::checkin(licensePlate, sailingID);
+
+    ReservationRec rec{};
+    std::size_t slot = 0;
+    if (!locateFlat(licensePlate, sailingID, false, rec, slot))
+        return false;
+
+    rec.status = RES_CHECKED_IN;
+    return rewriteFlat(slot, rec);
 }
 
 // ============================================================
-// Delete specific reservation (case-insensitive, safe rewrite)
+// Delete specific reservation (case-insensitive): the status
+// byte is flipped to REC_DEAD in place, nothing is rewritten
 // ============================================================
 bool FileIO_Reservations::deleteReservation(const std::string &licensePlate,
                                             SailingID sailingID)
 {
-    std::ifstream inFile("reservations.dat", std::ios::binary);
-    if (!inFile)
-        return false;
+    FERRY_METRIC_SCOPE("FileIO_Reservations::deleteReservation");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::remove(licensePlate, sailingID);
+    if (lsm())
+        return FerrySys::ReservationLSM::remove(licensePlate, sailingID);
 
-    std::ofstream outFile("temp.dat", std::ios::binary);
-    if (!outFile)
+    ReservationRec rec{};
+    std::size_t slot = 0;
+    if (!locateFlat(licensePlate, sailingID, false, rec, slot))
         return false;
 
-    ReservationRec rec{};
-    bool found = false;
+    rec.status = FerrySys::REC_DEAD;
+    if (!rewriteFlat(slot, rec))
+        return false;
+    FerrySys::Compactor::noteDead(FerrySys::Table::RESERVATIONS);
+    FerrySys::FreeList::push(FerrySys::Table::RESERVATIONS, { slot });
+    return true;
+}
 
-    std::string searchLicense = toUpper(licensePlate);
-    std::string searchID = toUpper(sailingID);
+// ============================================================
+// Cascade: tombstone all reservations of the given sailings in
+// one pass
+// ============================================================
+int FileIO_Reservations::deleteReservationsForSailings(const std::vector<SailingID> &sailingIDs)
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::deleteReservationsForSailings");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::dropSailings(sailingIDs);
+    if (lsm())
+        return FerrySys::ReservationLSM::dropSailings(sailingIDs);
+
+    std::unordered_set<std::string> doomed;
+    for (const auto &id : sailingIDs)
+        doomed.insert(toUpper(id));
+
+    std::size_t removed = 0;
+    std::vector<std::size_t> slots;
+    FerrySys::tombstoneRecordsIf("reservations.dat", sizeof(ReservationRec),
+        offsetof(ReservationRec, status),
+        [&doomed](const void *bytes) {
+            const auto *rec = static_cast<const ReservationRec*>(bytes);
+            return doomed.count(toUpper(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec->sailingID),
+                16))) > 0;
+        },
+        removed, &slots);
+
+    if (removed > 0)
+    {
+        FerrySys::Compactor::noteDead(FerrySys::Table::RESERVATIONS, removed);
+        FerrySys::FreeList::push(FerrySys::Table::RESERVATIONS, slots);
+    }
+    return static_cast<int>(removed);
+}
 
-    while (inFile.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+// ============================================================
+// Collect the live reservations of several sailings (one pass in
+// flat mode, one partition / key range each otherwise)
+// ============================================================
+bool FileIO_Reservations::readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                                      std::vector<ReservationRec> &rows)
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::readReservationsForSailings");
+    if (partitioned())
     {
-        std::string currentLicense = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.licenseplate),
-            FerrySys::VEH_LIC_CHARS));
-        std::string currentID = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.sailingID),
-            16));
-        if (currentLicense == searchLicense && currentID == searchID)
-        {
-            found = true; // Skip this record 
-        }
-        else
+        bool ok = true;
+        std::vector<ReservationRec> part;
+        for (const auto &id : sailingIDs)
         {
-            outFile.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            ok &= FerrySys::ReservationPartitions::read(id, part) || FerrySys::ReservationPartitions::count(id) == 0;
+            rows.insert(rows.end(), part.begin(), part.end());
         }
+        return ok;
     }
-
-    inFile.close();
-    outFile.close();
-
-    if (found)
+    if (lsm())
     {
-        std::remove("reservations.dat");
-        std::rename("temp.dat", "reservations.dat");
+        for (const auto &id : sailingIDs)
+            FerrySys::ReservationLSM::read(id, rows);
+        return true;
     }
-    else
+
+    // A few sailings: their index entries beat a pass over the file
+    if (sailingIDs.size() <= SAILING_LOOKUP_LIMIT)
     {
-        std::remove("temp.dat");
+        std::vector<ReservationRec> found;
+        bool indexed = true;
+        for (const auto &id : sailingIDs)
+            indexed = indexed && indexedSailingRows(id, found);
+        if (indexed)
+        {
+            rows.insert(rows.end(), found.begin(), found.end());
+            return true;
+        }
     }
 
-    return found;
+    std::unordered_set<std::string> wanted;
+    for (const auto &id : sailingIDs)
+        wanted.insert(toUpper(id));
+
+    using Rows = std::vector<ReservationRec>;
+    Rows found;
+    bool scanned = FerrySys::parallelScan(
+        "reservations.dat", sizeof(ReservationRec), found,
+        [&wanted](Rows &part, std::size_t, const unsigned char *bytes) {
+            const auto *rec = reinterpret_cast<const ReservationRec*>(bytes);
+            if (rec->status == FerrySys::REC_DEAD)
+                return;
+            if (wanted.count(toUpper(FerrySys::decodeField(
+                    reinterpret_cast<const unsigned char*>(rec->sailingID), 16))) > 0)
+                part.push_back(*rec);
+        },
+        [](Rows &out, Rows &&part) { out.insert(out.end(), part.begin(), part.end()); });
+    if (!scanned)
+        return false;
+    rows.insert(rows.end(), found.begin(), found.end());
+    return true;
 }
 
 // ============================================================
 // Count reservations for a given sailing (case-insensitive ID)
 // ============================================================
-int FileIO_Reservations::countReservationsForSailing(SailingID sailingID)
+int FileIO_Reservations::countReservationsForSailing(SailingID sailingID, bool includeArchive)
 {
-    std::ifstream file("reservations.dat", std::ios::binary);
-    if (!file)
-        return 0;
+    FERRY_METRIC_SCOPE("FileIO_Reservations::countReservationsForSailing");
+    if (includeArchive && !FileIO_Sailings::Sailingexist(sailingID))
+        return std::max(FerrySys::Archive::countReservations(sailingID), 0);
+
+    if (partitioned())
+        return FerrySys::ReservationPartitions::count(sailingID);
+    if (lsm())
+        return FerrySys::ReservationLSM::count(sailingID);
+
+    std::vector<ReservationRec> rows;
+    if (indexedSailingRows(sailingID, rows))
+        return static_cast<int>(rows.size());
 
-    ReservationRec rec{};
-    int count = 0;
     std::string searchID = toUpper(sailingID);
 
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
-    {
-        std::string currentID = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.sailingID),
-            16));
+    std::size_t count = 0;
+    bool scanned = FerrySys::parallelScan(
+        "reservations.dat", sizeof(ReservationRec), count,
+        [&searchID](std::size_t &n, std::size_t, const unsigned char *bytes) {
+            const auto *rec = reinterpret_cast<const ReservationRec*>(bytes);
+            if (rec->status == FerrySys::REC_DEAD)
+                return;
+            std::string currentID = toUpper(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec->sailingID),
+                16));
+            if (currentID == searchID)
+                ++n;
+        },
+        [](std::size_t &total, std::size_t &&part) { total += part; });
+
+    return scanned ? static_cast<int>(count) : -1;
+}
 
-        if (currentID == searchID)
-            count++;
+// ============================================================
+// Bulk count: reservations per sailing (upper-cased IDs), one
+// parallel pass over the whole file
+// ============================================================
+bool FileIO_Reservations::countReservationsBySailing(std::unordered_map<std::string, int> &counts)
+{
+    FERRY_METRIC_SCOPE("FileIO_Reservations::countReservationsBySailing");
+    if (partitioned())
+    {
+        counts = FerrySys::ReservationPartitions::countAll();
+        return true;
+    }
+    if (lsm())
+    {
+        counts = FerrySys::ReservationLSM::countAll();
+        return true;
     }
 
-    return count;
+    using Counts = std::unordered_map<std::string, int>;
+    counts.clear();
+    return FerrySys::parallelScan(
+        "reservations.dat", sizeof(ReservationRec), counts,
+        [](Counts &counts, std::size_t, const unsigned char *bytes) {
+            const auto *rec = reinterpret_cast<const ReservationRec*>(bytes);
+            if (rec->status == FerrySys::REC_DEAD)
+                return;
+            ++counts[toUpper(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec->sailingID),
+                16))];
+        },
+        [](Counts &total, Counts &&part) {
+            for (const auto &kv : part)
+                total[kv.first] += kv.second;
+        });
 }
 
 // ============================================================
@@ -237,38 +688,63 @@ int FileIO_Reservations::countReservationsForSailing(SailingID sailingID)
 // ============================================================
 int FileIO_Reservations::spaceAvailable(SailingID sailingID)
 {
+    FERRY_METRIC_SCOPE("FileIO_Reservations::spaceAvailable");
     Sailingrec sailing;
     if (!FileIO_Sailings::findSailing(sailingID, sailing))
         return -1;
 
-    std::ifstream file("reservations.dat", std::ios::binary);
-    if (!file)
-        return sailing.remainingHCL + sailing.remainingLCL;
-
-    ReservationRec rec{};
-    int usedHCL = 0, usedLCL = 0;
-    std::string searchID = toUpper(sailingID);
-
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+    // Licenses booked on this sailing
+    std::vector<std::string> licenses;
+    if (partitioned() || lsm())
     {
-        std::string currentID = toUpper(FerrySys::decodeField(
-            reinterpret_cast<unsigned char*>(rec.sailingID),
-            16));
+        std::vector<ReservationRec> rows;
+        if (partitioned())
+            FerrySys::ReservationPartitions::read(sailingID, rows);
+        else
+            FerrySys::ReservationLSM::read(sailingID, rows);
+        for (const auto &rec : rows)
+            licenses.push_back(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec.licenseplate),
+                FerrySys::VEH_LIC_CHARS));
+    }
+    else if (std::vector<ReservationRec> rows; indexedSailingRows(sailingID, rows))
+    {
+        for (const auto &rec : rows)
+            licenses.push_back(FerrySys::decodeField(
+                reinterpret_cast<const unsigned char*>(rec.licenseplate),
+                FerrySys::VEH_LIC_CHARS));
+    }
+    else
+    {
+        std::ifstream file = openFlatFile();
 
-        if (currentID == searchID)
+        ReservationRec rec{};
+        std::string searchID = toUpper(sailingID);
+        while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
         {
-            std::string license = FerrySys::decodeField(
-                reinterpret_cast<unsigned char*>(rec.licenseplate),
-                FerrySys::VEH_LIC_CHARS);
+            FerrySys::Metrics::recordRead(sizeof(rec));
+            if (rec.status == FerrySys::REC_DEAD)
+                continue;
+            std::string currentID = toUpper(FerrySys::decodeField(
+                reinterpret_cast<unsigned char*>(rec.sailingID),
+                16));
+            if (currentID == searchID)
+                licenses.push_back(FerrySys::decodeField(
+                    reinterpret_cast<unsigned char*>(rec.licenseplate),
+                    FerrySys::VEH_LIC_CHARS));
+        }
+    }
 
-            FerrySys::VehicleRecord vehicle;
-            if (FerrySys::FileIO_VehicleRecord::findVehicle(license, vehicle))
-            {
-                if (vehicle.isSpecial())
-                    usedHCL++;
-                else
-                    usedLCL++;
-            }
+    int usedHCL = 0, usedLCL = 0;
+    for (const auto &license : licenses)
+    {
+        FerrySys::VehicleRecord vehicle;
+        if (FerrySys::FileIO_VehicleRecord::findVehicle(license, vehicle))
+        {
+            if (vehicle.isSpecial())
+                usedHCL++;
+            else
+                usedLCL++;
         }
     }
 
@@ -280,29 +756,13 @@ int FileIO_Reservations::spaceAvailable(SailingID sailingID)
 bool FileIO_Reservations::reservationExists(const std::string &licensePlate,
                                             SailingID sailingID)
 {
-    std::ifstream file("reservations.dat", std::ios::binary);
-    if (!file) return false;
-
-    ReservationRec rec;
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(ReservationRec)))
-    {
-        // Decode both fields with trimming
-        std::string lic = FerrySys::decodeField(
-            reinterpret_cast<const unsigned char*>(rec.licenseplate),
-            FerrySys::VEH_LIC_CHARS
-        );
-
-        std::string sid = FerrySys::decodeField(
-            reinterpret_cast<const unsigned char*>(rec.sailingID),
-            16
-        );
+    FERRY_METRIC_SCOPE("FileIO_Reservations::reservationExists");
+    if (partitioned())
+        return FerrySys::ReservationPartitions::exists(licensePlate, sailingID);
+    if (lsm())
+        return FerrySys::ReservationLSM::exists(licensePlate, sailingID);
 
-        // Compare normalized strings
-        if (lic == licensePlate && sid == sailingID)
-            return true;
-    }
-    return false;
+    ReservationRec rec{};
+    std::size_t slot = 0;
+    return locateFlat(licensePlate, sailingID, true, rec, slot);
 }
-
-
-
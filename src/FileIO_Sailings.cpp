@@ -7,22 +7,145 @@
 //    Implements binary file I/O for ferry sailings with fixed-size
 //    fields to ensure predictable storage and retrieval. Supports
 //    adding, searching, deleting, updating, and reporting sailings.
+//    Deleted sailings are tombstoned (status byte REC_DEAD) and
+//    skipped by every reader until compaction removes them.
+//    Lookups by ID are answered from the in-memory columns of
+//    SailingTable.h, which every change here writes through to.
+//    Should the table be unreadable they go through the
+//    sailings.idx B+tree (see SailingIndex.h), and fall back to a
+//    linear scan only when the index cannot be read or built.
+//    Space updates re-read their record under an OFD lock on it.
 //************************************************************
 //************************************************************
 
 #include "FileIO_Sailings.h"
+#include "Metrics.h"
 #include "FileIO_Reservations.h"
+#include "ParallelScan.h"
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+#include "DataFile.h"
+#include "SailingIndex.h"
+#include "SailingTable.h"
+#include "Archive.h"
 #include <iostream>
 #include <fstream>
-#include <iomanip>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <unistd.h>
+#include <unordered_set>
 
 //------------------------------------------------------------
-// Helper: Sanitize char[] to std::string (strip trailing \0)
+// Helper: Sanitize char[] to std::string (strip trailing \0; a
+// field filled to its end has none, so never read past it)
 //------------------------------------------------------------
-static std::string sanitizeCharArray(const char* raw) {
-    std::string s(raw);
-    return s.substr(0, s.find('\0'));
+template <std::size_t N>
+static std::string sanitizeCharArray(const char (&raw)[N]) {
+    return std::string(raw, strnlen(raw, N));
+}
+
+//------------------------------------------------------------
+// Helper: find live sailing `sailingID`; `slot` receives its
+// record index. Candidates from the index are re-checked against
+// the record, since index entries may point at dead rows.
+//------------------------------------------------------------
+static bool locateSailing(const SailingID &sailingID, Sailingrec &result, std::size_t &slot) {
+    bool found = false;
+    if (FerrySys::SailingTable::find(sailingID, found, result, slot))
+        return found;
+
+    std::ifstream file("sailings.dat", std::ios::binary);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (!file) return false;
+    std::size_t base = FerrySys::skipHeader(file, sizeof(Sailingrec));
+    if (base == FerrySys::BAD_HEADER) return false;
+
+    Sailingrec rec{};
+    std::vector<std::size_t> candidates;
+    if (FerrySys::SailingIndex::find(sailingID, candidates)) {
+        for (std::size_t candidate : candidates) {
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(base + candidate * sizeof(rec)));
+            if (!file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+                continue;
+            FerrySys::Metrics::recordRead(sizeof(rec));
+            if (rec.status != FerrySys::REC_DEAD && sanitizeCharArray(rec.id) == sailingID) {
+                result = rec;
+                slot = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Index unavailable: linear scan
+    for (std::size_t i = 0; file.read(reinterpret_cast<char*>(&rec), sizeof(rec)); ++i) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
+        if (sanitizeCharArray(rec.id) == sailingID) {
+            result = rec;
+            slot = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------
+// Helper: read-modify-write the record of live sailing
+// `sailingID` in place. The record is read again from the file,
+// not the table, under an OFD write lock on its bytes, so two
+// processes (or threads) changing one sailing take turns and
+// neither writes back values the other has replaced. `change`
+// edits the record and returns false to leave the file as it
+// is. The table is told before the lock is dropped, so it
+// applies changes to one sailing in file order. False if the
+// sailing is gone or has moved (the table was behind), or on
+// I/O error.
+//------------------------------------------------------------
+static bool changeSailing(const SailingID &sailingID, const std::function<bool(Sailingrec &)> &change) {
+    Sailingrec rec{};
+    std::size_t slot = 0;
+    if (!locateSailing(sailingID, rec, slot))
+        return false;
+
+    int fd = ::open("sailings.dat", O_RDWR | O_CLOEXEC);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (fd < 0) return false;
+    std::size_t base = FerrySys::dataOffset(fd, sizeof(Sailingrec));
+    off_t at = static_cast<off_t>(base + slot * sizeof(rec));
+
+    struct flock range{};
+    range.l_type = F_WRLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = at;
+    range.l_len = static_cast<off_t>(sizeof(rec));
+    bool ok = base != FerrySys::BAD_HEADER;
+    if (ok) {
+        int rc;
+        do
+            rc = ::fcntl(fd, F_OFD_SETLKW, &range);
+        while (rc != 0 && errno == EINTR);
+        ok = rc == 0;
+    }
+    ok = ok && ::pread(fd, &rec, sizeof(rec), at) == static_cast<ssize_t>(sizeof(rec));
+    if (ok)
+        FerrySys::Metrics::recordRead(sizeof(rec));
+    ok = ok && rec.status != FerrySys::REC_DEAD && sanitizeCharArray(rec.id) == sailingID;
+    if (ok && change(rec)) {
+        ok = ::pwrite(fd, &rec, sizeof(rec), at) == static_cast<ssize_t>(sizeof(rec));
+        FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(rec));
+        if (ok)
+            FerrySys::SailingTable::noteSpace(sailingID, rec.remainingHCL, rec.remainingLCL);
+    }
+    ::close(fd);    // drops the lock
+    return ok;
 }
 
 //------------------------------------------------------------
@@ -34,11 +157,17 @@ bool FileIO_Sailings::getNextSailing(
     float &remainingHCL,
     float &remainingLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::getNextSailing");
     std::fstream file("sailings.dat", std::ios::binary | std::ios::in);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file) return false;
+    FerrySys::skipHeader(file, sizeof(Sailingrec));
 
     Sailingrec rec{};
-    if (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
         sailingID = sanitizeCharArray(rec.id);
         vesselName = sanitizeCharArray(rec.VesselName);
         remainingHCL = rec.remainingHCL;
@@ -58,7 +187,14 @@ void FileIO_Sailings::writeSailing(
     float remainingHCL,
     float remainingLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::writeSailing");
+    if (!FerrySys::DataFile::open(FerrySys::Table::SAILINGS, true)) {
+        std::cerr << "Error: Unable to open sailings.dat for writing!\n";
+        return;
+    }
+    std::size_t slot = FerrySys::fileRecordCount("sailings.dat", sizeof(Sailingrec));
     std::fstream file("sailings.dat", std::ios::binary | std::ios::app);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file) {
         std::cerr << "Error: Unable to open sailings.dat for writing!\n";
         return;
@@ -66,85 +202,128 @@ void FileIO_Sailings::writeSailing(
 
     Sailingrec rec{};
     std::memset(rec.id, '\0', sizeof(rec.id));
-    std::strncpy(rec.id, sailingID.c_str(), sizeof(rec.id) - 1);
+    std::memcpy(rec.id, sailingID.data(), std::min(sailingID.size(), sizeof(rec.id) - 1));
 
     std::memset(rec.VesselName, '\0', sizeof(rec.VesselName));
     std::strncpy(rec.VesselName, vesselName.c_str(), sizeof(rec.VesselName) - 1);
+    rec.status = FerrySys::REC_LIVE;
 
     rec.remainingHCL = remainingHCL;
     rec.remainingLCL = remainingLCL;
 
     file.write(reinterpret_cast<const char*>(&rec), sizeof(Sailingrec));
+    FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(Sailingrec));
+    file.close();
+    FerrySys::DataFile::noteAppended(FerrySys::Table::SAILINGS);
+    FerrySys::SailingIndex::insert(sailingID, slot);
+    FerrySys::SailingTable::noteWritten(rec, slot);
 }
 
 //------------------------------------------------------------
 // Find sailing record by ID
 //------------------------------------------------------------
-bool FileIO_Sailings::findSailing(SailingID sailingID, Sailingrec &result) {
-    std::fstream file("sailings.dat", std::ios::binary | std::ios::in);
-    if (!file) return false;
-
-    Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingID) {
-            result = rec;
-            return true;
-        }
-    }
-    return false;
+bool FileIO_Sailings::findSailing(SailingID sailingID, Sailingrec &result, bool includeArchive) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::findSailing");
+    std::size_t slot = 0;
+    if (locateSailing(sailingID, result, slot))
+        return true;
+    return includeArchive && FerrySys::Archive::findSailing(sailingID, result);
 }
 
 //------------------------------------------------------------
-// Delete sailing by ID (cascade reservations)
+// Helper: tombstone every sailing matching `match` in one pass
+// over sailings.dat, then all of their reservations in one pass
+// over reservations.dat
 //------------------------------------------------------------
-bool FileIO_Sailings::deleteSailing(SailingID sailingIDtoDelete) {
-    std::ifstream file("sailings.dat", std::ios::binary);
-    if (!file) {
-        std::cerr << "Error: Unable to open sailings.dat for reading!\n";
-        return false;
+static int deleteSailingsWhere(const std::function<bool(const std::string &)> &match,
+                               std::vector<SailingID> &removed)
+{
+    std::size_t before = removed.size();
+    std::size_t count = 0;
+    std::vector<std::size_t> slots;
+
+    bool ok = FerrySys::tombstoneRecordsIf("sailings.dat", sizeof(Sailingrec),
+        offsetof(Sailingrec, status),
+        [&](const void *bytes) {
+            const auto *rec = static_cast<const Sailingrec*>(bytes);
+            std::string id = sanitizeCharArray(rec->id);
+            if (!match(id))
+                return false;
+            removed.push_back(id);
+            return true;
+        },
+        count, &slots);
+
+    if (!ok) {
+        std::cerr << "Error: Unable to update sailings.dat!\n";
+        return 0;
     }
 
-    std::ofstream temp("temp.dat", std::ios::binary);
-    if (!temp) {
-        std::cerr << "Error: Unable to open temp.dat for writing!\n";
-        return false;
+    std::vector<SailingID> gone(removed.begin() + before, removed.end());
+    for (std::size_t i = 0; i < gone.size() && i < slots.size(); ++i)
+        FerrySys::SailingIndex::erase(gone[i], slots[i]);
+    if (!gone.empty()) {
+        FerrySys::Compactor::noteDead(FerrySys::Table::SAILINGS, gone.size());
+        FerrySys::SailingTable::noteDeleted(gone);
+        FileIO_Reservations::deleteReservationsForSailings(gone);
     }
 
-    Sailingrec rec{};
-    bool found = false;
+    return static_cast<int>(count);
+}
 
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingIDtoDelete) {
-            found = true;
-        } else {
-            temp.write(reinterpret_cast<char*>(&rec), sizeof(rec));
-        }
-    }
+//------------------------------------------------------------
+// Delete sailing by ID (cascade reservations)
+//------------------------------------------------------------
+bool FileIO_Sailings::deleteSailing(SailingID sailingIDtoDelete) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::deleteSailing");
+    std::vector<SailingID> removed;
+    return deleteSailingsWhere(
+        [&](const std::string &id) { return id == sailingIDtoDelete; },
+        removed) > 0;
+}
 
-    file.close();
-    temp.close();
+//------------------------------------------------------------
+// Delete a list of sailings (cascade reservations)
+//------------------------------------------------------------
+int FileIO_Sailings::deleteSailings(const std::vector<SailingID> &sailingIDs,
+                                    std::vector<SailingID> &removed) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::deleteSailings");
+    std::unordered_set<std::string> doomed(sailingIDs.begin(), sailingIDs.end());
+    return deleteSailingsWhere(
+        [&](const std::string &id) { return doomed.count(id) > 0; },
+        removed);
+}
 
-    std::remove("sailings.dat");
-    std::rename("temp.dat", "sailings.dat");
+//------------------------------------------------------------
+// Delete all sailings on a day (ID format ttt:dd:hh)
+//------------------------------------------------------------
+int FileIO_Sailings::deleteSailingsOnDay(const std::string &day,
+                                         std::vector<SailingID> &removed) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::deleteSailingsOnDay");
+    return deleteSailingsWhere(
+        [&](const std::string &id) { return id.size() >= 6 && id.compare(4, 2, day) == 0; },
+        removed);
+}
 
-    return found;
+//------------------------------------------------------------
+// Delete all sailings to an arrival city (ID format ttt:dd:hh)
+//------------------------------------------------------------
+int FileIO_Sailings::deleteSailingsToCity(const std::string &city,
+                                          std::vector<SailingID> &removed) {
+    FERRY_METRIC_SCOPE("FileIO_Sailings::deleteSailingsToCity");
+    return deleteSailingsWhere(
+        [&](const std::string &id) { return id.size() >= 3 && id.compare(0, 3, city) == 0; },
+        removed);
 }
 
 //------------------------------------------------------------
 // Check if sailing exists by ID
 //------------------------------------------------------------
 bool FileIO_Sailings::Sailingexist(SailingID sailingID) {
-    std::fstream file("sailings.dat", std::ios::binary | std::ios::in);
-    if (!file) return false;
-
+    FERRY_METRIC_SCOPE("FileIO_Sailings::Sailingexist");
     Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingID) {
-            return true;
-        }
-    }
-
-    return false;
+    std::size_t slot = 0;
+    return locateSailing(sailingID, rec, slot);
 }
 
 //------------------------------------------------------------
@@ -155,18 +334,14 @@ bool FileIO_Sailings::getRemainingSpace(
     float &remainingHCL,
     float &remainingLCL
 ) {
-    std::ifstream file("sailings.dat", std::ios::binary);
-    if (!file) return false;
-
+    FERRY_METRIC_SCOPE("FileIO_Sailings::getRemainingSpace");
     Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingID) {
-            remainingHCL = rec.remainingHCL;
-            remainingLCL = rec.remainingLCL;
-            return true;
-        }
-    }
-    return false;
+    std::size_t slot = 0;
+    if (!locateSailing(sailingID, rec, slot))
+        return false;
+    remainingHCL = rec.remainingHCL;
+    remainingLCL = rec.remainingLCL;
+    return true;
 }
 
 //------------------------------------------------------------
@@ -174,90 +349,139 @@ bool FileIO_Sailings::getRemainingSpace(
 //------------------------------------------------------------
 bool FileIO_Sailings::updateSailingSpace(SailingID sailingID, float carLength, float carHeight, int amount)
 {
-    std::fstream file("sailings.dat", std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) return false;
-
-    Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingID) {
-
-            // Add buffer for parking space
-            float spaceNeeded = carLength + 0.5f;
-
-            // Determine if this should use HCL or LCL
-            bool useHCL = false;
-            if (spaceNeeded > 7 && carHeight > 2) {
-                useHCL = true;
-            } else if (rec.remainingLCL <= 0 && amount < 0) {
-                // fallback if LCL is full when adding
-                useHCL = true;
-            }
+    FERRY_METRIC_SCOPE("FileIO_Sailings::updateSailingSpace");
+    return changeSailing(sailingID, [&](Sailingrec &rec) {
+        // Add buffer for parking space
+        float spaceNeeded = carLength + 0.5f;
+
+        // Determine if this should use HCL or LCL
+        bool useHCL = false;
+        if (spaceNeeded > 7 && carHeight > 2) {
+            useHCL = true;
+        } else if (rec.remainingLCL <= 0 && amount < 0) {
+            // fallback if LCL is full when adding
+            useHCL = true;
+        }
 
-            // Adjust remaining space (in meters)
-            if (useHCL)
-                rec.remainingHCL += (amount * spaceNeeded);
-            else
-                rec.remainingLCL += (amount * spaceNeeded);
+        // Adjust remaining space (in meters)
+        if (useHCL)
+            rec.remainingHCL += (amount * spaceNeeded);
+        else
+            rec.remainingLCL += (amount * spaceNeeded);
 
-            // Clamp to avoid negative space
-            if (rec.remainingHCL < 0) rec.remainingHCL = 0;
-            if (rec.remainingLCL < 0) rec.remainingLCL = 0;
+        // Clamp to avoid negative space
+        if (rec.remainingHCL < 0) rec.remainingHCL = 0;
+        if (rec.remainingLCL < 0) rec.remainingLCL = 0;
+        return true;
+    });
+}
 
-            file.seekp(-static_cast<int>(sizeof(rec)), std::ios::cur);
-            file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
-            return true;
-        }
-    }
+//------------------------------------------------------------
+// Overwrite remaining space (capacity table write-back)
+//------------------------------------------------------------
+bool FileIO_Sailings::setRemainingSpace(SailingID sailingID, float remainingHCL, float remainingLCL)
+{
+    FERRY_METRIC_SCOPE("FileIO_Sailings::setRemainingSpace");
+    return changeSailing(sailingID, [&](Sailingrec &rec) {
+        rec.remainingHCL = remainingHCL;
+        rec.remainingLCL = remainingLCL;
+        return true;
+    });
+}
 
-    return false;
+//------------------------------------------------------------
+// Add to remaining space as it is on disk now
+//------------------------------------------------------------
+bool FileIO_Sailings::adjustRemainingSpace(SailingID sailingID, float deltaHCL, float deltaLCL,
+                                           float &remainingHCL, float &remainingLCL)
+{
+    FERRY_METRIC_SCOPE("FileIO_Sailings::adjustRemainingSpace");
+    return changeSailing(sailingID, [&](Sailingrec &rec) {
+        // Whole centimetres, as the capacity table counts them
+        rec.remainingHCL = std::round((rec.remainingHCL + deltaHCL) * 100.0f) / 100.0f;
+        rec.remainingLCL = std::round((rec.remainingLCL + deltaLCL) * 100.0f) / 100.0f;
+        remainingHCL = rec.remainingHCL;
+        remainingLCL = rec.remainingLCL;
+        return deltaHCL != 0.0f || deltaLCL != 0.0f;
+    });
 }
 
 //------------------------------------------------------------
-// Return all sailings (for UI pagination)
+// Return all sailings (for UI pagination), in file order. From
+// the table; failing that, large files are read in parallel
+// record-aligned chunks. None if the file cannot be read.
 //------------------------------------------------------------
 std::vector<Sailingrec> FileIO_Sailings::Sailingreport()
 {
-    std::vector<Sailingrec> sailings;
-    std::ifstream file("sailings.dat", std::ios::binary);
-    if (!file) return sailings;
-
-    Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        sailings.push_back(rec);
+    FERRY_METRIC_SCOPE("FileIO_Sailings::Sailingreport");
+    std::vector<Sailingrec> rows;
+    if (FerrySys::SailingTable::rows(rows))
+        return rows;
+
+    using Rows = std::vector<Sailingrec>;
+    bool scanned = FerrySys::parallelScan(
+        "sailings.dat", sizeof(Sailingrec), rows,
+        [](Rows &part, std::size_t, const unsigned char *bytes) {
+            if (bytes[offsetof(Sailingrec, status)] == FerrySys::REC_DEAD)
+                return;
+            Sailingrec rec{};
+            std::memcpy(&rec, bytes, sizeof(rec));
+            part.push_back(rec);
+        },
+        [](Rows &out, Rows &&part) {
+            out.insert(out.end(), part.begin(), part.end());
+        });
+    if (!scanned)
+    {
+        std::cerr << "Error: Unable to read sailings.dat!\n";
+        rows.clear();
     }
-
-    return sailings;
+    return rows;
 }
 
-bool FileIO_Sailings::sailingstatus(SailingID sailingID) {
-    std::fstream file("sailings.dat", std::ios::binary | std::ios::in);
-    if (!file) {
-        std::cerr << "Error opening sailings.dat!\n";
-        return false;
-    }
-
-    Sailingrec rec{};
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        if (sanitizeCharArray(rec.id) == sailingID) {
-            int reservationCount = FileIO_Reservations::countReservationsForSailing(sailingID);
-
-            std::cout << "----------------------------------------------------------------------------------------------------------------\n";
-            std::cout << std::left << std::setw(15) << "Sailing ID"
-                      << std::setw(25) << "Reservations"
-                      << std::setw(20) << "Remaining HCL"
-                      << std::setw(20) << "Remaining LCL" << "\n";
-            std::cout << "----------------------------------------------------------------------------------------------------------------\n";
-
-            std::cout << std::fixed << std::setprecision(1)
-                      << std::left << std::setw(15) << sanitizeCharArray(rec.id)
-                      << std::setw(25) << reservationCount
-                      << std::setw(20) << rec.remainingHCL
-                      << std::setw(20) << rec.remainingLCL << "\n";
-            std::cout << "----------------------------------------------------------------------------------------------------------------\n";
-
-            return true;
+//------------------------------------------------------------
+// Sailings to a city (optionally on one day) in (day, hour)
+// order, from a range scan of the index
+//------------------------------------------------------------
+std::vector<Sailingrec> FileIO_Sailings::sailingsToCity(const std::string &city,
+                                                        const std::string &day)
+{
+    FERRY_METRIC_SCOPE("FileIO_Sailings::sailingsToCity");
+    std::string prefix = day.empty() ? city + ":" : city + ":" + day + ":";
+    auto matches = [&prefix](const Sailingrec &rec) {
+        return rec.status != FerrySys::REC_DEAD &&
+               sanitizeCharArray(rec.id).compare(0, prefix.size(), prefix) == 0;
+    };
+
+    std::vector<Sailingrec> result;
+    std::vector<std::size_t> slots;
+    if (FerrySys::SailingIndex::range(city, day, slots)) {
+        std::vector<Sailingrec> rows(slots.size());
+        if (FerrySys::readRecordsBatch("sailings.dat", sizeof(Sailingrec), slots, rows.data())) {
+            for (const Sailingrec &rec : rows)
+                if (matches(rec))
+                    result.push_back(rec);
+            return result;
         }
     }
 
-    return false;
-}
\ No newline at end of file
+    // Index unavailable: filter the full report and sort it
+    for (const Sailingrec &rec : Sailingreport())
+        if (matches(rec))
+            result.push_back(rec);
+    std::sort(result.begin(), result.end(), [](const Sailingrec &a, const Sailingrec &b) {
+        return std::strncmp(a.id, b.id, sizeof(a.id)) < 0;
+    });
+    return result;
+}
+
+//------------------------------------------------------------
+// Earliest sailings with room for a vehicle
+//------------------------------------------------------------
+bool FileIO_Sailings::availableSailings(const std::string &city, int day, int hour,
+                                        std::int32_t spaceCm, bool highCeiling,
+                                        std::size_t max, std::vector<Sailingrec> &result)
+{
+    FERRY_METRIC_SCOPE("FileIO_Sailings::availableSailings");
+    return FerrySys::SailingTable::available(city, day, hour, spaceCm, highCeiling, max, result);
+}
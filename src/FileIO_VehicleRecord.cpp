@@ -4,27 +4,56 @@
 //
 // Implements binary I/O for vehicle records using fixed-length encoding.
 // Uses helpers from VehicleRecord.hpp for license padding and full record
-// encode/decode. Ensures safe deletion and consistent formatting.
+// encode/decode. Deletes tombstone the record in place (first license
+// byte set to REC_DEAD, see VehicleRecord.hpp); readers skip such rows
+// and writeVehicle() reuses them through the free list (FreeList.h).
 // ---------------------------------------------------------------------------
 
 #include "FileIO_VehicleRecord.h"
+#include "Metrics.h"
+#include "ParallelScan.h"
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+#include "DataFile.h"
+#include "FreeList.h"
+#include "IndexSnapshot.h"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
-#include <cstdio> // for remove, rename
+#include <cstdio>
+#include <string_view>
+#include <unordered_map>
 
 namespace FerrySys
 {
 
 // ============================================================
-// Append new vehicle record to vehicles.dat
+// Helper: tombstoned vehicle record?
+// ============================================================
+static bool isDead(const unsigned char *raw)
+{
+    return raw[VEH_STATUS_OFFSET] == REC_DEAD;
+}
+
+// ============================================================
+// Store new vehicle record: fill a deleted slot if one is free,
+// otherwise append to vehicles.dat
 // ============================================================
 bool FileIO_VehicleRecord::writeVehicle(const VehicleRecord &vehicle)
 {
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::writeVehicle");
     VehicleRaw raw{};
     encodeVehicle(vehicle, raw); // Encode full record (license, phone, dims)
 
+    if (!DataFile::open(Table::VEHICLES, true))
+        return false;
+    if (FreeList::fill(Table::VEHICLES, raw.data()))
+        return true;
+
+    std::size_t slot = DataFile::rows(Table::VEHICLES);
     std::ofstream file("vehicles.dat", std::ios::binary | std::ios::app);
+    Metrics::add(Counter::FILE_OPENS);
     if (!file)
     {
         std::cerr << "Error: Could not open vehicles.dat for writing.\n";
@@ -32,22 +61,87 @@ bool FileIO_VehicleRecord::writeVehicle(const VehicleRecord &vehicle)
     }
 
     file.write(reinterpret_cast<const char*>(raw.data()), VEH_REC_BYTES);
+    Metrics::add(Counter::BYTES_WRITTEN, VEH_REC_BYTES);
+    file.close();
+    DataFile::noteAppended(Table::VEHICLES);
+    IndexSnapshot::noteInsert(Table::VEHICLES, slot, raw.data());
     return true;
 }
 
 // ============================================================
-// Find vehicle by license plate
+// Append several vehicles with one write
+// ============================================================
+bool FileIO_VehicleRecord::writeVehicles(const std::vector<VehicleRecord> &vehicles)
+{
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::writeVehicles");
+    if (vehicles.empty())
+        return true;
+    if (!DataFile::open(Table::VEHICLES, true))
+        return false;
+
+    std::vector<VehicleRaw> raws(vehicles.size());
+    for (std::size_t i = 0; i < vehicles.size(); ++i)
+        encodeVehicle(vehicles[i], raws[i]);
+
+    std::size_t slot = DataFile::rows(Table::VEHICLES);
+    std::ofstream file("vehicles.dat", std::ios::binary | std::ios::app);
+    Metrics::add(Counter::FILE_OPENS);
+    if (!file)
+    {
+        std::cerr << "Error: Could not open vehicles.dat for writing.\n";
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(raws.data()),
+               static_cast<std::streamsize>(raws.size() * VEH_REC_BYTES));
+    file.close();
+    if (!file)
+        return false;
+    Metrics::add(Counter::BYTES_WRITTEN, raws.size() * VEH_REC_BYTES);
+    DataFile::noteAppended(Table::VEHICLES, raws.size());
+    IndexSnapshot::noteInserts(Table::VEHICLES, slot, raws.data(), raws.size());
+    return true;
+}
+
+// ============================================================
+// Find vehicle by license plate: candidates from the license
+// index, re-checked against their records
 // ============================================================
 bool FileIO_VehicleRecord::findVehicle(const std::string &license,
                                        VehicleRecord &result)
 {
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::findVehicle");
+    std::vector<std::size_t> slots;
+    std::vector<VehicleRaw> raws;
+    if (IndexSnapshot::findVehicle(license, slots))
+    {
+        raws.resize(slots.size());
+        if (readRecordsBatch("vehicles.dat", VEH_REC_BYTES, slots, raws.data()))
+        {
+            for (const VehicleRaw &raw : raws)
+            {
+                if (isDead(raw.data()) || fieldView(raw.data(), VEH_LIC_CHARS) != license)
+                    continue;
+                decodeVehicle(raw, result);
+                return true;
+            }
+            return false;
+        }
+    }
+
+    // Index unavailable: linear scan
     std::ifstream file("vehicles.dat", std::ios::binary);
+    Metrics::add(Counter::FILE_OPENS);
     if (!file)
         return false;
+    skipHeader(file, VEH_REC_BYTES);
 
     VehicleRaw raw{};
     while (file.read(reinterpret_cast<char*>(raw.data()), VEH_REC_BYTES))
     {
+        Metrics::recordRead(VEH_REC_BYTES);
+        if (isDead(raw.data()))
+            continue;
         VehicleRecord temp;
         decodeVehicle(raw, temp);
 
@@ -61,26 +155,98 @@ bool FileIO_VehicleRecord::findVehicle(const std::string &license,
     return false;
 }
 
+// ============================================================
+// Find several vehicles: every index candidate read in one
+// batch, or one linear scan without the index
+// ============================================================
+bool FileIO_VehicleRecord::findVehicles(const std::vector<std::string> &licenses,
+                                        std::vector<VehicleRecord> &result,
+                                        std::vector<char> &found)
+{
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::findVehicles");
+    result.assign(licenses.size(), VehicleRecord{});
+    found.assign(licenses.size(), 0);
+    if (licenses.empty())
+        return true;
+
+    std::vector<std::string_view> keys(licenses.begin(), licenses.end());
+    IndexSnapshot::Hits hits;
+    if (IndexSnapshot::findVehicles(keys, hits))
+    {
+        std::vector<std::size_t> slots;
+        slots.reserve(hits.size());
+        for (const auto &hit : hits)
+            slots.push_back(hit.second);
+        std::vector<VehicleRaw> raws(slots.size());
+        if (!readRecordsBatch("vehicles.dat", VEH_REC_BYTES, slots, raws.data()))
+            return false;
+        for (std::size_t i = 0; i < hits.size(); ++i)
+        {
+            std::size_t pos = hits[i].first;
+            if (found[pos] || isDead(raws[i].data()) || fieldView(raws[i].data(), VEH_LIC_CHARS) != licenses[pos])
+                continue;
+            decodeVehicle(raws[i], result[pos]);
+            found[pos] = 1;
+        }
+        return true;
+    }
+
+    // Index unavailable: one linear scan for all of them
+    std::unordered_map<std::string, std::vector<std::size_t>> wanted;
+    for (std::size_t i = 0; i < licenses.size(); ++i)
+        wanted[licenses[i]].push_back(i);
+
+    std::ifstream file("vehicles.dat", std::ios::binary);
+    Metrics::add(Counter::FILE_OPENS);
+    if (!file)
+        return true;                        // no file: none found
+    skipHeader(file, VEH_REC_BYTES);
+
+    VehicleRaw raw{};
+    while (file.read(reinterpret_cast<char*>(raw.data()), VEH_REC_BYTES))
+    {
+        Metrics::recordRead(VEH_REC_BYTES);
+        if (isDead(raw.data()))
+            continue;
+        auto it = wanted.find(std::string(fieldView(raw.data(), VEH_LIC_CHARS)));
+        if (it == wanted.end())
+            continue;
+        for (std::size_t pos : it->second)
+        {
+            decodeVehicle(raw, result[pos]);
+            found[pos] = 1;
+        }
+        wanted.erase(it);
+    }
+    return true;
+}
+
 // ============================================================
 // Check if vehicle exists by license
 // ============================================================
 bool FileIO_VehicleRecord::vehicleExists(const std::string &license)
 {
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::vehicleExists");
     VehicleRecord temp;
     return findVehicle(license, temp);
 }
 
 // ============================================================
-// List all vehicles in vehicles.dat (formatted for debugging)
+// List all vehicles in vehicles.dat (formatted for debugging).
+// Chunks are decoded and formatted in parallel, then printed in
+// file order.
 // ============================================================
 void FileIO_VehicleRecord::listVehicles()
 {
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::listVehicles");
     std::ifstream file("vehicles.dat", std::ios::binary);
+    Metrics::add(Counter::FILE_OPENS);
     if (!file)
     {
         std::cout << "No vehicle records found.\n";
         return;
     }
+    file.close();
 
     std::cout << "------------------------------------------------------------\n";
     std::cout << std::left << std::setw(12) << "License"
@@ -90,67 +256,97 @@ void FileIO_VehicleRecord::listVehicles()
               << "Type\n";
     std::cout << "------------------------------------------------------------\n";
 
-    VehicleRaw raw{};
-    while (file.read(reinterpret_cast<char*>(raw.data()), VEH_REC_BYTES))
-    {
-        VehicleRecord vehicle;
-        decodeVehicle(raw, vehicle);
+    std::string text;
+    bool scanned = parallelScan(
+        "vehicles.dat", VEH_REC_BYTES, text,
+        [](std::string &out, std::size_t, const unsigned char *bytes) {
+            if (isDead(bytes))
+                return;
+            VehicleRaw raw{};
+            std::memcpy(raw.data(), bytes, VEH_REC_BYTES);
+            VehicleRecord vehicle;
+            decodeVehicle(raw, vehicle);
 
-        std::cout << std::left << std::setw(12) << vehicle.license
-                  << std::setw(16) << vehicle.phone
-                  << std::setw(10) << vehicle.length_m
-                  << std::setw(10) << vehicle.height_m
-                  << (vehicle.isSpecial() ? "Special (HCL)" : "Standard (LCL)") << "\n";
+            char line[96];
+            int n = std::snprintf(line, sizeof(line), "%-12s%-16s%-10d%-10d%s\n",
+                                  vehicle.license.c_str(), vehicle.phone.c_str(),
+                                  static_cast<int>(vehicle.length_m),
+                                  static_cast<int>(vehicle.height_m),
+                                  vehicle.isSpecial() ? "Special (HCL)" : "Standard (LCL)");
+            if (n > 0)
+                out.append(line, static_cast<std::size_t>(n) < sizeof(line) ? n : sizeof(line) - 1);
+        },
+        [](std::string &out, std::string &&part) { out += part; });
+    if (!scanned)
+    {
+        std::cerr << "Error: Could not read vehicles.dat.\n";
+        return;
     }
 
+    std::cout << text;
     std::cout << "------------------------------------------------------------\n";
 }
 
 // ============================================================
-// Delete vehicle by rewriting file without target record
+// Batched random reads of vehicles by record slot
+// ============================================================
+bool FileIO_VehicleRecord::readVehiclesAt(const std::vector<std::size_t> &slots,
+                                          std::vector<VehicleRecord> &result)
+{
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::readVehiclesAt");
+    std::vector<VehicleRaw> raws(slots.size());
+    if (!readRecordsBatch("vehicles.dat", VEH_REC_BYTES, slots, raws.data()))
+        return false;
+
+    result.resize(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        if (isDead(raws[i].data()))
+            result[i] = VehicleRecord{};    // tombstoned slot: empty license
+        else
+            decodeVehicle(raws[i], result[i]);
+    }
+    return true;
+}
+
+// ============================================================
+// Delete vehicle: flip its status byte in place
 // ============================================================
 bool FileIO_VehicleRecord::deleteVehicle(const std::string &license)
 {
-    std::ifstream file("vehicles.dat", std::ios::binary);
+    FERRY_METRIC_SCOPE("FileIO_VehicleRecord::deleteVehicle");
+    std::fstream file("vehicles.dat", std::ios::binary | std::ios::in | std::ios::out);
+    Metrics::add(Counter::FILE_OPENS);
     if (!file)
         return false;
-
-    std::ofstream temp("temp.dat", std::ios::binary);
-    if (!temp)
+    std::size_t base = skipHeader(file, VEH_REC_BYTES);
+    if (base == BAD_HEADER)
         return false;
 
     VehicleRaw raw{};
-    bool found = false;
-
     while (file.read(reinterpret_cast<char*>(raw.data()), VEH_REC_BYTES))
     {
+        Metrics::recordRead(VEH_REC_BYTES);
+        if (isDead(raw.data()))
+            continue;
+
         VehicleRecord vehicle;
         decodeVehicle(raw, vehicle);
-
         if (vehicle.license == license)
         {
-            found = true; // Skip this record (delete it)
-        }
-        else
-        {
-            temp.write(reinterpret_cast<const char*>(raw.data()), VEH_REC_BYTES);
+            const char dead = static_cast<char>(REC_DEAD);
+            file.seekp(-static_cast<std::streamoff>(VEH_REC_BYTES - VEH_STATUS_OFFSET), std::ios::cur);
+            file.write(&dead, 1);
+            Metrics::add(Counter::BYTES_WRITTEN, 1);
+            std::size_t slot = (static_cast<std::size_t>(file.tellp()) - base) / VEH_REC_BYTES;
+            file.close();
+            Compactor::noteDead(Table::VEHICLES);
+            FreeList::push(Table::VEHICLES, { slot });
+            return true;
         }
     }
 
-    file.close();
-    temp.close();
-
-    if (found)
-    {
-        std::remove("vehicles.dat");
-        std::rename("temp.dat", "vehicles.dat");
-    }
-    else
-    {
-        std::remove("temp.dat");
-    }
-
-    return found;
+    return false;
 }
 
 } // namespace FerrySys
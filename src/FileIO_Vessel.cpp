@@ -12,14 +12,19 @@
 //    Supported operations:
 //      • Sequential scan for listing vessels
 //      • Adding new vessel records
-//      • Deleting vessels (with cascading deletion of related sailings)
+//      • Deleting vessels (status byte flipped to REC_DEAD in place;
+//        readers skip dead rows until compaction)
 //      • Lookup by vessel name
 //
 //************************************************************
 //************************************************************
 
 #include "FileIO_Vessel.h"
+#include "Metrics.h"
 #include "FileIO_Sailings.h"
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+#include "DataFile.h"
 #include <cstring>
 #include <iostream>
 
@@ -32,6 +37,7 @@
 void FileIO_Vessel::reset()
 {
     std::fstream file("vessels.dat", std::ios::binary | std::ios::in);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file) {
         std::cout << "vessels.dat not found.\n";
         return;
@@ -50,12 +56,18 @@ bool FileIO_Vessel::getNextVessel(
     unsigned int &laneHCL,
     unsigned int &laneLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Vessel::getNextVessel");
     std::ifstream file("vessels.dat", std::ios::binary);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file)
         return false;
+    FerrySys::skipHeader(file, sizeof(Vesselrec));
 
     Vesselrec rec{};
-    if (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
         vesselName = rec.vesselName;
         laneHCL = rec.laneHCL;
         laneLCL = rec.laneLCL;
@@ -75,7 +87,11 @@ void FileIO_Vessel::writeVessel(
     unsigned int laneHCL,
     unsigned int laneLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Vessel::writeVessel");
+    if (!FerrySys::DataFile::open(FerrySys::Table::VESSELS, true))
+        return;
     std::fstream file("vessels.dat", std::ios::binary | std::ios::app);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file) {
         std::cout << "Error: Unable to open vessels.dat for writing!\n";
         return;
@@ -84,48 +100,52 @@ void FileIO_Vessel::writeVessel(
     Vesselrec rec{};
     std::strncpy(rec.vesselName, vesselName.c_str(), sizeof(rec.vesselName) - 1);
     rec.vesselName[sizeof(rec.vesselName) - 1] = '\0';
+    rec.status = FerrySys::REC_LIVE;
     rec.laneHCL = laneHCL;
     rec.laneLCL = laneLCL;
 
     file.write(reinterpret_cast<const char*>(&rec), sizeof(Vesselrec));
+    FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(Vesselrec));
+    file.close();
+    FerrySys::DataFile::noteAppended(FerrySys::Table::VESSELS);
 }
 
 //------------------------------------------------------------
-// Delete a vessel record (and cascade delete sailings/reservations)
+// Delete a vessel record (tombstone in place)
 //
 // Preconditions : Vessel must exist in `vessels.dat`.
-// Postconditions: Vessel is removed from file. Any sailings and reservations
-//                 tied to this vessel are also deleted via FileIO_Sailings.
+// Postconditions: Vessel's status byte is REC_DEAD; the row is dropped
+//                 at the next compaction.
 //------------------------------------------------------------
 bool FileIO_Vessel::deleteVessel(const std::string &vesselName)
 {
-    std::ifstream inFile("vessels.dat", std::ios::binary);
-    std::ofstream outFile("temp.dat", std::ios::binary);
-
-    if (!inFile || !outFile)
+    FERRY_METRIC_SCOPE("FileIO_Vessel::deleteVessel");
+    std::fstream file("vessels.dat", std::ios::binary | std::ios::in | std::ios::out);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
+    if (!file)
         return false;
+    FerrySys::skipHeader(file, sizeof(Vesselrec));
 
     Vesselrec rec{};
-    bool found = false;
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
 
-    while (inFile.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
         std::string nameFromFile(rec.vesselName);
         nameFromFile = nameFromFile.substr(0, nameFromFile.find('\0'));
 
         if (nameFromFile == vesselName) {
-            found = true; // Skip this record (delete it)
-            continue;
+            rec.status = FerrySys::REC_DEAD;
+            file.seekp(-static_cast<int>(sizeof(rec)), std::ios::cur);
+            file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            FerrySys::Metrics::add(FerrySys::Counter::BYTES_WRITTEN, sizeof(rec));
+            file.close();
+            FerrySys::Compactor::noteDead(FerrySys::Table::VESSELS);
+            return true;
         }
-
-        outFile.write(reinterpret_cast<char*>(&rec), sizeof(rec));
     }
-
-    inFile.close();
-    outFile.close();
-
-    std::remove("vessels.dat");
-    std::rename("temp.dat", "vessels.dat");
-    return found;
+    return false;
 }
 
 //------------------------------------------------------------
@@ -140,11 +160,17 @@ bool FileIO_Vessel::getNextVessel(
     unsigned int &laneHCL,
     unsigned int &laneLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Vessel::getNextVessel");
     if (!file.is_open())
         return false;
+    if (file.tellg() == std::streampos(0))
+        FerrySys::skipHeader(file, sizeof(Vesselrec));
 
     Vesselrec rec{};
-    if (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
         vesselName = rec.vesselName;
         laneHCL = rec.laneHCL;
         laneLCL = rec.laneLCL;
@@ -164,12 +190,18 @@ bool FileIO_Vessel::getVesselByName(
     unsigned int &laneHCL,
     unsigned int &laneLCL
 ) {
+    FERRY_METRIC_SCOPE("FileIO_Vessel::getVesselByName");
     std::ifstream file("vessels.dat", std::ios::binary);
+    FerrySys::Metrics::add(FerrySys::Counter::FILE_OPENS);
     if (!file)
         return false;
+    FerrySys::skipHeader(file, sizeof(Vesselrec));
 
     Vesselrec rec{};
     while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        FerrySys::Metrics::recordRead(sizeof(rec));
+        if (rec.status == FerrySys::REC_DEAD)
+            continue;
         std::string name(rec.vesselName);
         name = name.substr(0, name.find('\0'));
 
@@ -0,0 +1,222 @@
+//************************************************************
+//************************************************************
+//  FlatFileBackend.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Forwards every StorageBackend call to the FileIO_* class
+//    that already implements it. Updates run inside a
+//    WriteGate::Hold so a backup never sees one half done.
+//************************************************************
+//************************************************************
+
+#include "FlatFileBackend.h"
+#include "DataFile.h"
+#include "FileIO_VehicleRecord.h"
+#include "FileIO_Vessel.h"
+#include "IndexSnapshot.h"
+#include "ReservationLSM.h"
+#include "WriteGate.h"
+
+namespace FerrySys
+{
+
+// ============================================================
+// Vehicles
+// ============================================================
+bool FlatFileBackend::writeVehicle(const VehicleRecord &vehicle)
+{
+    WriteGate::Hold hold;
+    return FileIO_VehicleRecord::writeVehicle(vehicle);
+}
+
+bool FlatFileBackend::findVehicle(const LicensePlate &license, VehicleRecord &result)
+{
+    return FileIO_VehicleRecord::findVehicle(license, result);
+}
+
+bool FlatFileBackend::deleteVehicle(const LicensePlate &license)
+{
+    WriteGate::Hold hold;
+    return FileIO_VehicleRecord::deleteVehicle(license);
+}
+
+bool FlatFileBackend::findVehicles(const std::vector<LicensePlate> &licenses,
+                                   std::vector<VehicleRecord> &result, std::vector<char> &found)
+{
+    std::vector<std::string> keys(licenses.begin(), licenses.end());
+    return FileIO_VehicleRecord::findVehicles(keys, result, found);
+}
+
+bool FlatFileBackend::writeVehicles(const std::vector<VehicleRecord> &vehicles)
+{
+    WriteGate::Hold hold;
+    return FileIO_VehicleRecord::writeVehicles(vehicles);
+}
+
+// ============================================================
+// Vessels
+// ============================================================
+bool FlatFileBackend::writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL)
+{
+    WriteGate::Hold hold;
+    FileIO_Vessel::writeVessel(vesselName, laneHCL, laneLCL);
+    return true;
+}
+
+bool FlatFileBackend::findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL)
+{
+    return FileIO_Vessel::getVesselByName(vesselName, laneHCL, laneLCL);
+}
+
+bool FlatFileBackend::deleteVessel(const std::string &vesselName)
+{
+    WriteGate::Hold hold;
+    return FileIO_Vessel::deleteVessel(vesselName);
+}
+
+// ============================================================
+// Sailings
+// ============================================================
+bool FlatFileBackend::writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                                   float remainingHCL, float remainingLCL)
+{
+    WriteGate::Hold hold;
+    FileIO_Sailings::writeSailing(sailingID, vesselName, remainingHCL, remainingLCL);
+    return true;
+}
+
+bool FlatFileBackend::findSailing(const SailingID &sailingID, Sailingrec &result)
+{
+    return FileIO_Sailings::findSailing(sailingID, result);
+}
+
+bool FlatFileBackend::setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL)
+{
+    WriteGate::Hold hold;
+    return FileIO_Sailings::setRemainingSpace(sailingID, remainingHCL, remainingLCL);
+}
+
+bool FlatFileBackend::adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                                           float &remainingHCL, float &remainingLCL)
+{
+    WriteGate::Hold hold;
+    return FileIO_Sailings::adjustRemainingSpace(sailingID, deltaHCL, deltaLCL, remainingHCL, remainingLCL);
+}
+
+std::vector<Sailingrec> FlatFileBackend::sailings()
+{
+    return FileIO_Sailings::Sailingreport();
+}
+
+std::vector<Sailingrec> FlatFileBackend::sailingsToCity(const std::string &city, const std::string &day)
+{
+    return FileIO_Sailings::sailingsToCity(city, day);
+}
+
+std::vector<Sailingrec> FlatFileBackend::availableSailings(const std::string &city, int day, int hour,
+                                                           std::int32_t spaceCm, bool highCeiling,
+                                                           std::size_t max)
+{
+    std::vector<Sailingrec> result;
+    if (FileIO_Sailings::availableSailings(city, day, hour, spaceCm, highCeiling, max, result))
+        return result;
+    return StorageBackend::availableSailings(city, day, hour, spaceCm, highCeiling, max);
+}
+
+int FlatFileBackend::deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed)
+{
+    WriteGate::Hold hold;
+    return FileIO_Sailings::deleteSailings(sailingIDs, removed);
+}
+
+int FlatFileBackend::deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed)
+{
+    WriteGate::Hold hold;
+    return FileIO_Sailings::deleteSailingsOnDay(day, removed);
+}
+
+int FlatFileBackend::deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed)
+{
+    WriteGate::Hold hold;
+    return FileIO_Sailings::deleteSailingsToCity(city, removed);
+}
+
+// ============================================================
+// Reservations
+// ============================================================
+bool FlatFileBackend::writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    WriteGate::Hold hold;
+    return FileIO_Reservations::writeReservation(licensePlate, sailingID);
+}
+
+bool FlatFileBackend::writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings)
+{
+    WriteGate::Hold hold;
+    std::vector<std::pair<std::string, SailingID>> rows(bookings.begin(), bookings.end());
+    return FileIO_Reservations::writeReservations(rows);
+}
+
+bool FlatFileBackend::checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    WriteGate::Hold hold;
+    return FileIO_Reservations::writeCheckin(licensePlate, sailingID);
+}
+
+bool FlatFileBackend::deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    WriteGate::Hold hold;
+    return FileIO_Reservations::deleteReservation(licensePlate, sailingID);
+}
+
+bool FlatFileBackend::reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    return FileIO_Reservations::reservationExists(licensePlate, sailingID);
+}
+
+int FlatFileBackend::countReservations(const SailingID &sailingID)
+{
+    return FileIO_Reservations::countReservationsForSailing(sailingID);
+}
+
+bool FlatFileBackend::countReservationsBySailing(std::unordered_map<std::string, int> &counts)
+{
+    return FileIO_Reservations::countReservationsBySailing(counts);
+}
+
+bool FlatFileBackend::readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                                  std::vector<ReservationRec> &rows)
+{
+    return FileIO_Reservations::readReservationsForSailings(sailingIDs, rows);
+}
+
+// ============================================================
+// Lifecycle
+// ============================================================
+void FlatFileBackend::open()
+{
+    WriteGate::Hold hold;
+    // Check the data-file headers (upgrading legacy files), then
+    // pick the reservation layout, so any flat-file migration
+    // happens at startup rather than on the first booking, then
+    // map the index snapshots
+    DataFile::openAll();
+    FileIO_Reservations::storageMode();
+    IndexSnapshot::open();
+}
+
+void FlatFileBackend::compact(Table table)
+{
+    WriteGate::Hold hold;
+    Compactor::compact(table);
+}
+
+void FlatFileBackend::close()
+{
+    // Flush the LSM memtable and stop its merge thread (if open)
+    ReservationLSM::close();
+    IndexSnapshot::close();
+}
+
+} // namespace FerrySys
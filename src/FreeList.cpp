@@ -0,0 +1,202 @@
+//************************************************************
+//************************************************************
+//  FreeList.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the free-slot side files. Entries are native
+//    uint32 slot numbers; push appends, pop reads from the end
+//    and truncates past the entry it returns. Both hold an
+//    exclusive flock on the side file for the whole read-modify-
+//    write, so no two processes (or threads) hand out one slot.
+//************************************************************
+//************************************************************
+
+#include "FreeList.h"
+#include "BinaryFileOps.hpp"
+#include "IndexSnapshot.h"
+#include "Metrics.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+namespace
+{
+    std::mutex listLock;
+
+    using Entry = std::uint32_t;
+
+    //------------------------------------------------------------
+    // Side file for `t`, or nullptr if the table keeps no list
+    const char *freeFile(Table t)
+    {
+        switch (t)
+        {
+            case Table::VEHICLES:     return "vehicles.free";
+            case Table::RESERVATIONS: return "reservations.free";
+            default:                  return nullptr;
+        }
+    }
+
+    //------------------------------------------------------------
+    // Exclusive flock on the open side file; released by close()
+    bool lockList(int fd)
+    {
+        while (::flock(fd, LOCK_EX) != 0)
+        {
+            if (errno != EINTR)
+                return false;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // True if `slot` of the open data file holds a dead record
+    bool slotIsDead(int dataFd, const TableLayout &layout, std::size_t base,
+                    std::size_t records, std::size_t slot)
+    {
+        if (slot >= records)
+            return false;
+        unsigned char status = REC_LIVE;
+        off_t at = static_cast<off_t>(base + slot * layout.recordSize + layout.statusOffset);
+        return ::pread(dataFd, &status, 1, at) == 1 && status == REC_DEAD;
+    }
+}
+
+void FreeList::push(Table table, const std::vector<std::size_t> &slots)
+{
+    const char *path = freeFile(table);
+    if (!path || slots.empty())
+        return;
+
+    std::vector<Entry> entries(slots.begin(), slots.end());
+    std::lock_guard<std::mutex> guard(listLock);
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0)
+        return;     // the slots are still reclaimed by compaction
+    Metrics::add(Counter::FILE_OPENS);
+    if (!lockList(fd))
+    {
+        ::close(fd);
+        return;
+    }
+
+    std::size_t bytes = entries.size() * sizeof(Entry);
+    if (::write(fd, entries.data(), bytes) == static_cast<ssize_t>(bytes))
+        Metrics::add(Counter::BYTES_WRITTEN, bytes);
+    ::close(fd);
+}
+
+bool FreeList::pop(Table table, std::size_t &slot)
+{
+    const char *path = freeFile(table);
+    if (!path)
+        return false;
+
+    std::lock_guard<std::mutex> guard(listLock);
+    int fd = ::open(path, O_RDWR);
+    if (fd < 0)
+        return false;
+    Metrics::add(Counter::FILE_OPENS);
+    if (!lockList(fd))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // Sized under the lock: another process may have popped or pushed
+    struct stat st{};
+    std::size_t count = ::fstat(fd, &st) == 0 ? static_cast<std::size_t>(st.st_size) / sizeof(Entry) : 0;
+    if (count == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const TableLayout &layout = Compactor::layout(table);
+    int dataFd = ::open(layout.file, O_RDONLY);
+    std::size_t records = 0;
+    std::size_t base = 0;
+    if (dataFd >= 0 && ::fstat(dataFd, &st) == 0)
+    {
+        base = dataOffset(dataFd, layout.recordSize);
+        if (base != BAD_HEADER)
+            records = (static_cast<std::size_t>(st.st_size) - base) / layout.recordSize;
+    }
+
+    bool found = false;
+    while (count > 0 && !found)
+    {
+        Entry e = 0;
+        --count;
+        if (::pread(fd, &e, sizeof(e), static_cast<off_t>(count * sizeof(Entry))) != sizeof(e))
+            break;
+        Metrics::recordRead(sizeof(e));
+        if (dataFd >= 0 && slotIsDead(dataFd, layout, base, records, e))
+        {
+            slot = e;
+            found = true;
+        }
+    }
+
+    // Stale entries popped on the way are dropped along with the one returned
+    if (::ftruncate(fd, static_cast<off_t>(count * sizeof(Entry))) != 0)
+        found = false;      // could not consume it; append instead of reusing twice
+    if (dataFd >= 0)
+        ::close(dataFd);
+    ::close(fd);
+    return found;
+}
+
+bool FreeList::fill(Table table, const void *record)
+{
+    std::size_t slot = 0;
+    if (!pop(table, slot))
+        return false;
+
+    const TableLayout &layout = Compactor::layout(table);
+    int fd = ::open(layout.file, O_RDWR);
+    if (fd < 0)
+        return false;
+    Metrics::add(Counter::FILE_OPENS);
+
+    std::size_t base = dataOffset(fd, layout.recordSize);
+    off_t at = static_cast<off_t>(base + slot * layout.recordSize);
+    bool ok = base != BAD_HEADER && ::pwrite(fd, record, layout.recordSize, at) == static_cast<ssize_t>(layout.recordSize);
+    ::close(fd);
+    if (!ok)
+        return false;
+
+    Metrics::add(Counter::BYTES_WRITTEN, layout.recordSize);
+    Compactor::noteReused(table);
+    IndexSnapshot::noteInsert(table, slot, record);
+    return true;
+}
+
+std::size_t FreeList::size(Table table)
+{
+    const char *path = freeFile(table);
+    struct stat st{};
+    if (!path || ::stat(path, &st) != 0)
+        return 0;
+    return static_cast<std::size_t>(st.st_size) / sizeof(Entry);
+}
+
+void FreeList::clear(Table table)
+{
+    const char *path = freeFile(table);
+    if (!path)
+        return;
+    std::lock_guard<std::mutex> guard(listLock);
+    ::unlink(path);
+}
+
+} // namespace FerrySys
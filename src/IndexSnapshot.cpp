@@ -0,0 +1,622 @@
+//************************************************************
+//************************************************************
+//  IndexSnapshot.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the mapped hash-index snapshots.
+//
+//    File layout (host byte order, every section 8-aligned):
+//      SnapHeader
+//      Bucket[buckets]         open addressing on the key hash,
+//                              linear probing; count 0 = empty
+//      uint32 slots[entries]   each bucket's slots, contiguous
+//      uint64 bloom[bloomWords]
+//
+//    A snapshot is written to a temp file and renamed into
+//    place, so a reader maps either the old one or the new one.
+//************************************************************
+//************************************************************
+
+#include "IndexSnapshot.h"
+#include "BinaryFileOps.hpp"
+#include "DataFile.h"
+#include "FileIO_Reservations.h"
+#include "Metrics.h"
+#include "ParallelScan.h"
+#include "VehicleRecord.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr char         MAGIC[4] = { 'F', 'S', 'N', 'P' };
+    constexpr std::size_t  ID_CHARS = 16;
+    constexpr std::size_t  BLOOM_BITS_PER_KEY = 10;     // ~1% false positives
+    constexpr unsigned     BLOOM_PROBES = 7;
+    constexpr char         KEY_SEPARATOR = '\x1f';      // between license and sailing
+
+    struct SnapHeader
+    {
+        char          magic[4];
+        std::uint32_t version;
+        std::uint32_t index;            // KeyIndex
+        std::uint32_t buckets;          // power of two
+        std::uint64_t dataGeneration;
+        std::uint64_t keys;
+        std::uint64_t entries;
+        std::uint64_t bloomWords;
+        std::uint64_t dataRows;         // data-file slots covered, live and dead
+    };
+    static_assert(sizeof(SnapHeader) == 56, "fixed snapshot header");
+
+    struct Bucket
+    {
+        std::uint64_t hash;
+        std::uint32_t first;            // into slots[]
+        std::uint32_t count;
+    };
+
+    struct IndexInfo
+    {
+        const char *path;
+        Table       table;
+    };
+
+    const IndexInfo INDEXES[static_cast<int>(KeyIndex::COUNT)] = {
+        { "vehicles.lic.snap",     Table::VEHICLES },
+        { "reservations.key.snap", Table::RESERVATIONS },
+        { "reservations.sid.snap", Table::RESERVATIONS },
+    };
+
+    using Pairs = std::vector<std::pair<std::uint64_t, std::uint32_t>>;
+
+    struct Snapshot
+    {
+        int                 fd = -1;
+        unsigned char      *map = nullptr;
+        std::size_t         bytes = 0;
+        const SnapHeader   *header = nullptr;
+        const Bucket       *buckets = nullptr;
+        const std::uint32_t *slots = nullptr;
+        const std::uint64_t *bloom = nullptr;
+        std::unordered_multimap<std::uint64_t, std::uint32_t> overlay;
+        std::uint64_t       current = 0;    // generation snapshot + overlay reflect
+        std::size_t         rows = 0;       // data-file slots they cover
+        std::size_t         builds = 0;
+    };
+
+    std::shared_mutex snapLock;
+    Snapshot          snaps[static_cast<int>(KeyIndex::COUNT)];
+
+    const IndexInfo &info(KeyIndex k)
+    {
+        return INDEXES[static_cast<int>(k)];
+    }
+
+    std::uint64_t hashKey(std::string_view key)
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : key)
+        {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::string upper(std::string_view s)
+    {
+        std::string out(s);
+        std::transform(out.begin(), out.end(), out.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return out;
+    }
+
+    std::string reservationKey(std::string_view licensePlate, std::string_view sailingID)
+    {
+        return upper(licensePlate) + KEY_SEPARATOR + upper(sailingID);
+    }
+
+    //------------------------------------------------------------
+    // Key hash of a live record; false for dead rows
+    bool recordHash(KeyIndex k, const unsigned char *record, std::uint64_t &hash)
+    {
+        switch (k)
+        {
+            case KeyIndex::VEHICLE_LICENSE:
+                if (record[VEH_STATUS_OFFSET] == REC_DEAD)
+                    return false;
+                hash = hashKey(fieldView(record, VEH_LIC_CHARS));
+                return true;
+
+            case KeyIndex::RESERVATION_KEY:
+            case KeyIndex::RESERVATION_SAILING:
+            {
+                const auto *rec = reinterpret_cast<const ReservationRec*>(record);
+                if (rec->status == REC_DEAD)
+                    return false;
+                std::string_view sailing = fieldView(reinterpret_cast<const unsigned char*>(rec->sailingID), ID_CHARS);
+                if (k == KeyIndex::RESERVATION_SAILING)
+                {
+                    hash = hashKey(upper(sailing));
+                    return true;
+                }
+                std::string_view license = fieldView(reinterpret_cast<const unsigned char*>(rec->licenseplate),
+                                                     VEH_LIC_CHARS);
+                hash = hashKey(reservationKey(license, sailing));
+                return true;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    std::size_t align8(std::size_t n)
+    {
+        return (n + 7) / 8 * 8;
+    }
+
+    std::size_t fileBytes(const SnapHeader &h)
+    {
+        return sizeof(SnapHeader) + h.buckets * sizeof(Bucket) +
+               align8(h.entries * sizeof(std::uint32_t)) + h.bloomWords * sizeof(std::uint64_t);
+    }
+
+    bool bloomHas(const std::uint64_t *bloom, std::uint64_t words, std::uint64_t hash)
+    {
+        std::uint64_t bits = words * 64;
+        std::uint64_t h2 = (hash >> 33) | 1;
+        for (unsigned i = 0; i < BLOOM_PROBES; ++i)
+        {
+            std::uint64_t bit = (hash + i * h2) % bits;
+            if (!(bloom[bit / 64] & (1ull << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
+    void unmap(Snapshot &s)
+    {
+        if (s.map)
+            ::munmap(s.map, s.bytes);
+        if (s.fd >= 0)
+            ::close(s.fd);
+        s.fd = -1;
+        s.map = nullptr;
+        s.bytes = 0;
+        s.header = nullptr;
+        s.buckets = nullptr;
+        s.slots = nullptr;
+        s.bloom = nullptr;
+        s.overlay.clear();
+        s.current = 0;
+        s.rows = 0;
+    }
+
+    //------------------------------------------------------------
+    // Map k's snapshot file if it is well formed (any generation)
+    bool mapFile(KeyIndex k, Snapshot &s)
+    {
+        unmap(s);
+        s.fd = ::open(info(k).path, O_RDONLY | O_CLOEXEC);
+        if (s.fd < 0)
+            return false;
+        Metrics::add(Counter::FILE_OPENS);
+
+        struct stat st{};
+        if (::fstat(s.fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapHeader)))
+        {
+            unmap(s);
+            return false;
+        }
+        void *map = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, s.fd, 0);
+        if (map == MAP_FAILED)
+        {
+            unmap(s);
+            return false;
+        }
+        s.map = static_cast<unsigned char*>(map);
+        s.bytes = static_cast<std::size_t>(st.st_size);
+
+        const auto *h = reinterpret_cast<const SnapHeader*>(s.map);
+        if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != IndexSnapshot::VERSION ||
+            h->index != static_cast<std::uint32_t>(k) || h->buckets == 0 ||
+            (h->buckets & (h->buckets - 1)) != 0 || h->bloomWords == 0 || fileBytes(*h) != s.bytes)
+        {
+            unmap(s);
+            return false;
+        }
+        s.header = h;
+        s.buckets = reinterpret_cast<const Bucket*>(s.map + sizeof(SnapHeader));
+        s.slots = reinterpret_cast<const std::uint32_t*>(s.buckets + h->buckets);
+        s.bloom = reinterpret_cast<const std::uint64_t*>(
+            s.map + sizeof(SnapHeader) + h->buckets * sizeof(Bucket) + align8(h->entries * sizeof(std::uint32_t)));
+        s.current = h->dataGeneration;
+        s.rows = static_cast<std::size_t>(h->dataRows);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Write sorted `pairs` as k's snapshot for `generation`,
+    // covering the first `rows` slots of the data file
+    bool writeFile(KeyIndex k, const Pairs &pairs, std::uint64_t generation, std::size_t rows)
+    {
+        SnapHeader h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = IndexSnapshot::VERSION;
+        h.index = static_cast<std::uint32_t>(k);
+        h.dataGeneration = generation;
+        h.dataRows = rows;
+        h.entries = pairs.size();
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+            h.keys += (i == 0 || pairs[i].first != pairs[i - 1].first);
+
+        h.buckets = 16;
+        while (h.buckets < h.keys * 2)
+            h.buckets *= 2;
+        h.bloomWords = (std::max<std::uint64_t>(64, h.keys * BLOOM_BITS_PER_KEY) + 63) / 64;
+
+        std::vector<Bucket> buckets(h.buckets, Bucket{ 0, 0, 0 });
+        std::vector<std::uint32_t> slots(align8(pairs.size() * sizeof(std::uint32_t)) / sizeof(std::uint32_t), 0);
+        std::vector<std::uint64_t> bloom(h.bloomWords, 0);
+        std::uint64_t bits = h.bloomWords * 64;
+        for (std::size_t i = 0; i < pairs.size();)
+        {
+            std::uint64_t hash = pairs[i].first;
+            std::size_t first = i;
+            for (; i < pairs.size() && pairs[i].first == hash; ++i)
+                slots[i] = pairs[i].second;
+
+            std::size_t b = hash & (h.buckets - 1);
+            while (buckets[b].count != 0)
+                b = (b + 1) & (h.buckets - 1);
+            buckets[b] = Bucket{ hash, static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(i - first) };
+
+            std::uint64_t h2 = (hash >> 33) | 1;
+            for (unsigned p = 0; p < BLOOM_PROBES; ++p)
+            {
+                std::uint64_t bit = (hash + p * h2) % bits;
+                bloom[bit / 64] |= 1ull << (bit % 64);
+            }
+        }
+
+        const std::string path = info(k).path;
+        const std::string tmp = path + ".tmp";
+        std::FILE *out = std::fopen(tmp.c_str(), "wb");
+        if (!out)
+            return false;
+        Metrics::add(Counter::FILE_OPENS);
+        bool ok = std::fwrite(&h, sizeof(h), 1, out) == 1 &&
+                  std::fwrite(buckets.data(), sizeof(Bucket), buckets.size(), out) == buckets.size() &&
+                  std::fwrite(slots.data(), sizeof(std::uint32_t), slots.size(), out) == slots.size() &&
+                  std::fwrite(bloom.data(), sizeof(std::uint64_t), bloom.size(), out) == bloom.size();
+        ok = std::fclose(out) == 0 && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        Metrics::add(Counter::BYTES_WRITTEN, fileBytes(h));
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Scan the data file and write a fresh snapshot for `data`, the
+    // header as read before the scan (snapLock held)
+    bool rebuildLocked(KeyIndex k, Snapshot &s, const FileHeader &data)
+    {
+        FERRY_METRIC_SCOPE("IndexSnapshot::build");
+        const TableLayout &ti = Compactor::layout(info(k).table);
+        Pairs pairs;
+        bool scanned = parallelScan(
+            ti.file, ti.recordSize, pairs,
+            [k](Pairs &part, std::size_t index, const unsigned char *bytes) {
+                std::uint64_t hash = 0;
+                if (recordHash(k, bytes, hash))
+                    part.emplace_back(hash, static_cast<std::uint32_t>(index));
+            },
+            [](Pairs &out, Pairs &&part) { out.insert(out.end(), part.begin(), part.end()); });
+        if (!scanned)
+            return false;
+        std::sort(pairs.begin(), pairs.end());
+
+        ++s.builds;
+        std::size_t rows = static_cast<std::size_t>(data.liveRows + data.deadRows);
+        return writeFile(k, pairs, data.generation, rows) && mapFile(k, s) && s.current == data.generation;
+    }
+
+    //------------------------------------------------------------
+    // Fold the overlay into a new snapshot (snapLock held)
+    bool mergeLocked(KeyIndex k, Snapshot &s)
+    {
+        if (!s.header || s.overlay.empty())
+            return true;
+        FERRY_METRIC_SCOPE("IndexSnapshot::merge");
+        Pairs pairs;
+        pairs.reserve(s.header->entries + s.overlay.size());
+        for (std::uint32_t b = 0; b < s.header->buckets; ++b)
+        {
+            const Bucket &bucket = s.buckets[b];
+            for (std::uint32_t i = 0; i < bucket.count; ++i)
+                pairs.emplace_back(bucket.hash, s.slots[bucket.first + i]);
+        }
+        for (const auto &kv : s.overlay)
+            pairs.emplace_back(kv.first, kv.second);
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        std::uint64_t generation = s.current;
+        std::size_t rows = s.rows;
+        return writeFile(k, pairs, generation, rows) && mapFile(k, s);
+    }
+
+    //------------------------------------------------------------
+    // Bring k's snapshot up to `data` when every change since it
+    // was an append (another process's, or one not passed to
+    // noteInserts): the slots past those it covers go into the
+    // overlay. False if a rebuild is needed (snapLock held).
+    bool replayLocked(KeyIndex k, Snapshot &s, const FileHeader &data)
+    {
+        std::size_t rows = static_cast<std::size_t>(data.liveRows + data.deadRows);
+        if (!s.header || data.generation < s.current || data.generation - s.current > data.appendRun ||
+            rows < s.rows)
+            return false;
+
+        FERRY_METRIC_SCOPE("IndexSnapshot::replay");
+        const TableLayout &ti = Compactor::layout(info(k).table);
+        std::vector<unsigned char> buf;
+        ScanChunk tail{ s.rows, rows - s.rows };
+        if (!readChunk(ti.file, ti.recordSize, FILE_HEADER_BYTES, tail, buf) ||
+            buf.size() != tail.count * ti.recordSize)
+            return false;
+        Metrics::add(Counter::FILE_OPENS);
+        Metrics::add(Counter::RECORDS_SCANNED, tail.count);
+        Metrics::add(Counter::BYTES_READ, buf.size());
+        for (std::size_t r = 0; r < tail.count; ++r)
+        {
+            std::uint64_t hash = 0;
+            if (recordHash(k, buf.data() + r * ti.recordSize, hash))
+                s.overlay.emplace(hash, static_cast<std::uint32_t>(tail.first + r));
+        }
+        s.current = data.generation;
+        s.rows = rows;
+        if (s.overlay.size() >= IndexSnapshot::OVERLAY_MERGE_ROWS)
+            mergeLocked(k, s);
+        return true;
+    }
+
+    void lookupLocked(const Snapshot &s, std::uint64_t hash, std::vector<std::size_t> &slots)
+    {
+        if (s.header && bloomHas(s.bloom, s.header->bloomWords, hash))
+        {
+            std::uint32_t mask = s.header->buckets - 1;
+            for (std::uint32_t b = hash & mask; s.buckets[b].count != 0; b = (b + 1) & mask)
+            {
+                if (s.buckets[b].hash != hash)
+                    continue;
+                for (std::uint32_t i = 0; i < s.buckets[b].count; ++i)
+                    slots.push_back(s.slots[s.buckets[b].first + i]);
+                break;
+            }
+        }
+        auto range = s.overlay.equal_range(hash);
+        if (range.first == range.second)
+            return;
+        for (auto it = range.first; it != range.second; ++it)
+            slots.push_back(it->second);
+
+        // A reused slot can be in both
+        std::sort(slots.begin(), slots.end());
+        slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    }
+
+    //------------------------------------------------------------
+    // Make k's snapshot match `data`: catch it up on appends, map
+    // the file (caught up the same way), or rebuild it if it is
+    // missing or stale (snapLock held)
+    bool attachLocked(KeyIndex k, Snapshot &s, const FileHeader &data)
+    {
+        if (s.header && s.current == data.generation)
+            return true;
+        if (replayLocked(k, s, data))
+            return true;
+        if ((mapFile(k, s) && (s.current == data.generation || replayLocked(k, s, data))) ||
+            rebuildLocked(k, s, data))
+            return true;
+        unmap(s);
+        return false;
+    }
+
+    //------------------------------------------------------------
+    // Run `lookup` on k's snapshot once it matches the data file.
+    // Returns false if it cannot be brought up to date.
+    template <class Lookup>
+    bool withSnapshot(KeyIndex k, Lookup lookup)
+    {
+        FileHeader data{};
+        if (!DataFile::header(info(k).table, data))
+            return true;        // no data file: nothing to find
+
+        Snapshot &s = snaps[static_cast<int>(k)];
+        {
+            std::shared_lock<std::shared_mutex> guard(snapLock);
+            if (s.header && s.current == data.generation)
+            {
+                lookup(s);
+                return true;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> guard(snapLock);
+        if (!attachLocked(k, s, data))
+            return false;
+        lookup(s);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Slots of `hash` in index k
+    bool find(KeyIndex k, std::uint64_t hash, std::vector<std::size_t> &slots)
+    {
+        slots.clear();
+        return withSnapshot(k, [&](const Snapshot &s) { lookupLocked(s, hash, slots); });
+    }
+
+    //------------------------------------------------------------
+    // Slots of every hash in index k, paired with its position
+    bool findMany(KeyIndex k, const std::vector<std::uint64_t> &hashes, IndexSnapshot::Hits &hits)
+    {
+        return withSnapshot(k, [&](const Snapshot &s) {
+            std::vector<std::size_t> slots;
+            for (std::size_t i = 0; i < hashes.size(); ++i)
+            {
+                slots.clear();
+                lookupLocked(s, hashes[i], slots);
+                for (std::size_t slot : slots)
+                    hits.emplace_back(i, slot);
+            }
+        });
+    }
+}
+
+// ============================================================
+// Lookups
+// ============================================================
+bool IndexSnapshot::findVehicle(std::string_view license, std::vector<std::size_t> &slots)
+{
+    return find(KeyIndex::VEHICLE_LICENSE, hashKey(license), slots);
+}
+
+bool IndexSnapshot::findReservation(std::string_view licensePlate, std::string_view sailingID,
+                                    std::vector<std::size_t> &slots)
+{
+    return find(KeyIndex::RESERVATION_KEY, hashKey(reservationKey(licensePlate, sailingID)), slots);
+}
+
+bool IndexSnapshot::findSailingReservations(std::string_view sailingID, std::vector<std::size_t> &slots)
+{
+    return find(KeyIndex::RESERVATION_SAILING, hashKey(upper(sailingID)), slots);
+}
+
+bool IndexSnapshot::findVehicles(const std::vector<std::string_view> &licenses, Hits &hits)
+{
+    std::vector<std::uint64_t> hashes;
+    hashes.reserve(licenses.size());
+    for (std::string_view license : licenses)
+        hashes.push_back(hashKey(license));
+    return findMany(KeyIndex::VEHICLE_LICENSE, hashes, hits);
+}
+
+bool IndexSnapshot::findReservations(const std::vector<std::pair<std::string_view, std::string_view>> &keys,
+                                     Hits &hits)
+{
+    std::vector<std::uint64_t> hashes;
+    hashes.reserve(keys.size());
+    for (const auto &key : keys)
+        hashes.push_back(hashKey(reservationKey(key.first, key.second)));
+    return findMany(KeyIndex::RESERVATION_KEY, hashes, hits);
+}
+
+// ============================================================
+// Overlay
+// ============================================================
+void IndexSnapshot::noteInsert(Table table, std::size_t slot, const void *record)
+{
+    noteInserts(table, slot, record, 1);
+}
+
+void IndexSnapshot::noteInserts(Table table, std::size_t firstSlot, const void *records, std::size_t count)
+{
+    const std::size_t recordSize = Compactor::layout(table).recordSize;
+    std::uint64_t generation = 0;
+    std::unique_lock<std::shared_mutex> guard(snapLock);
+    for (int i = 0; i < static_cast<int>(KeyIndex::COUNT); ++i)
+    {
+        KeyIndex k = static_cast<KeyIndex>(i);
+        Snapshot &s = snaps[i];
+        if (info(k).table != table || !s.header)
+            continue;
+        if (generation == 0)
+            generation = DataFile::generation(table);
+
+        // Only a snapshot that has seen every earlier change can take this one
+        if (s.current + 1 != generation)
+            continue;
+        for (std::size_t r = 0; r < count; ++r)
+        {
+            std::uint64_t hash = 0;
+            if (recordHash(k, static_cast<const unsigned char*>(records) + r * recordSize, hash))
+                s.overlay.emplace(hash, static_cast<std::uint32_t>(firstSlot + r));
+        }
+        s.current = generation;
+        s.rows = std::max(s.rows, firstSlot + count);
+        if (s.overlay.size() >= OVERLAY_MERGE_ROWS)
+            mergeLocked(k, s);
+    }
+}
+
+// ============================================================
+// Lifecycle
+// ============================================================
+void IndexSnapshot::open()
+{
+    std::unique_lock<std::shared_mutex> guard(snapLock);
+    for (int i = 0; i < static_cast<int>(KeyIndex::COUNT); ++i)
+    {
+        KeyIndex k = static_cast<KeyIndex>(i);
+        FileHeader data{};
+        if (DataFile::header(info(k).table, data))
+            attachLocked(k, snaps[i], data);
+    }
+}
+
+void IndexSnapshot::close()
+{
+    std::unique_lock<std::shared_mutex> guard(snapLock);
+    for (int i = 0; i < static_cast<int>(KeyIndex::COUNT); ++i)
+    {
+        KeyIndex k = static_cast<KeyIndex>(i);
+        Snapshot &s = snaps[i];
+        if (s.header && s.current == DataFile::generation(info(k).table))
+            mergeLocked(k, s);
+        unmap(s);
+    }
+}
+
+const char *IndexSnapshot::path(KeyIndex index)
+{
+    return info(index).path;
+}
+
+SnapshotStats IndexSnapshot::stats(KeyIndex index)
+{
+    std::shared_lock<std::shared_mutex> guard(snapLock);
+    const Snapshot &s = snaps[static_cast<int>(index)];
+    SnapshotStats st;
+    st.mapped = s.header != nullptr;
+    st.keys = s.header ? static_cast<std::size_t>(s.header->keys) : 0;
+    st.entries = s.header ? static_cast<std::size_t>(s.header->entries) : 0;
+    st.overlay = s.overlay.size();
+    st.generation = s.current;
+    st.builds = s.builds;
+    return st;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,347 @@
+//************************************************************
+//************************************************************
+//  LoggingBackend.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the replication wrapper: every update checks for
+//    the follower role, runs on the wrapped engine under a
+//    WriteGate::Hold and a MutationLog::Writer and, if it
+//    succeeded, is logged before either ends. An update whose
+//    record could not be appended is flagged on stderr and
+//    reports failure (the sailing deletes still return their
+//    count); the change itself stays.
+//************************************************************
+//************************************************************
+
+#include "LoggingBackend.h"
+#include "Replica.h"
+#include "WriteGate.h"
+
+#include <iostream>
+
+namespace FerrySys
+{
+
+namespace
+{
+    MutationRec keyed(MutationOp op, const LicensePlate &license, const SailingID &sailingID)
+    {
+        MutationRec rec = MutationLog::make(op);
+        MutationLog::setField(rec.license, license);
+        MutationLog::setField(rec.sailingID, sailingID);
+        return rec;
+    }
+
+    MutationRec vehicleWritten(const VehicleRecord &vehicle)
+    {
+        MutationRec rec = MutationLog::make(MutationOp::VEHICLE_WRITE);
+        MutationLog::setField(rec.license, vehicle.license);
+        MutationLog::setField(rec.phone, vehicle.phone);
+        rec.arg0 = vehicle.length_m;
+        rec.arg1 = vehicle.height_m;
+        return rec;
+    }
+
+    //------------------------------------------------------------
+    // `ok`, with a message if a change reached the data files but
+    // not the log (replicas would silently miss it)
+    bool logged(bool ok)
+    {
+        if (!ok)
+            std::cerr << "Error: a change was saved but not written to " << MutationLog::LOG_FILE
+                      << "; seed the replicas again.\n";
+        return ok;
+    }
+
+    //------------------------------------------------------------
+    // One SAILING_DELETE per ID added to `removed` since `first`
+    bool logSailingDeletes(const std::vector<SailingID> &removed, std::size_t first)
+    {
+        bool ok = true;
+        for (std::size_t i = first; i < removed.size(); ++i)
+        {
+            MutationRec rec = MutationLog::make(MutationOp::SAILING_DELETE);
+            MutationLog::setField(rec.sailingID, removed[i]);
+            ok &= MutationLog::append(rec);
+        }
+        return logged(ok);
+    }
+}
+
+LoggingBackend::LoggingBackend(std::unique_ptr<StorageBackend> engine)
+    : inner(std::move(engine))
+{
+}
+
+// ============================================================
+// Vehicles
+// ============================================================
+bool LoggingBackend::writeVehicle(const VehicleRecord &vehicle)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeVehicle(vehicle))
+        return false;
+    return logged(MutationLog::append(vehicleWritten(vehicle)));
+}
+
+bool LoggingBackend::findVehicle(const LicensePlate &license, VehicleRecord &result)
+{
+    return inner->findVehicle(license, result);
+}
+
+bool LoggingBackend::findVehicles(const std::vector<LicensePlate> &licenses,
+                                  std::vector<VehicleRecord> &result, std::vector<char> &found)
+{
+    return inner->findVehicles(licenses, result, found);
+}
+
+bool LoggingBackend::writeVehicles(const std::vector<VehicleRecord> &vehicles)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeVehicles(vehicles))
+        return false;
+    bool ok = true;
+    for (const VehicleRecord &vehicle : vehicles)
+        ok &= MutationLog::append(vehicleWritten(vehicle));
+    return logged(ok);
+}
+
+bool LoggingBackend::deleteVehicle(const LicensePlate &license)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->deleteVehicle(license))
+        return false;
+    MutationRec rec = MutationLog::make(MutationOp::VEHICLE_DELETE);
+    MutationLog::setField(rec.license, license);
+    return logged(MutationLog::append(rec));
+}
+
+// ============================================================
+// Vessels
+// ============================================================
+bool LoggingBackend::writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeVessel(vesselName, laneHCL, laneLCL))
+        return false;
+    MutationRec rec = MutationLog::make(MutationOp::VESSEL_WRITE);
+    MutationLog::setField(rec.vesselName, vesselName);
+    rec.arg0 = static_cast<std::int32_t>(laneHCL);
+    rec.arg1 = static_cast<std::int32_t>(laneLCL);
+    return logged(MutationLog::append(rec));
+}
+
+bool LoggingBackend::findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL)
+{
+    return inner->findVessel(vesselName, laneHCL, laneLCL);
+}
+
+bool LoggingBackend::deleteVessel(const std::string &vesselName)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->deleteVessel(vesselName))
+        return false;
+    MutationRec rec = MutationLog::make(MutationOp::VESSEL_DELETE);
+    MutationLog::setField(rec.vesselName, vesselName);
+    return logged(MutationLog::append(rec));
+}
+
+// ============================================================
+// Sailings
+// ============================================================
+bool LoggingBackend::writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                                  float remainingHCL, float remainingLCL)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeSailing(sailingID, vesselName, remainingHCL, remainingLCL))
+        return false;
+    MutationRec rec = MutationLog::make(MutationOp::SAILING_WRITE);
+    MutationLog::setField(rec.sailingID, sailingID);
+    MutationLog::setField(rec.vesselName, vesselName);
+    rec.hcl = remainingHCL;
+    rec.lcl = remainingLCL;
+    return logged(MutationLog::append(rec));
+}
+
+bool LoggingBackend::findSailing(const SailingID &sailingID, Sailingrec &result)
+{
+    return inner->findSailing(sailingID, result);
+}
+
+bool LoggingBackend::setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->setRemainingSpace(sailingID, remainingHCL, remainingLCL))
+        return false;
+    MutationRec rec = MutationLog::make(MutationOp::SAILING_SPACE);
+    MutationLog::setField(rec.sailingID, sailingID);
+    rec.hcl = remainingHCL;
+    rec.lcl = remainingLCL;
+    return logged(MutationLog::append(rec));
+}
+
+bool LoggingBackend::adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                                          float &remainingHCL, float &remainingLCL)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->adjustRemainingSpace(sailingID, deltaHCL, deltaLCL, remainingHCL, remainingLCL))
+        return false;
+    if (deltaHCL == 0.0f && deltaLCL == 0.0f)
+        return true;                                // only read
+    MutationRec rec = MutationLog::make(MutationOp::SAILING_SPACE);
+    MutationLog::setField(rec.sailingID, sailingID);
+    rec.hcl = remainingHCL;
+    rec.lcl = remainingLCL;
+    return logged(MutationLog::append(rec));
+}
+
+std::vector<Sailingrec> LoggingBackend::sailings()
+{
+    return inner->sailings();
+}
+
+std::vector<Sailingrec> LoggingBackend::sailingsToCity(const std::string &city, const std::string &day)
+{
+    return inner->sailingsToCity(city, day);
+}
+
+std::vector<Sailingrec> LoggingBackend::availableSailings(const std::string &city, int day, int hour,
+                                                          std::int32_t spaceCm, bool highCeiling,
+                                                          std::size_t max)
+{
+    return inner->availableSailings(city, day, hour, spaceCm, highCeiling, max);
+}
+
+int LoggingBackend::deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed)
+{
+    if (Replica::isFollower())
+        return 0;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    std::size_t first = removed.size();
+    int n = inner->deleteSailings(sailingIDs, removed);
+    logSailingDeletes(removed, first);     // flagged on stderr; the sailings are gone
+    return n;
+}
+
+int LoggingBackend::deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed)
+{
+    if (Replica::isFollower())
+        return 0;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    std::size_t first = removed.size();
+    int n = inner->deleteSailingsOnDay(day, removed);
+    logSailingDeletes(removed, first);     // flagged on stderr; the sailings are gone
+    return n;
+}
+
+int LoggingBackend::deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed)
+{
+    if (Replica::isFollower())
+        return 0;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    std::size_t first = removed.size();
+    int n = inner->deleteSailingsToCity(city, removed);
+    logSailingDeletes(removed, first);     // flagged on stderr; the sailings are gone
+    return n;
+}
+
+// ============================================================
+// Reservations
+// ============================================================
+bool LoggingBackend::writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeReservation(licensePlate, sailingID))
+        return false;
+    return logged(MutationLog::append(keyed(MutationOp::RESERVATION_WRITE, licensePlate, sailingID)));
+}
+
+bool LoggingBackend::writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->writeReservations(bookings))
+        return false;
+    bool ok = true;
+    for (const auto &booking : bookings)
+        ok &= MutationLog::append(keyed(MutationOp::RESERVATION_WRITE, booking.first, booking.second));
+    return logged(ok);
+}
+
+bool LoggingBackend::checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->checkinReservation(licensePlate, sailingID))
+        return false;
+    return logged(MutationLog::append(keyed(MutationOp::RESERVATION_CHECKIN, licensePlate, sailingID)));
+}
+
+bool LoggingBackend::deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    if (Replica::isFollower())
+        return false;
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    if (!inner->deleteReservation(licensePlate, sailingID))
+        return false;
+    return logged(MutationLog::append(keyed(MutationOp::RESERVATION_DELETE, licensePlate, sailingID)));
+}
+
+bool LoggingBackend::reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    return inner->reservationExists(licensePlate, sailingID);
+}
+
+int LoggingBackend::countReservations(const SailingID &sailingID)
+{
+    return inner->countReservations(sailingID);
+}
+
+bool LoggingBackend::countReservationsBySailing(std::unordered_map<std::string, int> &counts)
+{
+    return inner->countReservationsBySailing(counts);
+}
+
+bool LoggingBackend::readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                                 std::vector<ReservationRec> &rows)
+{
+    return inner->readReservationsForSailings(sailingIDs, rows);
+}
+
+} // namespace FerrySys
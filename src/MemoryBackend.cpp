@@ -0,0 +1,276 @@
+//************************************************************
+//************************************************************
+//  MemoryBackend.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the in-memory storage engine. Records are kept
+//    in the same structs the files use, so callers see exactly
+//    what the file engines would return.
+//************************************************************
+//************************************************************
+
+#include "MemoryBackend.h"
+#include "FileIO_Vessel.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+
+namespace FerrySys
+{
+
+namespace
+{
+    // What the fixed-width field would read back: trailing
+    // padding dropped, as the files do
+    template <class Fixed>
+    Fixed fitted(std::string_view s)
+    {
+        Fixed out(s);
+        std::string_view v = out.view();
+        while (!v.empty() && v.back() == ' ')
+            v.remove_suffix(1);
+        return Fixed(v);
+    }
+
+    // Case-insensitive key
+    template <class Fixed>
+    Fixed upper(std::string_view s)
+    {
+        char buf[Fixed::CAPACITY];
+        Fixed f = fitted<Fixed>(s);
+        std::transform(f.begin(), f.end(), buf, [](unsigned char c) { return std::toupper(c); });
+        return Fixed(std::string_view(buf, f.size()));
+    }
+}
+
+// ============================================================
+// Vehicles
+// ============================================================
+bool MemoryBackend::writeVehicle(const VehicleRecord &vehicle)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::writeVehicle");
+    VehicleRecord stored = vehicle;
+    stored.license = fitted<LicensePlate>(vehicle.license);
+    stored.phone = fitted<PhoneNumber>(vehicle.phone);
+    std::unique_lock<std::shared_mutex> guard(lock);
+    vehicles.emplace(stored.license, stored);
+    return true;
+}
+
+bool MemoryBackend::findVehicle(const LicensePlate &license, VehicleRecord &result)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::findVehicle");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = vehicles.find(license);
+    if (it == vehicles.end())
+        return false;
+    result = it->second;
+    return true;
+}
+
+bool MemoryBackend::deleteVehicle(const LicensePlate &license)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::deleteVehicle");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    return vehicles.erase(license) > 0;
+}
+
+// ============================================================
+// Vessels
+// ============================================================
+bool MemoryBackend::writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::writeVessel");
+    Vesselrec rec{};
+    std::strncpy(rec.vesselName, vesselName.c_str(), sizeof(rec.vesselName) - 1);
+    rec.status = REC_LIVE;
+    rec.laneHCL = static_cast<unsigned short>(laneHCL);
+    rec.laneLCL = static_cast<unsigned short>(laneLCL);
+    std::unique_lock<std::shared_mutex> guard(lock);
+    vessels.emplace(rec.vesselName, rec);
+    return true;
+}
+
+bool MemoryBackend::findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::findVessel");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = vessels.find(vesselName);
+    if (it == vessels.end())
+        return false;
+    laneHCL = it->second.laneHCL;
+    laneLCL = it->second.laneLCL;
+    return true;
+}
+
+bool MemoryBackend::deleteVessel(const std::string &vesselName)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::deleteVessel");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    return vessels.erase(vesselName) > 0;
+}
+
+// ============================================================
+// Sailings
+// ============================================================
+bool MemoryBackend::writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                                 float remainingHCL, float remainingLCL)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::writeSailing");
+    Sailingrec rec{};
+    std::memcpy(rec.id, sailingID.data(), std::min(sailingID.size(), sizeof(rec.id) - 1));
+    std::strncpy(rec.VesselName, vesselName.c_str(), sizeof(rec.VesselName) - 1);
+    rec.status = REC_LIVE;
+    rec.remainingHCL = remainingHCL;
+    rec.remainingLCL = remainingLCL;
+    std::unique_lock<std::shared_mutex> guard(lock);
+    sailingRows.emplace(sailingID, rec);
+    return true;
+}
+
+bool MemoryBackend::findSailing(const SailingID &sailingID, Sailingrec &result)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::findSailing");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = sailingRows.find(sailingID);
+    if (it == sailingRows.end())
+        return false;
+    result = it->second;
+    return true;
+}
+
+bool MemoryBackend::setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::setRemainingSpace");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    auto it = sailingRows.find(sailingID);
+    if (it == sailingRows.end())
+        return false;
+    it->second.remainingHCL = remainingHCL;
+    it->second.remainingLCL = remainingLCL;
+    return true;
+}
+
+std::vector<Sailingrec> MemoryBackend::sailings()
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::sailings");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    std::vector<Sailingrec> rows;
+    rows.reserve(sailingRows.size());
+    for (const auto &kv : sailingRows)
+        rows.push_back(kv.second);
+    return rows;
+}
+
+int MemoryBackend::deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::deleteSailings");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    int count = 0;
+    for (const auto &id : sailingIDs)
+    {
+        if (sailingRows.erase(id) == 0)
+            continue;
+        reservations.erase(upper<SailingID>(id));
+        removed.push_back(id);
+        ++count;
+    }
+    return count;
+}
+
+// ============================================================
+// Reservations
+// ============================================================
+bool MemoryBackend::writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::writeReservation");
+    ReservationRec rec{};
+    encodeField(licensePlate, reinterpret_cast<unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    encodeField(sailingID, reinterpret_cast<unsigned char*>(rec.sailingID), sizeof(rec.sailingID));
+    rec.status = RES_BOOKED;
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    Bookings &bookings = reservations[upper<SailingID>(sailingID)];
+    return bookings.emplace(upper<LicensePlate>(licensePlate), rec).second;
+}
+
+bool MemoryBackend::checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::checkinReservation");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    auto s = reservations.find(upper<SailingID>(sailingID));
+    if (s == reservations.end())
+        return false;
+    auto r = s->second.find(upper<LicensePlate>(licensePlate));
+    if (r == s->second.end())
+        return false;
+    r->second.status = RES_CHECKED_IN;
+    return true;
+}
+
+bool MemoryBackend::deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::deleteReservation");
+    std::unique_lock<std::shared_mutex> guard(lock);
+    auto s = reservations.find(upper<SailingID>(sailingID));
+    if (s == reservations.end() || s->second.erase(upper<LicensePlate>(licensePlate)) == 0)
+        return false;
+    if (s->second.empty())
+        reservations.erase(s);
+    return true;
+}
+
+bool MemoryBackend::reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::reservationExists");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto s = reservations.find(upper<SailingID>(sailingID));
+    if (s == reservations.end())
+        return false;
+    auto r = s->second.find(upper<LicensePlate>(licensePlate));
+    if (r == s->second.end())
+        return false;
+    const ReservationRec &rec = r->second;
+    return fieldView(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS) == licensePlate.view() &&
+           fieldView(reinterpret_cast<const unsigned char*>(rec.sailingID), sizeof(rec.sailingID)) == sailingID.view();
+}
+
+int MemoryBackend::countReservations(const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::countReservations");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto s = reservations.find(upper<SailingID>(sailingID));
+    return s == reservations.end() ? 0 : static_cast<int>(s->second.size());
+}
+
+bool MemoryBackend::countReservationsBySailing(std::unordered_map<std::string, int> &counts)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::countReservationsBySailing");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    counts.clear();
+    for (const auto &kv : reservations)
+        counts[kv.first.str()] = static_cast<int>(kv.second.size());
+    return true;
+}
+
+bool MemoryBackend::readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                                std::vector<ReservationRec> &rows)
+{
+    FERRY_METRIC_SCOPE("MemoryBackend::readReservationsForSailings");
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (const auto &id : sailingIDs)
+    {
+        auto s = reservations.find(upper<SailingID>(id));
+        if (s == reservations.end())
+            continue;
+        for (const auto &kv : s->second)
+            rows.push_back(kv.second);
+    }
+    return true;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,317 @@
+//************************************************************
+//************************************************************
+//  Metrics.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the per-thread histogram and counter blocks.
+//
+//    Each thread owns one ThreadBlock and is its only writer,
+//    so updates are plain relaxed load+store pairs (no atomic
+//    read-modify-write). Blocks are never freed: when a thread
+//    exits its block is released for the next new thread to
+//    adopt, so totals survive and memory stays bounded by the
+//    peak thread count. Histograms are allocated on a thread's
+//    first call of each operation.
+//************************************************************
+//************************************************************
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <map>
+#include <mutex>
+#include <ostream>
+
+namespace FerrySys
+{
+
+namespace
+{
+    // Log-linear bucketing: values below 16 get their own bucket;
+    // above that, each power of two is split into 16 sub-buckets.
+    constexpr int           SUB_BITS = 4;
+    constexpr std::uint64_t SUB_COUNT = 1u << SUB_BITS;
+    constexpr int           MAX_MSB = 39;                       // ~9 minutes in ns
+    constexpr int           BUCKETS = (MAX_MSB - SUB_BITS + 2) * SUB_COUNT;
+
+    int bucketFor(std::uint64_t v)
+    {
+        if (v < SUB_COUNT)
+            return static_cast<int>(v);
+        int msb = 63 - __builtin_clzll(v);
+        if (msb > MAX_MSB)
+            return BUCKETS - 1;
+        int shift = msb - SUB_BITS;
+        return static_cast<int>((shift + 1) * SUB_COUNT + ((v >> shift) - SUB_COUNT));
+    }
+
+    // Largest value that lands in `bucket`
+    std::uint64_t bucketUpper(int bucket)
+    {
+        if (bucket < static_cast<int>(SUB_COUNT))
+            return static_cast<std::uint64_t>(bucket);
+        int shift = bucket / static_cast<int>(SUB_COUNT) - 1;
+        std::uint64_t top = bucket % SUB_COUNT + SUB_COUNT;
+        return ((top + 1) << shift) - 1;
+    }
+
+    // Single-writer increment
+    inline void bump(std::atomic<std::uint64_t> &a, std::uint64_t by)
+    {
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    struct Histogram
+    {
+        std::atomic<std::uint64_t> buckets[BUCKETS] = {};
+        std::atomic<std::uint64_t> calls{ 0 };
+        std::atomic<std::uint64_t> totalNs{ 0 };
+        std::atomic<std::uint64_t> maxNs{ 0 };
+        std::atomic<std::uint64_t> scanned{ 0 };
+    };
+
+    struct ThreadBlock
+    {
+        std::atomic<Histogram*>    hist[Metrics::MAX_OPS] = {};
+        std::atomic<std::uint64_t> counters[static_cast<int>(Counter::COUNT)] = {};
+        std::atomic<bool>          owned{ true };
+        ThreadBlock               *next = nullptr;      // registry chain
+    };
+
+    // Registry: op names and the list of thread blocks
+    std::mutex                registryLock;
+    const char               *opNames[Metrics::MAX_OPS] = {};
+    std::atomic<int>          opCount{ 0 };
+    std::atomic<ThreadBlock*> blocks{ nullptr };
+
+    std::mutex                    gaugeLock;
+    std::map<std::string, double> gauges;
+
+    ThreadBlock *acquireBlock()
+    {
+        // Adopt a block left behind by an exited thread
+        for (ThreadBlock *b = blocks.load(std::memory_order_acquire); b; b = b->next)
+        {
+            bool expected = false;
+            if (b->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                return b;
+        }
+
+        ThreadBlock *b = new ThreadBlock();
+        std::lock_guard<std::mutex> guard(registryLock);
+        b->next = blocks.load(std::memory_order_relaxed);
+        blocks.store(b, std::memory_order_release);
+        return b;
+    }
+
+    struct BlockHolder
+    {
+        ThreadBlock *block = acquireBlock();
+        ~BlockHolder() { block->owned.store(false, std::memory_order_release); }
+    };
+
+    ThreadBlock &myBlock()
+    {
+        thread_local BlockHolder holder;
+        return *holder.block;
+    }
+}
+
+// ============================================================
+// Recording
+// ============================================================
+int Metrics::registerOp(const char *name)
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+    int n = opCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i)
+    {
+        if (std::strcmp(opNames[i], name) == 0)
+            return i;
+    }
+    if (n == MAX_OPS)
+        return -1;
+    opNames[n] = name;
+    opCount.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void Metrics::recordLatency(int op, std::uint64_t nanos, std::uint64_t recordsScanned)
+{
+    if (op < 0 || op >= MAX_OPS)
+        return;
+
+    ThreadBlock &tb = myBlock();
+    Histogram *h = tb.hist[op].load(std::memory_order_relaxed);
+    if (!h)
+    {
+        h = new Histogram();
+        tb.hist[op].store(h, std::memory_order_release);
+    }
+
+    bump(h->buckets[bucketFor(nanos)], 1);
+    bump(h->calls, 1);
+    bump(h->totalNs, nanos);
+    bump(h->scanned, recordsScanned);
+    if (nanos > h->maxNs.load(std::memory_order_relaxed))
+        h->maxNs.store(nanos, std::memory_order_relaxed);
+}
+
+void Metrics::add(Counter c, std::uint64_t amount)
+{
+    bump(myBlock().counters[static_cast<int>(c)], amount);
+}
+
+void Metrics::setGauge(const std::string &name, double value)
+{
+    std::lock_guard<std::mutex> guard(gaugeLock);
+    gauges[name] = value;
+}
+
+std::uint64_t Metrics::threadRecordsScanned()
+{
+    return myBlock().counters[static_cast<int>(Counter::RECORDS_SCANNED)]
+               .load(std::memory_order_relaxed);
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+const OpStats *MetricsSnapshot::find(const std::string &name) const
+{
+    for (const OpStats &op : ops)
+    {
+        if (op.name == name)
+            return &op;
+    }
+    return nullptr;
+}
+
+MetricsSnapshot Metrics::snapshot()
+{
+    MetricsSnapshot snap;
+    int n = opCount.load(std::memory_order_acquire);
+    std::vector<std::uint64_t> merged(static_cast<std::size_t>(n) * BUCKETS, 0);
+    std::vector<OpStats> ops(static_cast<std::size_t>(n));
+
+    for (ThreadBlock *b = blocks.load(std::memory_order_acquire); b; b = b->next)
+    {
+        for (int c = 0; c < static_cast<int>(Counter::COUNT); ++c)
+            snap.counters[c] += b->counters[c].load(std::memory_order_relaxed);
+
+        for (int op = 0; op < n; ++op)
+        {
+            const Histogram *h = b->hist[op].load(std::memory_order_acquire);
+            if (!h)
+                continue;
+            OpStats &s = ops[op];
+            s.calls          += h->calls.load(std::memory_order_relaxed);
+            s.totalNs        += h->totalNs.load(std::memory_order_relaxed);
+            s.recordsScanned += h->scanned.load(std::memory_order_relaxed);
+            s.maxNs = std::max(s.maxNs, h->maxNs.load(std::memory_order_relaxed));
+            std::uint64_t *dst = &merged[static_cast<std::size_t>(op) * BUCKETS];
+            for (int i = 0; i < BUCKETS; ++i)
+                dst[i] += h->buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (int op = 0; op < n; ++op)
+    {
+        OpStats &s = ops[op];
+        if (s.calls == 0)
+            continue;
+        s.name = opNames[op];
+
+        // Percentiles from the merged buckets (bucket upper bound)
+        const std::uint64_t *b = &merged[static_cast<std::size_t>(op) * BUCKETS];
+        std::uint64_t total = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+            total += b[i];
+        const std::uint64_t ranks[3] = { (total * 50 + 99) / 100,
+                                         (total * 90 + 99) / 100,
+                                         (total * 99 + 99) / 100 };
+        std::uint64_t *outs[3] = { &s.p50Ns, &s.p90Ns, &s.p99Ns };
+        std::uint64_t seen = 0;
+        int next = 0;
+        for (int i = 0; i < BUCKETS && next < 3; ++i)
+        {
+            seen += b[i];
+            while (next < 3 && seen >= ranks[next] && ranks[next] > 0)
+                *outs[next++] = std::min(bucketUpper(i), s.maxNs);
+        }
+        snap.ops.push_back(std::move(s));
+    }
+
+    std::sort(snap.ops.begin(), snap.ops.end(),
+              [](const OpStats &a, const OpStats &b) { return a.totalNs > b.totalNs; });
+
+    {
+        std::lock_guard<std::mutex> guard(gaugeLock);
+        snap.gauges.assign(gauges.begin(), gauges.end());
+    }
+    return snap;
+}
+
+void Metrics::dump(std::ostream &out)
+{
+    MetricsSnapshot snap = snapshot();
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    // Leave the caller's stream (usually std::cout) formatted as it was
+    std::ios saved(nullptr);
+    saved.copyfmt(out);
+
+    out << "------------------------------------------------------------------------------------------------\n"
+        << std::left << std::setw(44) << "Operation (latency in us)"
+        << std::right << std::setw(9) << "Calls"
+        << std::setw(10) << "p50" << std::setw(10) << "p90"
+        << std::setw(10) << "p99" << std::setw(10) << "Max"
+        << std::setw(11) << "Recs/Call" << "\n"
+        << "------------------------------------------------------------------------------------------------\n";
+
+    out << std::fixed << std::setprecision(1);
+    for (const OpStats &s : snap.ops)
+    {
+        out << std::left << std::setw(44) << s.name
+            << std::right << std::setw(9) << s.calls
+            << std::setw(10) << us(s.p50Ns) << std::setw(10) << us(s.p90Ns)
+            << std::setw(10) << us(s.p99Ns) << std::setw(10) << us(s.maxNs)
+            << std::setw(11) << static_cast<double>(s.recordsScanned) / static_cast<double>(s.calls)
+            << "\n";
+    }
+
+    std::uint64_t hits = snap.counter(Counter::INDEX_HITS);
+    std::uint64_t misses = snap.counter(Counter::INDEX_MISSES);
+    double hitRate = (hits + misses) ? 100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+
+    out << "------------------------------------------------------------------------------------------------\n"
+        << "File opens          : " << snap.counter(Counter::FILE_OPENS) << "\n"
+        << "Bytes read          : " << snap.counter(Counter::BYTES_READ) << "\n"
+        << "Bytes written       : " << snap.counter(Counter::BYTES_WRITTEN) << "\n"
+        << "Records scanned     : " << snap.counter(Counter::RECORDS_SCANNED) << "\n"
+        << "Index hits / misses : " << hits << " / " << misses
+        << " (" << hitRate << "% hit)\n"
+        << "Rows compacted      : " << snap.counter(Counter::ROWS_COMPACTED) << "\n";
+    out << std::setprecision(3);
+    for (const auto &g : snap.gauges)
+        out << std::left << std::setw(36) << g.first << ": " << g.second << "\n";
+    out << "------------------------------------------------------------------------------------------------\n";
+    out.copyfmt(saved);
+}
+
+bool Metrics::dumpToFile(const std::string &path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        return false;
+    dump(file);
+    return static_cast<bool>(file);
+}
+
+} // namespace FerrySys
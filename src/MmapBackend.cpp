@@ -0,0 +1,578 @@
+//************************************************************
+//************************************************************
+//  MmapBackend.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the memory-mapped storage engine. Every call
+//    runs under one engine lock: attach() the tables it needs,
+//    then scan or store into the mapping. Updates also hold the
+//    WriteGate, taken before the engine lock.
+//************************************************************
+//************************************************************
+
+#include "MmapBackend.h"
+#include "DataFile.h"
+#include "FileIO_Vessel.h"
+#include "FreeList.h"
+#include "Metrics.h"
+#include "SailingTable.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr std::size_t ID_CHARS = 16;
+    constexpr std::size_t MIN_MAP_BYTES = 64 * 1024;
+
+    std::string upper(const std::string &s)
+    {
+        std::string out = s;
+        std::transform(out.begin(), out.end(), out.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return out;
+    }
+
+    std::string cstring(const char *raw, std::size_t width)
+    {
+        return std::string(raw, strnlen(raw, width));
+    }
+
+    std::string licenseOf(const ReservationRec &rec)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    }
+
+    std::string sailingOf(const ReservationRec &rec)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), ID_CHARS);
+    }
+
+    bool dead(const unsigned char *record, Table table)
+    {
+        return record[Compactor::layout(table).statusOffset] == REC_DEAD;
+    }
+}
+
+MmapBackend::~MmapBackend()
+{
+    close();
+}
+
+// ============================================================
+// Mapping management
+// ============================================================
+void MmapBackend::release(Mapping &m)
+{
+    if (m.map)
+        munmap(m.map, m.capacity);
+    if (m.fd >= 0)
+        ::close(m.fd);
+    m = Mapping{};
+}
+
+bool MmapBackend::attach(Table table)
+{
+    const TableLayout &layout = Compactor::layout(table);
+    Mapping &m = maps[static_cast<int>(table)];
+
+    // Creates the file with its header, or upgrades a legacy one
+    if (!DataFile::open(table, true))
+        return false;
+
+    // A file replaced or removed behind our back is reopened
+    struct stat st{};
+    if (m.fd >= 0 && (::stat(layout.file, &st) != 0 || st.st_ino != m.inode))
+        release(m);
+
+    if (m.fd < 0)
+    {
+        m.fd = ::open(layout.file, O_RDWR);
+        Metrics::add(Counter::FILE_OPENS);
+        if (m.fd < 0)
+        {
+            std::cerr << "Error: Could not open " << layout.file << ".\n";
+            return false;
+        }
+    }
+    if (::fstat(m.fd, &st) != 0 || st.st_size < static_cast<off_t>(FILE_HEADER_BYTES))
+        return false;
+    m.inode = st.st_ino;
+    std::size_t records = static_cast<std::size_t>(st.st_size) - FILE_HEADER_BYTES;
+    m.bytes = records / layout.recordSize * layout.recordSize;
+
+    if (m.map && FILE_HEADER_BYTES + m.bytes <= m.capacity)
+        return true;
+
+    // Map (or widen) with room for the file to double
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t want = std::max((FILE_HEADER_BYTES + m.bytes) * 2, MIN_MAP_BYTES);
+    want = (want + page - 1) / page * page;
+    if (m.map)
+        munmap(m.map, m.capacity);
+    void *map = mmap(nullptr, want, PROT_READ | PROT_WRITE, MAP_SHARED, m.fd, 0);
+    if (map == MAP_FAILED)
+    {
+        m.map = m.base = nullptr;
+        m.capacity = 0;
+        return false;
+    }
+    m.map = static_cast<unsigned char*>(map);
+    m.base = m.map + FILE_HEADER_BYTES;
+    m.capacity = want;
+    return true;
+}
+
+bool MmapBackend::insert(Table table, const void *record)
+{
+    const TableLayout &layout = Compactor::layout(table);
+    Mapping &m = maps[static_cast<int>(table)];
+
+    std::size_t slot = 0;
+    if (FreeList::pop(table, slot) && (slot + 1) * layout.recordSize <= m.bytes)
+    {
+        std::memcpy(m.base + slot * layout.recordSize, record, layout.recordSize);
+        Compactor::noteReused(table);
+        Metrics::add(Counter::BYTES_WRITTEN, layout.recordSize);
+        return true;
+    }
+
+    ssize_t n = ::pwrite(m.fd, record, layout.recordSize,
+                         static_cast<off_t>(FILE_HEADER_BYTES + m.bytes));
+    if (n != static_cast<ssize_t>(layout.recordSize))
+        return false;
+    Metrics::add(Counter::BYTES_WRITTEN, layout.recordSize);
+    DataFile::noteAppended(table);
+    return attach(table);
+}
+
+void MmapBackend::compact(Table table)
+{
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    Compactor::compact(table);
+}
+
+void MmapBackend::close()
+{
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    for (Mapping &m : maps)
+        release(m);
+}
+
+// ============================================================
+// Vehicles
+// ============================================================
+bool MmapBackend::writeVehicle(const VehicleRecord &vehicle)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::writeVehicle");
+    WriteGate::Hold hold;
+    VehicleRaw raw{};
+    encodeVehicle(vehicle, raw);
+    std::lock_guard<std::mutex> guard(lock);
+    return attach(Table::VEHICLES) && insert(Table::VEHICLES, raw.data());
+}
+
+bool MmapBackend::findVehicle(const LicensePlate &license, VehicleRecord &result)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::findVehicle");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::VEHICLES))
+        return false;
+    const Mapping &m = maps[static_cast<int>(Table::VEHICLES)];
+    for (std::size_t off = 0; off < m.bytes; off += VEH_REC_BYTES)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        const unsigned char *rec = m.base + off;
+        if (dead(rec, Table::VEHICLES) || decodeField(rec, VEH_LIC_CHARS) != license)
+            continue;
+        VehicleRaw raw;
+        std::memcpy(raw.data(), rec, VEH_REC_BYTES);
+        decodeVehicle(raw, result);
+        return true;
+    }
+    return false;
+}
+
+bool MmapBackend::deleteVehicle(const LicensePlate &license)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::deleteVehicle");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::VEHICLES))
+        return false;
+    Mapping &m = maps[static_cast<int>(Table::VEHICLES)];
+    for (std::size_t off = 0; off < m.bytes; off += VEH_REC_BYTES)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        unsigned char *rec = m.base + off;
+        if (dead(rec, Table::VEHICLES) || decodeField(rec, VEH_LIC_CHARS) != license)
+            continue;
+        rec[VEH_STATUS_OFFSET] = REC_DEAD;
+        Compactor::noteDead(Table::VEHICLES);
+        FreeList::push(Table::VEHICLES, { off / VEH_REC_BYTES });
+        return true;
+    }
+    return false;
+}
+
+// ============================================================
+// Vessels
+// ============================================================
+bool MmapBackend::writeVessel(const std::string &vesselName, unsigned int laneHCL, unsigned int laneLCL)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::writeVessel");
+    WriteGate::Hold hold;
+    Vesselrec rec{};
+    std::strncpy(rec.vesselName, vesselName.c_str(), sizeof(rec.vesselName) - 1);
+    rec.status = REC_LIVE;
+    rec.laneHCL = static_cast<unsigned short>(laneHCL);
+    rec.laneLCL = static_cast<unsigned short>(laneLCL);
+    std::lock_guard<std::mutex> guard(lock);
+    return attach(Table::VESSELS) && insert(Table::VESSELS, &rec);
+}
+
+bool MmapBackend::findVessel(const std::string &vesselName, unsigned int &laneHCL, unsigned int &laneLCL)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::findVessel");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::VESSELS))
+        return false;
+    const Mapping &m = maps[static_cast<int>(Table::VESSELS)];
+    const auto *rows = reinterpret_cast<const Vesselrec*>(m.base);
+    for (std::size_t i = 0; i < m.bytes / sizeof(Vesselrec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status == REC_DEAD || cstring(rows[i].vesselName, sizeof(rows[i].vesselName)) != vesselName)
+            continue;
+        laneHCL = rows[i].laneHCL;
+        laneLCL = rows[i].laneLCL;
+        return true;
+    }
+    return false;
+}
+
+bool MmapBackend::deleteVessel(const std::string &vesselName)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::deleteVessel");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::VESSELS))
+        return false;
+    Mapping &m = maps[static_cast<int>(Table::VESSELS)];
+    auto *rows = reinterpret_cast<Vesselrec*>(m.base);
+    for (std::size_t i = 0; i < m.bytes / sizeof(Vesselrec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status == REC_DEAD || cstring(rows[i].vesselName, sizeof(rows[i].vesselName)) != vesselName)
+            continue;
+        rows[i].status = REC_DEAD;
+        Compactor::noteDead(Table::VESSELS);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================
+// Sailings
+// ============================================================
+bool MmapBackend::writeSailing(const SailingID &sailingID, const std::string &vesselName,
+                               float remainingHCL, float remainingLCL)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::writeSailing");
+    WriteGate::Hold hold;
+    Sailingrec rec{};
+    std::memcpy(rec.id, sailingID.data(), std::min(sailingID.size(), sizeof(rec.id) - 1));
+    std::strncpy(rec.VesselName, vesselName.c_str(), sizeof(rec.VesselName) - 1);
+    rec.status = REC_LIVE;
+    rec.remainingHCL = remainingHCL;
+    rec.remainingLCL = remainingLCL;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::SAILINGS) || !insert(Table::SAILINGS, &rec))
+        return false;
+    SailingTable::forget();             // stores to the mapping may not touch the file's mtime
+    return true;
+}
+
+bool MmapBackend::findSailing(const SailingID &sailingID, Sailingrec &result)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::findSailing");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::SAILINGS))
+        return false;
+    const Mapping &m = maps[static_cast<int>(Table::SAILINGS)];
+    const auto *rows = reinterpret_cast<const Sailingrec*>(m.base);
+    for (std::size_t i = 0; i < m.bytes / sizeof(Sailingrec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && cstring(rows[i].id, sizeof(rows[i].id)) == sailingID)
+        {
+            std::memcpy(&result, &rows[i], sizeof(Sailingrec));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MmapBackend::setRemainingSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::setRemainingSpace");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::SAILINGS))
+        return false;
+    Mapping &m = maps[static_cast<int>(Table::SAILINGS)];
+    auto *rows = reinterpret_cast<Sailingrec*>(m.base);
+    for (std::size_t i = 0; i < m.bytes / sizeof(Sailingrec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && cstring(rows[i].id, sizeof(rows[i].id)) == sailingID)
+        {
+            rows[i].remainingHCL = remainingHCL;
+            rows[i].remainingLCL = remainingLCL;
+            SailingTable::forget();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Sailingrec> MmapBackend::sailings()
+{
+    FERRY_METRIC_SCOPE("MmapBackend::sailings");
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<Sailingrec> result;
+    if (!attach(Table::SAILINGS))
+        return result;
+    const Mapping &m = maps[static_cast<int>(Table::SAILINGS)];
+    const auto *rows = reinterpret_cast<const Sailingrec*>(m.base);
+    std::size_t n = m.bytes / sizeof(Sailingrec);
+    Metrics::add(Counter::RECORDS_SCANNED, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (rows[i].status != REC_DEAD)
+            result.push_back(rows[i]);
+    }
+    return result;
+}
+
+int MmapBackend::deleteSailings(const std::vector<SailingID> &sailingIDs, std::vector<SailingID> &removed)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::deleteSailings");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::SAILINGS) || !attach(Table::RESERVATIONS))
+        return 0;
+
+    // Tombstone the sailings...
+    std::unordered_set<std::string> doomed(sailingIDs.begin(), sailingIDs.end());
+    std::unordered_set<std::string> gone;
+    Mapping &s = maps[static_cast<int>(Table::SAILINGS)];
+    auto *sailingRows = reinterpret_cast<Sailingrec*>(s.base);
+    int count = 0;
+    for (std::size_t i = 0; i < s.bytes / sizeof(Sailingrec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (sailingRows[i].status == REC_DEAD)
+            continue;
+        std::string id = cstring(sailingRows[i].id, sizeof(sailingRows[i].id));
+        if (doomed.count(id) == 0)
+            continue;
+        sailingRows[i].status = REC_DEAD;
+        removed.push_back(id);
+        gone.insert(upper(id));
+        ++count;
+    }
+    if (count == 0)
+        return 0;
+    Compactor::noteDead(Table::SAILINGS, count);
+    SailingTable::forget();
+
+    // ...then their reservations in one pass
+    Mapping &r = maps[static_cast<int>(Table::RESERVATIONS)];
+    auto *resRows = reinterpret_cast<ReservationRec*>(r.base);
+    std::vector<std::size_t> slots;
+    for (std::size_t i = 0; i < r.bytes / sizeof(ReservationRec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (resRows[i].status == REC_DEAD || gone.count(upper(sailingOf(resRows[i]))) == 0)
+            continue;
+        resRows[i].status = REC_DEAD;
+        slots.push_back(i);
+    }
+    if (!slots.empty())
+    {
+        Compactor::noteDead(Table::RESERVATIONS, slots.size());
+        FreeList::push(Table::RESERVATIONS, slots);
+    }
+    return count;
+}
+
+// ============================================================
+// Reservations
+// ============================================================
+bool MmapBackend::writeReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::writeReservation");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return false;
+
+    // Reject duplicates (case-insensitive)
+    const Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    const auto *rows = reinterpret_cast<const ReservationRec*>(m.base);
+    std::string license = upper(licensePlate), id = upper(sailingID);
+    for (std::size_t i = 0; i < m.bytes / sizeof(ReservationRec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && upper(sailingOf(rows[i])) == id && upper(licenseOf(rows[i])) == license)
+            return false;
+    }
+
+    ReservationRec rec{};
+    encodeField(licensePlate, reinterpret_cast<unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    encodeField(sailingID, reinterpret_cast<unsigned char*>(rec.sailingID), ID_CHARS);
+    rec.status = RES_BOOKED;
+    return insert(Table::RESERVATIONS, &rec);
+}
+
+bool MmapBackend::checkinReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::checkinReservation");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return false;
+    Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    auto *rows = reinterpret_cast<ReservationRec*>(m.base);
+    std::string license = upper(licensePlate), id = upper(sailingID);
+    for (std::size_t i = 0; i < m.bytes / sizeof(ReservationRec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && upper(sailingOf(rows[i])) == id && upper(licenseOf(rows[i])) == license)
+        {
+            rows[i].status = RES_CHECKED_IN;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MmapBackend::deleteReservation(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::deleteReservation");
+    WriteGate::Hold hold;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return false;
+    Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    auto *rows = reinterpret_cast<ReservationRec*>(m.base);
+    std::string license = upper(licensePlate), id = upper(sailingID);
+    for (std::size_t i = 0; i < m.bytes / sizeof(ReservationRec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && upper(sailingOf(rows[i])) == id && upper(licenseOf(rows[i])) == license)
+        {
+            rows[i].status = REC_DEAD;
+            Compactor::noteDead(Table::RESERVATIONS);
+            FreeList::push(Table::RESERVATIONS, { i });
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MmapBackend::reservationExists(const LicensePlate &licensePlate, const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::reservationExists");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return false;
+    const Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    const auto *rows = reinterpret_cast<const ReservationRec*>(m.base);
+    for (std::size_t i = 0; i < m.bytes / sizeof(ReservationRec); ++i)
+    {
+        Metrics::add(Counter::RECORDS_SCANNED);
+        if (rows[i].status != REC_DEAD && sailingOf(rows[i]) == sailingID && licenseOf(rows[i]) == licensePlate)
+            return true;
+    }
+    return false;
+}
+
+int MmapBackend::countReservations(const SailingID &sailingID)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::countReservations");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return 0;
+    const Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    const auto *rows = reinterpret_cast<const ReservationRec*>(m.base);
+    std::size_t n = m.bytes / sizeof(ReservationRec);
+    Metrics::add(Counter::RECORDS_SCANNED, n);
+    std::string id = upper(sailingID);
+    int count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (rows[i].status != REC_DEAD && upper(sailingOf(rows[i])) == id)
+            ++count;
+    }
+    return count;
+}
+
+bool MmapBackend::countReservationsBySailing(std::unordered_map<std::string, int> &counts)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::countReservationsBySailing");
+    std::lock_guard<std::mutex> guard(lock);
+    counts.clear();
+    if (!attach(Table::RESERVATIONS))
+        return false;
+    const Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    const auto *rows = reinterpret_cast<const ReservationRec*>(m.base);
+    std::size_t n = m.bytes / sizeof(ReservationRec);
+    Metrics::add(Counter::RECORDS_SCANNED, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (rows[i].status != REC_DEAD)
+            ++counts[upper(sailingOf(rows[i]))];
+    }
+    return true;
+}
+
+bool MmapBackend::readReservationsForSailings(const std::vector<SailingID> &sailingIDs,
+                                              std::vector<ReservationRec> &rows)
+{
+    FERRY_METRIC_SCOPE("MmapBackend::readReservationsForSailings");
+    std::lock_guard<std::mutex> guard(lock);
+    if (!attach(Table::RESERVATIONS))
+        return false;
+    std::unordered_set<std::string> wanted;
+    for (const auto &id : sailingIDs)
+        wanted.insert(upper(id));
+
+    const Mapping &m = maps[static_cast<int>(Table::RESERVATIONS)];
+    const auto *all = reinterpret_cast<const ReservationRec*>(m.base);
+    std::size_t n = m.bytes / sizeof(ReservationRec);
+    Metrics::add(Counter::RECORDS_SCANNED, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (all[i].status != REC_DEAD && wanted.count(upper(sailingOf(all[i]))))
+            rows.push_back(all[i]);
+    }
+    return true;
+}
+
+} // namespace FerrySys
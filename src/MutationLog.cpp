@@ -0,0 +1,393 @@
+//************************************************************
+//************************************************************
+//  MutationLog.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the mutation log. The log file is opened on the
+//    first Writer that finds it and kept open. A thread that
+//    finds no log remembers that against the replication count
+//    in sailings.space (CapacityTable::replicationVersion), which
+//    create() and trim() bump, and looks again only once it has
+//    moved: while logging is off an update costs one load, and
+//    seeding a replica still turns logging on for processes
+//    already running. A Writer holds a process-wide mutex (flock
+//    does not order threads sharing one descriptor) and the
+//    flock; it reopens the log if the file was replaced while it
+//    waited, as it is by trim().
+//************************************************************
+//************************************************************
+
+#include "MutationLog.h"
+#include "CapacityTable.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr std::size_t REC_BYTES = sizeof(MutationRec);
+
+    std::mutex logLock;                 // logFd
+    int        logFd = -1;
+
+    std::mutex       writerLock;        // one Writer per process
+    thread_local int writerDepth = 0;   // Writers on this thread
+    thread_local int writerFd = -1;     // log locked by this thread's Writer
+
+    //------------------------------------------------------------
+    // No log was found at `version` (and no reset() since)
+    struct Absent
+    {
+        bool                           known = false;
+        std::uint64_t                  resets = 0;
+        CapacityTable::SailingsVersion version;
+    };
+    std::atomic<std::uint64_t> resets{ 0 };     // reset() calls
+    thread_local Absent        absent;          // this thread's last look
+
+    bool stillAbsent(const CapacityTable::SailingsVersion &now, std::uint64_t resetsNow)
+    {
+        return absent.known && absent.resets == resetsNow &&
+               absent.version.attachment == now.attachment && absent.version.changes == now.changes;
+    }
+
+    int openLog()
+    {
+        std::lock_guard<std::mutex> guard(logLock);
+        if (logFd < 0)
+        {
+            logFd = ::open(MutationLog::LOG_FILE, O_WRONLY | O_APPEND | O_CLOEXEC);
+            if (logFd >= 0)
+                Metrics::add(Counter::FILE_OPENS);
+        }
+        return logFd;
+    }
+
+    //------------------------------------------------------------
+    // Drop `fd` if it is still the open log (the file behind it
+    // was replaced or removed)
+    void closeLog(int fd)
+    {
+        std::lock_guard<std::mutex> guard(logLock);
+        if (logFd == fd)
+        {
+            ::close(logFd);
+            logFd = -1;
+        }
+    }
+
+    bool lockFile(int fd, int op)
+    {
+        int rc;
+        do
+            rc = ::flock(fd, op);
+        while (rc != 0 && errno == EINTR);
+        return rc == 0;
+    }
+
+    //------------------------------------------------------------
+    // Where the records of an open log start, and what LSNs
+    // they hold
+    struct Extent
+    {
+        std::uint64_t base = 0;         // LSN before the first record
+        off_t         start = 0;        // offset of that record
+        std::uint64_t last = 0;         // LSN of the last whole record
+    };
+
+    bool readAt(int fd, void *buf, std::size_t bytes, off_t offset)
+    {
+        std::size_t done = 0;
+        while (done < bytes)
+        {
+            ssize_t n = ::pread(fd, static_cast<char*>(buf) + done, bytes - done,
+                                offset + static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<std::size_t>(n);
+        }
+        Metrics::recordRead(done);
+        return done == bytes;
+    }
+
+    bool extentOf(int fd, Extent &extent)
+    {
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+            return false;
+        std::uint64_t records = static_cast<std::uint64_t>(st.st_size) / REC_BYTES;
+        MutationRec first{};
+        if (records > 0)
+        {
+            if (!readAt(fd, &first, REC_BYTES, 0))
+                return false;
+            if (first.op == static_cast<std::uint8_t>(MutationOp::LOG_BASE))
+            {
+                extent.base = static_cast<std::uint32_t>(first.arg0) |
+                              static_cast<std::uint64_t>(static_cast<std::uint32_t>(first.arg1)) << 32;
+                extent.start = static_cast<off_t>(REC_BYTES);
+                --records;
+            }
+        }
+        extent.last = extent.base + records;
+        return true;
+    }
+
+    bool extentOf(const std::string &path, Extent &extent)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        Metrics::add(Counter::FILE_OPENS);
+        bool ok = extentOf(fd, extent);
+        ::close(fd);
+        return ok;
+    }
+
+    bool syncDirectory()
+    {
+        int fd = ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    //------------------------------------------------------------
+    // True if `fd` is the file now named LOG_FILE
+    bool isCurrent(int fd)
+    {
+        struct stat open{}, named{};
+        return ::fstat(fd, &open) == 0 && ::stat(MutationLog::LOG_FILE, &named) == 0 &&
+               open.st_dev == named.st_dev && open.st_ino == named.st_ino;
+    }
+}
+
+// ============================================================
+// Writer
+// ============================================================
+MutationLog::Writer::Writer()
+{
+    if (writerDepth++ > 0)
+        return;
+
+    // Read before looking, so a log created meanwhile moves it
+    CapacityTable::SailingsVersion now;
+    std::uint64_t resetsNow = resets.load(std::memory_order_acquire);
+    bool stamped = CapacityTable::replicationVersion(now);
+    if (stamped && stillAbsent(now, resetsNow))
+        return;                         // logging is off
+
+    writerLock.lock();
+    int fd = openLog();
+    for (; fd >= 0; fd = openLog())
+    {
+        if (!lockFile(fd, LOCK_EX))
+            break;
+        if (isCurrent(fd))
+        {
+            writerFd = fd;
+            locked = true;
+            absent.known = false;
+            return;
+        }
+        lockFile(fd, LOCK_UN);
+        closeLog(fd);
+    }
+    writerLock.unlock();                // logging is off
+    absent.known = stamped && fd < 0;
+    absent.resets = resetsNow;
+    absent.version = now;
+}
+
+MutationLog::Writer::~Writer()
+{
+    if (--writerDepth > 0 || !locked)
+        return;
+    lockFile(writerFd, LOCK_UN);
+    writerFd = -1;
+    writerLock.unlock();
+}
+
+MutationRec MutationLog::make(MutationOp op)
+{
+    MutationRec rec;
+    std::memset(&rec, 0, sizeof(rec));
+    rec.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::system_clock::now().time_since_epoch()).count();
+    rec.op = static_cast<std::uint8_t>(op);
+    return rec;
+}
+
+bool MutationLog::append(const MutationRec &rec)
+{
+    Writer writer;
+    int fd = writerFd;
+    if (fd < 0)
+        return true;                    // logging is off
+
+    // Whole records only: a torn tail would shift every record after it
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+        return false;
+    off_t end = st.st_size - st.st_size % static_cast<off_t>(REC_BYTES);
+    if (end != st.st_size && ::ftruncate(fd, end) != 0)
+        return false;
+
+    ssize_t n;
+    do
+        n = ::write(fd, &rec, REC_BYTES);
+    while (n < 0 && errno == EINTR);
+    Metrics::add(Counter::BYTES_WRITTEN, n > 0 ? static_cast<std::size_t>(n) : 0);
+    if (n == static_cast<ssize_t>(REC_BYTES))
+        return true;
+    if (n > 0 && ::ftruncate(fd, end) != 0)
+        std::cerr << "Error: cannot cut a partial record off " << LOG_FILE << ".\n";
+    return false;
+}
+
+bool MutationLog::create()
+{
+    int fd = ::open(LOG_FILE, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    ::close(fd);
+    CapacityTable::noteReplicationChanged();
+    return true;
+}
+
+std::uint64_t MutationLog::lastLsn(const std::string &path)
+{
+    Extent extent;
+    return extentOf(path, extent) ? extent.last : 0;
+}
+
+std::uint64_t MutationLog::baseLsn(const std::string &path)
+{
+    Extent extent;
+    return extentOf(path, extent) ? extent.base : 0;
+}
+
+bool MutationLog::read(const std::string &path, std::uint64_t afterLsn, std::size_t max,
+                       std::vector<MutationRec> &out)
+{
+    out.clear();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    Metrics::add(Counter::FILE_OPENS);
+
+    // Sized from this descriptor, so a trim renaming a new log in
+    // meanwhile cannot mix the two files
+    Extent extent;
+    if (!extentOf(fd, extent) || afterLsn < extent.base)
+    {
+        ::close(fd);
+        return false;
+    }
+    std::size_t count = static_cast<std::size_t>(extent.last > afterLsn ? extent.last - afterLsn : 0);
+    count = count < max ? count : max;
+    out.resize(count);
+    bool ok = readAt(fd, out.data(), count * REC_BYTES,
+                     extent.start + static_cast<off_t>((afterLsn - extent.base) * REC_BYTES));
+    ::close(fd);
+    if (!ok)
+        out.clear();
+    return ok;
+}
+
+long MutationLog::trim(std::uint64_t keepAfterLsn)
+{
+    Writer writer;
+    if (writerFd < 0)
+        return 0;                       // logging is off
+
+    // Read through a descriptor of our own: the log is open for
+    // appends only. No other Writer runs, so both name one file.
+    int in = ::open(LOG_FILE, O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return -1;
+    Metrics::add(Counter::FILE_OPENS);
+    Extent extent;
+    if (!extentOf(in, extent))
+    {
+        ::close(in);
+        return -1;
+    }
+    keepAfterLsn = keepAfterLsn < extent.last ? keepAfterLsn : extent.last;
+    if (keepAfterLsn <= extent.base)
+    {
+        ::close(in);
+        return 0;
+    }
+
+    std::string tmp = std::string(LOG_FILE) + ".tmp";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0)
+    {
+        ::close(in);
+        return -1;
+    }
+    Metrics::add(Counter::FILE_OPENS);
+
+    MutationRec base = make(MutationOp::LOG_BASE);
+    base.arg0 = static_cast<std::int32_t>(static_cast<std::uint32_t>(keepAfterLsn));
+    base.arg1 = static_cast<std::int32_t>(static_cast<std::uint32_t>(keepAfterLsn >> 32));
+    std::vector<char> block(4096 * REC_BYTES);
+    std::memcpy(block.data(), &base, REC_BYTES);
+    std::size_t fill = REC_BYTES;
+    off_t from = extent.start + static_cast<off_t>((keepAfterLsn - extent.base) * REC_BYTES);
+    off_t end = extent.start + static_cast<off_t>((extent.last - extent.base) * REC_BYTES);
+    bool ok = true;
+    while (ok && (fill > 0 || from < end))
+    {
+        std::size_t take = static_cast<std::size_t>(end - from) < block.size() - fill
+                               ? static_cast<std::size_t>(end - from) : block.size() - fill;
+        ok = readAt(in, block.data() + fill, take, from);
+        from += static_cast<off_t>(take);
+        fill += take;
+        ok = ok && ::write(out, block.data(), fill) == static_cast<ssize_t>(fill);
+        Metrics::add(Counter::BYTES_WRITTEN, fill);
+        fill = 0;
+    }
+    ok = ok && ::fsync(out) == 0;
+    ::close(out);
+    ::close(in);
+    if (!ok || ::rename(tmp.c_str(), LOG_FILE) != 0)
+    {
+        ::unlink(tmp.c_str());
+        return -1;
+    }
+    syncDirectory();
+    CapacityTable::noteReplicationChanged();
+
+    // Writers waiting on the old file find it replaced and reopen
+    return static_cast<long>(keepAfterLsn - extent.base);
+}
+
+void MutationLog::reset()
+{
+    std::lock_guard<std::mutex> guard(logLock);
+    if (logFd >= 0)
+        ::close(logFd);
+    logFd = -1;
+    resets.fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // namespace FerrySys
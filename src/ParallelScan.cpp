@@ -0,0 +1,102 @@
+//************************************************************
+//************************************************************
+//  ParallelScan.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Chunking and bulk-read helpers behind parallelScan().
+//************************************************************
+//************************************************************
+
+#include "ParallelScan.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+    namespace fs = std::filesystem;
+
+    ThreadPool &scanPool()
+    {
+        static ThreadPool pool(0);
+        return pool;
+    }
+
+    std::size_t fileRecordCount(const std::string &path, std::size_t recordSize)
+    {
+        std::error_code ec;
+        std::uintmax_t bytes = fs::file_size(path, ec);
+        if (ec || recordSize == 0)
+            return 0;
+        std::size_t header = bytes > 0 ? dataOffset(path, recordSize) : 0;
+        if (header == BAD_HEADER)
+            return 0;
+        return static_cast<std::size_t>((bytes - header) / recordSize);
+    }
+
+    std::vector<ScanChunk> splitRecords(std::size_t totalRecords, std::size_t workers)
+    {
+        std::vector<ScanChunk> chunks;
+        if (totalRecords == 0)
+            return chunks;
+
+        if (totalRecords < SCAN_MIN_PARALLEL)
+        {
+            chunks.push_back({ 0, totalRecords });
+            return chunks;
+        }
+
+        // One worker still reads in bounded chunks, one at a time
+        std::size_t target = (workers > 1 ? workers : 1) * SCAN_CHUNKS_PER_WORKER;
+        std::size_t per    = (totalRecords + target - 1) / target;
+        if (per > SCAN_CHUNK_RECORDS || workers <= 1)
+            per = SCAN_CHUNK_RECORDS;
+
+        for (std::size_t first = 0; first < totalRecords; first += per)
+        {
+            std::size_t count = (totalRecords - first < per) ? totalRecords - first : per;
+            chunks.push_back({ first, count });
+        }
+        return chunks;
+    }
+
+    bool readChunk(const std::string &path, std::size_t recordSize, std::size_t dataStart,
+                   const ScanChunk &chunk, std::vector<unsigned char> &buf)
+    {
+        buf.clear();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        const std::size_t want = chunk.count * recordSize;
+        const off_t at = static_cast<off_t>(dataStart + chunk.first * recordSize);
+        buf.resize(want);
+        std::size_t got = 0;
+        ssize_t n = 0;
+        while (got < want)
+        {
+            n = ::pread(fd, buf.data() + got, want - got, at + static_cast<off_t>(got));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            got += static_cast<std::size_t>(n);
+        }
+
+        // Short only because the file ends there (it shrank meanwhile)
+        struct stat st{};
+        bool whole = got == want ||
+                     (n == 0 && ::fstat(fd, &st) == 0 &&
+                      static_cast<std::uint64_t>(st.st_size) <= static_cast<std::uint64_t>(at) + got);
+        ::close(fd);
+
+        // Keep whole records only
+        buf.resize(got - got % recordSize);
+        return whole;
+    }
+}
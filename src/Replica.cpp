@@ -0,0 +1,383 @@
+//************************************************************
+//************************************************************
+//  Replica.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements seeding, log apply, lag and log checkpoints for
+//    read replicas. replica.pos is two text lines, "primary
+//    <dir>" and "lsn <n>", replaced with a rename after each
+//    batch. replicas.list holds one absolute follower directory
+//    per line; it is changed only inside a MutationLog::Writer,
+//    so a checkpoint never misses a replica being seeded.
+//    isFollower() runs on every update, so each thread keeps its
+//    answer until the replication count in sailings.space moves
+//    (CapacityTable::replicationVersion).
+//************************************************************
+//************************************************************
+
+#include "Replica.h"
+#include "Backup.h"
+#include "CapacityTable.h"
+#include "Metrics.h"
+#include "MutationLog.h"
+#include "StorageBackend.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <vector>
+
+namespace FerrySys
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    //------------------------------------------------------------
+    // This thread's last isFollower() answer and the count it
+    // was found at
+    struct FollowerCheck
+    {
+        bool                           known = false;
+        bool                           follower = false;
+        CapacityTable::SailingsVersion version;
+    };
+    thread_local FollowerCheck lastCheck;
+
+    struct Position
+    {
+        std::string   primaryDir;
+        std::uint64_t lsn = 0;
+    };
+
+    bool readPosition(const std::string &path, Position &pos)
+    {
+        std::ifstream in(path);
+        std::string key;
+        in >> key;
+        if (key != "primary")
+            return false;
+        in >> std::ws;
+        std::getline(in, pos.primaryDir);
+        in >> key >> pos.lsn;
+        return key == "lsn" && static_cast<bool>(in) && !pos.primaryDir.empty();
+    }
+
+    bool writePosition(const std::string &path, const Position &pos)
+    {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out << "primary " << pos.primaryDir << "\n"
+                << "lsn " << pos.lsn << "\n";
+            out.close();
+            if (!out)
+                return false;
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        return !ec;
+    }
+
+    //------------------------------------------------------------
+    // replicas.list: read, and replace with a rename
+    std::vector<std::string> readList()
+    {
+        std::vector<std::string> dirs;
+        std::ifstream in(Replica::REPLICAS_FILE);
+        for (std::string line; std::getline(in, line);)
+        {
+            if (!line.empty())
+                dirs.push_back(line);
+        }
+        return dirs;
+    }
+
+    bool writeList(const std::vector<std::string> &dirs)
+    {
+        std::string tmp = std::string(Replica::REPLICAS_FILE) + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            for (const std::string &dir : dirs)
+                out << dir << "\n";
+            out.close();
+            if (!out)
+                return false;
+        }
+        std::error_code ec;
+        fs::rename(tmp, Replica::REPLICAS_FILE, ec);
+        return !ec;
+    }
+
+    std::string thisDir()
+    {
+        std::error_code ec;
+        return fs::absolute(fs::current_path(ec), ec).string();
+    }
+
+    // Whole records in this directory's log file, trimmed or not
+    std::uint64_t logRecords()
+    {
+        struct stat st{};
+        if (::stat(MutationLog::LOG_FILE, &st) != 0)
+            return 0;
+        return static_cast<std::uint64_t>(st.st_size) / sizeof(MutationRec);
+    }
+
+    std::atomic<std::uint64_t> checkedRecords{ 0 };    // logRecords() after the last checkpoint()
+
+    std::string logPath(const Position &pos)
+    {
+        return (fs::path(pos.primaryDir) / MutationLog::LOG_FILE).string();
+    }
+
+    //------------------------------------------------------------
+    // Apply one record. Each step checks first, so a record that
+    // was already applied changes nothing.
+    void apply(StorageBackend &store, const MutationRec &rec)
+    {
+        std::string license = MutationLog::field(rec.license);
+        std::string sailing = MutationLog::field(rec.sailingID);
+        std::string vessel = MutationLog::field(rec.vesselName);
+
+        switch (static_cast<MutationOp>(rec.op))
+        {
+            case MutationOp::VEHICLE_WRITE:
+                if (!store.vehicleExists(license))
+                    store.writeVehicle(VehicleRecord{ license, MutationLog::field(rec.phone), rec.arg0, rec.arg1 });
+                break;
+            case MutationOp::VEHICLE_DELETE:
+                if (store.vehicleExists(license))
+                    store.deleteVehicle(license);
+                break;
+            case MutationOp::VESSEL_WRITE:
+                if (!store.vesselExists(vessel))
+                    store.writeVessel(vessel, static_cast<unsigned int>(rec.arg0), static_cast<unsigned int>(rec.arg1));
+                break;
+            case MutationOp::VESSEL_DELETE:
+                if (store.vesselExists(vessel))
+                    store.deleteVessel(vessel);
+                break;
+            case MutationOp::SAILING_WRITE:
+                if (!store.sailingExists(sailing))
+                    store.writeSailing(sailing, vessel, rec.hcl, rec.lcl);
+                CapacityTable::remove(sailing);         // reloaded on next use
+                break;
+            case MutationOp::SAILING_SPACE:
+                store.setRemainingSpace(sailing, rec.hcl, rec.lcl);
+                CapacityTable::remove(sailing);
+                break;
+            case MutationOp::SAILING_DELETE:
+                if (store.sailingExists(sailing))
+                    store.deleteSailing(sailing);
+                CapacityTable::remove(sailing);
+                break;
+            case MutationOp::RESERVATION_WRITE:
+                if (!store.reservationExists(license, sailing))
+                    store.writeReservation(license, sailing);
+                break;
+            case MutationOp::RESERVATION_CHECKIN:
+                store.checkinReservation(license, sailing);
+                break;
+            case MutationOp::RESERVATION_DELETE:
+                if (store.reservationExists(license, sailing))
+                    store.deleteReservation(license, sailing);
+                break;
+            case MutationOp::LOG_BASE:
+                break;
+        }
+    }
+}
+
+bool Replica::isFollower()
+{
+    CapacityTable::SailingsVersion now;
+    bool stamped = CapacityTable::replicationVersion(now);
+    if (stamped && lastCheck.known && lastCheck.version.attachment == now.attachment &&
+        lastCheck.version.changes == now.changes)
+        return lastCheck.follower;
+
+    struct stat st{};
+    bool follower = ::stat(POSITION_FILE, &st) == 0;
+    lastCheck.known = stamped;
+    lastCheck.follower = follower;
+    lastCheck.version = now;
+    return follower;
+}
+
+// ============================================================
+// Seed
+// ============================================================
+bool Replica::seed(const std::string &followerDir)
+{
+    FERRY_METRIC_SCOPE("Replica::seed");
+    if (isFollower())
+    {
+        std::cerr << "Error: this directory is itself a replica.\n";
+        return false;
+    }
+
+    // Listed before the copy, so no checkpoint drops records the
+    // new replica has not applied
+    Position pos;
+    pos.primaryDir = thisDir();
+    std::error_code ec;
+    std::string follower = fs::absolute(followerDir, ec).lexically_normal().string();
+    auto list = [&](bool add) {
+        WriteGate::Hold hold;
+        MutationLog::Writer writer;
+        std::vector<std::string> dirs = readList();
+        auto at = std::find(dirs.begin(), dirs.end(), follower);
+        if ((at != dirs.end()) == add)
+            return true;
+        if (add)
+            dirs.push_back(follower);
+        else
+            dirs.erase(at);
+        return writeList(dirs);
+    };
+    if (!MutationLog::create() || !list(true))
+    {
+        std::cerr << "Error: cannot list the replica in " << REPLICAS_FILE << ".\n";
+        return false;
+    }
+
+    bool logged = false;
+    BackupResult copy = Backup::create(followerDir, [&] {
+        // No update runs while the copy is paused, so the copy
+        // holds exactly the changes up to the current end of log
+        logged = MutationLog::create();
+        pos.lsn = MutationLog::lastLsn(MutationLog::LOG_FILE);
+    });
+    if (!copy.ok)
+    {
+        list(false);
+        return false;
+    }
+    if (!logged)
+    {
+        std::cerr << "Error: cannot create " << MutationLog::LOG_FILE << ".\n";
+        list(false);
+        return false;
+    }
+    if (!writePosition((fs::path(followerDir) / POSITION_FILE).string(), pos))
+    {
+        std::cerr << "Error: cannot write " << POSITION_FILE << " in " << followerDir << ".\n";
+        list(false);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================
+// Apply
+// ============================================================
+long Replica::catchUp(std::size_t max)
+{
+    FERRY_TRACE_SPAN("Replica::catchUp");
+    Position pos;
+    if (!readPosition(POSITION_FILE, pos))
+        return -1;
+    std::vector<MutationRec> records;
+    if (!MutationLog::read(logPath(pos), pos.lsn, max, records))
+    {
+        static std::atomic<bool> reported{ false };
+        if (pos.lsn < MutationLog::baseLsn(logPath(pos)) && !reported.exchange(true))
+            std::cerr << "Error: the primary's log was trimmed past this replica; seed it again.\n";
+        return -1;
+    }
+    if (records.empty())
+        return 0;
+
+    StorageBackend &store = StorageBackend::current().engine();
+    for (const MutationRec &rec : records)
+        apply(store, rec);
+
+    pos.lsn += records.size();
+    if (!writePosition(POSITION_FILE, pos))
+        return -1;
+    return static_cast<long>(records.size());
+}
+
+// ============================================================
+// Checkpoint
+// ============================================================
+bool Replica::checkpointDue()
+{
+    return logRecords() >= checkedRecords.load() + CHECKPOINT_RECORDS;
+}
+
+long Replica::checkpoint(std::size_t minRecords)
+{
+    FERRY_METRIC_SCOPE("Replica::checkpoint");
+    WriteGate::Hold hold;
+    MutationLog::Writer writer;
+    checkedRecords.store(logRecords());
+    std::uint64_t keepAfter = MutationLog::lastLsn(MutationLog::LOG_FILE);
+    std::error_code ec;
+    if (!fs::exists(REPLICAS_FILE, ec))
+        return 0;                                   // replicas seeded before the list
+
+    std::string primary = thisDir();
+    std::vector<std::string> dirs = readList();
+    std::vector<std::string> kept;
+    for (const std::string &dir : dirs)
+    {
+        if (!fs::exists(dir, ec) && !ec)
+            continue;                               // removed
+        Position pos;
+        if (!readPosition((fs::path(dir) / POSITION_FILE).string(), pos))
+            keepAfter = 0;                          // being seeded, or unreadable
+        else if (pos.primaryDir != primary)
+            continue;                               // seeded from elsewhere since
+        else
+            keepAfter = std::min(keepAfter, pos.lsn);
+        kept.push_back(dir);
+    }
+    if (kept.size() != dirs.size() && !writeList(kept))
+    {
+        std::cerr << "Error: cannot rewrite " << REPLICAS_FILE << ".\n";
+        return -1;
+    }
+
+    if (keepAfter < MutationLog::baseLsn(MutationLog::LOG_FILE) + minRecords)
+        return 0;
+    long dropped = MutationLog::trim(keepAfter);
+    if (dropped < 0)
+        std::cerr << "Error: cannot trim " << MutationLog::LOG_FILE << ".\n";
+    checkedRecords.store(logRecords());
+    return dropped;
+}
+
+// ============================================================
+// Lag
+// ============================================================
+ReplicaStatus Replica::status()
+{
+    ReplicaStatus status;
+    Position pos;
+    if (!readPosition(POSITION_FILE, pos))
+        return status;
+    status.follower = true;
+    status.primaryDir = pos.primaryDir;
+    status.appliedLsn = pos.lsn;
+    status.primaryLsn = MutationLog::lastLsn(logPath(pos));
+
+    std::vector<MutationRec> next;
+    if (status.primaryLsn > status.appliedLsn && MutationLog::read(logPath(pos), pos.lsn, 1, next) && !next.empty())
+    {
+        auto nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::system_clock::now().time_since_epoch()).count();
+        status.lagSeconds = nowUs > next.front().timeUs ? (nowUs - next.front().timeUs) / 1e6 : 0.0;
+    }
+    return status;
+}
+
+} // namespace FerrySys
@@ -8,15 +8,16 @@
 //
 //    • Handles new and returning customer reservations
 //    • Validates sailing and vehicle data before booking
-//    • Deducts/restores space dynamically from sailings
+//    • Deducts/restores space atomically via the CapacityTable
 //    • Supports check-in and existence checks for vehicles/sailings
 //************************************************************
 //************************************************************
 
 #include "Reservation.h"
-#include "FileIO_VehicleRecord.h"
-#include "FileIO_Sailings.h"
-#include "FileIO_Reservations.h"
+#include "Metrics.h"
+#include "StorageBackend.h"
+#include "CapacityTable.h"
+#include "WriteGate.h"
 
 // ---------------------------------------------------------------------------
 // Threshold to determine high-ceiling vehicles (HCL lane requirement)
@@ -25,68 +26,91 @@
 static const double HIGH_CEILING_THRESHOLD = 2.0; // meters
 
 // ---------------------------------------------------------------------------
-// Helper: Determine if vehicle requires HCL lane (now in meters)
+// Helper: The storage engine in use
 // ---------------------------------------------------------------------------
-static bool isHighCeiling(const FerrySys::VehicleRecord &vehicle)
+static FerrySys::StorageBackend &store()
+{
+    return FerrySys::StorageBackend::current();
+}
+
+// ---------------------------------------------------------------------------
+// Determine if vehicle requires HCL lane (now in meters)
+// ---------------------------------------------------------------------------
+bool Reservation::isHighCeiling(const FerrySys::VehicleRecord &vehicle)
 {
     return vehicle.height_m > HIGH_CEILING_THRESHOLD;
 }
 
 // ---------------------------------------------------------------------------
-// Helper: Adjust sailing space (positive = restore, negative = reserve)
-// Passes meters directly to updateSailingSpace
+// Helper: Lane space a vehicle occupies (fixed-point centimetres,
+// including the parking buffer)
 // ---------------------------------------------------------------------------
-static void adjustSailingSpace(SailingID sailingID,
-                               const FerrySys::VehicleRecord &vehicle,
-                               int amount)
+static std::int32_t spaceNeeded(const FerrySys::VehicleRecord &vehicle)
 {
-    // amount is -1 for reservation, +1 for deletion
-    FileIO_Sailings::updateSailingSpace(
-        sailingID,
-        vehicle.length_m,  // pass float directly
-        vehicle.height_m,  // pass float directly
-        amount
-    );
+    return FerrySys::CapacityTable::vehicleSpaceCm(vehicle.length_m);
 }
 
 // ---------------------------------------------------------------------------
-// Helper: Determine lane choice and check availability
-// Returns true if booking is possible and sets `useHCL` accordingly
-// (This still checks space manually; fallback handled by updateSailingSpace)
+// Helper: Atomically take lane space for a vehicle on a sailing.
+// The space is claimed by compare-and-swap, so two terminals can never
+// both get the last metre of a lane. Returns the lane used in `lane`.
 // ---------------------------------------------------------------------------
-static bool canBookSailing(const FerrySys::VehicleRecord &vehicle,
-                           SailingID sailingID,
-                           bool &useHCL)
+static bool reserveSpace(const FerrySys::VehicleRecord &vehicle,
+                         SailingID sailingID,
+                         FerrySys::Lane &lane)
 {
-    // Validate sailing existence
-    if (!FileIO_Sailings::Sailingexist(sailingID))
-        return false;
+    return FerrySys::CapacityTable::reserve(sailingID,
+                                            spaceNeeded(vehicle),
+                                            Reservation::isHighCeiling(vehicle),
+                                            lane);
+}
 
-    // Retrieve remaining space from sailings file (in meters)
-    float remainingHCL = 0, remainingLCL = 0;
-    FileIO_Sailings::getRemainingSpace(sailingID, remainingHCL, remainingLCL);
+// ---------------------------------------------------------------------------
+// Group Reservation: one transaction for the whole fleet
+// ---------------------------------------------------------------------------
+bool Reservation::groupReservation(const std::vector<FerrySys::VehicleRecord> &vehicles,
+                                   SailingID sailingID,
+                                   FerrySys::BookingError &error)
+{
+    FERRY_METRIC_SCOPE("Reservation::groupReservation");
+    FerrySys::BookingTransaction booking(sailingID);
+    for (const FerrySys::VehicleRecord &vehicle : vehicles)
+        booking.add(vehicle);
+    bool ok = booking.commit();
+    error = booking.error();
+    return ok;
+}
 
-    // Decide lane based on vehicle type (height in meters)
-    if (isHighCeiling(vehicle)) {
-        // Must use HCL
-        if (vehicle.length_m <= remainingHCL) {
-            useHCL = true;
-            return true;
-        }
-    } else {
-        // Regular vehicles prefer LCL
-        if (vehicle.length_m <= remainingLCL) {
-            useHCL = false;
-            return true;
-        }
-        // If LCL full, fallback to HCL
-        if (vehicle.length_m <= remainingHCL) {
-            useHCL = true;
-            return true;
-        }
-    }
+// ---------------------------------------------------------------------------
+// Multi-leg Reservation: one transaction for every leg of the journey
+// ---------------------------------------------------------------------------
+bool Reservation::multiLegReservation(const FerrySys::VehicleRecord &vehicle,
+                                      const std::vector<SailingID> &sailingIDs,
+                                      FerrySys::BookingError &error,
+                                      SailingID &failedLeg)
+{
+    FERRY_METRIC_SCOPE("Reservation::multiLegReservation");
+    FerrySys::BookingTransaction booking;
+    for (const SailingID &sailingID : sailingIDs)
+        booking.add(vehicle, sailingID);
+    bool ok = booking.commit();
+    error = booking.error();
+    failedLeg = booking.failedSailing();
+    return ok;
+}
 
-    return false; // No suitable space available
+// ---------------------------------------------------------------------------
+// Alternatives for a full sailing: the same lane rule as reserveSpace(),
+// answered from the storage engine's capacity index
+// ---------------------------------------------------------------------------
+std::vector<Sailingrec> Reservation::nextAvailable(const FerrySys::VehicleRecord &vehicle,
+                                                   const std::string &city,
+                                                   int day,
+                                                   int hour,
+                                                   std::size_t max)
+{
+    FERRY_METRIC_SCOPE("Reservation::nextAvailable");
+    return store().availableSailings(city, day, hour, spaceNeeded(vehicle), isHighCeiling(vehicle), max);
 }
 
 // ---------------------------------------------------------------------------
@@ -95,92 +119,109 @@ static bool canBookSailing(const FerrySys::VehicleRecord &vehicle,
 bool Reservation::newCustomerReservation(const FerrySys::VehicleRecord &vehicle,
                                          SailingID sailingID)
 {
-    bool useHCL = false;
+    FERRY_METRIC_SCOPE("Reservation::newCustomerReservation");
+    FerrySys::WriteGate::Hold hold;     // a backup sees space, vehicle and reservation together
+    FerrySys::Lane lane = FerrySys::Lane::NONE;
 
-    // Check sailing existence & space
-    if (!canBookSailing(vehicle, sailingID, useHCL))
+    // Check sailing existence & take space
+    if (!reserveSpace(vehicle, sailingID, lane))
         return false;
 
     // Save vehicle to vehicles.dat if not already saved
-    if (!FerrySys::FileIO_VehicleRecord::vehicleExists(vehicle.license))
+    if (!store().vehicleExists(vehicle.license))
     {
-        if (!FerrySys::FileIO_VehicleRecord::writeVehicle(vehicle))
+        if (!store().writeVehicle(vehicle))
         {
+            FerrySys::CapacityTable::release(sailingID, spaceNeeded(vehicle), lane);
             return false;
         }
     }
 
-    // Write reservation
-    if (!FileIO_Reservations::writeReservation(vehicle.license, sailingID))
+    // Write reservation (give the space back if it is refused)
+    if (!store().writeReservation(vehicle.license, sailingID))
+    {
+        FerrySys::CapacityTable::release(sailingID, spaceNeeded(vehicle), lane);
         return false;
+    }
 
-    // Deduct space dynamically (amount = -1)
-    adjustSailingSpace(sailingID, vehicle, -1);
+    // Persist the new remaining space
+    FerrySys::CapacityTable::persist(sailingID);
     return true;
 }
 
 // ---------------------------------------------------------------------------
 // Returning Customer Reservation
 // ---------------------------------------------------------------------------
-bool Reservation::returningCustomerReservation(const std::string &licensePlate,
+bool Reservation::returningCustomerReservation(const FerrySys::LicensePlate &licensePlate,
                                                SailingID sailingID)
 {
+    FERRY_METRIC_SCOPE("Reservation::returningCustomerReservation");
+    FerrySys::WriteGate::Hold hold;     // reservation and its space, as one change
     FerrySys::VehicleRecord vehicle;
 
     // Ensure vehicle exists
-    if (!FerrySys::FileIO_VehicleRecord::findVehicle(licensePlate, vehicle))
+    if (!store().findVehicle(licensePlate, vehicle))
         return false;
 
-    bool useHCL = false;
+    FerrySys::Lane lane = FerrySys::Lane::NONE;
 
-    // Check sailing existence & space
-    if (!canBookSailing(vehicle, sailingID, useHCL))
+    // Check sailing existence & take space
+    if (!reserveSpace(vehicle, sailingID, lane))
         return false;
 
-    // Write reservation
-    if (!FileIO_Reservations::writeReservation(licensePlate, sailingID))
+    // Write reservation (give the space back if it is refused)
+    if (!store().writeReservation(licensePlate, sailingID))
+    {
+        FerrySys::CapacityTable::release(sailingID, spaceNeeded(vehicle), lane);
         return false;
+    }
 
-    // Deduct space dynamically (amount = -1)
-    adjustSailingSpace(sailingID, vehicle, -1);
+    // Persist the new remaining space
+    FerrySys::CapacityTable::persist(sailingID);
     return true;
 }
 
 // ---------------------------------------------------------------------------
 // Delete Reservation
 // ---------------------------------------------------------------------------
-bool Reservation::deleteReservation(const std::string &licensePlate,
+bool Reservation::deleteReservation(const FerrySys::LicensePlate &licensePlate,
                                     SailingID sailingID)
 {
+    FERRY_METRIC_SCOPE("Reservation::deleteReservation");
+    FerrySys::WriteGate::Hold hold;     // reservation and its space, as one change
     FerrySys::VehicleRecord vehicle;
-    if (!FerrySys::FileIO_VehicleRecord::findVehicle(licensePlate, vehicle))
+    if (!store().findVehicle(licensePlate, vehicle))
         return false;
 
     // Delete reservation record
-    if (!FileIO_Reservations::deleteReservation(licensePlate, sailingID))
+    if (!store().deleteReservation(licensePlate, sailingID))
         return false;
 
-    // Restore space dynamically (amount = +1)
-    adjustSailingSpace(sailingID, vehicle, +1);
+    // Restore space and persist it
+    FerrySys::CapacityTable::releaseVehicle(sailingID,
+                                            spaceNeeded(vehicle),
+                                            isHighCeiling(vehicle));
+    FerrySys::CapacityTable::persist(sailingID);
     return true;
 }
 
 // ---------------------------------------------------------------------------
 // Check-in Vehicle
 // ---------------------------------------------------------------------------
-bool Reservation::checkinVehicle(const std::string &licensePlate,
+bool Reservation::checkinVehicle(const FerrySys::LicensePlate &licensePlate,
                                  SailingID sailingID)
 {
-    return FileIO_Reservations::writeCheckin(licensePlate, sailingID);
+    FERRY_METRIC_SCOPE("Reservation::checkinVehicle");
+    return store().checkinReservation(licensePlate, sailingID);
 }
 
 // ---------------------------------------------------------------------------
 // Utility: Check if vehicle exists
 // ---------------------------------------------------------------------------
-bool Reservation::isVehicleExist(const std::string &licensePlate)
+bool Reservation::isVehicleExist(const FerrySys::LicensePlate &licensePlate)
 {
-    FerrySys::VehicleRecord vehicle;
-    return FerrySys::FileIO_VehicleRecord::findVehicle(licensePlate, vehicle);
+    FERRY_METRIC_SCOPE("Reservation::isVehicleExist");
+    return store().vehicleExists(licensePlate);
 }
 
 // ---------------------------------------------------------------------------
@@ -188,11 +229,28 @@ bool Reservation::isVehicleExist(const std::string &licensePlate)
 // ---------------------------------------------------------------------------
 bool Reservation::isSailingIDExist(SailingID sailingID)
 {
-    return FileIO_Sailings::Sailingexist(sailingID);
+    FERRY_METRIC_SCOPE("Reservation::isSailingIDExist");
+    return store().sailingExists(sailingID);
 }
 
 // ---------------------------------------------------------------------------
 // Lifecycle (Initialize/Shutdown)
 // ---------------------------------------------------------------------------
-void Reservation::initialize() {}
-void Reservation::shutdown() {}
+void Reservation::initialize()
+{
+    // Open the storage engine now, so any flat-file migration happens
+    // at startup rather than on the first booking
+    store().open();
+
+    // Warm the capacity table from sailings.dat
+    FerrySys::CapacityTable::load();
+}
+
+void Reservation::shutdown()
+{
+    // Drop tombstoned rows, then flush and release the engine
+    store().compact(FerrySys::Table::RESERVATIONS);
+    store().compact(FerrySys::Table::VEHICLES);
+    store().close();
+    FerrySys::CapacityTable::clear();
+}
@@ -0,0 +1,996 @@
+//************************************************************
+//************************************************************
+//  ReservationLSM.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the log-structured reservation store.
+//
+//    Keys are the upper-cased, space-padded sailing ID followed
+//    by the upper-cased, space-padded license (26 bytes), so keys
+//    compare with memcmp and a sailing's rows sort together.
+//    Rows keep the case they were booked with.
+//
+//    Run file: RunHeader, `rows` ReservationRecs in key order,
+//    `fences` keys (first key of each BLOCK_ROWS block), then
+//    `bloomWords` 64-bit Bloom filter words. Runs are written to
+//    a temp file and renamed, then named in the manifest, then
+//    the log is emptied; a crash between steps replays the log
+//    into rows that are already in a run, which is harmless.
+//
+//    Merging: all runs are merged into one. Because the merge
+//    always includes the oldest run, nothing older can be
+//    hidden behind a cancellation, so cancellations are dropped.
+//************************************************************
+//************************************************************
+
+#include "ReservationLSM.h"
+#include "Metrics.h"
+#include "WriteGate.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sys/file.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr std::uint32_t MAGIC = 0x4D534C46;     // "FLSM"
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::size_t   ID_CHARS = 16;
+    constexpr std::size_t   KEY_BYTES = ID_CHARS + VEH_LIC_CHARS;
+    constexpr std::size_t   REC_BYTES = sizeof(ReservationRec);
+    constexpr std::size_t   BLOOM_BITS_PER_KEY = 10;    // ~1% false positives
+    constexpr unsigned      BLOOM_PROBES = 7;
+    constexpr std::size_t   SCAN_ROWS = 1024;           // rows per read in full scans
+    const char *const       WAL = "lsm/wal.log";
+    const char *const       OWNER_LOCK = "lsm/LOCK";
+
+    using Key = std::array<char, KEY_BYTES>;
+
+    struct RunHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t rows;
+        std::uint32_t blockRows;
+        std::uint32_t fences;
+        std::uint32_t bloomWords;
+    };
+
+    Key keyOf(const ReservationRec &rec)
+    {
+        Key key;
+        for (std::size_t i = 0; i < ID_CHARS; ++i)
+            key[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(rec.sailingID[i])));
+        for (std::size_t i = 0; i < VEH_LIC_CHARS; ++i)
+            key[ID_CHARS + i] = static_cast<char>(std::toupper(static_cast<unsigned char>(rec.licenseplate[i])));
+        return key;
+    }
+
+    ReservationRec makeRec(const std::string &licensePlate, const SailingID &sailingID)
+    {
+        ReservationRec rec{};
+        encodeField(licensePlate, reinterpret_cast<unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+        encodeField(sailingID, reinterpret_cast<unsigned char*>(rec.sailingID), ID_CHARS);
+        rec.status = RES_BOOKED;
+        return rec;
+    }
+
+    //------------------------------------------------------------
+    // Smallest key of a sailing (license bytes below any character)
+    Key sailingLow(const SailingID &sailingID)
+    {
+        Key key = keyOf(makeRec("", sailingID));
+        std::fill(key.begin() + ID_CHARS, key.end(), '\0');
+        return key;
+    }
+
+    bool sameSailing(const Key &a, const Key &b)
+    {
+        return std::memcmp(a.data(), b.data(), ID_CHARS) == 0;
+    }
+
+    std::string sailingOf(const Key &key)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(key.data()), ID_CHARS);
+    }
+
+    std::uint64_t hashKey(const Key &key)
+    {
+        std::uint64_t h = 1469598103934665603ull;       // FNV-1a
+        for (char c : key)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    //------------------------------------------------------------
+    // One immutable run, with its fences and filter in memory
+    struct Run
+    {
+        std::uint32_t              number = 0;
+        int                        fd = -1;
+        std::size_t                rows = 0;
+        std::vector<Key>           fences;
+        std::vector<std::uint64_t> bloom;
+
+        ~Run()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        bool mayContain(const Key &key) const
+        {
+            std::uint64_t bits = bloom.size() * 64;
+            std::uint64_t h1 = hashKey(key), h2 = (h1 >> 33) | 1;
+            for (unsigned i = 0; i < BLOOM_PROBES; ++i)
+            {
+                std::uint64_t bit = (h1 + i * h2) % bits;
+                if (!(bloom[bit / 64] & (1ull << (bit % 64))))
+                    return false;
+            }
+            return true;
+        }
+
+        // Block whose first key is the last one <= key (0 if none)
+        std::size_t blockFor(const Key &key) const
+        {
+            auto it = std::upper_bound(fences.begin(), fences.end(), key);
+            return it == fences.begin() ? 0 : static_cast<std::size_t>(it - fences.begin()) - 1;
+        }
+
+        bool readRows(std::size_t first, std::size_t n, std::vector<ReservationRec> &out) const
+        {
+            n = std::min(n, rows - std::min(first, rows));
+            out.resize(n);
+            std::size_t bytes = n * REC_BYTES;
+            off_t offset = static_cast<off_t>(sizeof(RunHeader) + first * REC_BYTES);
+            if (n > 0 && ::pread(fd, out.data(), bytes, offset) != static_cast<ssize_t>(bytes))
+                return false;
+            Metrics::add(Counter::BYTES_READ, bytes);
+            Metrics::add(Counter::RECORDS_SCANNED, n);
+            return true;
+        }
+
+        bool find(const Key &key, ReservationRec &rec) const
+        {
+            if (rows == 0 || !mayContain(key) || key < fences.front())
+                return false;
+            std::vector<ReservationRec> block;
+            if (!readRows(blockFor(key) * BLOCK_ROWS, BLOCK_ROWS, block))
+                return false;
+            auto it = std::lower_bound(block.begin(), block.end(), key,
+                [](const ReservationRec &r, const Key &k) { return keyOf(r) < k; });
+            if (it == block.end() || keyOf(*it) != key)
+                return false;
+            rec = *it;
+            return true;
+        }
+
+        static constexpr std::size_t BLOCK_ROWS = ReservationLSM::BLOCK_ROWS;
+    };
+    using RunPtr = std::shared_ptr<const Run>;
+
+    std::string runPath(std::uint32_t number)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/run-%06u.sst", number);
+        return std::string(ReservationLSM::DIR) + name;
+    }
+
+    RunPtr openRun(std::uint32_t number)
+    {
+        auto run = std::make_shared<Run>();
+        run->number = number;
+        run->fd = ::open(runPath(number).c_str(), O_RDONLY | O_CLOEXEC);
+        Metrics::add(Counter::FILE_OPENS);
+        if (run->fd < 0)
+            return nullptr;
+
+        RunHeader h{};
+        if (::pread(run->fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            h.magic != MAGIC || h.version != VERSION || h.blockRows != ReservationLSM::BLOCK_ROWS ||
+            h.bloomWords == 0)
+            return nullptr;
+
+        run->rows = h.rows;
+        run->fences.resize(h.fences);
+        run->bloom.resize(h.bloomWords);
+        off_t offset = static_cast<off_t>(sizeof(h) + h.rows * REC_BYTES);
+        std::size_t fenceBytes = h.fences * KEY_BYTES;
+        std::size_t bloomBytes = h.bloomWords * sizeof(std::uint64_t);
+        if (::pread(run->fd, run->fences.data(), fenceBytes, offset) != static_cast<ssize_t>(fenceBytes) ||
+            ::pread(run->fd, run->bloom.data(), bloomBytes, offset + static_cast<off_t>(fenceBytes))
+                != static_cast<ssize_t>(bloomBytes))
+            return nullptr;
+        Metrics::add(Counter::BYTES_READ, sizeof(h) + fenceBytes + bloomBytes);
+        return run;
+    }
+
+    //------------------------------------------------------------
+    // Write `rows` (sorted by key, unique) as run `number`
+    RunPtr writeRun(std::uint32_t number, const std::vector<ReservationRec> &rows)
+    {
+        FERRY_TRACE_SPAN("ReservationLSM/writeRun");
+        RunHeader h{};
+        h.magic = MAGIC;
+        h.version = VERSION;
+        h.rows = static_cast<std::uint32_t>(rows.size());
+        h.blockRows = ReservationLSM::BLOCK_ROWS;
+        h.fences = static_cast<std::uint32_t>((rows.size() + h.blockRows - 1) / h.blockRows);
+
+        std::uint64_t bits = std::max<std::uint64_t>(64, rows.size() * BLOOM_BITS_PER_KEY);
+        h.bloomWords = static_cast<std::uint32_t>((bits + 63) / 64);
+        bits = h.bloomWords * 64ull;
+
+        std::vector<Key> fences;
+        std::vector<std::uint64_t> bloom(h.bloomWords, 0);
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            Key key = keyOf(rows[i]);
+            if (i % h.blockRows == 0)
+                fences.push_back(key);
+            std::uint64_t h1 = hashKey(key), h2 = (h1 >> 33) | 1;
+            for (unsigned p = 0; p < BLOOM_PROBES; ++p)
+            {
+                std::uint64_t bit = (h1 + p * h2) % bits;
+                bloom[bit / 64] |= 1ull << (bit % 64);
+            }
+        }
+
+        std::string path = runPath(number);
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            Metrics::add(Counter::FILE_OPENS);
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            out.write(reinterpret_cast<const char*>(rows.data()), static_cast<std::streamsize>(rows.size() * REC_BYTES));
+            out.write(reinterpret_cast<const char*>(fences.data()), static_cast<std::streamsize>(fences.size() * KEY_BYTES));
+            out.write(reinterpret_cast<const char*>(bloom.data()), static_cast<std::streamsize>(bloom.size() * 8));
+            out.close();
+            std::error_code ec;
+            if (!out)
+            {
+                fs::remove(tmp, ec);
+                return nullptr;
+            }
+            Metrics::add(Counter::BYTES_WRITTEN, sizeof(h) + rows.size() * REC_BYTES +
+                                                 fences.size() * KEY_BYTES + bloom.size() * 8);
+            fs::rename(tmp, path, ec);
+            if (ec)
+                return nullptr;
+        }
+        return openRun(number);
+    }
+
+    //------------------------------------------------------------
+    // Manifest: uint32 run numbers, oldest first
+    std::vector<std::uint32_t> readManifest()
+    {
+        std::vector<std::uint32_t> numbers;
+        std::ifstream in(ReservationLSM::MANIFEST, std::ios::binary);
+        Metrics::add(Counter::FILE_OPENS);
+        std::uint32_t n = 0;
+        while (in.read(reinterpret_cast<char*>(&n), sizeof(n)))
+            numbers.push_back(n);
+        return numbers;
+    }
+
+    bool writeManifest(const std::vector<RunPtr> &runs)
+    {
+        std::string tmp = std::string(ReservationLSM::MANIFEST) + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            Metrics::add(Counter::FILE_OPENS);
+            for (const auto &run : runs)
+                out.write(reinterpret_cast<const char*>(&run->number), sizeof(run->number));
+            if (!out)
+                return false;
+            Metrics::add(Counter::BYTES_WRITTEN, runs.size() * sizeof(std::uint32_t));
+        }
+        std::error_code ec;
+        fs::rename(tmp, ReservationLSM::MANIFEST, ec);
+        return !ec;
+    }
+
+    //------------------------------------------------------------
+    // Merge inputs: sorted row streams, newest first
+    class Source
+    {
+    public:
+        virtual ~Source() = default;
+        bool valid() const { return ok; }
+        const Key &key() const { return k; }
+        const ReservationRec &rec() const { return *r; }
+        virtual void next() = 0;
+
+    protected:
+        bool                  ok = false;
+        Key                   k{};
+        const ReservationRec *r = nullptr;
+    };
+
+    class MemSource : public Source
+    {
+    public:
+        using Table = std::map<Key, ReservationRec>;
+
+        MemSource(const Table &table, const Key *low)
+            : it(low ? table.lower_bound(*low) : table.begin()), end(table.end())
+        {
+            load();
+        }
+
+        void next() override
+        {
+            ++it;
+            load();
+        }
+
+    private:
+        void load()
+        {
+            ok = it != end;
+            if (ok)
+            {
+                k = it->first;
+                r = &it->second;
+            }
+        }
+
+        Table::const_iterator it, end;
+    };
+
+    class RunSource : public Source
+    {
+    public:
+        RunSource(RunPtr run, const Key *low)
+            : run(std::move(run)), chunk(low ? Run::BLOCK_ROWS : SCAN_ROWS)
+        {
+            if (low && !this->run->fences.empty())
+                pos = this->run->blockFor(*low) * Run::BLOCK_ROWS;
+            load();
+            while (ok && low && k < *low)
+                next();
+        }
+
+        void next() override
+        {
+            ++pos;
+            load();
+        }
+
+    private:
+        void load()
+        {
+            if (pos >= bufStart + buf.size())
+            {
+                bufStart = pos;
+                if (!run->readRows(pos, chunk, buf))
+                    buf.clear();
+            }
+            ok = pos < bufStart + buf.size();
+            if (ok)
+            {
+                r = &buf[pos - bufStart];
+                k = keyOf(*r);
+            }
+        }
+
+        RunPtr                      run;
+        std::size_t                 chunk;
+        std::size_t                 pos = 0;
+        std::size_t                 bufStart = 0;
+        std::vector<ReservationRec> buf;
+    };
+
+    //------------------------------------------------------------
+    // Newest version of every key, in key order (stopping after
+    // the sailing of `low` if given); `emit` sees cancellations too
+    template <class Emit>
+    void mergeSources(std::vector<std::unique_ptr<Source>> &sources, const Key *low, Emit emit)
+    {
+        while (true)
+        {
+            Source *newest = nullptr;
+            for (auto &s : sources)
+            {
+                if (s->valid() && (!newest || s->key() < newest->key()))
+                    newest = s.get();
+            }
+            if (!newest || (low && !sameSailing(newest->key(), *low)))
+                return;
+
+            Key key = newest->key();
+            emit(key, newest->rec());
+            for (auto &s : sources)
+            {
+                if (s->valid() && s->key() == key)
+                    s->next();
+            }
+        }
+    }
+
+    //------------------------------------------------------------
+    // Store state
+    struct Store
+    {
+        std::shared_mutex            lock;      // memtable, runs, log
+        std::map<Key, ReservationRec> memtable;
+        std::vector<RunPtr>          runs;      // oldest first
+        int                          wal = -1;
+        int                          owner = -1;    // flocked lsm/LOCK
+        bool                         refused = false;
+        std::size_t                  walRows = 0;
+        std::atomic<std::uint32_t>   nextRun{ 1 };
+        std::atomic<bool>            open{ false };
+
+        std::mutex                   mergeLock; // one merge at a time
+        std::mutex                   wakeLock;
+        std::condition_variable      wake;
+        bool                         mergeWanted = false;
+        bool                         stopping = false;
+        std::thread                  merger;
+
+        std::mutex                   cursorLock;
+        std::vector<ReservationRec>  cursorRows;
+        std::size_t                  cursorPos = 0;
+        bool                         cursorLoaded = false;
+
+        ~Store();
+    };
+
+    Store &store()
+    {
+        static Store s;
+        return s;
+    }
+
+    //------------------------------------------------------------
+    // Sources over the whole store (or one sailing), newest first.
+    // Caller holds s.lock.
+    std::vector<std::unique_ptr<Source>> sourcesLocked(Store &s, const Key *low)
+    {
+        std::vector<std::unique_ptr<Source>> sources;
+        sources.push_back(std::make_unique<MemSource>(s.memtable, low));
+        for (auto it = s.runs.rbegin(); it != s.runs.rend(); ++it)
+            sources.push_back(std::make_unique<RunSource>(*it, low));
+        return sources;
+    }
+
+    // Newest version of `key`; false if never written
+    bool lookupLocked(Store &s, const Key &key, ReservationRec &rec)
+    {
+        auto it = s.memtable.find(key);
+        if (it != s.memtable.end())
+        {
+            rec = it->second;
+            return true;
+        }
+        for (auto run = s.runs.rbegin(); run != s.runs.rend(); ++run)
+        {
+            if ((*run)->find(key, rec))
+                return true;
+        }
+        return false;
+    }
+
+    bool lookupLive(Store &s, const Key &key, ReservationRec &rec)
+    {
+        return lookupLocked(s, key, rec) && rec.status != REC_DEAD;
+    }
+
+    std::vector<ReservationRec> sailingRowsLocked(Store &s, const SailingID &sailingID)
+    {
+        std::vector<ReservationRec> rows;
+        Key low = sailingLow(sailingID);
+        auto sources = sourcesLocked(s, &low);
+        mergeSources(sources, &low, [&rows](const Key &, const ReservationRec &rec) {
+            if (rec.status != REC_DEAD)
+                rows.push_back(rec);
+        });
+        return rows;
+    }
+
+    void requestMerge(Store &s)
+    {
+        {
+            std::lock_guard<std::mutex> guard(s.wakeLock);
+            s.mergeWanted = true;
+        }
+        s.wake.notify_one();
+    }
+
+    //------------------------------------------------------------
+    // Memtable -> new run; caller holds s.lock exclusively
+    bool flushLocked(Store &s)
+    {
+        if (s.memtable.empty())
+            return true;
+        FERRY_TRACE_SPAN("ReservationLSM/flush");
+
+        std::vector<ReservationRec> rows;
+        rows.reserve(s.memtable.size());
+        for (const auto &kv : s.memtable)
+            rows.push_back(kv.second);      // cancellations too: they hide older runs
+
+        RunPtr run = writeRun(s.nextRun++, rows);
+        if (!run)
+            return false;
+        s.runs.push_back(run);
+        if (!writeManifest(s.runs))
+        {
+            s.runs.pop_back();
+            return false;
+        }
+        s.memtable.clear();
+        if (::ftruncate(s.wal, 0) == 0)
+            s.walRows = 0;
+        if (s.runs.size() >= ReservationLSM::MERGE_AT)
+            requestMerge(s);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Log and apply one change; caller holds s.lock exclusively
+    bool applyLocked(Store &s, const ReservationRec &rec)
+    {
+        if (::write(s.wal, &rec, REC_BYTES) != static_cast<ssize_t>(REC_BYTES))
+            return false;
+        Metrics::add(Counter::BYTES_WRITTEN, REC_BYTES);
+        ++s.walRows;
+        s.memtable[keyOf(rec)] = rec;
+        if (s.memtable.size() >= ReservationLSM::MEMTABLE_ROWS)
+            flushLocked(s);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Merge every current run into one. Runs flushed meanwhile
+    // are newer and are appended after the inputs, so the inputs
+    // stay a prefix of s.runs.
+    bool mergeRuns(Store &s)
+    {
+        std::lock_guard<std::mutex> merging(s.mergeLock);
+        std::vector<RunPtr> inputs;
+        {
+            std::shared_lock<std::shared_mutex> guard(s.lock);
+            if (s.runs.size() < 2)
+                return true;
+            inputs = s.runs;
+        }
+        FERRY_METRIC_SCOPE("ReservationLSM::merge");
+
+        std::vector<std::unique_ptr<Source>> sources;
+        std::size_t inputRows = 0;
+        for (auto it = inputs.rbegin(); it != inputs.rend(); ++it)
+        {
+            sources.push_back(std::make_unique<RunSource>(*it, nullptr));
+            inputRows += (*it)->rows;
+        }
+        std::vector<ReservationRec> rows;
+        mergeSources(sources, nullptr, [&rows](const Key &, const ReservationRec &rec) {
+            if (rec.status != REC_DEAD)
+                rows.push_back(rec);
+        });
+
+        RunPtr merged;
+        if (!rows.empty())
+        {
+            merged = writeRun(s.nextRun++, rows);
+            if (!merged)
+                return false;
+        }
+        // The manifest swap and the removal of the inputs are one
+        // change as far as a backup is concerned
+        WriteGate::Hold hold;
+        {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            std::vector<RunPtr> next(s.runs.begin() + static_cast<std::ptrdiff_t>(inputs.size()), s.runs.end());
+            if (merged)
+                next.insert(next.begin(), merged);
+            if (!writeManifest(next))
+                return false;
+            s.runs.swap(next);
+        }
+        std::error_code ec;
+        for (const auto &run : inputs)
+            fs::remove(runPath(run->number), ec);      // readers keep their open fd
+        Metrics::add(Counter::ROWS_COMPACTED, inputRows - rows.size());
+        return true;
+    }
+
+    void mergeLoop(Store &s)
+    {
+        std::unique_lock<std::mutex> wait(s.wakeLock);
+        while (true)
+        {
+            s.wake.wait(wait, [&s] { return s.stopping || s.mergeWanted; });
+            if (s.stopping)
+                return;
+            s.mergeWanted = false;
+            wait.unlock();
+            mergeRuns(s);
+            wait.lock();
+        }
+    }
+
+    //------------------------------------------------------------
+    // Take lsm/ for this process, load runs, replay the log, start
+    // the merge thread. False if another process owns the store.
+    bool openLocked(Store &s)
+    {
+        std::error_code ec;
+        fs::create_directories(ReservationLSM::DIR, ec);
+
+        // Each process would keep its own memtable, run numbers and
+        // manifest, and a flush empties the shared log, so only one
+        // process may have the store open
+        s.owner = ::open(OWNER_LOCK, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        Metrics::add(Counter::FILE_OPENS);
+        if (s.owner < 0 || ::flock(s.owner, LOCK_EX | LOCK_NB) != 0)
+        {
+            if (!s.refused)
+                std::cerr << "Error: the reservation store in " << ReservationLSM::DIR
+                          << "/ is open in another process; use ferryd to share it.\n";
+            s.refused = true;
+            if (s.owner >= 0)
+                ::close(s.owner);
+            s.owner = -1;
+            return false;
+        }
+        s.refused = false;
+
+        s.runs.clear();
+        std::uint32_t last = 0;
+        for (std::uint32_t number : readManifest())
+        {
+            last = std::max(last, number);
+            if (RunPtr run = openRun(number))
+                s.runs.push_back(run);
+        }
+        s.nextRun = last + 1;
+        if (!fs::exists(ReservationLSM::MANIFEST, ec))
+            writeManifest(s.runs);
+
+        s.memtable.clear();
+        s.walRows = 0;
+        s.wal = ::open(WAL, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        Metrics::add(Counter::FILE_OPENS);
+        ReservationRec rec{};
+        while (::read(s.wal, &rec, REC_BYTES) == static_cast<ssize_t>(REC_BYTES))
+        {
+            Metrics::recordRead(REC_BYTES);
+            s.memtable[keyOf(rec)] = rec;
+            ++s.walRows;
+        }
+        if (::ftruncate(s.wal, static_cast<off_t>(s.walRows * REC_BYTES)) != 0)
+            s.walRows = 0;      // torn tail stays; it is ignored on the next replay too
+
+        {
+            std::lock_guard<std::mutex> guard(s.wakeLock);
+            s.stopping = false;
+            s.mergeWanted = s.runs.size() >= ReservationLSM::MERGE_AT;
+        }
+        s.merger = std::thread(mergeLoop, std::ref(s));
+        s.open = true;
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Stop the merge thread and flush (also run at exit, so the
+    // thread is never left joinable)
+    void closeStore(Store &s)
+    {
+        if (!s.open)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(s.wakeLock);
+            s.stopping = true;
+        }
+        s.wake.notify_one();
+        if (s.merger.joinable())
+            s.merger.join();
+
+        // Not before the join: the merge thread may be waiting for
+        // a backup that is waiting for this Hold
+        WriteGate::Hold hold;
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        flushLocked(s);
+        ::close(s.wal);
+        s.wal = -1;
+        ::close(s.owner);       // releases lsm/ to other processes
+        s.owner = -1;
+        s.runs.clear();
+        s.memtable.clear();
+        s.open = false;
+    }
+
+    Store::~Store()
+    {
+        closeStore(*this);
+    }
+
+    //------------------------------------------------------------
+    // The store, opened on first use; s.open is false afterwards
+    // if another process owns it
+    Store &opened()
+    {
+        Store &s = store();
+        if (!s.open)
+        {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            if (!s.open)
+                openLocked(s);
+        }
+        return s;
+    }
+}
+
+bool ReservationLSM::present()
+{
+    std::error_code ec;
+    return fs::exists(MANIFEST, ec);
+}
+
+bool ReservationLSM::write(const std::string &licensePlate, const SailingID &sailingID)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    ReservationRec rec = makeRec(licensePlate, sailingID), existing{};
+    if (lookupLive(s, keyOf(rec), existing))
+        return false;   // duplicate
+    return applyLocked(s, rec);
+}
+
+bool ReservationLSM::checkin(const std::string &licensePlate, const SailingID &sailingID)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    ReservationRec rec{};
+    if (!lookupLive(s, keyOf(makeRec(licensePlate, sailingID)), rec))
+        return false;
+    rec.status = RES_CHECKED_IN;
+    return applyLocked(s, rec);
+}
+
+bool ReservationLSM::remove(const std::string &licensePlate, const SailingID &sailingID)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    ReservationRec rec{};
+    if (!lookupLive(s, keyOf(makeRec(licensePlate, sailingID)), rec))
+        return false;
+    rec.status = REC_DEAD;
+    return applyLocked(s, rec);
+}
+
+bool ReservationLSM::exists(const std::string &licensePlate, const SailingID &sailingID)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::shared_lock<std::shared_mutex> guard(s.lock);
+    ReservationRec rec{};
+    if (!lookupLive(s, keyOf(makeRec(licensePlate, sailingID)), rec))
+        return false;
+    return decodeField(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS) == licensePlate &&
+           decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), ID_CHARS) == sailingID;
+}
+
+int ReservationLSM::count(const SailingID &sailingID)
+{
+    Store &s = opened();
+    if (!s.open)
+        return 0;
+    std::shared_lock<std::shared_mutex> guard(s.lock);
+    return static_cast<int>(sailingRowsLocked(s, sailingID).size());
+}
+
+bool ReservationLSM::read(const SailingID &sailingID, std::vector<ReservationRec> &rows)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::shared_lock<std::shared_mutex> guard(s.lock);
+    std::vector<ReservationRec> found = sailingRowsLocked(s, sailingID);
+    rows.insert(rows.end(), found.begin(), found.end());
+    return true;
+}
+
+int ReservationLSM::dropSailings(const std::vector<SailingID> &sailingIDs)
+{
+    Store &s = opened();
+    if (!s.open)
+        return 0;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    int dropped = 0;
+    for (const auto &id : sailingIDs)
+    {
+        for (ReservationRec rec : sailingRowsLocked(s, id))
+        {
+            rec.status = REC_DEAD;
+            if (applyLocked(s, rec))
+                ++dropped;
+        }
+    }
+    return dropped;
+}
+
+std::unordered_map<std::string, int> ReservationLSM::countAll()
+{
+    Store &s = opened();
+    if (!s.open)
+        return {};
+    std::shared_lock<std::shared_mutex> guard(s.lock);
+    std::unordered_map<std::string, int> counts;
+    auto sources = sourcesLocked(s, nullptr);
+    mergeSources(sources, nullptr, [&counts](const Key &key, const ReservationRec &rec) {
+        if (rec.status != REC_DEAD)
+            ++counts[sailingOf(key)];
+    });
+    return counts;
+}
+
+bool ReservationLSM::next(std::string &licensePlate, SailingID &sailingID, bool &checkedIn)
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::lock_guard<std::mutex> cursor(s.cursorLock);
+    if (!s.cursorLoaded)
+    {
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        s.cursorRows.clear();
+        s.cursorPos = 0;
+        auto sources = sourcesLocked(s, nullptr);
+        mergeSources(sources, nullptr, [&s](const Key &, const ReservationRec &rec) {
+            if (rec.status != REC_DEAD)
+                s.cursorRows.push_back(rec);
+        });
+        s.cursorLoaded = true;
+    }
+    if (s.cursorPos >= s.cursorRows.size())
+        return false;
+
+    const ReservationRec &rec = s.cursorRows[s.cursorPos++];
+    licensePlate = decodeField(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    sailingID = decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), ID_CHARS);
+    checkedIn = rec.status == RES_CHECKED_IN;
+    return true;
+}
+
+void ReservationLSM::resetCursor()
+{
+    Store &s = store();
+    std::lock_guard<std::mutex> cursor(s.cursorLock);
+    s.cursorLoaded = false;
+    s.cursorRows.clear();
+}
+
+int ReservationLSM::migrate(const std::string &flatPath)
+{
+    std::error_code ec;
+    if (!fs::exists(flatPath, ec))
+        return 0;
+
+    // Live flat rows, first occurrence of each key
+    std::vector<ReservationRec> rows;
+    {
+        std::ifstream in(flatPath, std::ios::binary);
+        Metrics::add(Counter::FILE_OPENS);
+        skipHeader(in, REC_BYTES);
+        ReservationRec rec{};
+        while (in.read(reinterpret_cast<char*>(&rec), REC_BYTES))
+        {
+            Metrics::recordRead(REC_BYTES);
+            if (rec.status != REC_DEAD)
+                rows.push_back(rec);
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const ReservationRec &a, const ReservationRec &b) {
+        return keyOf(a) < keyOf(b);
+    });
+    rows.erase(std::unique(rows.begin(), rows.end(), [](const ReservationRec &a, const ReservationRec &b) {
+        return keyOf(a) == keyOf(b);
+    }), rows.end());
+
+    Store &s = opened();
+    if (!s.open)
+        return -1;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    std::vector<ReservationRec> fresh;
+    for (const auto &rec : rows)
+    {
+        ReservationRec existing{};
+        if (!lookupLive(s, keyOf(rec), existing))
+            fresh.push_back(rec);
+    }
+
+    // Bulk rows skip the log: they go straight to the newest run
+    if (!fresh.empty())
+    {
+        if (!flushLocked(s))
+            return -1;
+        RunPtr run = writeRun(s.nextRun++, fresh);
+        if (!run)
+            return -1;
+        s.runs.push_back(run);
+        if (!writeManifest(s.runs))
+        {
+            s.runs.pop_back();
+            return -1;
+        }
+        if (s.runs.size() >= MERGE_AT)
+            requestMerge(s);
+    }
+
+    fs::rename(flatPath, flatPath + ".migrated", ec);
+    return ec ? -1 : static_cast<int>(fresh.size());
+}
+
+bool ReservationLSM::flush()
+{
+    Store &s = opened();
+    if (!s.open)
+        return false;
+    std::unique_lock<std::shared_mutex> guard(s.lock);
+    return flushLocked(s);
+}
+
+bool ReservationLSM::compact()
+{
+    Store &s = opened();
+    return s.open && mergeRuns(s);
+}
+
+void ReservationLSM::close()
+{
+    closeStore(store());
+}
+
+LSMStats ReservationLSM::stats()
+{
+    Store &s = opened();
+    if (!s.open)
+        return {};
+    std::shared_lock<std::shared_mutex> guard(s.lock);
+    LSMStats st;
+    st.memtableRows = s.memtable.size();
+    st.walRows = s.walRows;
+    st.runs = s.runs.size();
+    for (const auto &run : s.runs)
+        st.runRows += run->rows;
+    return st;
+}
+
+} // namespace FerrySys
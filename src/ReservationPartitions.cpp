@@ -0,0 +1,377 @@
+//************************************************************
+//************************************************************
+//  ReservationPartitions.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements per-sailing reservation partitions on top of the
+//    BinaryFileOps fixed-record helpers (linear search within a
+//    partition, swap-delete, in-place overwrite).
+//
+//    Partition names are the upper-cased sailing ID with ':'
+//    written as '-'; any other character outside [A-Z0-9] is
+//    written as %XX so two IDs never share a file.
+//************************************************************
+//************************************************************
+
+#include "ReservationPartitions.h"
+#include "BinaryFileOps.hpp"
+#include "Metrics.h"
+#include "ParallelScan.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr std::size_t ID_CHARS = 16;
+    constexpr std::size_t REC_BYTES = sizeof(ReservationRec);
+
+    std::string upper(const std::string &s)
+    {
+        std::string out = s;
+        std::transform(out.begin(), out.end(), out.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        return out;
+    }
+
+    std::string licenseOf(const ReservationRec &rec)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+    }
+
+    std::string sailingOf(const ReservationRec &rec)
+    {
+        return decodeField(reinterpret_cast<const unsigned char*>(rec.sailingID), ID_CHARS);
+    }
+
+    ReservationRec makeRec(const std::string &licensePlate, const SailingID &sailingID)
+    {
+        ReservationRec rec{};
+        encodeField(licensePlate, reinterpret_cast<unsigned char*>(rec.licenseplate), VEH_LIC_CHARS);
+        encodeField(sailingID, reinterpret_cast<unsigned char*>(rec.sailingID), ID_CHARS);
+        rec.status = RES_BOOKED;
+        return rec;
+    }
+
+    //------------------------------------------------------------
+    // Catalog: one space-padded upper-cased sailing ID per record
+    bool catalogAdd(const std::string &upperID)
+    {
+        unsigned char rec[ID_CHARS];
+        encodeField(upperID, rec, ID_CHARS);
+        std::ofstream out(ReservationPartitions::CATALOG, std::ios::binary | std::ios::app);
+        Metrics::add(Counter::FILE_OPENS);
+        if (!out)
+            return false;
+        out.write(reinterpret_cast<const char*>(rec), ID_CHARS);
+        Metrics::add(Counter::BYTES_WRITTEN, ID_CHARS);
+        return static_cast<bool>(out);
+    }
+
+    std::vector<std::string> catalogList()
+    {
+        std::vector<std::string> ids;
+        std::ifstream in(ReservationPartitions::CATALOG, std::ios::binary);
+        Metrics::add(Counter::FILE_OPENS);
+        unsigned char rec[ID_CHARS];
+        while (in.read(reinterpret_cast<char*>(rec), ID_CHARS))
+        {
+            Metrics::recordRead(ID_CHARS);
+            ids.push_back(decodeField(rec, ID_CHARS));
+        }
+        return ids;
+    }
+
+    //------------------------------------------------------------
+    // Append `rows` to a partition in one write, cataloguing it if new
+    bool appendRows(const std::string &upperID, const std::vector<ReservationRec> &rows)
+    {
+        std::string path = ReservationPartitions::partitionPath(upperID);
+        std::error_code ec;
+        bool isNew = !fs::exists(path, ec);
+        if (isNew)
+            fs::create_directories(ReservationPartitions::DIR, ec);
+
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        Metrics::add(Counter::FILE_OPENS);
+        if (!out)
+            return false;
+        out.write(reinterpret_cast<const char*>(rows.data()),
+                  static_cast<std::streamsize>(rows.size() * REC_BYTES));
+        out.close();
+        if (!out)
+            return false;
+        Metrics::add(Counter::BYTES_WRITTEN, rows.size() * REC_BYTES);
+        return !isNew || catalogAdd(upperID);
+    }
+
+    //------------------------------------------------------------
+    // Index of the first row in `file` matching `match`, or its
+    // record count if none does
+    std::size_t findRow(std::fstream &file,
+                        const std::function<bool(const ReservationRec &)> &match)
+    {
+        return linearSearch(file, REC_BYTES, [&match](std::size_t, const void *bytes) {
+            Metrics::recordRead(REC_BYTES);
+            return match(*static_cast<const ReservationRec*>(bytes));
+        });
+    }
+
+    std::mutex cursorLock;
+    std::vector<std::string> cursorSailings;
+    std::size_t cursorPart = 0;
+    std::size_t cursorRow = 0;
+    bool cursorLoaded = false;
+}
+
+bool ReservationPartitions::present()
+{
+    std::error_code ec;
+    return fs::exists(CATALOG, ec);
+}
+
+std::string ReservationPartitions::partitionPath(const SailingID &sailingID)
+{
+    std::string name;
+    for (unsigned char c : upper(sailingID))
+    {
+        if (std::isalnum(c))
+            name += static_cast<char>(c);
+        else if (c == ':')
+            name += '-';
+        else
+        {
+            char hex[4];
+            std::snprintf(hex, sizeof(hex), "%%%02X", c);
+            name += hex;
+        }
+    }
+    return std::string(DIR) + "/" + name + ".dat";
+}
+
+bool ReservationPartitions::write(const std::string &licensePlate, const SailingID &sailingID)
+{
+    std::vector<ReservationRec> rows;
+    read(sailingID, rows);
+    std::string lic = upper(licensePlate);
+    for (const auto &rec : rows)
+    {
+        if (upper(licenseOf(rec)) == lic)
+            return false;   // duplicate
+    }
+    return appendRows(upper(sailingID), { makeRec(licensePlate, sailingID) });
+}
+
+bool ReservationPartitions::checkin(const std::string &licensePlate, const SailingID &sailingID)
+{
+    std::string path = partitionPath(sailingID);
+    std::error_code ec;
+    if (!fs::exists(path, ec))
+        return false;
+
+    std::fstream file = openBinaryFile(path);
+    Metrics::add(Counter::FILE_OPENS);
+    std::string lic = upper(licensePlate);
+    std::size_t idx = findRow(file, [&lic](const ReservationRec &rec) {
+        return upper(licenseOf(rec)) == lic;
+    });
+
+    ReservationRec rec{};
+    if (!readRecord(file, REC_BYTES, idx, &rec))
+        return false;
+    rec.status = RES_CHECKED_IN;
+    return writeRecord(file, REC_BYTES, idx, &rec);
+}
+
+bool ReservationPartitions::remove(const std::string &licensePlate, const SailingID &sailingID)
+{
+    std::string path = partitionPath(sailingID);
+    std::error_code ec;
+    if (!fs::exists(path, ec))
+        return false;
+
+    std::fstream file = openBinaryFile(path);
+    Metrics::add(Counter::FILE_OPENS);
+    std::string lic = upper(licensePlate);
+    std::size_t idx = findRow(file, [&lic](const ReservationRec &rec) {
+        return upper(licenseOf(rec)) == lic;
+    });
+    return swapDeleteRecord(file, path, REC_BYTES, idx);
+}
+
+bool ReservationPartitions::exists(const std::string &licensePlate, const SailingID &sailingID)
+{
+    std::vector<ReservationRec> rows;
+    read(sailingID, rows);
+    for (const auto &rec : rows)
+    {
+        if (licenseOf(rec) == licensePlate && sailingOf(rec) == sailingID)
+            return true;
+    }
+    return false;
+}
+
+int ReservationPartitions::count(const SailingID &sailingID)
+{
+    std::error_code ec;
+    auto bytes = fs::file_size(partitionPath(sailingID), ec);
+    return ec ? 0 : static_cast<int>(bytes / REC_BYTES);
+}
+
+bool ReservationPartitions::read(const SailingID &sailingID, std::vector<ReservationRec> &rows)
+{
+    rows.clear();
+    std::ifstream in(partitionPath(sailingID), std::ios::binary | std::ios::ate);
+    Metrics::add(Counter::FILE_OPENS);
+    if (!in)
+        return false;
+
+    std::size_t n = static_cast<std::size_t>(in.tellg()) / REC_BYTES;
+    rows.resize(n);
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(rows.data()), static_cast<std::streamsize>(n * REC_BYTES));
+    Metrics::add(Counter::RECORDS_SCANNED, n);
+    Metrics::add(Counter::BYTES_READ, n * REC_BYTES);
+    return static_cast<bool>(in);
+}
+
+int ReservationPartitions::dropSailings(const std::vector<SailingID> &sailingIDs)
+{
+    int dropped = 0;
+    std::unordered_set<std::string> doomed;
+    for (const auto &id : sailingIDs)
+    {
+        std::error_code ec;
+        std::string path = partitionPath(id);
+        int rows = count(id);
+        if (fs::remove(path, ec))
+        {
+            dropped += rows;
+            doomed.insert(upper(id));
+        }
+    }
+
+    if (!doomed.empty())
+    {
+        std::size_t removed = 0;
+        removeRecordsIf(CATALOG, ID_CHARS, [&doomed](const void *bytes) {
+            return doomed.count(decodeField(static_cast<const unsigned char*>(bytes), ID_CHARS)) > 0;
+        }, removed);
+    }
+    return dropped;
+}
+
+std::unordered_map<std::string, int> ReservationPartitions::countAll()
+{
+    std::unordered_map<std::string, int> counts;
+    for (const auto &id : catalogList())
+    {
+        int n = count(id);
+        if (n > 0)
+            counts[id] = n;
+    }
+    return counts;
+}
+
+bool ReservationPartitions::next(std::string &licensePlate, SailingID &sailingID, bool &checkedIn)
+{
+    std::lock_guard<std::mutex> guard(cursorLock);
+    if (!cursorLoaded)
+    {
+        cursorSailings = catalogList();
+        cursorPart = cursorRow = 0;
+        cursorLoaded = true;
+    }
+
+    std::vector<ReservationRec> rows;
+    for (; cursorPart < cursorSailings.size(); ++cursorPart, cursorRow = 0)
+    {
+        read(cursorSailings[cursorPart], rows);
+        if (cursorRow < rows.size())
+        {
+            const ReservationRec &rec = rows[cursorRow++];
+            licensePlate = licenseOf(rec);
+            sailingID = sailingOf(rec);
+            checkedIn = rec.status == RES_CHECKED_IN;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReservationPartitions::resetCursor()
+{
+    std::lock_guard<std::mutex> guard(cursorLock);
+    cursorLoaded = false;
+}
+
+int ReservationPartitions::migrate(const std::string &flatPath)
+{
+    std::error_code ec;
+    if (!fs::exists(flatPath, ec))
+        return 0;
+
+    // Live rows grouped by upper-cased sailing, in file order
+    using Groups = std::map<std::string, std::vector<ReservationRec>>;
+    Groups groups;
+    bool scanned = parallelScan(
+        flatPath, REC_BYTES, groups,
+        [](Groups &part, std::size_t, const unsigned char *bytes) {
+            const auto *rec = reinterpret_cast<const ReservationRec*>(bytes);
+            if (rec->status != REC_DEAD)
+                part[upper(sailingOf(*rec))].push_back(*rec);
+        },
+        [](Groups &out, Groups &&part) {
+            for (auto &kv : part)
+            {
+                auto &rows = out[kv.first];
+                rows.insert(rows.end(), kv.second.begin(), kv.second.end());
+            }
+        });
+    if (!scanned)
+        return -1;      // the flat file stays, to be migrated again
+
+    int moved = 0;
+    for (auto &kv : groups)
+    {
+        // Skip licenses the partition (or an earlier flat row) already has
+        std::vector<ReservationRec> existing;
+        read(kv.first, existing);
+        std::unordered_set<std::string> seen;
+        for (const auto &rec : existing)
+            seen.insert(upper(licenseOf(rec)));
+
+        std::vector<ReservationRec> fresh;
+        for (const auto &rec : kv.second)
+        {
+            if (seen.insert(upper(licenseOf(rec))).second)
+                fresh.push_back(rec);
+        }
+        if (fresh.empty())
+            continue;
+        if (!appendRows(kv.first, fresh))
+            return -1;
+        moved += static_cast<int>(fresh.size());
+    }
+
+    fs::create_directories(DIR, ec);
+    if (!present())
+        std::ofstream(CATALOG, std::ios::binary | std::ios::app);
+    fs::rename(flatPath, flatPath + ".migrated", ec);
+    return ec ? -1 : moved;
+}
+
+} // namespace FerrySys
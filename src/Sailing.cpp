@@ -9,8 +9,21 @@
 //************************************************************
 
 #include "Sailing.h"
-#include "FileIO_Vessel.h"
-#include "FileIO_Sailings.h"
+#include "Metrics.h"
+#include "StorageBackend.h"
+#include "CapacityTable.h"
+#include "Archive.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// The storage engine in use
+static FerrySys::StorageBackend &store()
+{
+    return FerrySys::StorageBackend::current();
+}
 
 // Create a new sailing
 SailingStatus Sailing::CreateSailing(const std::string &ArrivalCity,
@@ -18,6 +31,7 @@ SailingStatus Sailing::CreateSailing(const std::string &ArrivalCity,
                                      const std::string &Date,
                                      const std::string &Time)
 {
+    FERRY_METRIC_SCOPE("Sailing::CreateSailing");
     // Build Sailing ID (CITY:DD:HH)
     std::string day = Date.substr(6, 2);
     std::string hour = Time.substr(0, 2);
@@ -25,34 +39,109 @@ SailingStatus Sailing::CreateSailing(const std::string &ArrivalCity,
 
     // Validate vessel
     unsigned int laneHCL = 0, laneLCL = 0;
-    if (!FileIO_Vessel::getVesselByName(VesselName, laneHCL, laneLCL))
+    if (!store().findVessel(VesselName, laneHCL, laneLCL))
         return SailingStatus::VESSEL_NOT_FOUND;
 
     // Check if sailing exists
-    if (FileIO_Sailings::Sailingexist(SailingID))
+    if (store().sailingExists(SailingID))
         return SailingStatus::SAILING_ALREADY_EXISTS;
 
-    // Save to file
-    FileIO_Sailings::writeSailing(SailingID, VesselName, laneHCL, laneLCL);
+    // Save to storage
+    store().writeSailing(SailingID, VesselName, laneHCL, laneLCL);
+    FerrySys::CapacityTable::add(SailingID, laneHCL, laneLCL, laneHCL, laneLCL);
     return SailingStatus::SUCCESS;
 }
 
 // Delete sailing
 bool Sailing::DeleteSailing(SailingID sailingID)
 {
-    if (!FileIO_Sailings::Sailingexist(sailingID))
+    FERRY_METRIC_SCOPE("Sailing::DeleteSailing");
+    if (!store().sailingExists(sailingID))
+        return false;
+    if (!store().deleteSailing(sailingID))
         return false;
-    return FileIO_Sailings::deleteSailing(sailingID);
+    FerrySys::CapacityTable::remove(sailingID);
+    return true;
 }
 
-// Print sailing status
+// Delete all sailings on a date (cascades reservations in one pass)
+int Sailing::DeleteSailingsOnDate(const std::string &Date)
+{
+    FERRY_METRIC_SCOPE("Sailing::DeleteSailingsOnDate");
+    if (Date.size() < 8)
+        return 0;
+
+    std::vector<SailingID> removed;
+    int count = store().deleteSailingsOnDay(Date.substr(6, 2), removed);
+    for (const auto &id : removed)
+        FerrySys::CapacityTable::remove(id);
+    return count;
+}
+
+// Delete all sailings to a city (cascades reservations in one pass)
+int Sailing::DeleteSailingsToCity(const std::string &ArrivalCity)
+{
+    FERRY_METRIC_SCOPE("Sailing::DeleteSailingsToCity");
+    std::vector<SailingID> removed;
+    int count = store().deleteSailingsToCity(ArrivalCity, removed);
+    for (const auto &id : removed)
+        FerrySys::CapacityTable::remove(id);
+    return count;
+}
+
+// Archive sailings departed before (day, hour), then compact the
+// working files so the freed space is returned
+int Sailing::ArchiveDeparted(int day, int hour)
+{
+    FERRY_METRIC_SCOPE("Sailing::ArchiveDeparted");
+    std::vector<SailingID> archived;
+    int count = FerrySys::Archive::archiveDeparted(day, hour, archived);
+    if (count <= 0)
+        return count;
+    for (const auto &id : archived)
+        FerrySys::CapacityTable::remove(id);
+    store().compact(FerrySys::Table::SAILINGS);
+    store().compact(FerrySys::Table::RESERVATIONS);
+    return count;
+}
+
+// Print sailing status (falls back to the archive)
 bool Sailing::printStatus(SailingID sailingID)
 {
-    if (!FileIO_Sailings::Sailingexist(sailingID))
-        return false;
-    return FileIO_Sailings::sailingstatus(sailingID);
+    FERRY_METRIC_SCOPE("Sailing::printStatus");
+    Sailingrec rec{};
+    bool archived = false;
+    if (!store().findSailing(sailingID, rec))
+    {
+        if (!FerrySys::Archive::findSailing(sailingID, rec))
+            return false;
+        archived = true;
+    }
+
+    int reservationCount = archived
+        ? FerrySys::Archive::countReservations(sailingID)
+        : store().countReservations(sailingID);
+
+    std::cout << "----------------------------------------------------------------------------------------------------------------\n";
+    std::cout << std::left << std::setw(15) << "Sailing ID"
+              << std::setw(25) << "Reservations"
+              << std::setw(20) << "Remaining HCL"
+              << std::setw(20) << "Remaining LCL" << "\n";
+    std::cout << "----------------------------------------------------------------------------------------------------------------\n";
+
+    std::cout << std::fixed << std::setprecision(1)
+              << std::left << std::setw(15) << std::string(rec.id, strnlen(rec.id, sizeof(rec.id)))
+              << std::setw(25) << (reservationCount >= 0 ? std::to_string(reservationCount) : "unreadable")
+              << std::setw(20) << rec.remainingHCL
+              << std::setw(20) << rec.remainingLCL
+              << (archived ? "(departed, archived)" : "") << "\n";
+    std::cout << "----------------------------------------------------------------------------------------------------------------\n";
+    return true;
 }
 
 // Lifecycle
 void Sailing::initialize() {}
-void Sailing::shutdown() {}
+void Sailing::shutdown()
+{
+    store().compact(FerrySys::Table::SAILINGS);
+}
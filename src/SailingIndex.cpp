@@ -0,0 +1,518 @@
+//************************************************************
+//************************************************************
+//  SailingIndex.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the sailings.idx B+tree.
+//
+//    Every page is one Node: leaves hold sorted (key, slot)
+//    pairs and link to their right sibling; inner nodes hold
+//    `count` separator keys and `count + 1` child pages, with
+//    every key in child i <= keys[i] <= every key in child i+1
+//    (duplicates may straddle a separator). Lookups therefore
+//    descend by lower_bound and walk right; inserts descend by
+//    upper_bound and split full nodes on the way back up.
+//************************************************************
+//************************************************************
+
+#include "SailingIndex.h"
+#include "BinaryFileOps.hpp"
+#include "Compaction.h"
+#include "DataFile.h"
+#include "FileIO_Sailings.h"
+#include "Metrics.h"
+#include "ParallelScan.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <shared_mutex>
+#include <unistd.h>
+#include <utility>
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr std::uint32_t MAGIC = 0x58495346;     // "FSIX"
+    constexpr std::uint32_t VERSION = 2;
+    constexpr std::uint32_t NO_PAGE = 0;             // page 0 is the header
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t pageBytes;
+        std::uint32_t root;
+        std::uint32_t pages;            // including the header page
+        std::uint32_t height;           // 1 = root is a leaf
+        std::uint64_t entries;
+        std::uint64_t dataRecords;      // sailings.dat records reflected
+        std::uint64_t dataGeneration;   // and the generation they had
+    };
+
+    constexpr std::size_t FANOUT = 340;
+    constexpr std::size_t BULK_FILL = FANOUT * 3 / 4;   // room for later inserts
+
+    struct Node
+    {
+        std::uint8_t  leaf;
+        std::uint8_t  unused;
+        std::uint16_t count;
+        std::uint32_t next;                 // leaves: right sibling
+        std::uint64_t keys[FANOUT];
+        std::uint32_t vals[FANOUT + 1];     // leaves: slots; inner: child pages
+    };
+    static_assert(sizeof(Node) == SailingIndex::PAGE_BYTES, "one node per page");
+
+    // Character positions of "CCC:DD:HH" that make up the key
+    constexpr int KEY_CHARS[7] = { 0, 1, 2, 4, 5, 7, 8 };
+
+    std::shared_mutex treeLock;
+    std::once_flag    hookOnce;
+
+    //------------------------------------------------------------
+    // Pack `text` at KEY_CHARS; positions past its end get `fill`
+    std::uint64_t pack(const std::string &text, unsigned char fill)
+    {
+        std::uint64_t key = 0;
+        for (int pos : KEY_CHARS)
+        {
+            unsigned char c = static_cast<std::size_t>(pos) < text.size()
+                ? static_cast<unsigned char>(text[pos]) : fill;
+            key = (key << 8) | c;
+        }
+        return key;
+    }
+
+    std::size_t dataRecords()
+    {
+        return fileRecordCount("sailings.dat", sizeof(Sailingrec));
+    }
+
+    std::uint64_t dataGeneration()
+    {
+        return DataFile::generation(Table::SAILINGS);
+    }
+
+    //------------------------------------------------------------
+    // sailings.idx opened for page I/O
+    class PageFile
+    {
+    public:
+        PageFile(const char *path, int flags)
+            : fd(::open(path, flags, 0644))
+        {
+            if (fd >= 0)
+                Metrics::add(Counter::FILE_OPENS);
+        }
+        ~PageFile()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        PageFile(const PageFile &) = delete;
+        PageFile &operator=(const PageFile &) = delete;
+
+        bool ok() const { return fd >= 0; }
+
+        bool readHeader(Header &h)
+        {
+            if (::pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)))
+                return false;
+            return h.magic == MAGIC && h.version == VERSION &&
+                   h.pageBytes == SailingIndex::PAGE_BYTES && h.root != NO_PAGE;
+        }
+
+        bool writeHeader(const Header &h)
+        {
+            return ::pwrite(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+        }
+
+        bool read(std::uint32_t page, Node &n)
+        {
+            off_t at = static_cast<off_t>(page) * static_cast<off_t>(SailingIndex::PAGE_BYTES);
+            if (::pread(fd, &n, sizeof(n), at) != static_cast<ssize_t>(sizeof(n)))
+                return false;
+            Metrics::add(Counter::BYTES_READ, sizeof(n));
+            return n.count <= FANOUT;
+        }
+
+        bool write(std::uint32_t page, const Node &n)
+        {
+            off_t at = static_cast<off_t>(page) * static_cast<off_t>(SailingIndex::PAGE_BYTES);
+            if (::pwrite(fd, &n, sizeof(n), at) != static_cast<ssize_t>(sizeof(n)))
+                return false;
+            Metrics::add(Counter::BYTES_WRITTEN, sizeof(n));
+            return true;
+        }
+
+    private:
+        int fd;
+    };
+
+    //------------------------------------------------------------
+    // Index exists and reflects the current sailings.dat
+    bool isFresh()
+    {
+        PageFile f(SailingIndex::INDEX_FILE, O_RDONLY);
+        Header h{};
+        return f.ok() && f.readHeader(h) && h.dataGeneration == dataGeneration();
+    }
+
+    //------------------------------------------------------------
+    // Leaf holding the first key >= `key`; `page` receives its
+    // page number
+    bool descend(PageFile &f, const Header &h, std::uint64_t key, Node &n, std::uint32_t &page)
+    {
+        page = h.root;
+        for (std::uint32_t level = 0; level < h.height; ++level)
+        {
+            if (!f.read(page, n))
+                return false;
+            if (n.leaf)
+                return true;
+            std::size_t i = std::lower_bound(n.keys, n.keys + n.count, key) - n.keys;
+            page = n.vals[i];
+        }
+        return false;       // deeper than the header says: corrupt
+    }
+
+    //------------------------------------------------------------
+    // Slots with lo <= key <= hi, in key order
+    bool scan(std::uint64_t lo, std::uint64_t hi, std::vector<std::size_t> &slots)
+    {
+        PageFile f(SailingIndex::INDEX_FILE, O_RDONLY);
+        Header h{};
+        Node n;
+        std::uint32_t page = NO_PAGE;
+        if (!f.ok() || !f.readHeader(h) || !descend(f, h, lo, n, page))
+            return false;
+
+        while (true)
+        {
+            for (std::size_t i = 0; i < n.count; ++i)
+            {
+                if (n.keys[i] < lo)
+                    continue;
+                if (n.keys[i] > hi)
+                    return true;
+                slots.push_back(n.vals[i]);
+            }
+            if (n.next == NO_PAGE)
+                return true;
+            if (!f.read(n.next, n))
+                return false;
+        }
+    }
+
+    //------------------------------------------------------------
+    // Bulk-build into a temp file, then swap it in
+    bool buildLocked()
+    {
+        FERRY_METRIC_SCOPE("SailingIndex::build");
+        using Entries = std::vector<std::pair<std::uint64_t, std::uint32_t>>;
+        std::size_t records = dataRecords();
+        std::uint64_t generation = dataGeneration();
+        Entries entries;
+        bool scanned = parallelScan(
+            "sailings.dat", sizeof(Sailingrec), entries,
+            [](Entries &part, std::size_t index, const unsigned char *bytes) {
+                const auto *rec = reinterpret_cast<const Sailingrec*>(bytes);
+                if (rec->status == REC_DEAD)
+                    return;
+                std::string id(rec->id, strnlen(rec->id, sizeof(rec->id)));
+                part.emplace_back(SailingIndex::keyOf(id), static_cast<std::uint32_t>(index));
+            },
+            [](Entries &out, Entries &&part) {
+                out.insert(out.end(), part.begin(), part.end());
+            });
+        if (!scanned)
+            return false;
+        std::sort(entries.begin(), entries.end());
+
+        const std::string tmp = std::string(SailingIndex::INDEX_FILE) + ".tmp";
+        bool ok = true;
+        Header h{ MAGIC, VERSION, static_cast<std::uint32_t>(SailingIndex::PAGE_BYTES),
+                  NO_PAGE, 1, 1, entries.size(), records, generation };
+        {
+            PageFile f(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC);
+            if (!f.ok())
+                return false;
+
+            // Leaves, left to right; `level` keeps (first key, page) per node
+            std::vector<std::pair<std::uint64_t, std::uint32_t>> level;
+            std::size_t leaves = entries.empty() ? 1 : (entries.size() + BULK_FILL - 1) / BULK_FILL;
+            for (std::size_t l = 0; l < leaves && ok; ++l)
+            {
+                Node n{};
+                n.leaf = 1;
+                std::size_t first = l * BULK_FILL;
+                std::size_t last = std::min(first + BULK_FILL, entries.size());
+                for (std::size_t i = first; i < last; ++i, ++n.count)
+                {
+                    n.keys[n.count] = entries[i].first;
+                    n.vals[n.count] = entries[i].second;
+                }
+                std::uint32_t page = h.pages++;
+                n.next = l + 1 < leaves ? page + 1 : NO_PAGE;
+                ok = f.write(page, n);
+                level.emplace_back(first < last ? entries[first].first : 0, page);
+            }
+
+            // Inner levels until a single root remains
+            while (level.size() > 1 && ok)
+            {
+                std::vector<std::pair<std::uint64_t, std::uint32_t>> parents;
+                for (std::size_t first = 0; first < level.size() && ok; first += BULK_FILL + 1)
+                {
+                    std::size_t last = std::min(first + BULK_FILL + 1, level.size());
+                    Node n{};
+                    n.vals[0] = level[first].second;
+                    for (std::size_t c = first + 1; c < last; ++c, ++n.count)
+                    {
+                        n.keys[n.count] = level[c].first;
+                        n.vals[n.count + 1] = level[c].second;
+                    }
+                    std::uint32_t page = h.pages++;
+                    ok = f.write(page, n);
+                    parents.emplace_back(level[first].first, page);
+                }
+                level.swap(parents);
+                ++h.height;
+            }
+
+            h.root = level.front().second;
+            ok = ok && f.writeHeader(h);
+        }
+
+        if (!ok || std::rename(tmp.c_str(), SailingIndex::INDEX_FILE) != 0)
+        {
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    struct Split
+    {
+        bool          happened = false;
+        std::uint64_t sep = 0;
+        std::uint32_t right = NO_PAGE;
+    };
+
+    //------------------------------------------------------------
+    // Insert below `page`; reports a split for the parent to absorb
+    bool insertBelow(PageFile &f, Header &h, std::uint32_t page,
+                     std::uint64_t key, std::uint32_t slot, Split &split)
+    {
+        Node n;
+        if (!f.read(page, n))
+            return false;
+
+        std::vector<std::uint64_t> keys(n.keys, n.keys + n.count);
+        std::vector<std::uint32_t> vals;
+        if (n.leaf)
+        {
+            vals.assign(n.vals, n.vals + n.count);
+            std::size_t pos = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+            keys.insert(keys.begin() + pos, key);
+            vals.insert(vals.begin() + pos, slot);
+        }
+        else
+        {
+            vals.assign(n.vals, n.vals + n.count + 1);
+            std::size_t i = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+            Split child;
+            if (!insertBelow(f, h, vals[i], key, slot, child))
+                return false;
+            if (!child.happened)
+                return true;
+            keys.insert(keys.begin() + i, child.sep);
+            vals.insert(vals.begin() + i + 1, child.right);
+        }
+
+        if (keys.size() <= FANOUT)
+        {
+            n.count = static_cast<std::uint16_t>(keys.size());
+            std::copy(keys.begin(), keys.end(), n.keys);
+            std::copy(vals.begin(), vals.end(), n.vals);
+            return f.write(page, n);
+        }
+
+        // Split: the lower half stays in `page`, the upper half moves right
+        std::size_t mid = keys.size() / 2;
+        Node left{}, right{};
+        left.leaf = right.leaf = n.leaf;
+        split.happened = true;
+        split.sep = keys[mid];
+        split.right = h.pages++;
+
+        if (n.leaf)
+        {
+            left.count = static_cast<std::uint16_t>(mid);
+            right.count = static_cast<std::uint16_t>(keys.size() - mid);
+            std::copy(keys.begin(), keys.begin() + mid, left.keys);
+            std::copy(vals.begin(), vals.begin() + mid, left.vals);
+            std::copy(keys.begin() + mid, keys.end(), right.keys);
+            std::copy(vals.begin() + mid, vals.end(), right.vals);
+            right.next = n.next;
+            left.next = split.right;
+        }
+        else
+        {
+            // keys[mid] moves up; each side keeps its own children
+            left.count = static_cast<std::uint16_t>(mid);
+            right.count = static_cast<std::uint16_t>(keys.size() - mid - 1);
+            std::copy(keys.begin(), keys.begin() + mid, left.keys);
+            std::copy(vals.begin(), vals.begin() + mid + 1, left.vals);
+            std::copy(keys.begin() + mid + 1, keys.end(), right.keys);
+            std::copy(vals.begin() + mid + 1, vals.end(), right.vals);
+        }
+        return f.write(page, left) && f.write(split.right, right);
+    }
+
+    void registerHook()
+    {
+        std::call_once(hookOnce, [] {
+            Compactor::onCompacted(Table::SAILINGS, [] { SailingIndex::invalidate(); });
+        });
+    }
+
+    //------------------------------------------------------------
+    // Scan [lo, hi], rebuilding first if the index is stale
+    bool lookup(std::uint64_t lo, std::uint64_t hi, std::vector<std::size_t> &slots)
+    {
+        registerHook();
+        {
+            std::shared_lock<std::shared_mutex> guard(treeLock);
+            if (isFresh())
+                return scan(lo, hi, slots);
+        }
+        std::unique_lock<std::shared_mutex> guard(treeLock);
+        if (!isFresh() && !buildLocked())
+            return false;
+        return scan(lo, hi, slots);
+    }
+}
+
+std::uint64_t SailingIndex::keyOf(const SailingID &sailingID)
+{
+    return pack(sailingID, 0);
+}
+
+bool SailingIndex::find(const SailingID &sailingID, std::vector<std::size_t> &slots)
+{
+    std::uint64_t key = keyOf(sailingID);
+    return lookup(key, key, slots);
+}
+
+bool SailingIndex::range(const std::string &city, const std::string &day,
+                         std::vector<std::size_t> &slots)
+{
+    if (city.size() != 3 || (!day.empty() && day.size() != 2))
+        return true;        // cannot match the ID format: nothing to find
+    std::string prefix = day.empty() ? city : city + ":" + day;
+    return lookup(pack(prefix, 0x00), pack(prefix, 0xFF), slots);
+}
+
+void SailingIndex::insert(const SailingID &sailingID, std::size_t slot)
+{
+    registerHook();
+    std::unique_lock<std::shared_mutex> guard(treeLock);
+    PageFile f(INDEX_FILE, O_RDWR);
+    Header h{};
+    if (!f.ok() || !f.readHeader(h))
+        return;                         // built on first lookup
+    // The tree must reflect the file as it was just before this
+    // append (an empty file has no generation yet)
+    std::uint64_t generation = dataGeneration();
+    if (h.dataRecords != slot || (slot > 0 && h.dataGeneration + 1 != generation))
+    {
+        ::unlink(INDEX_FILE);           // missed a write: rebuild on next lookup
+        return;
+    }
+
+    Split split;
+    if (!insertBelow(f, h, h.root, keyOf(sailingID), static_cast<std::uint32_t>(slot), split))
+    {
+        ::unlink(INDEX_FILE);
+        return;
+    }
+    if (split.happened)
+    {
+        Node root{};
+        root.count = 1;
+        root.keys[0] = split.sep;
+        root.vals[0] = h.root;
+        root.vals[1] = split.right;
+        h.root = h.pages++;
+        ++h.height;
+        if (!f.write(h.root, root))
+        {
+            ::unlink(INDEX_FILE);
+            return;
+        }
+    }
+    ++h.entries;
+    h.dataRecords = slot + 1;
+    h.dataGeneration = generation;
+    if (!f.writeHeader(h))
+        ::unlink(INDEX_FILE);
+}
+
+void SailingIndex::erase(const SailingID &sailingID, std::size_t slot)
+{
+    std::unique_lock<std::shared_mutex> guard(treeLock);
+    PageFile f(INDEX_FILE, O_RDWR);
+    Header h{};
+    Node n;
+    std::uint32_t page = NO_PAGE;
+    std::uint64_t key = keyOf(sailingID);
+    if (!f.ok() || !f.readHeader(h) || !descend(f, h, key, n, page))
+        return;
+
+    // Leaves may be left under-full (or empty); nothing is merged
+    while (true)
+    {
+        for (std::size_t i = 0; i < n.count; ++i)
+        {
+            if (n.keys[i] > key)
+                return;
+            if (n.keys[i] == key && n.vals[i] == slot)
+            {
+                std::copy(n.keys + i + 1, n.keys + n.count, n.keys + i);
+                std::copy(n.vals + i + 1, n.vals + n.count, n.vals + i);
+                --n.count;
+                --h.entries;
+                if (!f.write(page, n) || !f.writeHeader(h))
+                    ::unlink(INDEX_FILE);
+                return;
+            }
+        }
+        if (n.next == NO_PAGE)
+            return;
+        page = n.next;
+        if (!f.read(page, n))
+            return;
+    }
+}
+
+bool SailingIndex::build()
+{
+    registerHook();
+    std::unique_lock<std::shared_mutex> guard(treeLock);
+    return buildLocked();
+}
+
+void SailingIndex::invalidate()
+{
+    std::unique_lock<std::shared_mutex> guard(treeLock);
+    ::unlink(INDEX_FILE);
+}
+
+} // namespace FerrySys
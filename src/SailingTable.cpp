@@ -0,0 +1,602 @@
+//************************************************************
+//************************************************************
+//  SailingTable.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the in-memory sailing columns: the vectorized ID
+//    scan, loading sailings.dat in one read, the version check
+//    that decides when to load again, and the per-route max trees
+//    behind available().
+//
+//    The version is the change count in sailings.space
+//    (CapacityTable::sailingsVersion): one atomic load per lookup.
+//    A write-through bumps it and applies its own change only if
+//    the count it bumped is the one the columns were loaded at (or
+//    last brought to); any other value means another process or
+//    thread changed the file too, and the columns are loaded
+//    again. If sailings.space cannot be used, lookups fall back to
+//    stat()ing the file, and every write-through drops the columns.
+//************************************************************
+//************************************************************
+
+#include "SailingTable.h"
+#include "BinaryFileOps.hpp"
+#include "CapacityTable.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <shared_mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace FerrySys
+{
+
+namespace
+{
+    constexpr const char *SAILINGS_FILE = "sailings.dat";
+    constexpr std::size_t ID_BYTES = 16;
+
+    struct alignas(16) PackedID
+    {
+        char bytes[ID_BYTES];
+    };
+    static_assert(sizeof(PackedID) == ID_BYTES, "IDs are packed back to back");
+
+    PackedID pack(const char *text, std::size_t len)
+    {
+        PackedID id{};
+        std::memcpy(id.bytes, text, len < ID_BYTES ? len : ID_BYTES);
+        return id;
+    }
+
+    PackedID pack(const SailingID &sailingID)
+    {
+        return pack(sailingID.data(), sailingID.size());
+    }
+
+    // What sailings.dat looked like when the table last matched it,
+    // if sailings.space cannot be used
+    struct Stamp
+    {
+        bool            exists = false;
+        dev_t           dev = 0;
+        ino_t           ino = 0;
+        off_t           size = 0;
+        struct timespec mtime{};
+
+        bool operator==(const Stamp &o) const
+        {
+            return exists == o.exists && (!exists ||
+                   (dev == o.dev && ino == o.ino && size == o.size &&
+                    mtime.tv_sec == o.mtime.tv_sec && mtime.tv_nsec == o.mtime.tv_nsec));
+        }
+    };
+
+    Stamp stampOf(const struct stat &st)
+    {
+        Stamp s;
+        s.exists = true;
+        s.dev = st.st_dev;
+        s.ino = st.st_ino;
+        s.size = st.st_size;
+        s.mtime = st.st_mtim;
+        return s;
+    }
+
+    Stamp currentStamp()
+    {
+        struct stat st{};
+        return ::stat(SAILINGS_FILE, &st) == 0 ? stampOf(st) : Stamp{};
+    }
+
+    //------------------------------------------------------------
+    // Split "CCC:DD:HH" into its city and departure (day * 100 +
+    // hour). False for IDs not of that form.
+    bool departure(const PackedID &id, std::string &city, std::int32_t &when)
+    {
+        std::size_t len = strnlen(id.bytes, ID_BYTES);
+        const char *colon = static_cast<const char*>(std::memchr(id.bytes, ':', len));
+        if (!colon || colon == id.bytes)
+            return false;
+        std::size_t at = static_cast<std::size_t>(colon - id.bytes);
+        const char *d = colon + 1;
+        auto digit = [](char c) { return c >= '0' && c <= '9'; };
+        if (len != at + 6 || !digit(d[0]) || !digit(d[1]) || d[2] != ':' || !digit(d[3]) || !digit(d[4]))
+            return false;
+        city.assign(id.bytes, at);
+        when = ((d[0] - '0') * 10 + (d[1] - '0')) * 100 + (d[3] - '0') * 10 + (d[4] - '0');
+        return true;
+    }
+
+    constexpr std::size_t  NO_LEAF = SIZE_MAX;
+    constexpr std::int32_t EMPTY_LEAF = INT32_MIN;
+
+    //------------------------------------------------------------
+    // The sailings to one city ordered by departure, with two max
+    // trees over their remaining space (centimetres, as
+    // CapacityTable counts it): the HCL alone, which is all a
+    // high-ceiling vehicle may use, and the larger of the two
+    // lanes, which is what any other vehicle may use. Trees are
+    // stored heap-style, node 1 the root and the leaves at
+    // [leaves, 2 * leaves); padding leaves hold EMPTY_LEAF.
+    struct Route
+    {
+        std::vector<std::size_t>  rows;         // table row per leaf
+        std::vector<std::int32_t> departs;      // day * 100 + hour per leaf
+        std::size_t               leaves = 1;   // power of two >= rows
+        std::vector<std::int32_t> hclMax;
+        std::vector<std::int32_t> anyMax;
+
+        void set(std::size_t leaf, std::int32_t hclCm, std::int32_t lclCm)
+        {
+            std::size_t node = leaves + leaf;
+            hclMax[node] = hclCm;
+            anyMax[node] = std::max(hclCm, lclCm);
+            for (node /= 2; node >= 1; node /= 2)
+            {
+                hclMax[node] = std::max(hclMax[2 * node], hclMax[2 * node + 1]);
+                anyMax[node] = std::max(anyMax[2 * node], anyMax[2 * node + 1]);
+            }
+        }
+
+        //--------------------------------------------------------
+        // First leaf at or after `from` under `node` (covering
+        // [lo, hi)) whose value is at least `need`, or NO_LEAF.
+        // Whole subtrees that are too full or too early are
+        // skipped, so this visits O(log n) nodes.
+        static std::size_t firstFit(const std::vector<std::int32_t> &tree, std::size_t node,
+                                    std::size_t lo, std::size_t hi, std::size_t from, std::int32_t need)
+        {
+            if (hi <= from || tree[node] < need)
+                return NO_LEAF;
+            if (hi - lo == 1)
+                return lo;
+            std::size_t mid = lo + (hi - lo) / 2;
+            std::size_t left = firstFit(tree, 2 * node, lo, mid, from, need);
+            return left != NO_LEAF ? left : firstFit(tree, 2 * node + 1, mid, hi, from, need);
+        }
+    };
+
+    struct Table
+    {
+        std::shared_mutex         lock;         // everything below
+        bool                      loaded = false;
+        bool                      shared = false;   // version valid, else stamp
+        CapacityTable::SailingsVersion version;
+        Stamp                     stamp;
+        std::vector<PackedID>     ids;
+        std::vector<float>        hcl;
+        std::vector<float>        lcl;
+        std::vector<std::size_t>  slots;
+        std::vector<std::array<char, sizeof(Sailingrec::VesselName)>> vessels;
+
+        // Routes are built by the first available() after a load,
+        // insert or delete (under the shared lock, so builders
+        // take routeBuild); space updates keep them current.
+        std::atomic<bool>         routesBuilt{false};
+        std::mutex                routeBuild;
+        std::unordered_map<std::string, Route> routes;
+        std::vector<std::size_t>  leafOf;       // per row, NO_LEAF if in no route
+
+        void clear()
+        {
+            ids.clear();
+            hcl.clear();
+            lcl.clear();
+            slots.clear();
+            vessels.clear();
+            dropRoutes();
+        }
+
+        void dropRoutes()
+        {
+            routesBuilt.store(false, std::memory_order_release);
+            routes.clear();
+            leafOf.clear();
+        }
+
+        void buildRoutes()
+        {
+            FERRY_METRIC_SCOPE("SailingTable::buildRoutes");
+            routes.clear();
+            leafOf.assign(ids.size(), NO_LEAF);
+            std::unordered_map<std::string, std::vector<std::pair<std::int32_t, std::size_t>>> byCity;
+            std::string city;
+            std::int32_t when = 0;
+            for (std::size_t row = 0; row < ids.size(); ++row)
+            {
+                if (departure(ids[row], city, when))
+                    byCity[city].emplace_back(when, row);
+            }
+
+            for (auto &[name, order] : byCity)
+            {
+                std::sort(order.begin(), order.end());
+                Route &r = routes[name];
+                while (r.leaves < order.size())
+                    r.leaves *= 2;
+                r.hclMax.assign(2 * r.leaves, EMPTY_LEAF);
+                r.anyMax.assign(2 * r.leaves, EMPTY_LEAF);
+                r.rows.reserve(order.size());
+                r.departs.reserve(order.size());
+                for (std::size_t leaf = 0; leaf < order.size(); ++leaf)
+                {
+                    std::size_t row = order[leaf].second;
+                    r.departs.push_back(order[leaf].first);
+                    r.rows.push_back(row);
+                    leafOf[row] = leaf;
+                    std::int32_t hclCm = CapacityTable::toCentimetres(hcl[row]);
+                    r.hclMax[r.leaves + leaf] = hclCm;
+                    r.anyMax[r.leaves + leaf] = std::max(hclCm, CapacityTable::toCentimetres(lcl[row]));
+                }
+                for (std::size_t node = r.leaves - 1; node >= 1; --node)
+                {
+                    r.hclMax[node] = std::max(r.hclMax[2 * node], r.hclMax[2 * node + 1]);
+                    r.anyMax[node] = std::max(r.anyMax[2 * node], r.anyMax[2 * node + 1]);
+                }
+            }
+            routesBuilt.store(true, std::memory_order_release);
+        }
+
+        // Called under the shared lock
+        void ensureRoutes()
+        {
+            if (routesBuilt.load(std::memory_order_acquire))
+                return;
+            std::lock_guard<std::mutex> guard(routeBuild);
+            if (!routesBuilt.load(std::memory_order_relaxed))
+                buildRoutes();
+        }
+
+        // Keep the trees current after a space change to `row`
+        void spaceChanged(std::size_t row)
+        {
+            std::string city;
+            std::int32_t when = 0;
+            if (!routesBuilt.load(std::memory_order_relaxed) || leafOf[row] == NO_LEAF ||
+                !departure(ids[row], city, when))
+                return;
+            auto it = routes.find(city);
+            if (it != routes.end())
+                it->second.set(leafOf[row], CapacityTable::toCentimetres(hcl[row]),
+                               CapacityTable::toCentimetres(lcl[row]));
+        }
+
+        // Rows stay in slot (file) order, even when threads'
+        // appends are noted out of order
+        void push(const Sailingrec &rec, std::size_t slot)
+        {
+            dropRoutes();
+            auto at = static_cast<std::ptrdiff_t>(
+                std::upper_bound(slots.begin(), slots.end(), slot) - slots.begin());
+            ids.insert(ids.begin() + at, pack(rec.id, strnlen(rec.id, sizeof(rec.id))));
+            hcl.insert(hcl.begin() + at, rec.remainingHCL);
+            lcl.insert(lcl.begin() + at, rec.remainingLCL);
+            slots.insert(slots.begin() + at, slot);
+            std::array<char, sizeof(Sailingrec::VesselName)> vessel{};
+            std::memcpy(vessel.data(), rec.VesselName, strnlen(rec.VesselName, sizeof(rec.VesselName)));
+            vessels.insert(vessels.begin() + at, vessel);
+        }
+
+        void erase(std::size_t row)
+        {
+            dropRoutes();
+            ids.erase(ids.begin() + static_cast<std::ptrdiff_t>(row));
+            hcl.erase(hcl.begin() + static_cast<std::ptrdiff_t>(row));
+            lcl.erase(lcl.begin() + static_cast<std::ptrdiff_t>(row));
+            slots.erase(slots.begin() + static_cast<std::ptrdiff_t>(row));
+            vessels.erase(vessels.begin() + static_cast<std::ptrdiff_t>(row));
+        }
+
+        Sailingrec record(std::size_t row) const
+        {
+            Sailingrec rec{};
+            std::memcpy(rec.id, ids[row].bytes, sizeof(rec.id));
+            std::memcpy(rec.VesselName, vessels[row].data(), sizeof(rec.VesselName));
+            rec.status = REC_LIVE;
+            rec.remainingHCL = hcl[row];
+            rec.remainingLCL = lcl[row];
+            return rec;
+        }
+
+        std::size_t rowOf(const SailingID &sailingID) const
+        {
+            return SailingTable::scan(ids.empty() ? nullptr : ids.front().bytes, ids.size(), sailingID);
+        }
+
+        //--------------------------------------------------------
+        // Read every live row with one read of sailings.dat. The
+        // version is read first, so a change racing the read
+        // moves it past what is recorded here.
+        bool load()
+        {
+            FERRY_METRIC_SCOPE("SailingTable::load");
+            clear();
+            loaded = false;
+            shared = CapacityTable::sailingsVersion(version);
+            int fd = ::open(SAILINGS_FILE, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno != ENOENT)
+                    return false;
+                stamp = Stamp{};            // no file: no sailings
+                loaded = true;
+                return true;
+            }
+            Metrics::add(Counter::FILE_OPENS);
+
+            struct stat st{};
+            std::size_t start = dataOffset(fd, sizeof(Sailingrec));
+            bool ok = start != BAD_HEADER && ::fstat(fd, &st) == 0;
+            std::size_t bytes = ok && static_cast<std::size_t>(st.st_size) > start
+                                ? static_cast<std::size_t>(st.st_size) - start : 0;
+            std::size_t count = bytes / sizeof(Sailingrec);
+            std::vector<Sailingrec> recs(count);
+            std::size_t done = 0;
+            while (ok && done < count * sizeof(Sailingrec))
+            {
+                ssize_t n = ::pread(fd, reinterpret_cast<char*>(recs.data()) + done,
+                                    count * sizeof(Sailingrec) - done, static_cast<off_t>(start + done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                ok = n > 0;
+                if (ok)
+                    done += static_cast<std::size_t>(n);
+            }
+            ::close(fd);
+            if (!ok)
+                return false;
+
+            Metrics::add(Counter::BYTES_READ, done);
+            Metrics::add(Counter::RECORDS_SCANNED, count);
+            ids.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (recs[i].status != REC_DEAD)
+                    push(recs[i], i);
+            }
+            stamp = stampOf(st);
+            loaded = true;
+            return true;
+        }
+    };
+
+    Table &table()
+    {
+        static Table t;
+        return t;
+    }
+
+    bool sameVersion(const CapacityTable::SailingsVersion &a, const CapacityTable::SailingsVersion &b)
+    {
+        return a.attachment == b.attachment && a.changes == b.changes;
+    }
+
+    //------------------------------------------------------------
+    // Whether `t` still matches sailings.dat
+    bool isCurrent(const Table &t)
+    {
+        if (!t.loaded)
+            return false;
+        CapacityTable::SailingsVersion now;
+        if (CapacityTable::sailingsVersion(now))
+            return t.shared && sameVersion(now, t.version);
+        return !t.shared && t.stamp == currentStamp();
+    }
+
+    //------------------------------------------------------------
+    // Run `read` under the shared lock on a table that matches the
+    // file, loading it first if needed. False if it cannot load.
+    template <class Read>
+    bool withCurrent(Read read)
+    {
+        Table &t = table();
+        {
+            std::shared_lock<std::shared_mutex> guard(t.lock);
+            if (isCurrent(t))
+            {
+                read(t);
+                return true;
+            }
+        }
+        std::unique_lock<std::shared_mutex> guard(t.lock);
+        if (!isCurrent(t) && !t.load())
+            return false;
+        read(t);
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Write-through, after sailings.dat was changed: bump the
+    // version, and apply `change` if the columns were current just
+    // before it; otherwise they are loaded again on next use
+    template <class Change>
+    void writeThrough(Change change)
+    {
+        Table &t = table();
+        std::unique_lock<std::shared_mutex> guard(t.lock);
+        CapacityTable::SailingsVersion before;
+        bool shared = CapacityTable::noteSailingsChanged(before);
+        if (!t.loaded)
+            return;
+        if (!shared || !t.shared || !sameVersion(before, t.version))
+        {
+            t.clear();
+            t.loaded = false;
+            return;
+        }
+        change(t);
+        t.version.changes = before.changes + 1;
+    }
+}
+
+// ============================================================
+// Scan
+// ============================================================
+std::size_t SailingTable::scan(const char *ids, std::size_t count, const SailingID &sailingID)
+{
+    const PackedID want = pack(sailingID);
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i key = _mm_load_si128(reinterpret_cast<const __m128i*>(want.bytes));
+    const auto *col = reinterpret_cast<const __m128i*>(ids);
+    for (; i + 4 <= count; i += 4)
+    {
+        int hit = (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(col + i), key)) == 0xFFFF) |
+                  (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(col + i + 1), key)) == 0xFFFF) << 1 |
+                  (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(col + i + 2), key)) == 0xFFFF) << 2 |
+                  (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(col + i + 3), key)) == 0xFFFF) << 3;
+        if (hit)
+            return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(hit)));
+    }
+    for (; i < count; ++i)
+    {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(col + i), key)) == 0xFFFF)
+            return i;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t key = vld1q_u8(reinterpret_cast<const std::uint8_t*>(want.bytes));
+    const auto *col = reinterpret_cast<const std::uint8_t*>(ids);
+    for (; i + 4 <= count; i += 4)
+    {
+        // A row matches when every byte compares equal (min lane 0xFF)
+        int hit = (vminvq_u8(vceqq_u8(vld1q_u8(col + (i    ) * ID_BYTES), key)) == 0xFF) |
+                  (vminvq_u8(vceqq_u8(vld1q_u8(col + (i + 1) * ID_BYTES), key)) == 0xFF) << 1 |
+                  (vminvq_u8(vceqq_u8(vld1q_u8(col + (i + 2) * ID_BYTES), key)) == 0xFF) << 2 |
+                  (vminvq_u8(vceqq_u8(vld1q_u8(col + (i + 3) * ID_BYTES), key)) == 0xFF) << 3;
+        if (hit)
+            return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(hit)));
+    }
+    for (; i < count; ++i)
+    {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(col + i * ID_BYTES), key)) == 0xFF)
+            return i;
+    }
+#else
+    std::uint64_t lo, hi;
+    std::memcpy(&lo, want.bytes, 8);
+    std::memcpy(&hi, want.bytes + 8, 8);
+    for (; i < count; ++i)
+    {
+        std::uint64_t a, b;
+        std::memcpy(&a, ids + i * ID_BYTES, 8);
+        std::memcpy(&b, ids + i * ID_BYTES + 8, 8);
+        if (a == lo && b == hi)
+            return i;
+    }
+#endif
+    return count;
+}
+
+// ============================================================
+// Reads
+// ============================================================
+bool SailingTable::find(const SailingID &sailingID, bool &found, Sailingrec &result, std::size_t &slot)
+{
+    return withCurrent([&](const Table &t) {
+        std::size_t row = t.rowOf(sailingID);
+        found = row < t.ids.size();
+        if (!found)
+            return;
+        result = t.record(row);
+        slot = t.slots[row];
+    });
+}
+
+bool SailingTable::rows(std::vector<Sailingrec> &out)
+{
+    return withCurrent([&](const Table &t) {
+        out.clear();
+        out.reserve(t.ids.size());
+        for (std::size_t row = 0; row < t.ids.size(); ++row)
+            out.push_back(t.record(row));
+    });
+}
+
+bool SailingTable::available(const std::string &city, int day, int hour, std::int32_t spaceCm,
+                             bool highCeiling, std::size_t max, std::vector<Sailingrec> &out)
+{
+    return withCurrent([&](Table &t) {
+        out.clear();
+        t.ensureRoutes();
+        auto it = t.routes.find(city);
+        if (it == t.routes.end())
+            return;
+        const Route &r = it->second;
+        const std::vector<std::int32_t> &tree = highCeiling ? r.hclMax : r.anyMax;
+        std::size_t from = static_cast<std::size_t>(
+            std::lower_bound(r.departs.begin(), r.departs.end(), day * 100 + hour) - r.departs.begin());
+        while (out.size() < max)
+        {
+            std::size_t leaf = Route::firstFit(tree, 1, 0, r.leaves, from, spaceCm);
+            if (leaf == NO_LEAF)
+                break;
+            out.push_back(t.record(r.rows[leaf]));
+            from = leaf + 1;
+        }
+    });
+}
+
+// ============================================================
+// Write-through
+// ============================================================
+void SailingTable::noteWritten(const Sailingrec &rec, std::size_t slot)
+{
+    writeThrough([&](Table &t) { t.push(rec, slot); });
+}
+
+void SailingTable::noteSpace(const SailingID &sailingID, float remainingHCL, float remainingLCL)
+{
+    writeThrough([&](Table &t) {
+        std::size_t row = t.rowOf(sailingID);
+        if (row < t.ids.size())
+        {
+            t.hcl[row] = remainingHCL;
+            t.lcl[row] = remainingLCL;
+            t.spaceChanged(row);
+        }
+    });
+}
+
+void SailingTable::noteDeleted(const std::vector<SailingID> &sailingIDs)
+{
+    writeThrough([&](Table &t) {
+        for (const SailingID &id : sailingIDs)
+        {
+            std::size_t row = t.rowOf(id);
+            if (row < t.ids.size())
+                t.erase(row);
+        }
+    });
+}
+
+void SailingTable::forget()
+{
+    CapacityTable::SailingsVersion before;
+    CapacityTable::noteSailingsChanged(before);
+    Table &t = table();
+    std::unique_lock<std::shared_mutex> guard(t.lock);
+    t.clear();
+    t.loaded = false;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,252 @@
+//************************************************************
+//************************************************************
+//  StorageBackend.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Engine selection, plus the default sailing queries that an
+//    engine may override with something faster (the flat-file
+//    engine uses sailings.idx and its one-pass cascade).
+//************************************************************
+//************************************************************
+
+#include "StorageBackend.h"
+#include "CapacityTable.h"
+#include "FlatFileBackend.h"
+#include "LoggingBackend.h"
+#include "MemoryBackend.h"
+#include "MmapBackend.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace FerrySys
+{
+
+namespace
+{
+    std::mutex                      backendLock;
+    std::unique_ptr<StorageBackend> backend;
+
+    std::unique_ptr<StorageBackend> make(BackendKind kind)
+    {
+        switch (kind)
+        {
+            case BackendKind::MMAP:   return std::make_unique<LoggingBackend>(std::make_unique<MmapBackend>());
+            case BackendKind::MEMORY: return std::make_unique<MemoryBackend>();
+            default:                  return std::make_unique<LoggingBackend>(std::make_unique<FlatFileBackend>());
+        }
+    }
+
+    std::string idOf(const Sailingrec &rec)
+    {
+        return std::string(rec.id, strnlen(rec.id, sizeof(rec.id)));
+    }
+
+    //------------------------------------------------------------
+    // Delete every live sailing whose ID matches `match`
+    template <class Match>
+    int deleteMatching(StorageBackend &store, Match match, std::vector<SailingID> &removed)
+    {
+        std::vector<SailingID> doomed;
+        for (const Sailingrec &rec : store.sailings())
+        {
+            std::string id = idOf(rec);
+            if (match(id))
+                doomed.push_back(id);
+        }
+        return doomed.empty() ? 0 : store.deleteSailings(doomed, removed);
+    }
+}
+
+// ============================================================
+// Engine selection
+// ============================================================
+StorageBackend &StorageBackend::current()
+{
+    std::lock_guard<std::mutex> guard(backendLock);
+    if (!backend)
+    {
+        BackendKind kind = BackendKind::FLAT_FILE;
+        if (const char *env = std::getenv("FERRY_STORAGE"))
+            parseKind(env, kind);
+        backend = make(kind);
+    }
+    return *backend;
+}
+
+void StorageBackend::select(BackendKind kind)
+{
+    std::lock_guard<std::mutex> guard(backendLock);
+    if (backend)
+        backend->close();
+    backend = make(kind);
+}
+
+const char *StorageBackend::kindName(BackendKind kind)
+{
+    switch (kind)
+    {
+        case BackendKind::MMAP:   return "mmap";
+        case BackendKind::MEMORY: return "memory";
+        default:                  return "flat";
+    }
+}
+
+bool StorageBackend::parseKind(const std::string &text, BackendKind &kind)
+{
+    for (BackendKind k : { BackendKind::FLAT_FILE, BackendKind::MMAP, BackendKind::MEMORY })
+    {
+        if (text == kindName(k))
+        {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================
+// Default sailing queries (scan sailings())
+// ============================================================
+std::vector<Sailingrec> StorageBackend::sailingsToCity(const std::string &city, const std::string &day)
+{
+    FERRY_METRIC_SCOPE("StorageBackend::sailingsToCity");
+    std::string prefix = day.empty() ? city + ":" : city + ":" + day + ":";
+    std::vector<Sailingrec> result;
+    for (const Sailingrec &rec : sailings())
+    {
+        if (idOf(rec).compare(0, prefix.size(), prefix) == 0)
+            result.push_back(rec);
+    }
+    std::sort(result.begin(), result.end(), [](const Sailingrec &a, const Sailingrec &b) {
+        return std::strncmp(a.id, b.id, sizeof(a.id)) < 0;
+    });
+    return result;
+}
+
+std::vector<Sailingrec> StorageBackend::availableSailings(const std::string &city, int day, int hour,
+                                                          std::int32_t spaceCm, bool highCeiling,
+                                                          std::size_t max)
+{
+    FERRY_METRIC_SCOPE("StorageBackend::availableSailings");
+    std::vector<Sailingrec> result;
+    char from[8];
+    std::snprintf(from, sizeof(from), "%02d:%02d", day, hour);
+    for (const Sailingrec &rec : sailingsToCity(city, ""))     // ordered by day and hour
+    {
+        if (result.size() >= max)
+            break;
+        std::string id = idOf(rec);
+        std::int32_t hclCm = CapacityTable::toCentimetres(rec.remainingHCL);
+        std::int32_t lclCm = CapacityTable::toCentimetres(rec.remainingLCL);
+        if (id.compare(city.size() + 1, std::string::npos, from) >= 0 &&
+            (hclCm >= spaceCm || (!highCeiling && lclCm >= spaceCm)))
+            result.push_back(rec);
+    }
+    return result;
+}
+
+int StorageBackend::deleteSailingsOnDay(const std::string &day, std::vector<SailingID> &removed)
+{
+    return deleteMatching(*this,
+        [&day](const std::string &id) { return id.size() >= 6 && id.compare(4, 2, day) == 0; },
+        removed);
+}
+
+int StorageBackend::deleteSailingsToCity(const std::string &city, std::vector<SailingID> &removed)
+{
+    return deleteMatching(*this,
+        [&city](const std::string &id) { return id.size() >= 3 && id.compare(0, 3, city) == 0; },
+        removed);
+}
+
+// ============================================================
+// Default space write-back
+// ============================================================
+bool StorageBackend::adjustRemainingSpace(const SailingID &sailingID, float deltaHCL, float deltaLCL,
+                                          float &remainingHCL, float &remainingLCL)
+{
+    Sailingrec rec{};
+    if (!findSailing(sailingID, rec))
+        return false;
+    remainingHCL = std::round((rec.remainingHCL + deltaHCL) * 100.0f) / 100.0f;
+    remainingLCL = std::round((rec.remainingLCL + deltaLCL) * 100.0f) / 100.0f;
+    if (deltaHCL == 0.0f && deltaLCL == 0.0f)
+        return true;
+    return setRemainingSpace(sailingID, remainingHCL, remainingLCL);
+}
+
+// ============================================================
+// Default batch updates (one call each, undone on a failure)
+// ============================================================
+bool StorageBackend::findVehicles(const std::vector<LicensePlate> &licenses,
+                                  std::vector<VehicleRecord> &result, std::vector<char> &found)
+{
+    result.assign(licenses.size(), VehicleRecord{});
+    found.assign(licenses.size(), 0);
+    for (std::size_t i = 0; i < licenses.size(); ++i)
+        found[i] = findVehicle(licenses[i], result[i]) ? 1 : 0;
+    return true;
+}
+
+bool StorageBackend::writeVehicles(const std::vector<VehicleRecord> &vehicles)
+{
+    for (std::size_t i = 0; i < vehicles.size(); ++i)
+    {
+        if (writeVehicle(vehicles[i]))
+            continue;
+        while (i-- > 0)
+            deleteVehicle(vehicles[i].license);
+        return false;
+    }
+    return true;
+}
+
+bool StorageBackend::writeReservations(const std::vector<std::pair<LicensePlate, SailingID>> &bookings)
+{
+    for (std::size_t i = 0; i < bookings.size(); ++i)
+    {
+        if (writeReservation(bookings[i].first, bookings[i].second))
+            continue;
+        while (i-- > 0)
+            deleteReservation(bookings[i].first, bookings[i].second);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================
+// Shorthands
+// ============================================================
+bool StorageBackend::vehicleExists(const LicensePlate &license)
+{
+    VehicleRecord vehicle;
+    return findVehicle(license, vehicle);
+}
+
+bool StorageBackend::vesselExists(const std::string &vesselName)
+{
+    unsigned int hcl = 0, lcl = 0;
+    return findVessel(vesselName, hcl, lcl);
+}
+
+bool StorageBackend::sailingExists(const SailingID &sailingID)
+{
+    Sailingrec rec{};
+    return findSailing(sailingID, rec);
+}
+
+bool StorageBackend::deleteSailing(const SailingID &sailingID)
+{
+    std::vector<SailingID> removed;
+    return deleteSailings({ sailingID }, removed) > 0;
+}
+
+} // namespace FerrySys
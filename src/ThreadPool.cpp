@@ -0,0 +1,212 @@
+//************************************************************
+//************************************************************
+//  ThreadPool.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the work-stealing worker pool and TaskGroup.
+//************************************************************
+//************************************************************
+
+#include "ThreadPool.h"
+
+#include <chrono>
+
+namespace FerrySys
+{
+
+// Pool and deque owned by the current thread (null outside a pool)
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local std::size_t       currentWorker = 0;
+
+//------------------------------------------------------------
+// Start workerCount threads (hardware concurrency if 0)
+//------------------------------------------------------------
+ThreadPool::ThreadPool(std::size_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::thread::hardware_concurrency();
+        if (workerCount == 0)
+            workerCount = 1;
+    }
+
+    for (std::size_t i = 0; i < workerCount; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    shutdown();
+}
+
+//------------------------------------------------------------
+// Queue a job: own deque when called from a worker, otherwise
+// round-robin across workers
+//------------------------------------------------------------
+bool ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        if (stopping)
+            return false;
+    }
+
+    std::size_t target = (currentPool == this)
+                         ? currentWorker
+                         : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    // Count first so a concurrent pop can never drive it below zero.
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[target]->lock);
+        queues[target]->jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+    return true;
+}
+
+//------------------------------------------------------------
+// Take the oldest job from a worker's own deque
+//------------------------------------------------------------
+bool ThreadPool::popLocal(std::size_t self, std::function<void()> &job)
+{
+    WorkQueue &q = *queues[self];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.jobs.empty())
+        return false;
+    job = std::move(q.jobs.front());
+    q.jobs.pop_front();
+    queued.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+//------------------------------------------------------------
+// Take the newest job from some other worker's deque
+//------------------------------------------------------------
+bool ThreadPool::steal(std::size_t self, std::function<void()> &job)
+{
+    std::size_t n = queues.size();
+    for (std::size_t k = 1; k <= n; ++k)
+    {
+        WorkQueue &q = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.jobs.empty())
+            continue;
+        job = std::move(q.jobs.back());
+        q.jobs.pop_back();
+        queued.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------
+// Run one queued job on the caller (used while waiting)
+//------------------------------------------------------------
+bool ThreadPool::runPending()
+{
+    if (queued.load(std::memory_order_acquire) == 0 || queues.empty())
+        return false;
+
+    std::function<void()> job;
+    std::size_t self = (currentPool == this) ? currentWorker : 0;
+    if (!popLocal(self, job) && !steal(self, job))
+        return false;
+    job();
+    return true;
+}
+
+//------------------------------------------------------------
+// Finish queued jobs and join every worker
+//------------------------------------------------------------
+void ThreadPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        if (stopping && workers.empty())
+            return;
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &t : workers)
+    {
+        if (t.joinable())
+            t.join();
+    }
+    workers.clear();
+}
+
+//------------------------------------------------------------
+// Worker: own deque first, then steal, then sleep
+//------------------------------------------------------------
+void ThreadPool::workerLoop(std::size_t self)
+{
+    currentPool   = this;
+    currentWorker = self;
+
+    while (true)
+    {
+        std::function<void()> job;
+        if (popLocal(self, job) || steal(self, job))
+        {
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this] {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && queued.load(std::memory_order_acquire) == 0)
+            return; // stopping and drained
+    }
+}
+
+// ============================================================
+// TaskGroup
+// ============================================================
+void TaskGroup::run(std::function<void()> job)
+{
+    pending.fetch_add(1, std::memory_order_acq_rel);
+    auto wrapped = [this, job = std::move(job)] {
+        job();
+        done();
+    };
+    if (!pool.submit(wrapped))
+        wrapped();
+}
+
+void TaskGroup::done()
+{
+    // Decrement under the lock so wait() cannot return (and the
+    // group be destroyed) while this job still touches it.
+    std::lock_guard<std::mutex> guard(lock);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        finished.notify_all();
+}
+
+void TaskGroup::wait()
+{
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (pool.runPending())
+            continue;
+
+        std::unique_lock<std::mutex> guard(lock);
+        finished.wait_for(guard, std::chrono::milliseconds(1), [this] {
+            return pending.load(std::memory_order_acquire) == 0;
+        });
+    }
+    std::lock_guard<std::mutex> guard(lock);  // last done() has released
+}
+
+} // namespace FerrySys
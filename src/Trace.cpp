@@ -0,0 +1,158 @@
+//************************************************************
+//************************************************************
+//  Trace.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the per-thread span rings and the Chrome
+//    trace-event JSON writer.
+//
+//    A ring is created on a thread's first span and linked into
+//    a global list; it is never freed, so spans from exited
+//    threads still reach the file. The owning thread is the
+//    only writer: it fills the slot, then publishes it by
+//    advancing `head` with release ordering.
+//************************************************************
+//************************************************************
+
+#include "Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+std::atomic<bool> Trace::on{ false };
+
+namespace
+{
+    struct Event
+    {
+        const char   *name;
+        std::uint64_t startNs;
+        std::uint64_t durationNs;
+    };
+
+    struct Ring
+    {
+        Event                      events[Trace::RING_EVENTS];
+        std::atomic<std::uint64_t> head{ 0 };     // total events ever written
+        unsigned                   tid = 0;
+        Ring                      *next = nullptr;
+    };
+
+    std::mutex         listLock;
+    Ring              *rings = nullptr;
+    unsigned           nextTid = 1;
+    std::string        outputPath;
+
+    const std::chrono::steady_clock::time_point epoch =
+        std::chrono::steady_clock::now() - std::chrono::nanoseconds(1);
+
+    Ring &myRing()
+    {
+        thread_local Ring *ring = nullptr;
+        if (!ring)
+        {
+            ring = new Ring();
+            std::lock_guard<std::mutex> guard(listLock);
+            ring->tid = nextTid++;
+            ring->next = rings;
+            rings = ring;
+        }
+        return *ring;
+    }
+
+    // JSON string body for a span name (names are literals, but
+    // escape anyway so the file always parses)
+    void writeEscaped(std::FILE *f, const char *s)
+    {
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                std::fputc('\\', f);
+            std::fputc(*s, f);
+        }
+    }
+
+    // Pick up FERRY_TRACE before main() runs
+    struct EnvStart
+    {
+        EnvStart()
+        {
+            const char *path = std::getenv("FERRY_TRACE");
+            if (path && *path)
+                Trace::start(path);
+        }
+    } envStart;
+}
+
+void Trace::start(const std::string &path)
+{
+    {
+        std::lock_guard<std::mutex> guard(listLock);
+        outputPath = path;
+    }
+    on.store(true, std::memory_order_relaxed);
+}
+
+std::uint64_t Trace::nowNs()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+}
+
+void Trace::record(const char *name, std::uint64_t startNs, std::uint64_t durationNs)
+{
+    Ring &r = myRing();
+    std::uint64_t h = r.head.load(std::memory_order_relaxed);
+    r.events[h % RING_EVENTS] = { name, startNs, durationNs };
+    r.head.store(h + 1, std::memory_order_release);
+}
+
+bool Trace::flush()
+{
+    if (!enabled())
+        return false;
+
+    std::lock_guard<std::mutex> guard(listLock);
+    std::FILE *f = std::fopen(outputPath.c_str(), "w");
+    if (!f)
+        return false;
+
+    const long pid = static_cast<long>(::getpid());
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+    bool first = true;
+
+    for (Ring *r = rings; r; r = r->next)
+    {
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,"
+                        "\"args\":{\"name\":\"ferry-%u\"}}",
+                     first ? "" : ",\n", pid, r->tid, r->tid);
+        first = false;
+
+        std::uint64_t head = r->head.load(std::memory_order_acquire);
+        std::uint64_t begin = head > RING_EVENTS ? head - RING_EVENTS : 0;
+        for (std::uint64_t i = begin; i < head; ++i)
+        {
+            const Event &e = r->events[i % RING_EVENTS];
+            std::fputs(",\n{\"name\":\"", f);
+            writeEscaped(f, e.name);
+            // Trace-event timestamps are microseconds; keep ns precision
+            std::fprintf(f, "\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         pid, r->tid,
+                         static_cast<double>(e.startNs) / 1000.0,
+                         static_cast<double>(e.durationNs) / 1000.0);
+        }
+    }
+
+    std::fputs("\n]}\n", f);
+    return std::fclose(f) == 0;
+}
+
+} // namespace FerrySys
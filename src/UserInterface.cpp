@@ -14,17 +14,73 @@
 //************************************************************
 
 #include <iostream>
+#include <iomanip>
 #include <string>
+#include <vector>
 #include <limits>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
 #include "UserInterface.h"
 #include "Vessel.h"
 #include "Sailing.h"
 #include "Reservation.h"
-#include "FileIO_Sailings.h"
-#include "FileIO_Reservations.h"
-#include "FileIO_VehicleRecord.h"
+#include "StorageBackend.h"
+#include "Metrics.h"
+#include "Compaction.h"
+#include "Backup.h"
+#include "BulkExport.h"
+#include "BulkImport.h"
+#include "Replica.h"
+
+// ============================================================
+// Helper: The storage engine in use
+// ============================================================
+static FerrySys::StorageBackend &store()
+{
+    return FerrySys::StorageBackend::current();
+}
+
+// ============================================================
+// Helper: After "Sailing is fully booked", list the next sailings
+// to the same city that still have room for the vehicle
+// ============================================================
+static void suggestSailings(const FerrySys::VehicleRecord &vehicle, const std::string &sailingID)
+{
+    const std::size_t SUGGESTIONS = 5;
+    std::string city = sailingID.substr(0, sailingID.find(':'));
+    std::time_t now = std::time(nullptr);
+    std::tm local = *std::localtime(&now);
+
+    // One extra in case the full sailing itself shows up (its space
+    // may fit by the lane rule even though the check above refused it)
+    std::vector<Sailingrec> open =
+        Reservation::nextAvailable(vehicle, city, local.tm_mday, local.tm_hour, SUGGESTIONS + 1);
+    open.erase(std::remove_if(open.begin(), open.end(),
+                              [&](const Sailingrec &rec) {
+                                  return sailingID == std::string_view(rec.id, strnlen(rec.id, sizeof(rec.id)));
+                              }),
+               open.end());
+    if (open.size() > SUGGESTIONS)
+        open.resize(SUGGESTIONS);
+
+    if (open.empty())
+    {
+        std::cout << "No later sailing to " << city << " has room for this vehicle.\n";
+        return;
+    }
+    std::cout << "Next sailings to " << city << " with room for this vehicle:\n";
+    for (const Sailingrec &rec : open)
+    {
+        std::cout << "  " << std::left << std::setw(10) << std::string(rec.id, strnlen(rec.id, sizeof(rec.id))) << std::right
+                  << " " << std::setw(25) << std::left << rec.VesselName << std::right
+                  << " HCL " << std::fixed << std::setprecision(1) << rec.remainingHCL
+                  << " m, LCL " << rec.remainingLCL << " m left\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
 
 // ============================================================
 // Helper: Clear input buffer
@@ -216,7 +272,17 @@ unsigned int UserInterface::getDimension(const std::string &label)
 // ============================================================
 void UserInterface::initialize()
 {
+    Vessel::initialize();
+    Sailing::initialize();
+    Reservation::initialize();
     std::cout << "User Interface Initialized.\n";
+    if (FerrySys::Replica::isFollower())
+    {
+        FerrySys::ReplicaStatus status = FerrySys::Replica::status();
+        std::cout << "READ-ONLY REPLICA of " << status.primaryDir << ": changes will be refused; "
+                  << "data as of " << std::fixed << std::setprecision(1) << status.lagSeconds
+                  << " s ago.\n" << std::defaultfloat;
+    }
 }
 
 // ============================================================
@@ -247,9 +313,15 @@ void UserInterface::runMainMenu()
             case 2: sailingMenu(); break;
             case 3: reservationMenu(); break;
             case 4: printSailingReport(); break;
+            case 9: FerrySys::Metrics::dump(std::cout); break;   // hidden: metrics
             default:
                 std::cout << "Invalid selection. Try again.\n";
         }
+
+        // Between actions nothing else touches the files: compact here
+        FerrySys::Compactor::compactIfNeeded();
+        if (FerrySys::Replica::checkpointDue())
+            FerrySys::Replica::checkpoint();
     }
 }
 
@@ -336,8 +408,12 @@ void UserInterface::sailingMenu()
                   << "1) Create New Sailing\n"
                   << "2) Delete Existing Sailing\n"
                   << "3) Query Sailing Status\n"
+                  << "4) Delete All Sailings on a Date\n"
+                  << "5) Delete All Sailings on a Route\n"
+                  << "6) List Sailings to a City on a Date\n"
+                  << "7) Archive Departed Sailings\n"
                   << "0) Back to Main Menu\n"
-                  << "Select one of the numbers above (0-3): ";
+                  << "Select one of the numbers above (0-7): ";
 
         int choice;
         std::cin >> choice;
@@ -418,6 +494,68 @@ void UserInterface::sailingMenu()
                 if (!promptYesNo("Check the status of a different Sailing (Y/N)?")) break;
             }
         }
+        else if (choice == 4)
+        {
+            std::string date = getDate();
+            if (date.empty()) continue;
+
+            if (!promptYesNo("Delete every sailing on " + date + " and its reservations (Y/N)?")) continue;
+
+            int count = Sailing::DeleteSailingsOnDate(date);
+            std::cout << count << " sailing(s) deleted.\n";
+        }
+        else if (choice == 5)
+        {
+            std::string city = getCityCode();
+            if (city.empty()) continue;
+
+            if (!promptYesNo("Delete every sailing to " + city + " and its reservations (Y/N)?")) continue;
+
+            int count = Sailing::DeleteSailingsToCity(city);
+            std::cout << count << " sailing(s) deleted.\n";
+        }
+        else if (choice == 6)
+        {
+            std::string city = getCityCode();
+            if (city.empty()) continue;
+
+            std::string date = getDate();
+            if (date.empty()) continue;
+
+            std::vector<Sailingrec> sailings = store().sailingsToCity(city, date.substr(6, 2));
+            if (sailings.empty())
+            {
+                std::cout << "No sailings to " << city << " on " << date << ".\n";
+                continue;
+            }
+
+            std::cout << std::left << std::setw(15) << "Sailing ID"
+                      << std::setw(25) << "Vessel Name"
+                      << std::setw(20) << "Remaining HCL"
+                      << std::setw(20) << "Remaining LCL" << "\n";
+            for (const auto &rec : sailings)
+            {
+                std::cout << std::left << std::setw(15) << std::string(rec.id, strnlen(rec.id, sizeof(rec.id)))
+                          << std::setw(25) << std::string(rec.VesselName)
+                          << std::setw(20) << rec.remainingHCL
+                          << std::setw(20) << rec.remainingLCL << "\n";
+            }
+        }
+        else if (choice == 7)
+        {
+            // Sailings that left before the current hour of this month
+            std::time_t now = std::time(nullptr);
+            std::tm local = *std::localtime(&now);
+
+            if (!promptYesNo("Archive every sailing departed before day " + std::to_string(local.tm_mday) +
+                             ", " + std::to_string(local.tm_hour) + ":00 (Y/N)?")) continue;
+
+            int count = Sailing::ArchiveDeparted(local.tm_mday, local.tm_hour);
+            if (count < 0)
+                std::cout << "Archive could not be written; no sailings were moved.\n";
+            else
+                std::cout << count << " sailing(s) archived.\n";
+        }
         else
             std::cout << "Invalid selection.\n";
     }
@@ -448,7 +586,7 @@ void UserInterface::reservationMenu()
         // ============================================================
         else if (choice == 1)
         {
-            std::cout << "1) New Customer\n2) Returning Customer\n0) Cancel\nSelect: ";
+            std::cout << "1) New Customer\n2) Returning Customer\n3) Fleet Group\n4) Round Trip / Multi-leg\n0) Cancel\nSelect: ";
             int sub;
             std::cin >> sub;
             clearInput();
@@ -485,27 +623,30 @@ void UserInterface::reservationMenu()
                 std::vector<std::string> errors;
 
                 // License already exists?
-                if (FerrySys::FileIO_VehicleRecord::vehicleExists(vehicle.license))
+                if (store().vehicleExists(vehicle.license))
                     errors.push_back("License Plate already exists in the system.");
 
                 // Sailing exists?
-                if (!FileIO_Sailings::Sailingexist(sailingID))
+                bool full = false;
+                if (!store().sailingExists(sailingID))
                     errors.push_back("Sailing ID doesn’t exist.");
 
                 // Sailing fully booked?
                 else
                 {
-                    float hcl, lcl;
-                    if (FileIO_Sailings::getRemainingSpace(sailingID, hcl, lcl))
+                    Sailingrec rec{};
+                    if (store().findSailing(sailingID, rec))
                     {
-                        if ((vehicle.height_m > 1.8 && hcl < vehicle.length_m) ||
-                            (vehicle.height_m <= 1.8 && lcl < vehicle.length_m))
+                        float hcl = rec.remainingHCL, lcl = rec.remainingLCL;
+                        full = (vehicle.height_m > 1.8 && hcl < vehicle.length_m) ||
+                               (vehicle.height_m <= 1.8 && lcl < vehicle.length_m);
+                        if (full)
                             errors.push_back("Sailing is fully booked.");
                     }
                 }
 
                 // Duplicate reservation check
-                if (FileIO_Reservations::reservationExists(vehicle.license, sailingID))
+                if (store().reservationExists(vehicle.license, sailingID))
                     errors.push_back("Vehicle is already reserved on this sailing.");
 
                 // 3. Show errors and prompt
@@ -514,6 +655,8 @@ void UserInterface::reservationMenu()
                     std::cout << "\nError(s) found:\n";
                     for (const auto &e : errors)
                         std::cout << "- " << e << "\n";
+                    if (full)
+                        suggestSailings(vehicle, sailingID);
 
                     if (promptYesNo("Do you wish to re-enter the details (Y/N)?"))
                         continue; // Restart
@@ -549,32 +692,35 @@ void UserInterface::reservationMenu()
                 std::vector<std::string> errors;
 
                 // License exists?
-                if (!FerrySys::FileIO_VehicleRecord::vehicleExists(license))
+                if (!store().vehicleExists(license))
                     errors.push_back("License plate doesn’t exist. You may need to register as a new customer.");
 
                 // Sailing exists?
-                if (!FileIO_Sailings::Sailingexist(sailingID))
+                bool full = false;
+                FerrySys::VehicleRecord existingVehicle;
+                if (!store().sailingExists(sailingID))
                     errors.push_back("Sailing ID doesn’t exist.");
 
                 // Sailing fully booked?
                 else
                 {
-                    float hcl, lcl;
-                    if (FileIO_Sailings::getRemainingSpace(sailingID, hcl, lcl))
+                    Sailingrec rec{};
+                    if (store().findSailing(sailingID, rec))
                     {
+                        float hcl = rec.remainingHCL, lcl = rec.remainingLCL;
                         // We need vehicle info to check fully booked properly
-                        FerrySys::VehicleRecord existingVehicle;
-                        if (FerrySys::FileIO_VehicleRecord::findVehicle(license, existingVehicle))
+                        if (store().findVehicle(license, existingVehicle))
                         {
-                            if ((existingVehicle.height_m > 1.8 && hcl < existingVehicle.length_m) ||
-                                (existingVehicle.height_m <= 1.8 && lcl < existingVehicle.length_m))
+                            full = (existingVehicle.height_m > 1.8 && hcl < existingVehicle.length_m) ||
+                                   (existingVehicle.height_m <= 1.8 && lcl < existingVehicle.length_m);
+                            if (full)
                                 errors.push_back("Sailing is fully booked.");
                         }
                     }
                 }
 
                 // Duplicate reservation check
-                if (FileIO_Reservations::reservationExists(license, sailingID))
+                if (store().reservationExists(license, sailingID))
                     errors.push_back("Vehicle is already reserved on this sailing.");
 
                 // 3. Show errors and prompt
@@ -583,6 +729,8 @@ void UserInterface::reservationMenu()
                     std::cout << "\nError(s) found:\n";
                     for (const auto &e : errors)
                         std::cout << "- " << e << "\n";
+                    if (full)
+                        suggestSailings(existingVehicle, sailingID);
 
                     if (promptYesNo("Do you wish to re-enter the details (Y/N)?"))
                         continue; // Restart
@@ -598,6 +746,107 @@ void UserInterface::reservationMenu()
                 else
                     std::cout << "Failed to make reservation.\n";
             }
+
+            // ============================================================
+            // FLEET GROUP (all vehicles on one sailing, or none)
+            // ============================================================
+            else if (sub == 3)
+            {
+                std::string sailingID = getSailingID();
+                if (sailingID.empty()) continue;
+                if (!store().sailingExists(sailingID))
+                {
+                    std::cout << "Sailing ID doesn’t exist.\n";
+                    continue;
+                }
+
+                // 1. Collect the group; unknown plates are registered
+                std::vector<FerrySys::VehicleRecord> group;
+                std::cout << "Enter each vehicle in the group (0 when done).\n";
+                while (true)
+                {
+                    std::string license = getLicensePlate();
+                    if (license.empty()) break;
+
+                    FerrySys::VehicleRecord vehicle;
+                    if (!store().findVehicle(license, vehicle))
+                    {
+                        std::cout << "New vehicle " << license << ".\n";
+                        vehicle.license = license;
+                        vehicle.phone = getPhoneNumber();
+                        if (vehicle.phone.empty()) continue;
+                        vehicle.height_m = getDimension("Vehicle Height");
+                        if (vehicle.height_m == 0) continue;
+                        vehicle.length_m = getDimension("Vehicle Length");
+                        if (vehicle.length_m == 0) continue;
+                    }
+                    group.push_back(vehicle);
+                    std::cout << group.size() << " vehicle(s) in the group.\n";
+                }
+                if (group.empty()) continue;
+
+                // 2. Confirm and reserve
+                if (!promptYesNo("Reserve all " + std::to_string(group.size()) + " vehicles (Y/N)?")) continue;
+
+                FerrySys::BookingError error = FerrySys::BookingError::NONE;
+                if (Reservation::groupReservation(group, sailingID, error))
+                    std::cout << "Reservations successfully made for " << group.size() << " vehicles.\n";
+                else
+                    std::cout << "Failed to make reservations: " << FerrySys::BookingTransaction::describe(error)
+                              << ". No vehicle was booked.\n";
+            }
+
+            // ============================================================
+            // ROUND TRIP / MULTI-LEG (one vehicle on every sailing, or none)
+            // ============================================================
+            else if (sub == 4)
+            {
+                // 1. The vehicle; an unknown plate is registered with the booking
+                std::string license = getLicensePlate();
+                if (license.empty()) continue;
+
+                FerrySys::VehicleRecord vehicle;
+                if (!store().findVehicle(license, vehicle))
+                {
+                    std::cout << "New vehicle " << license << ".\n";
+                    vehicle.license = license;
+                    vehicle.phone = getPhoneNumber();
+                    if (vehicle.phone.empty()) continue;
+                    vehicle.height_m = getDimension("Vehicle Height");
+                    if (vehicle.height_m == 0) continue;
+                    vehicle.length_m = getDimension("Vehicle Length");
+                    if (vehicle.length_m == 0) continue;
+                }
+
+                // 2. The legs, in travel order
+                std::vector<SailingID> legs;
+                std::cout << "Enter each sailing of the journey (0 when done).\n";
+                while (true)
+                {
+                    std::string sailingID = getSailingID();
+                    if (sailingID.empty()) break;
+                    legs.push_back(sailingID);
+                    std::cout << legs.size() << " sailing(s) in the journey.\n";
+                }
+                if (legs.empty()) continue;
+
+                // 3. Confirm and reserve
+                if (!promptYesNo("Reserve all " + std::to_string(legs.size()) + " sailings (Y/N)?")) continue;
+
+                FerrySys::BookingError error = FerrySys::BookingError::NONE;
+                SailingID failedLeg;
+                if (Reservation::multiLegReservation(vehicle, legs, error, failedLeg))
+                    std::cout << "Reservations successfully made on " << legs.size() << " sailings.\n";
+                else
+                {
+                    std::cout << "Failed to make reservations: " << FerrySys::BookingTransaction::describe(error);
+                    if (!failedLeg.empty())
+                        std::cout << " (" << failedLeg << ")";
+                    std::cout << ". No sailing was booked.\n";
+                    if (error == FerrySys::BookingError::SAILING_FULL)
+                        suggestSailings(vehicle, failedLeg);
+                }
+            }
         }
 
         // ============================================================
@@ -626,7 +875,7 @@ void UserInterface::reservationMenu()
                 std::string sailingID = getSailingID();
                 if (sailingID.empty()) break;
                 
-                if (!FileIO_Sailings::Sailingexist(sailingID))
+                if (!store().sailingExists(sailingID))
                 {
                 std::cout << "Sailing ID doesn’t exist. Do you wish to go back to the form (Y/N)? ";
                  if (promptYesNo(""))
@@ -656,7 +905,7 @@ void UserInterface::reservationMenu()
 
 void UserInterface::printSailingReport()
 {
-    std::vector<Sailingrec> sailings = FileIO_Sailings::Sailingreport();
+    std::vector<Sailingrec> sailings = store().sailings();
 
     if (sailings.empty()) {
         std::cout << "No sailings available.\n";
@@ -681,7 +930,7 @@ void UserInterface::printSailingReport()
         for (size_t i = start; i < end; ++i)
         {
             const auto &rec = sailings[i];
-            std::cout << std::left << std::setw(15) << std::string(rec.id)
+            std::cout << std::left << std::setw(15) << std::string(rec.id, strnlen(rec.id, sizeof(rec.id)))
                       << std::setw(25) << std::string(rec.VesselName)
                       << std::setw(20) << rec.remainingHCL
                       << std::setw(20) << rec.remainingLCL << "\n";
@@ -710,5 +959,158 @@ void UserInterface::printSailingReport()
 // ============================================================
 void UserInterface::shutdown()
 {
+    Reservation::shutdown();
+    Sailing::shutdown();
+    Vessel::shutdown();
+
+    if (!FerrySys::Metrics::dumpToFile(FerrySys::Metrics::DUMP_FILE))
+        std::cout << "Warning: could not write " << FerrySys::Metrics::DUMP_FILE << ".\n";
+    FerrySys::Trace::flush();
     std::cout << "User Interface Shutdown.\n";
 }
+
+// ============================================================
+// Command-line import
+// ============================================================
+int UserInterface::runImport(const std::string &kind,
+                             const std::string &csvPath,
+                             const std::string &rejectPath)
+{
+    FerrySys::ImportKind importKind;
+    if (!FerrySys::BulkImport::parseKind(kind, importKind))
+    {
+        std::cerr << "Error: unknown import kind '" << kind
+                  << "' (vessels, sailings, vehicles or reservations).\n";
+        return 1;
+    }
+    if (FerrySys::StorageBackend::current().kind() == FerrySys::BackendKind::MEMORY)
+    {
+        std::cerr << "Error: import writes the data files; FERRY_STORAGE=memory has none.\n";
+        return 1;
+    }
+
+    Vessel::initialize();
+    Sailing::initialize();
+    Reservation::initialize();
+
+    FerrySys::ImportResult result = FerrySys::BulkImport::run(importKind, csvPath, rejectPath);
+    std::cout << "Imported " << result.imported << " of " << result.rows << " "
+              << FerrySys::BulkImport::kindName(importKind) << " rows";
+    if (result.rejected > 0)
+        std::cout << " (" << result.rejected << " rejected, see " << rejectPath << ")";
+    std::cout << ".\n";
+
+    Reservation::shutdown();
+    Sailing::shutdown();
+    Vessel::shutdown();
+    FerrySys::Trace::flush();
+
+    if (!result.ok)
+    {
+        std::cerr << "Error: import of " << csvPath << " did not complete.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================
+// Command-line export
+// ============================================================
+int UserInterface::runExport(const std::string &kind,
+                             const std::string &format,
+                             const std::string &outPath)
+{
+    FerrySys::ExportKind exportKind;
+    FerrySys::ExportFormat exportFormat;
+    if (!FerrySys::BulkExport::parseKind(kind, exportKind))
+    {
+        std::cerr << "Error: unknown export kind '" << kind
+                  << "' (vessels, sailings, vehicles, reservations or bookings).\n";
+        return 1;
+    }
+    if (!FerrySys::BulkExport::parseFormat(format, exportFormat))
+    {
+        std::cerr << "Error: unknown export format '" << format << "' (csv or json).\n";
+        return 1;
+    }
+    if (FerrySys::StorageBackend::current().kind() == FerrySys::BackendKind::MEMORY)
+    {
+        std::cerr << "Error: export reads the data files; FERRY_STORAGE=memory has none.\n";
+        return 1;
+    }
+
+    Vessel::initialize();
+    Sailing::initialize();
+    Reservation::initialize();
+
+    FerrySys::ExportResult result = FerrySys::BulkExport::run(exportKind, exportFormat, outPath);
+
+    Reservation::shutdown();
+    Sailing::shutdown();
+    Vessel::shutdown();
+    FerrySys::Trace::flush();
+
+    if (!result.ok)
+    {
+        std::cerr << "Error: export to " << outPath << " did not complete.\n";
+        return 1;
+    }
+    // Keep standard output for the data when it goes there
+    std::ostream &note = (outPath == "-") ? std::cerr : std::cout;
+    note << "Exported " << result.rows << " " << FerrySys::BulkExport::kindName(exportKind)
+         << " rows (" << result.bytes << " bytes).\n";
+    return 0;
+}
+
+// ============================================================
+// Command-line backup
+// ============================================================
+int UserInterface::runBackup(const std::string &destDir)
+{
+    FerrySys::BackupResult result = FerrySys::Backup::create(destDir);
+    if (!result.ok)
+    {
+        std::cerr << "Error: backup to " << destDir << " did not complete.\n";
+        return 1;
+    }
+    std::cout << "Backed up " << result.files << " files (" << result.bytes << " bytes, "
+              << result.cloned << " cloned) to " << destDir << "; writes paused "
+              << result.pausedMs << " ms.\n";
+    return 0;
+}
+
+// ============================================================
+// Command-line replica
+// ============================================================
+int UserInterface::runReplica(const std::string &followerDir)
+{
+    if (FerrySys::StorageBackend::current().kind() == FerrySys::BackendKind::MEMORY)
+    {
+        std::cerr << "Error: replicas copy the data files; FERRY_STORAGE=memory has none.\n";
+        return 1;
+    }
+
+    // An existing follower: report how far behind it is
+    std::error_code ec;
+    if (std::filesystem::exists(std::filesystem::path(followerDir) / FerrySys::Replica::POSITION_FILE, ec))
+    {
+        std::filesystem::current_path(followerDir, ec);
+        FerrySys::ReplicaStatus status = FerrySys::Replica::status();
+        if (ec || !status.follower)
+        {
+            std::cerr << "Error: cannot read the replica position in " << followerDir << ".\n";
+            return 1;
+        }
+        std::cout << "Replica of " << status.primaryDir << ": applied " << status.appliedLsn << " of "
+                  << status.primaryLsn << " log records (" << status.lagSeconds << " s behind).\n";
+        return 0;
+    }
+
+    if (!FerrySys::Replica::seed(followerDir))
+    {
+        std::cerr << "Error: replica in " << followerDir << " was not seeded.\n";
+        return 1;
+    }
+    std::cout << "Seeded replica in " << followerDir << "; run ferryd there to keep it current.\n";
+    return 0;
+}
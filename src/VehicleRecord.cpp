@@ -35,10 +35,10 @@ namespace FerrySys
     void decodeVehicle(const VehicleRaw &in, VehicleRecord &out)
     {
         // License
-        out.license = decodeField(in.data(), VEH_LIC_CHARS);
+        out.license = fieldView(in.data(), VEH_LIC_CHARS);
 
         // Phone
-        out.phone   = decodeField(in.data() + VEH_LIC_CHARS, VEH_PHONE_CHARS);
+        out.phone   = fieldView(in.data() + VEH_LIC_CHARS, VEH_PHONE_CHARS);
 
         // Length & height
         std::int32_t len = 0, ht = 0;
@@ -12,9 +12,9 @@
 //************************************************************
 
 #include "Vessel.h"
-#include "FileIO_Vessel.h"
+#include "Metrics.h"
+#include "StorageBackend.h"
 #include <vector>
-#include <fstream>
 
 // ---------------------------------------------------------------------------
 // Static member definitions
@@ -29,13 +29,14 @@ VesselStatus Vessel::CreateVessel(const std::string &vesselName,
                                   unsigned int laneHCL,
                                   unsigned int laneLCL)
 {
+    FERRY_METRIC_SCOPE("Vessel::CreateVessel");
     // Check if vessel already exists
     if (isVesselExist(vesselName)) {
         return VesselStatus::ALREADY_EXISTS;
     }
 
-    // Write vessel to persistent file
-    FileIO_Vessel::writeVessel(vesselName, laneHCL, laneLCL);
+    // Write vessel to persistent storage
+    FerrySys::StorageBackend::current().writeVessel(vesselName, laneHCL, laneLCL);
     return VesselStatus::SUCCESS;
 }
 
@@ -44,11 +45,12 @@ VesselStatus Vessel::CreateVessel(const std::string &vesselName,
 // ---------------------------------------------------------------------------
 VesselStatus Vessel::DeleteVessel(const std::string &vesselNametoDelete)
 {
+    FERRY_METRIC_SCOPE("Vessel::DeleteVessel");
     // Ensure vessel exists before attempting deletion
     if (!isVesselExist(vesselNametoDelete))
         return VesselStatus::NOT_FOUND;
 
-    if (FileIO_Vessel::deleteVessel(vesselNametoDelete))
+    if (FerrySys::StorageBackend::current().deleteVessel(vesselNametoDelete))
         return VesselStatus::SUCCESS;
 
     // Could be enhanced: differentiate between not found vs I/O error
@@ -60,24 +62,15 @@ VesselStatus Vessel::DeleteVessel(const std::string &vesselNametoDelete)
 // ---------------------------------------------------------------------------
 bool Vessel::isVesselExist(const std::string &vesselName)
 {
-    std::fstream file("vessels.dat", std::ios::binary | std::ios::in);
-    if (!file) return false;
-
-    Vesselrec rec;
-    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
-        std::string nameFromFile(rec.vesselName);
-        nameFromFile = nameFromFile.substr(0, nameFromFile.find('\0'));
-
-        if (nameFromFile == vesselName) {
-            return true;
-        }
-    }
-
-    return false;
+    FERRY_METRIC_SCOPE("Vessel::isVesselExist");
+    return FerrySys::StorageBackend::current().vesselExists(vesselName);
 }
 
 // ---------------------------------------------------------------------------
 // Lifecycle (Initialize / Shutdown)
 // ---------------------------------------------------------------------------
 void Vessel::initialize() {}
-void Vessel::shutdown() {}
+void Vessel::shutdown()
+{
+    FerrySys::StorageBackend::current().compact(FerrySys::Table::VESSELS);
+}
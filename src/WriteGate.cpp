@@ -0,0 +1,149 @@
+//************************************************************
+//************************************************************
+//  WriteGate.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Implements the write gate: a per-thread nesting depth, and
+//    per process a count of active Holds whose 0 -> 1 and
+//    1 -> 0 steps take and drop the shared lock on writes.lock.
+//************************************************************
+//************************************************************
+
+#include "WriteGate.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace FerrySys
+{
+
+namespace
+{
+    struct Gate
+    {
+        std::mutex  lock;               // holders, fds
+        int         turnstileFd = -1;
+        int         gateFd = -1;
+        bool        opened = false;
+        std::size_t holders = 0;        // Holds active in this process
+    };
+
+    // Never destroyed: stores flushed by static destructors still
+    // take a Hold
+    Gate &gate()
+    {
+        static Gate *g = new Gate;
+        return *g;
+    }
+
+    thread_local int depth = 0;         // Holds on this thread
+
+    int openLockFile(const char *path)
+    {
+        return ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    }
+
+    bool lockFile(int fd, int op)
+    {
+        int rc;
+        do
+            rc = ::flock(fd, op);
+        while (rc != 0 && errno == EINTR);
+        return rc == 0;
+    }
+
+    void closeFd(int &fd)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+// ============================================================
+// Hold
+// ============================================================
+WriteGate::Hold::Hold()
+{
+    if (depth++ > 0)
+        return;
+
+    Gate &g = gate();
+    int turnstile;
+    {
+        std::lock_guard<std::mutex> guard(g.lock);
+        if (!g.opened)
+        {
+            g.turnstileFd = openLockFile(TURNSTILE_FILE);
+            g.gateFd = openLockFile(GATE_FILE);
+            g.opened = true;
+        }
+        turnstile = g.turnstileFd;
+    }
+
+    // Wait here while a backup is pending or running
+    if (turnstile >= 0 && lockFile(turnstile, LOCK_SH))
+        lockFile(turnstile, LOCK_UN);
+
+    std::lock_guard<std::mutex> guard(g.lock);
+    if (g.holders == 0 && g.gateFd >= 0)
+        lockFile(g.gateFd, LOCK_SH);
+    ++g.holders;
+}
+
+WriteGate::Hold::~Hold()
+{
+    if (--depth > 0)
+        return;
+
+    Gate &g = gate();
+    std::lock_guard<std::mutex> guard(g.lock);
+    if (--g.holders == 0 && g.gateFd >= 0)
+        lockFile(g.gateFd, LOCK_UN);
+}
+
+// ============================================================
+// Pause
+// ============================================================
+WriteGate::Pause::Pause()
+{
+    if (depth > 0)
+        return;                         // would wait for itself
+    turnstileFd = openLockFile(TURNSTILE_FILE);
+    gateFd = openLockFile(GATE_FILE);
+    if (turnstileFd < 0 || gateFd < 0 || !lockFile(turnstileFd, LOCK_EX))
+        return;
+    locked = lockFile(gateFd, LOCK_EX);
+    if (!locked)
+        lockFile(turnstileFd, LOCK_UN);
+}
+
+WriteGate::Pause::~Pause()
+{
+    if (locked)
+    {
+        lockFile(gateFd, LOCK_UN);
+        lockFile(turnstileFd, LOCK_UN);
+    }
+    closeFd(gateFd);
+    closeFd(turnstileFd);
+}
+
+// ============================================================
+// Reset
+// ============================================================
+void WriteGate::reset()
+{
+    Gate &g = gate();
+    std::lock_guard<std::mutex> guard(g.lock);
+    closeFd(g.turnstileFd);
+    closeFd(g.gateFd);
+    g.opened = false;
+}
+
+} // namespace FerrySys
@@ -0,0 +1,68 @@
+//************************************************************
+//************************************************************
+//  ferryd.cpp
+//  CMPT 276 – Assignment 4
+//
+//  PURPOSE:
+//    Entry point for the reservation daemon. Keeps the data
+//    files and business modules warm in one process and serves
+//    check-in terminals over a Unix domain socket.
+//
+//    Usage: ferryd [socketPath] [workerThreads] [flat|mmap|memory]
+//
+//    Started in a replica directory (see Replica.h) it serves
+//    reads only and follows the primary's log.
+//************************************************************
+//************************************************************
+
+#include "FerryServer.h"
+#include "Replica.h"
+#include "StorageBackend.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+static FerrySys::FerryServer *activeServer = nullptr;
+
+static void onSignal(int)
+{
+    if (activeServer)
+        activeServer->requestStop();
+}
+
+int main(int argc, char *argv[])
+{
+    std::string socketPath = (argc > 1) ? argv[1] : FerrySys::Proto::DEFAULT_SOCKET;
+    std::size_t workers    = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 0;
+
+    if (argc > 3)
+    {
+        FerrySys::BackendKind kind;
+        if (!FerrySys::StorageBackend::parseKind(argv[3], kind))
+        {
+            std::cerr << "ferryd: unknown storage engine '" << argv[3] << "' (flat, mmap or memory).\n";
+            return 1;
+        }
+        FerrySys::StorageBackend::select(kind);
+    }
+
+    FerrySys::FerryServer server(socketPath, workers);
+    activeServer = &server;
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "ferryd listening on " << socketPath << " ("
+              << FerrySys::StorageBackend::kindName(FerrySys::StorageBackend::current().kind())
+              << " storage" << (FerrySys::Replica::isFollower() ? ", read-only replica" : "") << ")\n";
+    if (!server.run())
+    {
+        std::cerr << "ferryd: failed to start.\n";
+        return 1;
+    }
+
+    std::cout << "ferryd stopped.\n";
+    return 0;
+}
@@ -114,7 +114,48 @@ Constants: UPPER_CASE_WITH_UNDERSCORES.
  
 #include "UserInterface.h"
 
-int main() {
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    // ferry import <vessels|sailings|vehicles|reservations> <file.csv> [rejects.csv]
+    if (argc > 1 && std::strcmp(argv[1], "import") == 0) {
+        if (argc < 4) {
+            std::cerr << "Usage: ferry import <vessels|sailings|vehicles|reservations> <file.csv> [rejects.csv]\n";
+            return 1;
+        }
+        std::string rejects = (argc > 4) ? argv[4] : std::string(argv[3]) + ".rejects";
+        return UserInterface::runImport(argv[2], argv[3], rejects);
+    }
+
+    // ferry export <vessels|sailings|vehicles|reservations|bookings> [csv|json] [file]
+    if (argc > 1 && std::strcmp(argv[1], "export") == 0) {
+        if (argc < 3) {
+            std::cerr << "Usage: ferry export <vessels|sailings|vehicles|reservations|bookings> [csv|json] [file]\n";
+            return 1;
+        }
+        return UserInterface::runExport(argv[2], (argc > 3) ? argv[3] : "csv", (argc > 4) ? argv[4] : "-");
+    }
+
+    // ferry backup <dir>
+    if (argc > 1 && std::strcmp(argv[1], "backup") == 0) {
+        if (argc < 3) {
+            std::cerr << "Usage: ferry backup <dir>\n";
+            return 1;
+        }
+        return UserInterface::runBackup(argv[2]);
+    }
+
+    // ferry replica <dir>
+    if (argc > 1 && std::strcmp(argv[1], "replica") == 0) {
+        if (argc < 3) {
+            std::cerr << "Usage: ferry replica <dir>\n";
+            return 1;
+        }
+        return UserInterface::runReplica(argv[2]);
+    }
+
     UserInterface::initialize();
     UserInterface::runMainMenu();
     UserInterface::shutdown();
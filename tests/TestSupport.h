@@ -0,0 +1,77 @@
+// ---------------------------------------------------------------------------
+// TestSupport.h
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Helpers shared by the standalone tests:
+//     expect()        reports a failed check on stderr
+//     enterTestDir()  starts the test in a fresh, empty directory
+//     finish()        prints "<name> test PASS" or "... FAIL" and gives
+//                     the exit code (0 = PASS, 1 = FAIL)
+//     vehicle()       a vehicle of the given size, for booking tests
+//     spaceIs()       a sailing's remaining lane space, as the backend
+//                     reports it
+// ---------------------------------------------------------------------------
+
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include "StorageBackend.h"
+#include "VehicleRecord.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------
+// `cond`, printing "FAIL: <what>" when it is false.
+inline bool expect(bool cond, const std::string &what)
+{
+    if (!cond)
+        std::cerr << "FAIL: " << what << "\n";
+    return cond;
+}
+
+//------------------------------------------------------------
+// Remove `dir`, create it again empty and make it the current
+// directory (e.g. "../data/<name>_test", relative to build/).
+// Postconditions: false, with a message, if it cannot.
+inline bool enterTestDir(const std::string &dir)
+{
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    std::filesystem::current_path(dir, ec);
+    if (ec)
+        std::cerr << "ERROR: cannot enter test directory\n";
+    return !ec;
+}
+
+//------------------------------------------------------------
+// Print the result line for test `name`; the exit code.
+inline int finish(const std::string &name, bool pass)
+{
+    std::cout << name << " test " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
+
+//------------------------------------------------------------
+// Vehicle `license`, `length` x `height` metres, with a fixed
+// phone number.
+inline FerrySys::VehicleRecord vehicle(const std::string &license, int length, int height)
+{
+    return FerrySys::VehicleRecord{ license, "6045550000", length, height };
+}
+
+//------------------------------------------------------------
+// Whether `sailingID` has `hcl` / `lcl` metres left in `store`
+// (to the centimetre).
+inline bool spaceIs(FerrySys::StorageBackend &store, const char *sailingID, float hcl, float lcl)
+{
+    Sailingrec rec{};
+    return store.findSailing(sailingID, rec) &&
+           std::fabs(rec.remainingHCL - hcl) < 0.01f && std::fabs(rec.remainingLCL - lcl) < 0.01f;
+}
+
+#endif // TESTSUPPORT_H
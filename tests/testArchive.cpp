@@ -0,0 +1,80 @@
+// ---------------------------------------------------------------------------
+// testArchive.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks archival of departed sailings:
+//     1. Sailings before the cutoff leave sailings.dat, with their
+//        reservations; later ones stay.
+//     2. Archived sailings and bookings are still found on request.
+//     3. The segment is compressed, and an archived ID can be
+//        scheduled again next month.
+//
+//   Runs inside ../data/archive_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "Archive.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "Sailing.h"
+#include "TestSupport.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+int main()
+{
+    if (!enterTestDir("../data/archive_test"))
+        return 1;
+
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    const char *sailings[] = { "YVR:01:08", "NAN:02:10", "YVR:03:08", "YVR:03:09", "VIC:20:14" };
+    for (const char *id : sailings)
+    {
+        FileIO_Sailings::writeSailing(id, "Queen", 100.0f, 200.0f);
+        for (int i = 0; i < 30; ++i)
+            FileIO_Reservations::writeReservation("CAR" + std::to_string(i), id);
+    }
+
+    // 1. Cutoff day 3, 09:00 takes the first three
+    int archived = Sailing::ArchiveDeparted(3, 9);
+    bool pass = expect(archived == 3, "three sailings archived");
+    pass &= expect(!FileIO_Sailings::Sailingexist("YVR:01:08") && !FileIO_Sailings::Sailingexist("YVR:03:08"),
+                   "departed sailings left the working file");
+    pass &= expect(FileIO_Sailings::Sailingexist("YVR:03:09") && FileIO_Sailings::Sailingexist("VIC:20:14"),
+                   "upcoming sailings kept");
+    pass &= expect(FileIO_Sailings::Sailingreport().size() == 2, "sailings.dat holds two rows");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:02:10") == 0, "reservations moved out");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:20:14") == 30, "other reservations kept");
+    pass &= expect(fs::file_size("reservations.dat") == FILE_HEADER_BYTES + 2 * 30 * sizeof(ReservationRec),
+                   "reservations compacted");
+    pass &= expect(Sailing::ArchiveDeparted(3, 9) == 0, "second run archives nothing");
+
+    // 2. Read back on request
+    Sailingrec rec{};
+    pass &= expect(!FileIO_Sailings::findSailing("NAN:02:10", rec), "hot lookup misses");
+    pass &= expect(FileIO_Sailings::findSailing("NAN:02:10", rec, true) && std::string(rec.VesselName) == "Queen",
+                   "archive lookup finds sailing");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("nan:02:10", true) == 30, "archived count");
+    pass &= expect(Archive::findSailing("nan:02:10", rec) && Archive::countReservations("Nan:02:10") == 30,
+                   "archive lookups agree on case");
+    std::vector<ReservationRec> rows;
+    pass &= expect(Archive::readReservations("YVR:01:08", rows) && rows.size() == 30, "archived rows");
+    pass &= expect(Sailing::printStatus("YVR:03:08"), "status of archived sailing");
+    pass &= expect(Archive::sailings().size() == 3, "archive lists three sailings");
+
+    // 3. Compressed, and IDs can recur
+    std::uintmax_t raw = 3 * sizeof(Sailingrec) + 90 * sizeof(ReservationRec);
+    pass &= expect(fs::file_size("archive/seg-000001.arc") < raw, "segment smaller than raw rows");
+    FileIO_Sailings::writeSailing("YVR:01:08", "King", 50.0f, 50.0f);
+    pass &= expect(FileIO_Sailings::findSailing("YVR:01:08", rec, true) && std::string(rec.VesselName) == "King",
+                   "hot sailing wins over archived one");
+
+    return finish("Archive", pass);
+}
@@ -0,0 +1,140 @@
+// ---------------------------------------------------------------------------
+// testBackends.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Runs one scenario against every storage engine (flat, mmap, memory):
+//     1. Vessels, sailings and vehicles round-trip; duplicates and
+//        case rules match the flat files.
+//     2. Bookings made through Vessel / Sailing / Reservation land in
+//        the engine, with capacity persisted.
+//     3. Cascading sailing deletes (one, by route) and vehicle / vessel
+//        deletes.
+//   Then checks that flat and mmap read each other's files and that the
+//   memory engine creates none.
+//
+//   Runs inside ../data/backends_test/<engine> (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "CapacityTable.h"
+#include "Reservation.h"
+#include "Sailing.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+#include "Vessel.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static const char *kTestDir = "../data/backends_test";
+
+// ---------------------------------------------------------------------------
+// The shared scenario; `name` prefixes failure messages
+// ---------------------------------------------------------------------------
+static bool scenario(BackendKind kind)
+{
+    std::string name = StorageBackend::kindName(kind);
+    StorageBackend::select(kind);
+    StorageBackend &store = StorageBackend::current();
+    CapacityTable::clear();
+    bool pass = expect(store.kind() == kind, name + ": engine selected");
+
+    // 1. Records round-trip
+    pass &= expect(Vessel::CreateVessel("Queen", 100, 200) == VesselStatus::SUCCESS, name + ": vessel created");
+    pass &= expect(Vessel::CreateVessel("Queen", 1, 1) == VesselStatus::ALREADY_EXISTS, name + ": duplicate vessel");
+    unsigned int hcl = 0, lcl = 0;
+    pass &= expect(store.findVessel("Queen", hcl, lcl) && hcl == 100 && lcl == 200, name + ": vessel lanes");
+    pass &= expect(!store.vesselExists("queen"), name + ": vessel names are exact");
+
+    for (const char *time : { "08:00", "09:00", "10:00" })
+        pass &= expect(Sailing::CreateSailing("YVR", "Queen", "25-07-01", time) == SailingStatus::SUCCESS,
+                       name + ": sailing created");
+    pass &= expect(Sailing::CreateSailing("NAN", "Queen", "25-07-02", "10:00") == SailingStatus::SUCCESS,
+                   name + ": second route");
+    pass &= expect(Sailing::CreateSailing("YVR", "Queen", "25-07-01", "08:00") == SailingStatus::SAILING_ALREADY_EXISTS,
+                   name + ": duplicate sailing");
+    pass &= expect(Sailing::CreateSailing("VIC", "King", "25-07-01", "08:00") == SailingStatus::VESSEL_NOT_FOUND,
+                   name + ": unknown vessel");
+    std::vector<Sailingrec> route = store.sailingsToCity("YVR", "01");
+    pass &= expect(route.size() == 3 && std::string(route[0].id) == "YVR:01:08" && std::string(route[2].id) == "YVR:01:10",
+                   name + ": route in hour order");
+
+    // 2. Bookings through the business layer
+    pass &= expect(Reservation::newCustomerReservation(vehicle("AB123", 5, 1), "YVR:01:08"), name + ": new customer");
+    pass &= expect(Reservation::newCustomerReservation(vehicle("TRUCK1", 10, 3), "YVR:01:08"), name + ": tall vehicle");
+    pass &= expect(Reservation::returningCustomerReservation("AB123", "YVR:01:09"), name + ": returning customer");
+    pass &= expect(!Reservation::returningCustomerReservation("ab123", "yvr:01:08") &&
+                   !store.writeReservation("ab123", "yvr:01:08"), name + ": duplicate booking (any case)");
+    pass &= expect(Reservation::isVehicleExist("AB123") && !Reservation::isVehicleExist("ab123"),
+                   name + ": licenses are exact");
+    pass &= expect(store.reservationExists("AB123", "YVR:01:08") && !store.reservationExists("ab123", "YVR:01:08"),
+                   name + ": reservationExists is exact");
+    pass &= expect(Reservation::checkinVehicle("ab123", "YVR:01:08"), name + ": check-in");
+    pass &= expect(store.countReservations("yvr:01:08") == 2, name + ": count");
+    std::unordered_map<std::string, int> counts;
+    pass &= expect(store.countReservationsBySailing(counts) && counts.size() == 2, name + ": counts per sailing");
+
+    Sailingrec rec{};
+    pass &= expect(store.findSailing("YVR:01:08", rec) && rec.remainingLCL < 200.0f && rec.remainingHCL < 100.0f,
+                   name + ": capacity persisted");
+    pass &= expect(Reservation::deleteReservation("AB123", "YVR:01:09"), name + ": cancel");
+    pass &= expect(store.findSailing("YVR:01:09", rec) && rec.remainingLCL == 200.0f, name + ": space returned");
+
+    // 3. Deletes
+    std::vector<ReservationRec> rows;
+    pass &= expect(Sailing::DeleteSailing("YVR:01:08"), name + ": sailing deleted");
+    pass &= expect(store.readReservationsForSailings({ "YVR:01:08" }, rows) && rows.empty(), name + ": cascade");
+    pass &= expect(store.writeReservation("AB123", "NAN:02:10"), name + ": book other route");
+    pass &= expect(Sailing::DeleteSailingsToCity("YVR") == 2, name + ": route deleted");
+    pass &= expect(store.sailings().size() == 1 && store.countReservations("NAN:02:10") == 1, name + ": other route kept");
+    pass &= expect(store.deleteVehicle("TRUCK1") && !store.vehicleExists("TRUCK1"), name + ": vehicle deleted");
+    pass &= expect(Vessel::DeleteVessel("Queen") == VesselStatus::SUCCESS && !Vessel::isVesselExist("Queen"),
+                   name + ": vessel deleted");
+    return pass;
+}
+
+int main()
+{
+    if (!enterTestDir(kTestDir))
+        return 1;
+    std::error_code ec;
+    fs::path root = fs::current_path();
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+
+    bool pass = true;
+    for (BackendKind kind : { BackendKind::FLAT_FILE, BackendKind::MMAP, BackendKind::MEMORY })
+    {
+        fs::path dir = root / StorageBackend::kindName(kind);
+        fs::create_directories(dir, ec);
+        fs::current_path(dir, ec);
+        if (ec)
+        {
+            std::cerr << "ERROR: cannot enter test directory\n";
+            return 1;
+        }
+        pass &= scenario(kind);
+    }
+
+    // The memory engine never touched its directory
+    pass &= expect(fs::is_empty(root / "memory"), "memory: no files");
+
+    // mmap data read by the flat engine, and the other way round
+    fs::current_path(root / "mmap", ec);
+    StorageBackend::select(BackendKind::FLAT_FILE);
+    StorageBackend &flat = StorageBackend::current();
+    pass &= expect(flat.countReservations("NAN:02:10") == 1 && flat.vehicleExists("AB123"), "flat reads mmap files");
+    pass &= expect(flat.writeReservation("CD456", "NAN:02:10"), "flat writes to mmap files");
+    StorageBackend::select(BackendKind::MMAP);
+    StorageBackend &mapped = StorageBackend::current();
+    pass &= expect(mapped.countReservations("NAN:02:10") == 2 && mapped.sailingExists("NAN:02:10"), "mmap reads flat files");
+    StorageBackend::select(BackendKind::FLAT_FILE);
+
+    return finish("Backends", pass);
+}
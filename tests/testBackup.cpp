@@ -0,0 +1,127 @@
+// ---------------------------------------------------------------------------
+// testBackup.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the online backup:
+//     1. A WriteGate::Pause holds back an update until it ends.
+//     2. A backup taken while another thread keeps booking copies every
+//        data file, each with whole records and a header that matches
+//        its size, and bookings carry on during and after it.
+//     3. The reservations/ directory is copied in the partitioned
+//        layout; a directory that already holds files is refused.
+//
+//   Runs inside ../data/backup_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "Backup.h"
+#include "DataFile.h"
+#include "FileIO_Reservations.h"
+#include "ParallelScan.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+#include "WriteGate.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+// Every table in `dir`: header row count matches the file size
+static bool consistentCopy(const std::string &dir)
+{
+    std::error_code ec;
+    fs::current_path(dir, ec);
+    DataFile::forget();
+    bool ok = !ec;
+    for (int t = 0; t < static_cast<int>(Table::COUNT); ++t)
+    {
+        const TableLayout &layout = Compactor::layout(static_cast<Table>(t));
+        FileHeader header{};
+        ok = ok && DataFile::header(static_cast<Table>(t), header) &&
+             fs::file_size(layout.file) == FILE_HEADER_BYTES + header.liveRows * layout.recordSize &&
+             header.liveRows == fileRecordCount(layout.file, layout.recordSize);
+    }
+    fs::current_path("..", ec);
+    DataFile::forget();
+    return ok && !ec;
+}
+
+int main()
+{
+    std::error_code ec;
+    if (!enterTestDir("../data/backup_test"))
+        return 1;
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    StorageBackend &store = StorageBackend::current();
+    store.writeVessel("Spirit", 120, 240);
+    store.writeSailing("VIC:01:08", "Spirit", 120, 240);
+    for (int i = 0; i < 500; ++i)
+    {
+        store.writeVehicle(VehicleRecord{ "CAR" + std::to_string(i), "6045550000", 5, 1 });
+        store.writeReservation("CAR" + std::to_string(i), "VIC:01:08");
+    }
+
+    // 1. A pause holds writers back
+    bool pass = true;
+    std::atomic<bool> written{ false };
+    std::thread writer;
+    {
+        WriteGate::Pause pause;
+        pass &= expect(pause.held(), "pause taken");
+        writer = std::thread([&] {
+            store.writeVehicle(VehicleRecord{ "LATE", "6045550000", 5, 1 });
+            written = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        pass &= expect(!written, "update waits for the pause");
+    }
+    writer.join();
+    pass &= expect(written && store.vehicleExists("LATE"), "update runs after the pause");
+
+    // 2. Backup while bookings flow
+    std::atomic<bool> stop{ false };
+    std::atomic<int> booked{ 0 };
+    writer = std::thread([&] {
+        for (int i = 0; !stop; ++i)
+        {
+            ++booked;                           // counted first: never behind the file
+            store.writeReservation("W" + std::to_string(i), "VIC:01:08");
+        }
+    });
+    while (booked < 50)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    BackupResult r = Backup::create("snap1");
+    int atBackup = booked;
+    while (booked < atBackup + 50)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    stop = true;
+    writer.join();
+
+    pass &= expect(r.ok && r.files >= 4 && r.bytes > 0, "backup written");
+    pass &= expect(fs::exists("snap1/vehicles.dat") && fs::exists("snap1/sailings.dat") &&
+                   fs::exists("snap1/vessels.dat") && fs::exists("snap1/reservations.dat"), "four data files");
+    pass &= expect(!fs::exists("snap1/" + std::string(WriteGate::GATE_FILE)), "lock files left out");
+    pass &= expect(consistentCopy("snap1"), "copy headers match contents");
+    std::size_t copied = fileRecordCount("snap1/reservations.dat", sizeof(ReservationRec));
+    pass &= expect(copied > 500 && copied <= 500 + static_cast<std::size_t>(atBackup), "copy is a point in time");
+
+    // 3. Partitioned layout; refused destination
+    FileIO_Reservations::setStorageMode(ReservationStorage::PARTITIONED);
+    store.writeReservation("CAR1", "NAN:02:09");
+    r = Backup::create("snap2");
+    pass &= expect(r.ok && fs::exists("snap2/reservations/catalog.dat"), "partitions copied");
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    r = Backup::create("snap1");
+    pass &= expect(!r.ok, "non-empty destination refused");
+
+    return finish("Backup", pass);
+}
@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------------------
+// testBatchRead.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the batched read engines (AsyncIO.h):
+//     1. The best engine (io_uring where the kernel allows it) reads a
+//        batch several rings deep, in any offset order, byte for byte.
+//     2. FERRY_IO_ENGINE=pread forces the fallback, which reads the same.
+//     3. A read running past the end of file is reported short, and a
+//        request the kernel refuses fails alone, by both.
+//     4. io_uring only: a batch whose wait is interrupted by signals over
+//        and over (reads from a pipe filled slowly) still completes every
+//        request exactly once.
+//   Also prints the time per batch for each engine.
+//
+//   Runs inside ../data/batchread_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "AsyncIO.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/time.h>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace FerrySys;
+
+static constexpr std::size_t BLOCK = 256;
+static constexpr std::size_t BLOCKS = 4096;
+static constexpr std::size_t BATCH = 1000;          // ~4 rings of 256
+
+static unsigned char pattern(std::size_t pos)
+{
+    return static_cast<unsigned char>((pos / BLOCK) * 7 + pos % BLOCK);
+}
+
+//------------------------------------------------------------
+// One engine over records.bin: shuffled full blocks, then a
+// read off the end and a refused one
+static bool checkEngine(BatchReader &reader)
+{
+    int fd = ::open("records.bin", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return expect(false, "open records.bin");
+
+    std::mt19937 rng(42);
+    std::vector<std::size_t> order(BATCH);
+    for (std::size_t i = 0; i < BATCH; ++i)
+        order[i] = rng() % BLOCKS;
+
+    std::vector<unsigned char> buf(BATCH * BLOCK);
+    std::vector<ReadRequest> requests(BATCH);
+    const int ROUNDS = 20;
+    bool all = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        std::fill(buf.begin(), buf.end(), 0);
+        for (std::size_t i = 0; i < BATCH; ++i)
+            requests[i] = ReadRequest{ order[i] * BLOCK, BLOCK, buf.data() + i * BLOCK, -1 };
+        all &= reader.readBatch(fd, requests);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool same = true;
+    for (std::size_t i = 0; i < BATCH; ++i)
+    {
+        for (std::size_t b = 0; b < BLOCK; ++b)
+            same &= buf[i * BLOCK + b] == pattern(order[i] * BLOCK + b);
+    }
+    bool pass = expect(all && same, std::string(reader.name()) + ": batch read byte for byte");
+
+    std::vector<ReadRequest> tail{ ReadRequest{ BLOCKS * BLOCK - 100, BLOCK, buf.data(), -1 },
+                                   ReadRequest{ 0, BLOCK, buf.data() + BLOCK, -1 } };
+    pass &= expect(!reader.readBatch(fd, tail) && tail[0].result == 100 &&
+                   tail[1].result == static_cast<std::int64_t>(BLOCK), std::string(reader.name()) + ": short read reported");
+
+    // A request refused as it is submitted (io_uring stops the submit
+    // there): it fails alone and the ones queued behind it still run
+    std::vector<ReadRequest> refused;
+    for (std::size_t i = 0; i < 8; ++i)
+        refused.push_back(ReadRequest{ i * BLOCK, BLOCK, buf.data() + i * BLOCK, -1 });
+    refused[2].length = static_cast<std::size_t>(-1);
+    bool read = reader.readBatch(fd, refused);
+    bool rest = true;
+    for (std::size_t i = 0; i < refused.size(); ++i)
+    {
+        if (i != 2)
+            rest &= refused[i].result == static_cast<std::int64_t>(BLOCK) && buf[i * BLOCK + 1] == pattern(i * BLOCK + 1);
+    }
+    pass &= expect(!read && refused[2].result <= 0 && rest, std::string(reader.name()) + ": refused request fails alone");
+    ::close(fd);
+
+    std::cout << reader.name() << ": " << secs * 1e6 / ROUNDS << " us per " << BATCH << "-read batch\n";
+    return pass;
+}
+
+//------------------------------------------------------------
+// io_uring: reads from a pipe that fills slowly while SIGALRM
+// keeps interrupting the wait for completions
+static std::atomic<int> alarms{ 0 };
+
+static void onAlarm(int)
+{
+    alarms.fetch_add(1);
+}
+
+static bool checkInterrupted(BatchReader &reader)
+{
+    constexpr std::size_t CHUNKS = 64, CHUNK = 16;
+    int pipeFds[2];
+    if (::pipe(pipeFds) != 0)
+        return expect(false, "pipe");
+
+    struct sigaction action{};
+    action.sa_handler = onAlarm;            // no SA_RESTART
+    sigemptyset(&action.sa_mask);
+    struct sigaction old{};
+    ::sigaction(SIGALRM, &action, &old);
+    itimerval every{ { 0, 200 }, { 0, 200 } };
+    ::setitimer(ITIMER_REAL, &every, nullptr);
+
+    std::thread writer([&] {
+        for (std::size_t c = 0; c < CHUNKS; ++c)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            unsigned char chunk[CHUNK];
+            std::memset(chunk, static_cast<int>('A' + c), CHUNK);
+            while (::write(pipeFds[1], chunk, CHUNK) < 0 && errno == EINTR)
+                ;
+        }
+    });
+
+    std::vector<unsigned char> buf(CHUNKS * CHUNK, 0);
+    std::vector<ReadRequest> requests(CHUNKS);
+    for (std::size_t i = 0; i < CHUNKS; ++i)
+        requests[i] = ReadRequest{ 0, CHUNK, buf.data() + i * CHUNK, -1 };
+    bool ok = reader.readBatch(pipeFds[0], requests);
+    writer.join();
+
+    itimerval off{};
+    ::setitimer(ITIMER_REAL, &off, nullptr);
+    ::sigaction(SIGALRM, &old, nullptr);
+    ::close(pipeFds[0]);
+    ::close(pipeFds[1]);
+
+    std::set<unsigned char> seen;
+    bool whole = true;
+    for (std::size_t i = 0; i < CHUNKS; ++i)
+    {
+        whole &= std::all_of(buf.begin() + i * CHUNK, buf.begin() + (i + 1) * CHUNK,
+                             [&](unsigned char b) { return b == buf[i * CHUNK]; });
+        seen.insert(buf[i * CHUNK]);
+    }
+    bool pass = expect(alarms.load() > 0, "waits interrupted");
+    pass &= expect(ok && whole && seen.size() == CHUNKS, "interrupted batch read every chunk once");
+    return pass;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/batchread_test"))
+        return 1;
+
+    {
+        std::vector<unsigned char> data(BLOCKS * BLOCK);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = pattern(i);
+        std::ofstream out("records.bin", std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    // 1. Best engine
+    ::unsetenv("FERRY_IO_ENGINE");
+    std::unique_ptr<BatchReader> best = makeBatchReader();
+    bool pass = checkEngine(*best);
+
+    // 2. Forced fallback
+    ::setenv("FERRY_IO_ENGINE", "pread", 1);
+    std::unique_ptr<BatchReader> fallback = makeBatchReader();
+    ::unsetenv("FERRY_IO_ENGINE");
+    pass &= expect(std::string(fallback->name()) == "pread", "FERRY_IO_ENGINE=pread forces the fallback");
+    pass &= checkEngine(*fallback);
+
+    // 4. Interrupted waits
+    if (std::string(best->name()) == "io_uring")
+        pass &= checkInterrupted(*best);
+    else
+        std::cout << "io_uring not available here; interrupted-wait check skipped\n";
+
+    return finish("BatchRead", pass);
+}
@@ -0,0 +1,140 @@
+// ---------------------------------------------------------------------------
+// testBulkExport.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the CSV / JSON export:
+//     1. A vehicle table spanning many format chunks comes out in file
+//        order without its deleted rows, and imports back unchanged.
+//     2. Names needing it are quoted (CSV) or escaped (JSON); JSON is one
+//        array with one object per line.
+//     3. The bookings view joins each reservation to its sailing's vessel
+//        and its vehicle, with empty fields for a vehicle that is gone.
+//     4. Reservations in the partitioned layout export the same rows.
+//
+//   Runs inside ../data/bulkexport_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BulkExport.h"
+#include "BulkImport.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "FileIO_VehicleRecord.h"
+#include "FileIO_Vessel.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static std::string readAll(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static std::vector<std::string> readLines(const std::string &path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+int main()
+{
+    std::error_code ec;
+    if (!enterTestDir("../data/bulkexport_test") || !fs::create_directories("copy", ec))
+        return 1;
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+
+    // 1. Vehicles over many chunks
+    const int VEHICLES = 40000;
+    for (int i = 0; i < VEHICLES; ++i)
+        FileIO_VehicleRecord::writeVehicle(VehicleRecord{ "CAR" + std::to_string(i), "6045550000", 5 + i % 3, 1 });
+    for (int i = 0; i < VEHICLES; i += 1000)
+        FileIO_VehicleRecord::deleteVehicle("CAR" + std::to_string(i));
+
+    ExportResult r = BulkExport::run(ExportKind::VEHICLES, ExportFormat::CSV, "vehicles.csv");
+    std::vector<std::string> lines = readLines("vehicles.csv");
+    bool pass = expect(r.ok && r.rows == VEHICLES - 40 && lines.size() == r.rows + 1, "vehicle rows");
+    pass &= expect(static_cast<std::size_t>(VEHICLES) > 2 * BulkExport::CHUNK_RECORDS, "vehicles span chunks");
+    pass &= expect(lines[0] == BulkExport::columns(ExportKind::VEHICLES) && lines[1] == "CAR1,6045550000,6,1" &&
+                   lines.back() == "CAR39999,6045550000,5,1", "vehicle lines");
+    pass &= expect(r.bytes == readAll("vehicles.csv").size(), "byte count");
+    bool ordered = true;
+    std::size_t next = 1;
+    for (int i = 0; i < VEHICLES && ordered; ++i)
+    {
+        if (i % 1000 == 0)
+            continue;
+        ordered = lines[next++].rfind("CAR" + std::to_string(i) + ",", 0) == 0;
+    }
+    pass &= expect(ordered, "file order kept across chunks");
+
+    fs::current_path("copy", ec);
+    ImportResult in = BulkImport::run(ImportKind::VEHICLES, "../vehicles.csv", "vehicles.rej");
+    VehicleRecord v;
+    pass &= expect(in.ok && in.imported == r.rows && in.rejected == 0, "export imports back");
+    pass &= expect(FileIO_VehicleRecord::findVehicle("CAR1234", v) && v.length_m == 5 + 1234 % 3, "imported vehicle");
+    fs::current_path("..", ec);
+
+    // 2. Quoting and JSON
+    FileIO_Vessel::writeVessel("Spirit", 120, 240);
+    FileIO_Vessel::writeVessel("Queen, of \"Oak\"", 90, 180);
+    r = BulkExport::run(ExportKind::VESSELS, ExportFormat::CSV, "vessels.csv");
+    lines = readLines("vessels.csv");
+    pass &= expect(r.ok && lines.size() == 3 && lines[2] == "\"Queen, of \"\"Oak\"\"\",90,180", "CSV quoting");
+    r = BulkExport::run(ExportKind::VESSELS, ExportFormat::JSON, "vessels.json");
+    pass &= expect(r.ok && readAll("vessels.json") ==
+                   "[\n{\"name\":\"Spirit\",\"laneHCL\":120,\"laneLCL\":240},\n"
+                   "{\"name\":\"Queen, of \\\"Oak\\\"\",\"laneHCL\":90,\"laneLCL\":180}\n]\n", "JSON array");
+
+    FileIO_Sailings::writeSailing("VIC:01:08", "Spirit", 120, 234.5f);
+    r = BulkExport::run(ExportKind::SAILINGS, ExportFormat::JSON, "sailings.json");
+    pass &= expect(r.ok && readAll("sailings.json").find("\"remainingHCL\":120,\"remainingLCL\":234.5}") !=
+                   std::string::npos, "shortest float text");
+    r = BulkExport::run(ExportKind::RESERVATIONS, ExportFormat::JSON, "empty.json");
+    pass &= expect(r.ok && r.rows == 0 && readAll("empty.json") == "[]\n", "empty JSON");
+
+    // 3. The bookings view
+    FileIO_Sailings::writeSailing("NAN:02:09", "Queen, of \"Oak\"", 90, 180);
+    FileIO_Reservations::writeReservation("CAR1", "VIC:01:08");
+    FileIO_Reservations::writeReservation("CAR2", "nan:02:09");
+    FileIO_Reservations::writeReservation("CAR3", "VIC:01:08");
+    FileIO_Reservations::writeCheckin("CAR2", "NAN:02:09");
+    FileIO_VehicleRecord::deleteVehicle("CAR3");
+    r = BulkExport::run(ExportKind::BOOKINGS, ExportFormat::CSV, "bookings.csv");
+    lines = readLines("bookings.csv");
+    pass &= expect(r.ok && lines.size() == 4 && lines[1] == "VIC:01:08,Spirit,CAR1,6045550000,6,1,0" &&
+                   lines[2] == "nan:02:09,\"Queen, of \"\"Oak\"\"\",CAR2,6045550000,7,1,1" &&
+                   lines[3] == "VIC:01:08,Spirit,CAR3,,,,0", "bookings joined");
+    r = BulkExport::run(ExportKind::BOOKINGS, ExportFormat::JSON, "bookings.json");
+    pass &= expect(r.ok && readAll("bookings.json").find("\"license\":\"CAR3\",\"phone\":null,\"length\":null") !=
+                   std::string::npos, "missing vehicle is null");
+
+    // 4. Partitioned reservations
+    r = BulkExport::run(ExportKind::RESERVATIONS, ExportFormat::CSV, "flat.csv");
+    std::vector<std::string> flat = readLines("flat.csv");
+    FileIO_Reservations::setStorageMode(ReservationStorage::PARTITIONED);
+    r = BulkExport::run(ExportKind::RESERVATIONS, ExportFormat::CSV, "partitioned.csv");
+    std::vector<std::string> parts = readLines("partitioned.csv");
+    std::sort(flat.begin(), flat.end());
+    std::sort(parts.begin(), parts.end());
+    pass &= expect(r.ok && r.rows == 3 && parts == flat, "partitioned rows match");
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+
+    return finish("Bulk export", pass);
+}
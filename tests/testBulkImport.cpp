@@ -0,0 +1,191 @@
+// ---------------------------------------------------------------------------
+// testBulkImport.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the CSV import:
+//     1. Vessels and sailings load; header, comment and blank lines are
+//        skipped; quoted fields are unwrapped; bad rows are rejected with
+//        their line numbers.
+//     2. A vehicle file spanning several parse chunks loads in order;
+//        vehicles already on file and repeats within the file are
+//        rejected.
+//     3. Reservations need a known vehicle and sailing, take lane space
+//        until the sailing is full, and are refused when already booked.
+//     4. A round whose append fails part way (file size limit) leaves no
+//        torn record, no header count and no lane space taken.
+//
+//   Runs inside ../data/bulkimport_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BulkImport.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "FileIO_VehicleRecord.h"
+#include "FileIO_Vessel.h"
+#include "TestSupport.h"
+#include "BinaryFileOps.hpp"
+#include "DataFile.h"
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace FerrySys;
+
+static void writeFile(const std::string &path, const std::string &text)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+static std::vector<std::string> readLines(const std::string &path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/bulkimport_test"))
+        return 1;
+
+    // 1. Vessels and sailings
+    FileIO_Vessel::writeVessel("Queen", 100, 200);
+    writeFile("vessels.csv",
+              "name,laneHCL,laneLCL\n"
+              "# partner fleet\n"
+              "Spirit,120,240\n"
+              "\n"
+              "\"Coastal Renaissance\" , 90 ,180\r\n"
+              "Queen,1,1\n"
+              "Tiny,20,20\n"
+              "Broken,12\n");
+    ImportResult r = BulkImport::run(ImportKind::VESSELS, "vessels.csv", "vessels.rej");
+    bool pass = expect(r.ok && r.rows == 5 && r.imported == 3 && r.rejected == 2, "vessel counts");
+    unsigned int hcl = 0, lcl = 0;
+    pass &= expect(FileIO_Vessel::getVesselByName("Coastal Renaissance", hcl, lcl) && hcl == 90 && lcl == 180,
+                   "quoted vessel imported");
+    std::vector<std::string> rej = readLines("vessels.rej");
+    pass &= expect(rej.size() == 2 && rej[0] == "6,vessel already exists,Queen,1,1" &&
+                   rej[1].rfind("8,expected 3 fields,", 0) == 0, "vessel rejects with line numbers");
+
+    writeFile("sailings.csv",
+              "VIC:01:08,Spirit\n"
+              "VIC:01:12,Tiny\n"
+              "NAN:02:09,Nobody\n"
+              "VIC01:08,Spirit\n"
+              "VIC:01:08,Queen\n");
+    r = BulkImport::run(ImportKind::SAILINGS, "sailings.csv", "sailings.rej");
+    pass &= expect(r.ok && r.imported == 2 && r.rejected == 3, "sailing counts");
+    float remHCL = 0, remLCL = 0;
+    pass &= expect(FileIO_Sailings::getRemainingSpace("VIC:01:08", remHCL, remLCL) && remHCL == 120 && remLCL == 240,
+                   "sailing takes vessel lanes");
+    rej = readLines("sailings.rej");
+    pass &= expect(rej.size() == 3 && rej[0].rfind("3,unknown vessel", 0) == 0 &&
+                   rej[1].rfind("4,sailing ID", 0) == 0 && rej[2].rfind("5,sailing already exists", 0) == 0,
+                   "sailing rejects");
+
+    // 2. Vehicles over several chunks
+    FileIO_VehicleRecord::writeVehicle(VehicleRecord{ "CAR7", "6045550000", 5, 1 });
+    const int VEHICLES = 60000;
+    {
+        std::ostringstream csv;
+        csv << "license,phone,length,height\n";
+        for (int i = 0; i < VEHICLES; ++i)
+            csv << "CAR" << i << ",604-555-" << (1000 + i % 9000) << ",5,1\n";
+        csv << "CAR12,604-555-0000,5,1\n";             // repeat
+        csv << "CAR-BAD,604-555-0000,five,1\n";
+        writeFile("vehicles.csv", csv.str());
+        pass &= expect(csv.str().size() > BulkImport::CHUNK_BYTES, "vehicle file spans chunks");
+    }
+    r = BulkImport::run(ImportKind::VEHICLES, "vehicles.csv", "vehicles.rej");
+    pass &= expect(r.ok && r.rows == VEHICLES + 2 && r.imported == VEHICLES - 1 && r.rejected == 3,
+                   "vehicle counts");
+    rej = readLines("vehicles.rej");
+    pass &= expect(rej.size() == 3 && rej[0].rfind("9,vehicle already exists,CAR7", 0) == 0 &&
+                   rej[1] == "60002,duplicate in input,CAR12,604-555-0000,5,1" &&
+                   rej[2].rfind("60003,length and height", 0) == 0, "vehicle rejects in input order");
+    VehicleRecord v;
+    pass &= expect(FileIO_VehicleRecord::findVehicle("CAR59999", v) && v.length_m == 5, "last vehicle readable");
+    pass &= expect(FileIO_VehicleRecord::findVehicle("CAR7", v) && v.phone == "6045550000", "existing vehicle kept");
+
+    // 3. Reservations: Tiny holds three 5 m cars per 20 m lane
+    {
+        std::ostringstream csv;
+        for (int i = 0; i < 10; ++i)
+            csv << "CAR" << i << ",VIC:01:12\n";
+        csv << "CAR1,VIC:01:12\n";              // same booking again
+        csv << "GHOST,VIC:01:12\n";
+        csv << "CAR20,NAN:02:09\n";
+        csv << "CAR20,VIC:01:08\n";
+        writeFile("reservations.csv", csv.str());
+    }
+    r = BulkImport::run(ImportKind::RESERVATIONS, "reservations.csv", "reservations.rej");
+    pass &= expect(r.ok && r.rows == 14 && r.imported == 7 && r.rejected == 7, "reservation counts");
+    rej = readLines("reservations.rej");
+    pass &= expect(rej.size() == 7 && rej[0].rfind("7,sailing full", 0) == 0 &&
+                   rej[4].rfind("11,duplicate in input", 0) == 0 && rej[5].rfind("12,unknown vehicle", 0) == 0 &&
+                   rej[6].rfind("13,unknown sailing", 0) == 0, "reservation rejects");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:01:12") == 6, "six booked");
+    pass &= expect(FileIO_Reservations::reservationExists("CAR20", "VIC:01:08"), "booking readable");
+    pass &= expect(FileIO_Sailings::getRemainingSpace("VIC:01:12", remHCL, remLCL) &&
+                   remHCL < 5.5f && remLCL < 5.5f, "lane space persisted");
+
+    r = BulkImport::run(ImportKind::RESERVATIONS, "reservations.csv", "reservations.rej");
+    rej = readLines("reservations.rej");
+    pass &= expect(r.imported == 0 && rej.size() == 14 && rej[0].rfind("1,already booked", 0) == 0,
+                   "second run finds every booking");
+
+    // 4. The file may grow by one record only: the second is cut short
+    //    (the reject file stays under the same limit)
+    {
+        std::ostringstream csv;
+        for (int i = 30; i < 33; ++i)
+            csv << "CAR" << i << ",VIC:01:08\n";
+        writeFile("failing.csv", csv.str());
+    }
+    struct stat st{};
+    ::stat("reservations.dat", &st);
+    off_t sizeBefore = st.st_size;
+    std::size_t rowsBefore = DataFile::rows(Table::RESERVATIONS);
+    FileIO_Sailings::getRemainingSpace("VIC:01:08", remHCL, remLCL);
+    float hclBefore = remHCL, lclBefore = remLCL;
+
+    pid_t child = ::fork();
+    if (child == 0)
+    {
+        std::signal(SIGXFSZ, SIG_IGN);
+        struct rlimit limit{};
+        limit.rlim_cur = limit.rlim_max =
+            static_cast<rlim_t>(sizeBefore) + sizeof(ReservationRec) + sizeof(ReservationRec) / 2;
+        ::setrlimit(RLIMIT_FSIZE, &limit);
+        r = BulkImport::run(ImportKind::RESERVATIONS, "failing.csv", "failing.rej");
+        rej = readLines("failing.rej");
+        std::_Exit(!r.ok && r.imported == 0 && rej.size() == 3 &&
+                   rej[0].rfind("1,not written", 0) == 0 ? 0 : 1);
+    }
+    int status = 1;
+    ::waitpid(child, &status, 0);
+    pass &= expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "failed round reported, every row rejected");
+    ::stat("reservations.dat", &st);
+    pass &= expect(st.st_size == sizeBefore && DataFile::rows(Table::RESERVATIONS) == rowsBefore,
+                   "partial append cut off, header unchanged");
+    pass &= expect(FileIO_Sailings::getRemainingSpace("VIC:01:08", remHCL, remLCL) &&
+                   remHCL == hclBefore && remLCL == lclBefore, "failed round's space given back");
+    pass &= expect(!FileIO_Reservations::reservationExists("CAR30", "VIC:01:08"), "nothing booked");
+
+    return finish("Bulk import", pass);
+}
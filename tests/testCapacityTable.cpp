@@ -0,0 +1,219 @@
+// ---------------------------------------------------------------------------
+// testCapacityTable.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Multithreaded stress test for the lock-free CapacityTable, on sailings
+//   in sailings.dat booked the way a terminal books them: take the space,
+//   then write it back (persist()).
+//   Many threads race to book vehicles onto one sailing whose lanes fit
+//   only a fraction of them. After every round the number of successful
+//   bookings must exactly match the space taken, both in the table and on
+//   file, and no lane may go negative (zero overbooking). Each round is
+//   repeated with 1, 2, 4, ... threads and the booking throughput is
+//   printed so scaling can be read off directly. Then the table is grown
+//   well past its first level, and several processes book one sailing.
+//
+//   Runs inside ../data/capacity_test (relative to build/).
+//
+// BUILD (from build/ folder; see README_build.txt, Additional Tests):
+//   g++ -std=c++20 -Wall -Wextra -pedantic -O2 -pthread -I../include ^
+//       ../tests/testCapacityTable.cpp <all ../src/*.cpp except main.cpp
+//       and ferryd.cpp> -o testCapacityTable
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "CapacityTable.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using FerrySys::CapacityTable;
+using FerrySys::Lane;
+using FerrySys::StorageBackend;
+
+static const int          kAttempts     = 200000;   // bookings tried per round
+static const std::int32_t kVehicleCm    = CapacityTable::vehicleSpaceCm(4); // 450 cm
+static const unsigned     kLaneMetres   = 9000;     // 2000 vehicles per lane
+
+// ----------------------------------------------------------------------------
+// Remaining space in the table and on file, in centimetres
+// ----------------------------------------------------------------------------
+static bool spaceIs(const std::string &sailingID, long hclCm, long lclCm)
+{
+    float hcl = 0, lcl = 0;
+    Sailingrec rec{};
+    return CapacityTable::remaining(sailingID, hcl, lcl) &&
+           StorageBackend::current().findSailing(sailingID, rec) &&
+           CapacityTable::toCentimetres(hcl) == hclCm && CapacityTable::toCentimetres(lcl) == lclCm &&
+           CapacityTable::toCentimetres(rec.remainingHCL) == hclCm &&
+           CapacityTable::toCentimetres(rec.remainingLCL) == lclCm;
+}
+
+// ----------------------------------------------------------------------------
+// One round on its own sailing: `threads` workers share kAttempts bookings;
+// every seventh booking is released again to keep the CAS loops contended
+// in both directions. Each change is written back as a booking would.
+// ----------------------------------------------------------------------------
+static bool runRound(unsigned threads, int round)
+{
+    std::string sailing = "TST:" + std::to_string(10 + round) + ":08";
+    StorageBackend::current().writeSailing(sailing, "Tester", kLaneMetres, kLaneMetres);
+
+    std::atomic<long> booked{ 0 };
+    std::atomic<long> bookedHCL{ 0 };
+    std::atomic<long> lost{ 0 };
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            long mine = 0, mineHCL = 0, mineLost = 0;
+            for (int i = static_cast<int>(t); i < kAttempts; i += static_cast<int>(threads))
+            {
+                Lane lane = Lane::NONE;
+                bool high = (i % 5) == 0;
+                if (!CapacityTable::reserve(sailing, kVehicleCm, high, lane))
+                    continue;
+
+                if (i % 7 == 0)
+                    CapacityTable::release(sailing, kVehicleCm, lane);
+                else
+                {
+                    ++mine;
+                    if (lane == Lane::HCL)
+                        ++mineHCL;
+                }
+                if (!CapacityTable::persist(sailing))
+                    ++mineLost;
+            }
+            booked += mine;
+            bookedHCL += mineHCL;
+            lost += mineLost;
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long capCm = CapacityTable::toCentimetres(static_cast<float>(kLaneMetres));
+    long expectHCL = capCm - bookedHCL.load() * kVehicleCm;
+    long expectLCL = capCm - (booked.load() - bookedHCL.load()) * kVehicleCm;
+
+    std::cout << "  threads=" << threads
+              << "  booked=" << booked.load()
+              << "  ops/s=" << static_cast<long>(kAttempts / secs) << "\n";
+
+    bool ok = expect(lost.load() == 0, "every write-back succeeded");
+    ok &= expect(expectHCL >= 0 && expectLCL >= 0, "no lane went negative");
+    ok &= expect(spaceIs(sailing, expectHCL, expectLCL), "space taken matches the bookings, in the table and on file");
+    return ok;
+}
+
+// ----------------------------------------------------------------------------
+// Far more sailings than the first level holds, with churn: deleted IDs are
+// replaced by new ones and every live sailing stays bookable.
+// ----------------------------------------------------------------------------
+static bool runGrowth()
+{
+    const int SAILINGS = 5 * static_cast<int>(CapacityTable::INITIAL_SLOTS);
+    auto id = [](int n) { return "G" + std::to_string(n / 1000) + ":" + std::to_string(n % 1000); };
+
+    bool ok = true;
+    for (int n = 0; n < SAILINGS; ++n)
+        ok &= CapacityTable::add(SailingID(id(n)), 10.0f, 10.0f, 10.0f, 10.0f);
+    for (int n = 0; n < SAILINGS; n += 2)
+        ok &= CapacityTable::remove(SailingID(id(n)));
+    for (int n = SAILINGS; n < 2 * SAILINGS; ++n)
+        ok &= CapacityTable::add(SailingID(id(n)), 10.0f, 10.0f, 10.0f, 10.0f);
+
+    for (int n = 0; n < 2 * SAILINGS && ok; ++n)
+    {
+        Lane lane = Lane::NONE;
+        bool live = n >= SAILINGS || n % 2 == 1;
+        ok = CapacityTable::reserve(SailingID(id(n)), kVehicleCm, false, lane) == live;
+    }
+    return expect(ok, "sailings kept as the table grew");
+}
+
+// ----------------------------------------------------------------------------
+// Several processes (terminals) booking one sailing on file: every booking
+// that succeeds is deducted exactly once, and none overbooks.
+// ----------------------------------------------------------------------------
+static bool runProcesses()
+{
+    StorageBackend &store = StorageBackend::current();
+    store.writeVessel("Spirit", 40, 60);
+    store.writeSailing("VIC:01:08", "Spirit", 40.0f, 60.0f);
+    CapacityTable::load();
+
+    // 13 vehicles fit the LCL (1.5 m left), 8 the HCL (4 m left)
+    const int PROCESSES = 4, ATTEMPTS = 10;
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; ++p)
+    {
+        pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            int booked = 0;
+            for (int i = 0; i < ATTEMPTS; ++i)
+            {
+                Lane lane = Lane::NONE;
+                if (CapacityTable::reserve("VIC:01:08", kVehicleCm, false, lane))
+                    booked += CapacityTable::persist("VIC:01:08") ? 1 : 0;
+            }
+            std::_Exit(booked);
+        }
+        children.push_back(pid);
+    }
+    int booked = 0;
+    for (pid_t pid : children)
+    {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        booked += WIFEXITED(status) ? WEXITSTATUS(status) : 0;
+    }
+
+    bool ok = expect(booked == 21, std::to_string(booked) + " booked across processes, 21 fit");
+    ok &= expect(spaceIs("VIC:01:08", 400, 150), "processes' bookings deducted once each");
+
+    // A later process sees the same counters
+    CapacityTable::load();
+    Lane lane = Lane::NONE;
+    ok &= expect(!CapacityTable::reserve("VIC:01:08", kVehicleCm, false, lane) &&
+                 spaceIs("VIC:01:08", 400, 150), "counters kept across load()");
+    return ok;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/capacity_test"))
+        return 1;
+    StorageBackend::current().writeVessel("Tester", kLaneMetres, kLaneMetres);
+    CapacityTable::load();
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads < 2)
+        maxThreads = 2;
+
+    bool pass = true;
+    int round = 0;
+    for (unsigned threads = 1; threads <= maxThreads && pass; threads *= 2)
+        pass = runRound(threads, round++);
+    pass = pass && runGrowth();
+    pass = pass && runProcesses();
+
+    CapacityTable::clear();
+    return finish("CapacityTable", pass);
+}
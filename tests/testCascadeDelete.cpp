@@ -0,0 +1,76 @@
+// ---------------------------------------------------------------------------
+// testCascadeDelete.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Verifies that deleting sailings also removes their reservations:
+//     1. deleteSailing() drops one sailing and only its reservations.
+//     2. deleteSailingsOnDay() drops every sailing on a day in one pass.
+//     3. deleteSailingsToCity() drops a whole route.
+//   Remaining reservations must keep their original relative order.
+//
+//   Runs inside ../data/cascade_test (relative to build/) so the real data
+//   files in the working directory are never touched.
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "TestSupport.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const char *kTestDir = "../data/cascade_test";
+
+static int countAll()
+{
+    std::unordered_map<std::string, int> counts;
+    if (!FileIO_Reservations::countReservationsBySailing(counts))
+        return -1;
+    int total = 0;
+    for (const auto &kv : counts)
+        total += kv.second;
+    return total;
+}
+
+int main()
+{
+    if (!enterTestDir(kTestDir))
+        return 1;
+
+    // 4 sailings: two on day 29, two to YVR; 5 reservations each
+    const std::vector<std::string> sailings{ "YVR:29:14", "YVR:30:09", "NAN:29:18", "NAN:01:07" };
+    for (const auto &id : sailings)
+    {
+        FileIO_Sailings::writeSailing(id, "Queen", 100, 200);
+        for (int i = 0; i < 5; ++i)
+            FileIO_Reservations::writeReservation(id.substr(0, 3) + id.substr(4, 2) + "_" + std::to_string(i), id);
+    }
+
+    bool pass = expect(countAll() == 20, "seeded 20 reservations");
+
+    // 1. Single sailing
+    pass &= expect(FileIO_Sailings::deleteSailing("YVR:30:09"), "deleteSailing found sailing");
+    pass &= expect(!FileIO_Sailings::Sailingexist("YVR:30:09"), "sailing removed");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:30:09") == 0, "cascade removed its reservations");
+    pass &= expect(countAll() == 15, "other reservations untouched");
+    pass &= expect(FileIO_Reservations::reservationExists("NAN01_4", "NAN:01:07"), "tail record survived compaction");
+
+    // 2. Whole day
+    std::vector<SailingID> removed;
+    pass &= expect(FileIO_Sailings::deleteSailingsOnDay("29", removed) == 2, "two sailings on day 29");
+    pass &= expect(removed.size() == 2, "removed IDs reported");
+    pass &= expect(countAll() == 5, "day cascade removed 10 reservations");
+
+    // 3. Whole route
+    removed.clear();
+    pass &= expect(FileIO_Sailings::deleteSailingsToCity("NAN", removed) == 1, "one sailing left to NAN");
+    pass &= expect(countAll() == 0, "route cascade removed the rest");
+    pass &= expect(FileIO_Sailings::Sailingreport().empty(), "sailings.dat empty");
+
+    return finish("Cascade delete", pass);
+}
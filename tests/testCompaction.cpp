@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------------
+// testCompaction.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks tombstone deletes and compaction:
+//     1. deleteReservation() leaves the file size unchanged and the row
+//        disappears from every reader.
+//     2. Compaction is due only past the dead-row threshold; it drops
+//        exactly the dead rows and runs the rebuild hooks.
+//     3. Deleted vessels and vehicles are skipped and can be re-added.
+//
+//   Runs inside ../data/compaction_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "Compaction.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_Vessel.h"
+#include "TestSupport.h"
+#include "Vessel.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static std::string plate(int i)
+{
+    return "P" + std::to_string(i);
+}
+
+int main()
+{
+    if (!enterTestDir("../data/compaction_test"))
+        return 1;
+
+    const SailingID sailing = "YVR:29:14";
+    for (int i = 0; i < 200; ++i)
+        FileIO_Reservations::writeReservation(plate(i), sailing);
+
+    int hookRuns = 0;
+    Compactor::onCompacted(Table::RESERVATIONS, [&hookRuns] { ++hookRuns; });
+
+    // 1. In-place delete
+    auto bytes = fs::file_size("reservations.dat");
+    bool pass = expect(FileIO_Reservations::deleteReservation(plate(0), sailing), "delete found row");
+    pass &= expect(fs::file_size("reservations.dat") == bytes, "delete did not rewrite the file");
+    pass &= expect(!FileIO_Reservations::reservationExists(plate(0), sailing), "dead row invisible");
+    pass &= expect(!FileIO_Reservations::deleteReservation(plate(0), sailing), "second delete finds nothing");
+    pass &= expect(FileIO_Reservations::writeReservation(plate(0), sailing), "re-booking allowed after delete");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing(sailing) == 200, "count skips dead rows");
+
+    // 2. Threshold: 40 dead of 200 rows is below both limits
+    //    (the re-booking above filled the first dead slot)
+    for (int i = 1; i <= 40; ++i)
+        FileIO_Reservations::deleteReservation(plate(i), sailing);
+    pass &= expect(Compactor::stats(Table::RESERVATIONS).dead == 40, "dead rows counted");
+    pass &= expect(!Compactor::compactionDue(), "not due below threshold");
+
+    for (int i = 41; i <= 80; ++i)
+        FileIO_Reservations::deleteReservation(plate(i), sailing);
+    TableStats before = Compactor::stats(Table::RESERVATIONS);
+    pass &= expect(before.dead == 80 && before.rows == 200, "80 of 200 rows dead");
+    pass &= expect(Compactor::compactionDue(), "due past threshold");
+
+    Compactor::compactIfNeeded();
+    TableStats after = Compactor::stats(Table::RESERVATIONS);
+    pass &= expect(after.rows == 120 && after.dead == 0, "compaction dropped exactly the dead rows");
+    pass &= expect(hookRuns == 1, "rebuild hook ran once");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing(sailing) == 120, "live rows intact");
+    pass &= expect(FileIO_Reservations::reservationExists(plate(0), sailing), "re-booked row survived");
+
+    // 3. Vessels and vehicles
+    Vessel::CreateVessel("Queen", 100, 200);
+    pass &= expect(Vessel::DeleteVessel("Queen") == VesselStatus::SUCCESS, "vessel deleted");
+    pass &= expect(!Vessel::isVesselExist("Queen"), "dead vessel invisible");
+    pass &= expect(Vessel::CreateVessel("Queen", 50, 60) == VesselStatus::SUCCESS, "vessel re-created");
+    unsigned int hcl = 0, lcl = 0;
+    FileIO_Vessel::getVesselByName("Queen", hcl, lcl);
+    pass &= expect(hcl == 50 && lcl == 60, "live vessel row wins");
+
+    VehicleRecord car{ "ABC123", "6045551234", 5, 1 };
+    FileIO_VehicleRecord::writeVehicle(car);
+    pass &= expect(FileIO_VehicleRecord::deleteVehicle("ABC123"), "vehicle deleted");
+    pass &= expect(!FileIO_VehicleRecord::vehicleExists("ABC123"), "dead vehicle invisible");
+    Vessel::shutdown();
+    pass &= expect(Compactor::stats(Table::VESSELS).rows == 1, "shutdown compacted vessels");
+
+    return finish("Compaction", pass);
+}
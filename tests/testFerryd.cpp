@@ -0,0 +1,233 @@
+// ---------------------------------------------------------------------------
+// testFerryd.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Runs the ferryd server in-process on a temporary socket and checks
+//   whole batches round-trip through FerryClient::call():
+//     1. A RESERVE batch books every new vehicle and refuses a repeat,
+//        each answer in its request's place.
+//     2. A QUERY batch reports the bookings, count and remaining space.
+//     3. A DELETE batch cancels them; a second QUERY batch sees the
+//        space back and no bookings; an unknown opcode is BAD_REQUEST.
+//     4. Terminals sending RESERVE batches at once are all served.
+//     5. More stalled terminals than workers, each part way through a
+//        frame, do not hold up a working terminal, and are disconnected
+//        after FerryServer::FRAME_TIMEOUT_MS.
+//   Also prints the round trip per batch.
+//
+//   Runs inside ../data/ferryd_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FerryClient.h"
+#include "FerryServer.h"
+#include "FileIO_Reservations.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <future>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+using Proto::OpCode;
+using Proto::RequestRec;
+using Proto::ResponseRec;
+using Proto::Status;
+
+static constexpr int VEHICLES = 50;
+static constexpr int TERMINALS = 8;
+static const char *SAILING = "VIC:05:08";
+
+// Space-pad a request field
+static void put(char *dest, std::size_t len, const std::string &src)
+{
+    for (std::size_t i = 0; i < len; ++i)
+        dest[i] = i < src.size() ? src[i] : ' ';
+}
+
+static RequestRec request(OpCode op, const std::string &license = "", const std::string &sailing = SAILING)
+{
+    RequestRec req = FerryClient::makeRequest(op);
+    put(req.license, sizeof(req.license), license);
+    put(req.sailingID, sizeof(req.sailingID), sailing);
+    return req;
+}
+
+static RequestRec reserveNew(const std::string &license)
+{
+    RequestRec req = request(OpCode::RESERVE_NEW, license);
+    put(req.phone, sizeof(req.phone), "6045550000");
+    req.arg0 = 5;                           // 5 m, low: 5.5 m of LCL
+    req.arg1 = 1;
+    return req;
+}
+
+static std::string plate(const char *prefix, int i)
+{
+    return prefix + std::to_string(100 + i);
+}
+
+static bool isStatus(const ResponseRec &res, Status status)
+{
+    return res.status == static_cast<std::uint8_t>(status);
+}
+
+// A terminal that sends the first `bytes` of a frame and then stops
+static int stallAfter(const std::string &socketPath, std::size_t bytes)
+{
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        return fd;
+    std::vector<unsigned char> frame(sizeof(Proto::FrameHeader) + sizeof(RequestRec));
+    Proto::FrameHeader hdr{ Proto::FRAME_MAGIC, 1, 0 };
+    std::memcpy(frame.data(), &hdr, sizeof(hdr));
+    Proto::sendAll(fd, frame.data(), std::min(bytes, frame.size()));
+    return fd;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/ferryd_test"))
+        return 1;
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    StorageBackend &store = StorageBackend::current();
+    store.open();
+    bool pass = store.writeVessel("Big", 2000, 2000);
+    pass &= store.writeSailing(SAILING, "Big", 2000.0f, 2000.0f);
+
+    std::string socketPath = (fs::temp_directory_path() / ("ferryd_test." + std::to_string(::getpid()) + ".sock")).string();
+    FerryServer server(socketPath, 4);
+    std::thread serving([&] { server.run(); });
+    FerryClient client;
+    for (int i = 0; i < 200 && !client.connect(socketPath); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pass &= expect(client.isConnected() && client.ping(), "server answering on the temp socket");
+
+    // 1. RESERVE batch: every vehicle new, the last one a repeat
+    std::vector<RequestRec> batch;
+    std::vector<ResponseRec> replies;
+    for (int i = 0; i < VEHICLES; ++i)
+        batch.push_back(reserveNew(plate("FD", i)));
+    batch.push_back(reserveNew(plate("FD", 0)));
+    auto start = std::chrono::steady_clock::now();
+    bool sent = client.call(batch, replies);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool booked = sent && replies.size() == batch.size();
+    for (std::size_t i = 0; booked && i < replies.size(); ++i)
+        booked = replies[i].op == batch[i].op && isStatus(replies[i], i < VEHICLES ? Status::OK : Status::FAILED);
+    pass &= expect(booked, "RESERVE batch answered in order, repeat refused");
+
+    // 2. QUERY batch
+    auto query = [&](bool expectBooked, int count, float lcl) {
+        std::vector<RequestRec> q;
+        for (int i = 0; i < VEHICLES; ++i)
+            q.push_back(request(OpCode::RESERVATION_EXISTS, plate("FD", i)));
+        q.push_back(request(OpCode::SAILING_COUNT));
+        q.push_back(request(OpCode::SAILING_SPACE));
+        q.push_back(request(OpCode::VEHICLE_EXISTS, plate("FD", 0)));
+        std::vector<ResponseRec> r;
+        if (!client.call(q, r) || r.size() != q.size())
+            return false;
+        bool ok = true;
+        for (int i = 0; i < VEHICLES; ++i)
+            ok &= isStatus(r[i], expectBooked ? Status::OK : Status::FAILED);
+        const ResponseRec &counted = r[VEHICLES], &space = r[VEHICLES + 1], &vehicle = r[VEHICLES + 2];
+        return ok && isStatus(counted, Status::OK) && counted.value == count &&
+               isStatus(space, Status::OK) && space.hcl == 2000.0f && std::fabs(space.lcl - lcl) < 0.01f &&
+               isStatus(vehicle, Status::OK);
+    };
+    pass &= expect(query(true, VEHICLES, 2000.0f - VEHICLES * 5.5f), "QUERY batch sees the bookings");
+
+    // 3. DELETE batch, one of them unknown, then the space is back
+    batch.clear();
+    for (int i = 0; i < VEHICLES; ++i)
+        batch.push_back(request(OpCode::RESERVATION_DELETE, plate("FD", i)));
+    batch.push_back(request(OpCode::RESERVATION_DELETE, "NOBODY"));
+    bool deleted = client.call(batch, replies) && replies.size() == batch.size();
+    for (std::size_t i = 0; deleted && i < replies.size(); ++i)
+        deleted = isStatus(replies[i], i < VEHICLES ? Status::OK : Status::FAILED);
+    pass &= expect(deleted, "DELETE batch cancelled every booking");
+    pass &= expect(query(false, 0, 2000.0f), "QUERY batch sees the space released");
+
+    batch.assign(1, request(OpCode::OP_COUNT));
+    pass &= expect(client.call(batch, replies) && replies.size() == 1 && isStatus(replies[0], Status::BAD_REQUEST),
+                   "unknown opcode answered BAD_REQUEST");
+
+    // 4. Terminals at once
+    std::vector<std::thread> terminals;
+    std::vector<char> served(TERMINALS, 0);
+    for (int t = 0; t < TERMINALS; ++t)
+    {
+        terminals.emplace_back([&, t] {
+            FerryClient terminal;
+            if (!terminal.connect(socketPath))
+                return;
+            std::vector<RequestRec> mine;
+            std::vector<ResponseRec> answers;
+            for (int i = 0; i < 10; ++i)
+                mine.push_back(reserveNew(plate("T", t * 10 + i)));
+            bool all = terminal.call(mine, answers) && answers.size() == mine.size();
+            for (const ResponseRec &res : answers)
+                all &= isStatus(res, Status::OK);
+            served[t] = all;
+        });
+    }
+    for (auto &t : terminals)
+        t.join();
+    pass &= expect(std::count(served.begin(), served.end(), 1) == TERMINALS && query(false, TERMINALS * 10,
+                   2000.0f - TERMINALS * 10 * 5.5f), "concurrent terminals all booked");
+
+    // 5. Stalled terminals: two in the header, four in the request
+    std::vector<int> stalled;
+    for (int i = 0; i < 6; ++i)
+        stalled.push_back(stallAfter(socketPath, i < 2 ? 3 : sizeof(Proto::FrameHeader) + 10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto answered = std::async(std::launch::async, [&] {
+        std::vector<ResponseRec> r;
+        std::vector<RequestRec> ping(1, request(OpCode::PING));
+        return client.call(ping, r) && r.size() == 1 && isStatus(r[0], Status::OK);
+    });
+    bool prompt = answered.wait_for(std::chrono::milliseconds(FerryServer::FRAME_TIMEOUT_MS / 2)) ==
+                  std::future_status::ready;
+    pass &= expect(prompt, "terminal served while others stall");
+    if (!prompt)
+        for (int fd : stalled)
+            ::shutdown(fd, SHUT_WR);            // let the old blocking workers go
+    pass &= expect(answered.get(), "ping answered");
+
+    bool dropped = true;
+    for (int fd : stalled)
+    {
+        pollfd p{ fd, POLLIN, 0 };
+        char b;
+        dropped &= ::poll(&p, 1, 2 * FerryServer::FRAME_TIMEOUT_MS) == 1 && ::recv(fd, &b, 1, 0) == 0;
+        ::close(fd);
+    }
+    pass &= expect(dropped, "stalled terminals disconnected");
+
+    client.disconnect();
+    server.requestStop();
+    serving.join();
+    pass &= expect(!fs::exists(socketPath), "socket removed on stop");
+    store.close();
+
+    std::cout << "RESERVE batch of " << VEHICLES + 1 << " round-tripped in " << secs * 1e3 << " ms\n";
+    return finish("Ferryd", pass);
+}
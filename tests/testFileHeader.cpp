@@ -0,0 +1,241 @@
+// ---------------------------------------------------------------------------
+// testFileHeader.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the data-file headers:
+//     1. A legacy headerless file is upgraded on open with its rows and
+//        dead rows counted, and still reads the same.
+//     2. New files get a header; row and dead-row counts follow appends,
+//        deletes, slot reuse and compaction without scanning the file.
+//     3. The generation moves on appends, reuse and compaction only.
+//     4. A header with another record size, schema version or byte order,
+//        or counting more rows than the file holds, is refused.
+//     5. Nothing is read from a file with a foreign or cut-off header, and
+//        a file ending in a partial record is refused on open.
+//     6. Processes upgrading the same legacy file at once leave it with
+//        one header and all of its rows.
+//     7. Another process's tombstone and slot reuse, which leave the
+//        file size alone, are seen here at once, and this process's next
+//        update keeps them.
+//
+//   Runs inside ../data/fileheader_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "DataFile.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_VehicleRecord.h"
+#include "FileIO_Vessel.h"
+#include "Metrics.h"
+#include "TestSupport.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+// Several processes open the same legacy file at once; it must end
+// up with one header and every row, whichever process upgrades it
+static bool concurrentUpgrade()
+{
+    const int ROWS = 50000, PROCESSES = 6;
+    std::vector<unsigned char> legacy;
+    {
+        std::ofstream out("legacy.dat", std::ios::binary);
+        for (int i = 0; i < ROWS; ++i)
+        {
+            VehicleRaw raw{};
+            encodeVehicle(VehicleRecord{ "L" + std::to_string(i), "6045551234", 5, 1 }, raw);
+            out.write(reinterpret_cast<const char*>(raw.data()), VEH_REC_BYTES);
+            legacy.insert(legacy.end(), raw.begin(), raw.end());
+        }
+    }
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; ++p)
+    {
+        pid_t pid = ::fork();
+        if (pid == 0)
+            std::_Exit(DataFile::upgrade("legacy.dat", VEH_REC_BYTES, VEH_STATUS_OFFSET) ? 0 : 1);
+        children.push_back(pid);
+    }
+    bool ok = true;
+    for (pid_t pid : children)
+    {
+        int status = 0;
+        ok &= ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::ifstream in("legacy.dat", std::ios::binary);
+    FileHeader h{};
+    std::vector<unsigned char> rows(legacy.size());
+    in.read(reinterpret_cast<char*>(&h), sizeof(h));
+    in.read(reinterpret_cast<char*>(rows.data()), static_cast<std::streamsize>(rows.size()));
+    return expect(ok, "every upgrader succeeded") &&
+           expect(fs::file_size("legacy.dat") == FILE_HEADER_BYTES + legacy.size() &&
+                  h.liveRows == static_cast<std::uint64_t>(ROWS) && rows == legacy,
+                  "one header, every row, after concurrent upgrades");
+}
+
+// vessels.dat holding only `h`
+static void writeVesselHeader(const FileHeader &h)
+{
+    std::ofstream out("vessels.dat", std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+int main()
+{
+    if (!enterTestDir("../data/fileheader_test"))
+        return 1;
+
+    // 1. Legacy vehicles.dat: five rows, one tombstoned
+    {
+        std::ofstream out("vehicles.dat", std::ios::binary);
+        for (int i = 0; i < 5; ++i)
+        {
+            VehicleRaw raw{};
+            encodeVehicle(VehicleRecord{ "OLD" + std::to_string(i), "6045551234", 5, 1 }, raw);
+            if (i == 3)
+                raw[VEH_STATUS_OFFSET] = REC_DEAD;
+            out.write(reinterpret_cast<const char*>(raw.data()), VEH_REC_BYTES);
+        }
+    }
+    bool pass = expect(DataFile::open(Table::VEHICLES), "legacy file opens");
+    FileHeader h{};
+    pass &= expect(DataFile::header(Table::VEHICLES, h) && h.liveRows == 4 && h.deadRows == 1,
+                   "upgrade counted rows");
+    pass &= expect(fs::file_size("vehicles.dat") == FILE_HEADER_BYTES + 5 * VEH_REC_BYTES,
+                   "header prepended");
+    VehicleRecord found;
+    pass &= expect(FileIO_VehicleRecord::findVehicle("OLD4", found) && found.license == "OLD4",
+                   "upgraded rows readable");
+    pass &= expect(!FileIO_VehicleRecord::findVehicle("OLD3", found), "dead row stays dead");
+
+    // 2. Fresh reservations.dat, counts kept by the header
+    for (int i = 0; i < 40; ++i)
+        FileIO_Reservations::writeReservation("R" + std::to_string(i), "VIC:01:08");
+    std::uint64_t gen = DataFile::generation(Table::RESERVATIONS);
+    for (int i = 0; i < 10; ++i)
+        FileIO_Reservations::deleteReservation("R" + std::to_string(i), "VIC:01:08");
+    pass &= expect(DataFile::generation(Table::RESERVATIONS) == gen, "deletes keep the generation");
+
+    DataFile::forget();     // counts must come back from the header, not a scan
+    std::uint64_t before = Metrics::threadRecordsScanned();
+    TableStats st = Compactor::stats(Table::RESERVATIONS);
+    pass &= expect(st.rows == 40 && st.dead == 10, "stats from the header");
+    pass &= expect(Metrics::threadRecordsScanned() == before, "no scan to count");
+
+    FileIO_Reservations::writeReservation("NEW", "VIC:01:08");
+    pass &= expect(DataFile::generation(Table::RESERVATIONS) == gen + 1, "reuse bumps the generation");
+    pass &= expect(DataFile::header(Table::RESERVATIONS, h) && h.liveRows == 31 && h.deadRows == 9,
+                   "reuse revives a dead row");
+
+    Compactor::compact(Table::RESERVATIONS);
+    pass &= expect(DataFile::header(Table::RESERVATIONS, h) && h.liveRows == 31 && h.deadRows == 0,
+                   "compaction clears dead rows");
+    pass &= expect(h.generation == gen + 2, "compaction bumps the generation");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:01:08") == 31, "rows intact");
+
+    // 3. Appends
+    FileIO_Vessel::writeVessel("Queen", 100, 200);
+    gen = DataFile::generation(Table::VESSELS);
+    FileIO_Vessel::writeVessel("Spirit", 120, 240);
+    pass &= expect(DataFile::generation(Table::VESSELS) == gen + 1, "append bumps the generation");
+    pass &= expect(DataFile::rows(Table::VESSELS) == 2, "appends counted");
+
+    // 4. Foreign headers
+    FileHeader good{};
+    pass &= expect(DataFile::header(Table::VESSELS, good), "vessel header");
+    good.liveRows = good.deadRows = 0;      // written below with no records
+
+    FileHeader bad = good;
+    bad.recordSize = sizeof(Vesselrec) + 2;
+    writeVesselHeader(bad);
+    pass &= expect(!DataFile::open(Table::VESSELS), "record size mismatch refused");
+
+    bad = good;
+    bad.version = DataFile::SCHEMA_VERSION + 1;
+    writeVesselHeader(bad);
+    pass &= expect(!DataFile::open(Table::VESSELS), "schema version mismatch refused");
+
+    bad = good;
+    bad.endianMark = 0x04030201;
+    writeVesselHeader(bad);
+    pass &= expect(!DataFile::open(Table::VESSELS), "byte order mismatch refused");
+
+    bad = good;
+    bad.liveRows = 1;
+    writeVesselHeader(bad);
+    pass &= expect(!DataFile::open(Table::VESSELS), "more rows than the file holds refused");
+
+    // 5. Readers read nothing past a header they cannot use
+    bad = good;
+    bad.liveRows = 1;
+    bad.version = DataFile::SCHEMA_VERSION + 1;
+    writeVesselHeader(bad);
+    {
+        Vesselrec rec{};
+        std::strncpy(rec.vesselName, "Ghost", sizeof(rec.vesselName) - 1);
+        std::ofstream out("vessels.dat", std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    }
+    unsigned int hcl = 0, lcl = 0;
+    pass &= expect(dataOffset(std::string("vessels.dat")) == BAD_HEADER, "foreign header flagged");
+    pass &= expect(!FileIO_Vessel::getVesselByName("Ghost", hcl, lcl), "no record read past it");
+    {
+        std::ofstream out("vessels.dat", std::ios::binary | std::ios::trunc);
+        out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    }
+    pass &= expect(dataOffset(std::string("vessels.dat")) == BAD_HEADER, "cut-off header flagged");
+
+    // A torn append: the header is fine, the last record is not whole
+    writeVesselHeader(good);
+    {
+        std::ofstream out("vessels.dat", std::ios::binary | std::ios::app);
+        out.write("torn", 4);
+    }
+    pass &= expect(!DataFile::open(Table::VESSELS), "partial last record refused");
+
+    writeVesselHeader(good);
+    FileIO_Vessel::writeVessel("Queen", 100, 200);
+    DataFile::forget();
+    pass &= expect(DataFile::open(Table::VESSELS) && DataFile::rows(Table::VESSELS) == 1,
+                   "valid header accepted, rows refitted to the file");
+
+    // 6. Upgrades racing in several processes
+    pass &= concurrentUpgrade();
+
+    // 7. A delete and a slot reuse in another process
+    FileHeader mine{};
+    pass &= expect(DataFile::header(Table::RESERVATIONS, mine), "header cached here");
+    pid_t child = ::fork();
+    if (child == 0)
+    {
+        bool ok = FileIO_Reservations::deleteReservation("R10", "VIC:01:08") &&
+                  FileIO_Reservations::deleteReservation("R11", "VIC:01:08") &&
+                  FileIO_Reservations::writeReservation("CHILD", "VIC:01:08");
+        std::_Exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    pass &= expect(::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                   "other process deleted and reused");
+    pass &= expect(DataFile::header(Table::RESERVATIONS, h) && h.liveRows == mine.liveRows - 1 &&
+                   h.deadRows == mine.deadRows + 1 && h.generation == mine.generation + 1,
+                   "its counts and generation seen here");
+    FileIO_Reservations::deleteReservation("R12", "VIC:01:08");
+    pass &= expect(DataFile::header(Table::RESERVATIONS, h) && h.liveRows == mine.liveRows - 2 &&
+                   h.deadRows == mine.deadRows + 2 && h.generation == mine.generation + 1,
+                   "an update here keeps them");
+
+    return finish("File header", pass);
+}
@@ -0,0 +1,87 @@
+// ---------------------------------------------------------------------------
+// testFixedString.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks FixedString<N> and the record types built on it:
+//     1. Compile time: trivially copyable, constexpr comparison and hash.
+//     2. Truncation to N characters, conversions to and from std::string.
+//     3. Use as a hash / ordered map key; VehicleRecord round-trips through
+//        the 32-byte on-disk encoding.
+//     4. A sailing ID fits the record's id field with its NUL: an
+//        over-long ID is stored and found again as the same 15 characters.
+//
+//   Runs inside ../data/fixedstring_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "CommonTypes.h"
+#include "FileIO_Sailings.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+#include "VehicleRecord.hpp"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+using namespace FerrySys;
+
+// 1. Compile-time properties
+static_assert(std::is_trivially_copyable_v<SailingID>);
+static_assert(std::is_trivially_copyable_v<VehicleRecord>);
+static_assert(sizeof(LicensePlate) == VEH_LIC_CHARS + 2);
+static_assert(SailingID("YVR:01:08") == SailingID("YVR:01:08"));
+static_assert(SailingID("YVR:01:08") < SailingID("YVR:01:09"));
+static_assert(SailingID("YVR:01:08").hash() != SailingID("YVR:01:09").hash());
+static_assert(LicensePlate("ABCDEFGHIJKLM").size() == VEH_LIC_CHARS);
+static_assert(SailingID::CAPACITY < sizeof(Sailingrec::id), "sailing IDs keep a NUL on file");
+
+int main()
+{
+    if (!enterTestDir("../data/fixedstring_test"))
+        return 1;
+
+    // 2. Truncation and conversions
+    std::string longPlate = "ABCDEFGHIJKLM";
+    LicensePlate plate = longPlate;
+    bool pass = expect(plate == "ABCDEFGHIJ" && std::string(plate.c_str()) == "ABCDEFGHIJ", "truncated to 10");
+    std::string back = plate;
+    pass &= expect(back == "ABCDEFGHIJ" && back == plate && plate == back, "std::string round-trip");
+    pass &= expect(LicensePlate().empty() && LicensePlate(nullptr).empty(), "empty values");
+    pass &= expect(SailingID("YVR:01:08").substr(4, 2) == "01", "substr");
+    std::ostringstream out;
+    out << SailingID("NAN:02:10");
+    pass &= expect(out.str() == "NAN:02:10", "stream output");
+
+    // 3. Keys and records
+    std::unordered_set<SailingID> ids = { "YVR:01:08", "YVR:01:09", "YVR:01:08" };
+    std::map<SailingID, int> ordered = { { "VIC:03:10", 1 }, { "NAN:02:10", 2 } };
+    pass &= expect(ids.size() == 2 && ids.count("YVR:01:09") == 1, "hash key");
+    pass &= expect(ordered.begin()->first == "NAN:02:10", "ordered key");
+
+    VehicleRecord in;
+    in.license = "AB123";
+    in.phone = "604-555-0100";
+    in.length_m = 5;
+    in.height_m = 2;
+    VehicleRaw raw{};
+    encodeVehicle(in, raw);
+    VehicleRecord decoded;
+    decodeVehicle(raw, decoded);
+    pass &= expect(vehicleEqual(in, decoded), "vehicle encode/decode");
+
+    // 4. Over-long sailing IDs on file
+    StorageBackend &store = StorageBackend::current();
+    const std::string longID = "ABCDEFGHIJKLMNOP";
+    Sailingrec rec{};
+    pass &= expect(store.writeSailing(longID, "Spirit", 10.0f, 10.0f) && store.findSailing(longID, rec),
+                   "16-character sailing ID found again");
+    pass &= expect(std::string(rec.id) == longID.substr(0, SailingID::CAPACITY), "stored as 15 characters");
+
+    return finish("FixedString", pass);
+}
@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------------
+// testFreeList.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks free-slot reuse:
+//     1. Deleted vehicles / reservations leave their slots on the free
+//        list, and new records fill them instead of growing the file.
+//     2. A listed slot that is not dead is never overwritten.
+//     3. Compaction clears the list.
+//     4. Processes popping the same list never get the same slot.
+//
+//   Runs inside ../data/freelist_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BinaryFileOps.hpp"
+#include "FileIO_Reservations.h"
+#include "FileIO_VehicleRecord.h"
+#include "FreeList.h"
+#include "TestSupport.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static VehicleRecord car(const std::string &license)
+{
+    return VehicleRecord{ license, "6045551234", 5, 1 };
+}
+
+// Processes popping one list at once; every listed slot must come out
+// exactly once
+static bool concurrentPops()
+{
+    const int VEHICLES = 2000, PROCESSES = 4;
+    for (int i = 0; i < VEHICLES; ++i)
+        FileIO_VehicleRecord::writeVehicle(car("P" + std::to_string(i)));
+    // Tombstoned in one pass, so no automatic compaction drops the list
+    std::size_t marked = 0;
+    std::vector<std::size_t> slots;
+    tombstoneRecordsIf("vehicles.dat", VEH_REC_BYTES, VEH_STATUS_OFFSET,
+                       [](const void *rec) {
+                           VehicleRaw raw{};
+                           std::memcpy(raw.data(), rec, VEH_REC_BYTES);
+                           VehicleRecord v;
+                           decodeVehicle(raw, v);
+                           return v.license.size() > 1 && v.license[0] == 'P';
+                       },
+                       marked, &slots);
+    FreeList::push(Table::VEHICLES, slots);
+    std::size_t listed = FreeList::size(Table::VEHICLES);
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; ++p)
+    {
+        pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            std::ofstream out("popped." + std::to_string(p));
+            std::size_t slot = 0;
+            while (FreeList::pop(Table::VEHICLES, slot))
+                out << slot << "\n";
+            out.close();
+            std::_Exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children)
+        ::waitpid(pid, nullptr, 0);
+
+    std::set<std::size_t> seen;
+    std::size_t popped = 0;
+    for (int p = 0; p < PROCESSES; ++p)
+    {
+        std::ifstream in("popped." + std::to_string(p));
+        std::size_t slot = 0;
+        while (in >> slot)
+        {
+            seen.insert(slot);
+            ++popped;
+        }
+    }
+    return expect(listed == VEHICLES && popped == listed && seen.size() == listed,
+                  "each slot popped once across processes");
+}
+
+int main()
+{
+    if (!enterTestDir("../data/freelist_test"))
+        return 1;
+
+    // 1. Vehicles
+    for (int i = 0; i < 10; ++i)
+        FileIO_VehicleRecord::writeVehicle(car("V" + std::to_string(i)));
+    auto bytes = fs::file_size("vehicles.dat");
+
+    FileIO_VehicleRecord::deleteVehicle("V2");
+    FileIO_VehicleRecord::deleteVehicle("V7");
+    bool pass = expect(FreeList::size(Table::VEHICLES) == 2, "two vehicle slots listed");
+
+    FileIO_VehicleRecord::writeVehicle(car("NEW1"));
+    FileIO_VehicleRecord::writeVehicle(car("NEW2"));
+    pass &= expect(fs::file_size("vehicles.dat") == bytes, "vehicle holes filled, no append");
+    pass &= expect(FreeList::size(Table::VEHICLES) == 0, "vehicle list drained");
+    pass &= expect(FileIO_VehicleRecord::vehicleExists("NEW1") &&
+                   FileIO_VehicleRecord::vehicleExists("NEW2"), "new vehicles readable");
+    pass &= expect(!FileIO_VehicleRecord::vehicleExists("V2") &&
+                   FileIO_VehicleRecord::vehicleExists("V3"), "neighbours untouched");
+    pass &= expect(Compactor::stats(Table::VEHICLES).dead == 0, "reused slots no longer dead");
+
+    FileIO_VehicleRecord::writeVehicle(car("NEW3"));
+    pass &= expect(fs::file_size("vehicles.dat") == bytes + VEH_REC_BYTES, "appends once list is empty");
+
+    // 1b. Reservations, including a cascade delete
+    for (int i = 0; i < 6; ++i)
+        FileIO_Reservations::writeReservation("R" + std::to_string(i), "YVR:01:08");
+    for (int i = 0; i < 6; ++i)
+        FileIO_Reservations::writeReservation("R" + std::to_string(i), "NAN:01:10");
+    bytes = fs::file_size("reservations.dat");
+
+    FileIO_Reservations::deleteReservationsForSailings({ "YVR:01:08" });
+    pass &= expect(FreeList::size(Table::RESERVATIONS) == 6, "cascade lists its slots");
+    for (int i = 0; i < 6; ++i)
+        FileIO_Reservations::writeReservation("S" + std::to_string(i), "NAN:01:10");
+    pass &= expect(fs::file_size("reservations.dat") == bytes, "reservation holes filled");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:01:10") == 12, "all bookings present");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:01:08") == 0, "cascaded rows stay gone");
+
+    // 2. A stale entry pointing at a live row is skipped
+    FreeList::push(Table::RESERVATIONS, { 0 });
+    FileIO_Reservations::writeReservation("T1", "NAN:01:10");
+    pass &= expect(fs::file_size("reservations.dat") == bytes + sizeof(ReservationRec), "stale slot not reused");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:01:10") == 13, "live row kept");
+
+    // 3. Compaction clears the list
+    FileIO_Reservations::deleteReservation("S0", "NAN:01:10");
+    pass &= expect(FreeList::size(Table::RESERVATIONS) == 1, "delete lists its slot");
+    Compactor::compact(Table::RESERVATIONS);
+    pass &= expect(FreeList::size(Table::RESERVATIONS) == 0, "compaction clears list");
+
+    // 4. Pops racing in several processes
+    pass &= concurrentPops();
+
+    return finish("Free list", pass);
+}
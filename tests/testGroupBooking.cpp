@@ -0,0 +1,118 @@
+// ---------------------------------------------------------------------------
+// testGroupBooking.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks fleet group bookings (BookingTransaction):
+//     1. A group of new vehicles is registered and booked, filling the LCL
+//        and overflowing to the HCL, and the space reaches sailings.dat.
+//     2. A group that does not fit, or holds a vehicle already on the
+//        sailing, changes nothing: no vehicle, reservation or space.
+//     3. High-ceiling vehicles only take HCL; duplicates, unknown sailings
+//        and empty groups are refused.
+//     4. Two groups racing for room for one: exactly one is booked.
+//   Also prints the time to commit a group.
+//
+//   Runs inside ../data/groupbooking_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BookingTransaction.h"
+#include "CapacityTable.h"
+#include "FileIO_Reservations.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace FerrySys;
+
+static BookingError book(const char *sailingID, const std::vector<VehicleRecord> &group)
+{
+    BookingTransaction booking(sailingID);
+    for (const VehicleRecord &v : group)
+        booking.add(v);
+    booking.commit();
+    return booking.error();
+}
+
+int main()
+{
+    if (!enterTestDir("../data/groupbooking_test"))
+        return 1;
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    StorageBackend &store = StorageBackend::current();
+    store.open();
+    CapacityTable::clear();
+
+    bool pass = store.writeVessel("Spirit", 40, 60);
+    for (const char *id : { "VIC:01:08", "VIC:02:08", "VIC:03:08" })
+        pass &= store.writeSailing(id, "Spirit", 40.0f, 60.0f);
+
+    // 1. Twenty new 4 m vehicles (4.5 m each): 13 in the LCL, 7 in the HCL
+    std::vector<VehicleRecord> fleet;
+    for (int i = 0; i < 20; ++i)
+        fleet.push_back(vehicle("FLT" + std::to_string(100 + i), 4, 1));
+    auto start = std::chrono::steady_clock::now();
+    pass &= expect(book("VIC:01:08", fleet) == BookingError::NONE, "fleet booked");
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool all = true;
+    for (const VehicleRecord &v : fleet)
+        all &= store.vehicleExists(v.license) && store.reservationExists(v.license, "VIC:01:08");
+    pass &= expect(all && store.countReservations("VIC:01:08") == 20, "every vehicle registered and booked");
+    pass &= expect(spaceIs(store, "VIC:01:08", 8.5f, 1.5f), "LCL filled first, rest on HCL, persisted");
+
+    // 2. Too big (13.5 m, 8.5 + 1.5 left) and already booked: nothing changes
+    pass &= expect(book("VIC:01:08", { fleet[0], vehicle("NEW1", 4, 1), vehicle("NEW2", 4, 1) }) ==
+                   BookingError::SAILING_FULL, "group too big refused");
+    pass &= expect(!store.vehicleExists("NEW1") && !store.vehicleExists("NEW2") &&
+                   store.countReservations("VIC:01:08") == 20 && spaceIs(store, "VIC:01:08", 8.5f, 1.5f),
+                   "refused group left no trace");
+
+    pass &= expect(book("VIC:02:08", { vehicle("ONE1", 4, 1) }) == BookingError::NONE, "single booked");
+    pass &= expect(book("VIC:02:08", { vehicle("NEW3", 4, 1), vehicle("ONE1", 4, 1) }) ==
+                   BookingError::ALREADY_BOOKED, "already booked refused");
+    float hcl = 0, lcl = 0;
+    pass &= expect(!store.vehicleExists("NEW3") && store.countReservations("VIC:02:08") == 1 &&
+                   CapacityTable::remaining("VIC:02:08", hcl, lcl) && hcl == 40.0f && lcl == 55.5f,
+                   "new vehicle and space rolled back");
+
+    // 3. High-ceiling vehicles and refusals
+    pass &= expect(book("VIC:02:08", { vehicle("TALL1", 10, 3), vehicle("TALL2", 10, 3) }) == BookingError::NONE,
+                   "high-ceiling pair booked");
+    pass &= expect(spaceIs(store, "VIC:02:08", 19.0f, 55.5f), "high-ceiling vehicles took HCL only");
+    pass &= expect(book("VIC:02:08", { vehicle("TALL3", 10, 3), vehicle("TALL4", 10, 3) }) ==
+                   BookingError::SAILING_FULL, "HCL short even with LCL free");
+    pass &= expect(book("VIC:02:08", { vehicle("DUP", 4, 1), vehicle("DUP", 4, 1) }) ==
+                   BookingError::DUPLICATE_VEHICLE, "duplicate refused");
+    pass &= expect(book("XYZ:01:01", { vehicle("LOST", 4, 1) }) == BookingError::UNKNOWN_SAILING,
+                   "unknown sailing refused");
+    pass &= expect(book("VIC:02:08", {}) == BookingError::EMPTY, "empty group refused");
+
+    // 4. Two groups of 12 (54 m each) racing for 100 m
+    BookingError results[2];
+    std::vector<std::thread> racers;
+    for (int g = 0; g < 2; ++g)
+    {
+        racers.emplace_back([&, g] {
+            std::vector<VehicleRecord> group;
+            for (int i = 0; i < 12; ++i)
+                group.push_back(vehicle("R" + std::to_string(g) + "V" + std::to_string(i), 4, 1));
+            results[g] = book("VIC:03:08", group);
+        });
+    }
+    for (auto &t : racers)
+        t.join();
+    int booked = (results[0] == BookingError::NONE) + (results[1] == BookingError::NONE);
+    pass &= expect(booked == 1 && store.countReservations("VIC:03:08") == 12, "exactly one racing group booked");
+
+    std::cout << "Group of " << fleet.size() << " committed in " << secs * 1e3 << " ms\n";
+    store.close();
+
+    return finish("GroupBooking", pass);
+}
@@ -0,0 +1,152 @@
+// ---------------------------------------------------------------------------
+// testIndexSnapshot.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the license / reservation / sailing index snapshots:
+//     1. The snapshots are built once and reopened without a rebuild.
+//     2. Lookups through them match the data files; absent keys are empty.
+//     3. New rows (appended or filling a deleted slot) are found at once
+//        and folded into the snapshot on close.
+//     4. Compaction, or a damaged snapshot file, forces one rebuild.
+//     5. Rows another process appends are read into the overlay on the
+//        next lookup, without a rebuild; its slot reuse forces one.
+//
+//   Runs inside ../data/indexsnapshot_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "Compaction.h"
+#include "FileIO_Reservations.h"
+#include "FileIO_VehicleRecord.h"
+#include "IndexSnapshot.h"
+#include "TestSupport.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static std::size_t builds()
+{
+    std::size_t n = 0;
+    for (int i = 0; i < static_cast<int>(KeyIndex::COUNT); ++i)
+        n += IndexSnapshot::stats(static_cast<KeyIndex>(i)).builds;
+    return n;
+}
+
+static const char *const SAILINGS[] = { "VIC:01:08", "VIC:01:12", "NAN:02:09" };
+
+//------------------------------------------------------------
+// Run `body` in a child process, as another terminal would
+template <class Fn>
+static bool inChild(Fn body)
+{
+    pid_t pid = ::fork();
+    if (pid == 0)
+        std::_Exit(body() ? 0 : 1);
+    int status = 0;
+    return pid > 0 && ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/indexsnapshot_test"))
+        return 1;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string license = "LIC" + std::to_string(i);
+        FileIO_VehicleRecord::writeVehicle(VehicleRecord{ license, "6045551234", 5, 1 });
+        FileIO_Reservations::writeReservation(license, SAILINGS[i % 3]);
+    }
+
+    // 1. Built on open, kept on close, mapped again without a rebuild
+    IndexSnapshot::open();
+    std::size_t built = builds();
+    bool pass = expect(built == 3, "three snapshots built");
+    IndexSnapshot::close();
+    for (int i = 0; i < static_cast<int>(KeyIndex::COUNT); ++i)
+        pass &= expect(fs::exists(IndexSnapshot::path(static_cast<KeyIndex>(i))), "snapshot file written");
+
+    IndexSnapshot::open();
+    pass &= expect(builds() == built, "reopened without a rebuild");
+    SnapshotStats st = IndexSnapshot::stats(KeyIndex::RESERVATION_SAILING);
+    pass &= expect(st.mapped && st.keys == 3 && st.entries == 300, "sailing index shape");
+
+    // 2. Lookups
+    VehicleRecord v;
+    pass &= expect(FileIO_VehicleRecord::findVehicle("LIC123", v) && v.license == "LIC123", "vehicle found");
+    pass &= expect(!FileIO_VehicleRecord::findVehicle("NOPE", v), "absent vehicle");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("vic:01:12") == 100, "sailing count");
+    pass &= expect(FileIO_Reservations::reservationExists("LIC4", "VIC:01:12"), "reservation found");
+    pass &= expect(!FileIO_Reservations::reservationExists("LIC4", "VIC:01:08"), "absent reservation");
+    std::vector<std::size_t> slots;
+    pass &= expect(IndexSnapshot::findSailingReservations("XXX:09:09", slots) && slots.empty(),
+                   "absent sailing empty");
+    pass &= expect(!FileIO_Reservations::writeReservation("lic7", "vic:01:12"), "duplicate refused");
+
+    // 3. Appends and slot reuse go to the overlay, then into the snapshot
+    FileIO_Reservations::writeReservation("NEW1", "VIC:01:08");
+    FileIO_Reservations::deleteReservation("LIC0", "VIC:01:08");
+    FileIO_Reservations::writeReservation("NEW2", "NAN:02:09");    // fills LIC0's slot
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:01:08") == 100, "delete and append seen");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:02:09") == 101, "reused slot seen");
+    pass &= expect(FileIO_Reservations::writeCheckin("NEW2", "NAN:02:09"), "check-in through the index");
+    pass &= expect(IndexSnapshot::stats(KeyIndex::RESERVATION_KEY).overlay == 2, "overlay holds new rows");
+    pass &= expect(builds() == built, "no rebuild for inserts");
+
+    IndexSnapshot::close();
+    IndexSnapshot::open();
+    st = IndexSnapshot::stats(KeyIndex::RESERVATION_KEY);
+    pass &= expect(st.overlay == 0 && st.entries == 302, "overlay merged on close");
+    pass &= expect(builds() == built, "merge is not a rebuild");
+    pass &= expect(FileIO_Reservations::reservationExists("NEW1", "VIC:01:08"), "merged row found");
+
+    // 4. Compaction moves slots: rebuilt on the next lookup
+    for (int i = 3; i < 120; i += 3)
+        FileIO_Reservations::deleteReservation("LIC" + std::to_string(i), "VIC:01:08");
+    Compactor::compact(Table::RESERVATIONS);
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:01:08") == 61, "count after compaction");
+    pass &= expect(FileIO_Reservations::reservationExists("LIC120", "VIC:01:08") &&
+                   !FileIO_Reservations::reservationExists("LIC3", "VIC:01:08"), "lookups after compaction");
+    pass &= expect(builds() == built + 2, "reservation indexes rebuilt");
+    built = builds();
+
+    IndexSnapshot::close();
+    fs::resize_file(IndexSnapshot::path(KeyIndex::VEHICLE_LICENSE), 10);
+    IndexSnapshot::open();
+    pass &= expect(builds() == built + 1, "damaged snapshot rebuilt");
+    pass &= expect(FileIO_VehicleRecord::findVehicle("LIC299", v), "vehicle found after rebuild");
+    built = builds();
+
+    // 5. Another process's appends are replayed; its slot reuse is not
+    pass &= expect(inChild([] {
+        return FileIO_VehicleRecord::writeVehicle(VehicleRecord{ "CHILD1", "6045551234", 5, 1 }) &&
+               FileIO_Reservations::writeReservation("CHILD1", "VIC:01:08") &&
+               FileIO_Reservations::writeReservation("CHILD2", "VIC:01:08");
+    }), "child appended rows");
+    pass &= expect(FileIO_VehicleRecord::findVehicle("CHILD1", v) &&
+                   FileIO_Reservations::reservationExists("CHILD2", "VIC:01:08") &&
+                   FileIO_Reservations::countReservationsForSailing("VIC:01:08") == 63, "child's rows found");
+    pass &= expect(builds() == built, "appends replayed without a rebuild");
+    pass &= expect(IndexSnapshot::stats(KeyIndex::RESERVATION_SAILING).overlay == 2, "appended rows in the overlay");
+
+    pass &= expect(inChild([] {
+        return FileIO_Reservations::deleteReservation("CHILD1", "VIC:01:08") &&
+               FileIO_Reservations::writeReservation("CHILD3", "NAN:02:09");     // fills CHILD1's slot
+    }), "child reused a slot");
+    pass &= expect(FileIO_Reservations::reservationExists("CHILD3", "NAN:02:09") &&
+                   !FileIO_Reservations::reservationExists("CHILD1", "VIC:01:08"), "reused slot seen");
+    pass &= expect(builds() > built, "slot reuse rebuilt");
+    IndexSnapshot::close();
+
+    return finish("Index snapshot", pass);
+}
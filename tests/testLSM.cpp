@@ -0,0 +1,147 @@
+// ---------------------------------------------------------------------------
+// testLSM.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the log-structured reservation store:
+//     1. Bookings left only in the write-ahead log by a process that
+//        exited without shutting down are replayed on startup.
+//     2. Switching to LSM loads reservations.dat and drops cancelled rows.
+//     3. Bookings past the memtable size flush to runs; duplicates,
+//        check-in, cancellation and counts see every run.
+//     4. Merging leaves one run without cancelled rows, and Bloom
+//        filters keep lookups of absent keys from reading blocks.
+//     5. Data survives close() and reopening.
+//     6. While one process has the store open, another is refused.
+//
+//   Runs inside ../data/lsm_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FileIO_Reservations.h"
+#include "Metrics.h"
+#include "ReservationLSM.h"
+#include "TestSupport.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+int main()
+{
+    if (!enterTestDir("../data/lsm_test"))
+        return 1;
+
+    // 1. A child books and exits without flushing
+    pid_t child = fork();
+    if (child == 0)
+    {
+        for (int i = 0; i < 9; ++i)
+            ReservationLSM::write("WAL" + std::to_string(i), "ABC:01:01");
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    bool pass = expect(ReservationLSM::stats().walRows == 9, "log replayed");
+
+    // 2. Flat file, then migrate
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    for (const char *id : { "YVR:29:14", "NAN:01:08" })
+    {
+        for (int i = 0; i < 20; ++i)
+            FileIO_Reservations::writeReservation("P" + std::to_string(i), id);
+    }
+    FileIO_Reservations::deleteReservation("P0", "NAN:01:08");
+    FileIO_Reservations::setStorageMode(ReservationStorage::LSM);
+
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("abc:01:01") == 9, "replayed rows visible");
+    pass &= expect(!fs::exists("reservations.dat") && fs::exists("reservations.dat.migrated"), "flat file set aside");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:29:14") == 20, "rows moved");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:01:08") == 19, "dead row dropped");
+
+    // 3. Enough bookings to flush several runs
+    const int BULK = static_cast<int>(ReservationLSM::MEMTABLE_ROWS) * 3;
+    for (int i = 0; i < BULK; ++i)
+        FileIO_Reservations::writeReservation("B" + std::to_string(i), "VIC:" + std::to_string(10 + i % 16) + ":00");
+    pass &= expect(ReservationLSM::stats().memtableRows < ReservationLSM::MEMTABLE_ROWS, "memtable flushed");
+    pass &= expect(!FileIO_Reservations::writeReservation("p5", "yvr:29:14"), "duplicate in a run rejected");
+    pass &= expect(!FileIO_Reservations::writeReservation("B7", "VIC:17:00"), "duplicate in another run rejected");
+    pass &= expect(FileIO_Reservations::writeCheckin("B7", "VIC:17:00"), "check-in");
+    pass &= expect(FileIO_Reservations::reservationExists("P3", "YVR:29:14"), "exists (exact)");
+    pass &= expect(!FileIO_Reservations::reservationExists("p3", "YVR:29:14"), "exists is case-sensitive");
+    for (int i = 0; i < BULK; i += 2)
+        FileIO_Reservations::deleteReservation("B" + std::to_string(i), "VIC:" + std::to_string(10 + i % 16) + ":00");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:11:00") == BULK / 16, "odd rows kept");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("VIC:10:00") == 0, "even rows cancelled");
+    pass &= expect(FileIO_Reservations::writeReservation("B0", "VIC:10:00"), "rebook after cancel");
+
+    std::string license;
+    SailingID id;
+    bool checkedIn = false, sawCheckin = false;
+    int rows = 0;
+    FileIO_Reservations::reset();
+    while (FileIO_Reservations::getNextReservation(license, id, checkedIn))
+    {
+        ++rows;
+        sawCheckin |= (license == "B7" && checkedIn);
+    }
+    int live = 9 + 20 + 19 + BULK / 2 + 1;
+    pass &= expect(rows == live && sawCheckin, "sequential read sees newest versions");
+
+    // 4. Merge and filters
+    ReservationLSM::flush();
+    ReservationLSM::compact();
+    LSMStats st = ReservationLSM::stats();
+    pass &= expect(st.runs == 1 && st.runRows == static_cast<std::size_t>(live), "one run, cancellations dropped");
+
+    std::uint64_t before = Metrics::threadRecordsScanned();
+    int found = 0;
+    for (int i = 0; i < 1000; ++i)
+        found += FileIO_Reservations::reservationExists("NONE" + std::to_string(i), "VIC:11:00");
+    std::uint64_t scanned = Metrics::threadRecordsScanned() - before;
+    pass &= expect(found == 0 && scanned < 1000 * ReservationLSM::BLOCK_ROWS / 20, "Bloom filter skips absent keys");
+
+    // 5. Cascade, then reopen from disk (ABC, YVR, odd VIC hours, VIC:10)
+    pass &= expect(FileIO_Reservations::deleteReservationsForSailings({ "NAN:01:08" }) == 19, "cascade cancels a sailing");
+    ReservationLSM::close();
+    pass &= expect(ReservationLSM::stats().walRows == 0, "close flushed the log");
+    std::unordered_map<std::string, int> counts;
+    pass &= expect(FileIO_Reservations::countReservationsBySailing(counts) && counts.size() == 2 + 8 + 1,
+                   "sailings after reopen");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:01:08") == 0, "cascade persisted");
+    pass &= expect(FileIO_Reservations::reservationExists("B0", "VIC:10:00"), "rebooked row persisted");
+    ReservationLSM::close();
+
+    // 6. A second process is refused while the first has the store open
+    int ready[2], done[2];
+    pass &= expect(::pipe(ready) == 0 && ::pipe(done) == 0, "pipes");
+    child = fork();
+    if (child == 0)
+    {
+        char c = 0;
+        bool owned = ReservationLSM::write("OWNER", "OWN:01:01");
+        ssize_t n = ::write(ready[1], &c, 1);
+        n = ::read(done[0], &c, 1);
+        (void)n;
+        ReservationLSM::close();
+        _exit(owned ? 0 : 1);
+    }
+    char c = 0;
+    pass &= expect(::read(ready[0], &c, 1) == 1, "owner started");
+    pass &= expect(!ReservationLSM::write("OTHER", "OWN:01:01") &&
+                   ReservationLSM::count("OWN:01:01") == 0, "second process refused");
+    pass &= expect(::write(done[1], &c, 1) == 1 && waitpid(child, &status, 0) == child &&
+                   WIFEXITED(status) && WEXITSTATUS(status) == 0, "owner booked and exited");
+    pass &= expect(ReservationLSM::count("OWN:01:01") == 1 &&
+                   ReservationLSM::write("OTHER", "OWN:01:01"), "store usable once released");
+    ReservationLSM::close();
+
+    return finish("LSM", pass);
+}
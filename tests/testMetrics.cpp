@@ -0,0 +1,87 @@
+// ---------------------------------------------------------------------------
+// testMetrics.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the metrics surface:
+//     1. Percentiles from the log-linear histogram land within one bucket
+//        (~6%) of the exact values.
+//     2. Counters recorded on several threads are all merged.
+//     3. A FileIO lookup is timed and charged with the records it scanned.
+//
+//   Runs inside ../data/metrics_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FileIO_Sailings.h"
+#include "Metrics.h"
+#include "TestSupport.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace FerrySys;
+
+static bool near(std::uint64_t got, std::uint64_t want)
+{
+    return got >= want && got <= want + want / 16 + 1;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/metrics_test"))
+        return 1;
+
+    bool pass = true;
+
+    // 1. Latencies 1..1000 us, one call each
+    int op = Metrics::registerOp("test::synthetic");
+    pass &= expect(Metrics::registerOp("test::synthetic") == op, "same name -> same id");
+    for (std::uint64_t us = 1; us <= 1000; ++us)
+        Metrics::recordLatency(op, us * 1000, 0);
+
+    MetricsSnapshot snap = Metrics::snapshot();
+    const OpStats *s = snap.find("test::synthetic");
+    pass &= expect(s && s->calls == 1000, "1000 calls recorded");
+    if (s)
+    {
+        pass &= expect(near(s->p50Ns, 500000), "p50 ~ 500 us");
+        pass &= expect(near(s->p90Ns, 900000), "p90 ~ 900 us");
+        pass &= expect(near(s->p99Ns, 990000), "p99 ~ 990 us");
+        pass &= expect(s->maxNs == 1000000, "max exact");
+    }
+
+    // 2. Counters from 4 threads
+    std::uint64_t before = snap.counter(Counter::BYTES_WRITTEN);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([] { for (int i = 0; i < 10000; ++i) Metrics::add(Counter::BYTES_WRITTEN, 3); });
+    for (auto &t : threads)
+        t.join();
+    snap = Metrics::snapshot();
+    pass &= expect(snap.counter(Counter::BYTES_WRITTEN) - before == 120000, "per-thread counters merged");
+
+    // 3. A miss on a 50-row sailings file scans all 50 rows
+    for (int i = 0; i < 50; ++i)
+        FileIO_Sailings::writeSailing("AAA:" + std::to_string(10 + i % 20) + ":" + std::to_string(10 + i), "Queen", 10, 10);
+    Sailingrec rec{};
+    FileIO_Sailings::findSailing("ZZZ:01:01", rec);
+    snap = Metrics::snapshot();
+    s = snap.find("FileIO_Sailings::findSailing");
+    pass &= expect(s && s->calls == 1 && s->recordsScanned == 50, "findSailing charged 50 records");
+
+    std::ostringstream text;
+    text << std::setprecision(2);
+    Metrics::dump(text);
+    pass &= expect(text.str().find("FileIO_Sailings::writeSailing") != std::string::npos, "dump lists operations");
+    text.str("");
+    text << 2.0 / 3.0;
+    pass &= expect(text.str() == "0.67" && text.precision() == 2 && !(text.flags() & std::ios::fixed) &&
+                   !(text.flags() & std::ios::left), "dump leaves the stream format alone");
+
+    return finish("Metrics", pass);
+}
@@ -0,0 +1,137 @@
+// ---------------------------------------------------------------------------
+// testNextSailing.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the "next sailing with room" query:
+//     1. A small route gives the expected sailings for high-ceiling and
+//        ordinary vehicles, from several starting times.
+//     2. Over many routes, the flat-file engine (SailingTable's route
+//        trees) agrees with the plain scan of StorageBackend's default
+//        after space updates, new sailings and deletes.
+//   Also prints microseconds per query.
+//
+//   Runs inside ../data/nextsailing_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "CapacityTable.h"
+#include "FileIO_Sailings.h"
+#include "FlatFileBackend.h"
+#include "TestSupport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace FerrySys;
+
+static std::string sailingID(const std::string &city, int day, int hour)
+{
+    char id[16];
+    std::snprintf(id, sizeof(id), "%s:%02d:%02d", city.c_str(), day, hour);
+    return id;
+}
+
+static std::string idsOf(const std::vector<Sailingrec> &rows)
+{
+    std::string text;
+    for (const Sailingrec &rec : rows)
+        text += std::string(rec.id) + " ";
+    return text;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/nextsailing_test"))
+        return 1;
+
+    FlatFileBackend flat;
+    const std::int32_t sevenMetres = CapacityTable::vehicleSpaceCm(7.0f);
+
+    // 1. One small route
+    flat.writeSailing("VIC:01:08", "Spirit", 0.0f, 10.0f);
+    flat.writeSailing("VIC:01:10", "Spirit", 20.0f, 0.0f);
+    flat.writeSailing("VIC:02:06", "Spirit", 30.0f, 30.0f);
+    flat.writeSailing("NAN:01:09", "Coastal", 30.0f, 30.0f);
+
+    bool pass = true;
+    pass &= expect(idsOf(flat.availableSailings("VIC", 1, 0, sevenMetres, true, 5)) == "VIC:01:10 VIC:02:06 ",
+                   "high-ceiling vehicle skips the full HCL");
+    pass &= expect(idsOf(flat.availableSailings("VIC", 1, 0, sevenMetres, false, 5)) ==
+                   "VIC:01:08 VIC:01:10 VIC:02:06 ", "ordinary vehicle uses either lane");
+    pass &= expect(idsOf(flat.availableSailings("VIC", 1, 9, sevenMetres, false, 1)) == "VIC:01:10 ",
+                   "starts at the given hour, stops at max");
+    pass &= expect(flat.availableSailings("VIC", 2, 7, sevenMetres, false, 5).empty(), "nothing after the last");
+    pass &= expect(flat.availableSailings("VIC", 1, 0, CapacityTable::vehicleSpaceCm(40.0f), false, 5).empty(),
+                   "nothing long enough");
+    pass &= expect(flat.availableSailings("XYZ", 1, 0, sevenMetres, false, 5).empty(), "unknown city");
+
+    FileIO_Sailings::updateSailingSpace("VIC:01:10", 7.0f, 3.0f, -1);     // takes 7.5 m of HCL
+    pass &= expect(idsOf(flat.availableSailings("VIC", 1, 0, sevenMetres, true, 5)) == "VIC:01:10 VIC:02:06 ",
+                   "12.5 m still fits");
+    FileIO_Sailings::updateSailingSpace("VIC:01:10", 7.0f, 3.0f, -1);
+    pass &= expect(idsOf(flat.availableSailings("VIC", 1, 0, sevenMetres, true, 5)) == "VIC:02:06 ",
+                   "space update seen");
+
+    // 2. Many routes against the plain scan
+    const std::vector<std::string> cities = { "VIC", "NAN", "BOW", "SAL", "TSA" };
+    std::mt19937 rng(276);
+    std::uniform_real_distribution<float> space(0.0f, 40.0f);
+    for (const std::string &city : cities)
+    {
+        for (int day = 3; day <= 28; ++day)
+        {
+            for (int hour = 0; hour < 24; hour += 2)
+                flat.writeSailing(sailingID(city, day, hour), "Vessel", space(rng), space(rng));
+        }
+    }
+
+    long queries = 0;
+    double seconds = 0.0;
+    auto agree = [&](int rounds) {
+        bool same = true;
+        for (int i = 0; i < rounds; ++i)
+        {
+            const std::string &city = cities[rng() % cities.size()];
+            int day = static_cast<int>(rng() % 28) + 1;
+            int hour = static_cast<int>(rng() % 24);
+            std::int32_t need = CapacityTable::vehicleSpaceCm(static_cast<float>(rng() % 36));
+            bool high = rng() % 2 == 0;
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Sailingrec> fast = flat.availableSailings(city, day, hour, need, high, 5);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ++queries;
+            std::vector<Sailingrec> slow = flat.StorageBackend::availableSailings(city, day, hour, need, high, 5);
+            same &= idsOf(fast) == idsOf(slow);
+        }
+        return same;
+    };
+
+    pass &= expect(agree(2000), "route trees match the scan");
+
+    for (int i = 0; i < 500; ++i)
+    {
+        std::string id = sailingID(cities[rng() % cities.size()], static_cast<int>(rng() % 26) + 3,
+                                   static_cast<int>(rng() % 12) * 2);
+        flat.setRemainingSpace(id, space(rng), space(rng));
+    }
+    pass &= expect(agree(2000), "match after space updates");
+
+    for (const std::string &city : cities)
+        flat.writeSailing(sailingID(city, 15, 1), "Vessel", 40.0f, 40.0f);
+    std::vector<SailingID> removed;
+    flat.deleteSailings({ sailingID("VIC", 10, 0), sailingID("NAN", 20, 12) }, removed);
+    flat.deleteSailingsOnDay("25", removed);
+    pass &= expect(agree(2000), "match after new and deleted sailings");
+
+    std::cout << "availableSailings over " << cities.size() * 26 * 12 << " sailings: "
+              << seconds * 1e6 / static_cast<double>(queries) << " us/query\n";
+
+    return finish("NextSailing", pass);
+}
@@ -0,0 +1,265 @@
+// ---------------------------------------------------------------------------
+// testParallelScan.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the work-stealing pool and the parallel file scan:
+//     1. Jobs queued on one worker's own deque, while that worker is
+//        busy, are stolen and run by the others.
+//     2. TaskGroup::wait runs pending jobs itself: a job waiting on its
+//        children on a one-worker pool finishes, and an outside caller
+//        runs jobs while the only worker is blocked.
+//     3. splitRecords covers [0, n) with adjacent chunks for sizes around
+//        the inline threshold and chunk bounds.
+//     4. parallelScan visits every record exactly once, with the right
+//        index and bytes, across chunk edges, with and without a file
+//        header.
+//     5. A chunk that cannot be read fails instead of coming back short
+//        (a chunk the file has shrunk away from is still fine), and a
+//        scan of a file with an unreadable header fails.
+//   Also prints the speed-up of a full-file count over one thread.
+//
+//   Runs inside ../data/parallelscan_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BinaryFileOps.hpp"
+#include "ParallelScan.h"
+#include "TestSupport.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace FerrySys;
+
+static constexpr std::size_t REC = 24;     // index, then filler
+
+//------------------------------------------------------------
+// Run `body` on its own thread; a deadlock is reported as a
+// failure instead of hanging the test
+template <class Fn>
+static bool finishes(Fn body, const std::string &what)
+{
+    auto done = std::async(std::launch::async, body);
+    if (done.wait_for(std::chrono::seconds(10)) == std::future_status::ready)
+        return expect(done.get(), what);
+    std::cerr << "FAIL: " << what << " (deadlocked)\n";
+    std::cout << "ParallelScan test FAIL\n";
+    std::_Exit(1);
+}
+
+//------------------------------------------------------------
+// `records` records numbered from 0, after a FileHeader if
+// `header`
+static void writeFile(const std::string &path, std::size_t records, bool header)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (header)
+    {
+        FileHeader h{};
+        std::memcpy(h.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        h.version = FILE_SCHEMA_VERSION;
+        h.headerBytes = FILE_HEADER_BYTES;
+        h.recordSize = REC;
+        h.endianMark = FILE_ENDIAN_MARK;
+        h.liveRows = records;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    }
+    std::vector<unsigned char> buf(REC * 4096);
+    for (std::size_t first = 0; first < records; first += 4096)
+    {
+        std::size_t n = std::min<std::size_t>(4096, records - first);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::uint64_t index = first + i;
+            std::memcpy(&buf[i * REC], &index, sizeof(index));
+            std::memset(&buf[i * REC + sizeof(index)], static_cast<int>(index & 0xFF), REC - sizeof(index));
+        }
+        out.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(n * REC));
+    }
+}
+
+//------------------------------------------------------------
+// 4. Each record seen once, at its own index, bytes intact
+static bool scanOnce(const std::string &path, std::size_t records)
+{
+    struct Seen
+    {
+        std::vector<std::uint64_t> indexes;
+        bool                       intact = true;
+    };
+    Seen seen;
+    bool scanned = parallelScan(path, REC, seen,
+        [](Seen &part, std::size_t index, const unsigned char *bytes) {
+            std::uint64_t stored;
+            std::memcpy(&stored, bytes, sizeof(stored));
+            part.intact &= stored == index && bytes[REC - 1] == static_cast<unsigned char>(index & 0xFF);
+            part.indexes.push_back(index);
+        },
+        [](Seen &into, Seen &&from) {
+            into.intact &= from.intact;
+            into.indexes.insert(into.indexes.end(), from.indexes.begin(), from.indexes.end());
+        });
+
+    bool inOrder = seen.indexes.size() == records;
+    for (std::size_t i = 0; inOrder && i < records; ++i)
+        inOrder = seen.indexes[i] == i;
+    return scanned && seen.intact && inOrder;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/parallelscan_test"))
+        return 1;
+
+    // 1. Work stealing: a busy worker's own jobs run elsewhere
+    bool pass = finishes([] {
+        ThreadPool pool(4);
+        constexpr int JOBS = 64;
+        std::atomic<int> ran{ 0 };
+        std::mutex idsLock;
+        std::set<std::thread::id> ids;
+        std::thread::id owner;
+        std::promise<void> queued;
+        pool.submit([&] {
+            owner = std::this_thread::get_id();
+            for (int i = 0; i < JOBS; ++i)          // onto this worker's deque
+            {
+                pool.submit([&] {
+                    {
+                        std::lock_guard<std::mutex> guard(idsLock);
+                        ids.insert(std::this_thread::get_id());
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    ran.fetch_add(1);
+                });
+            }
+            while (ran.load() < JOBS)               // busy: never runs its own
+                std::this_thread::yield();
+            queued.set_value();
+        });
+        queued.get_future().wait();
+        return ran.load() == JOBS && ids.size() >= 2 && ids.count(owner) == 0;
+    }, "jobs stolen from a busy worker");
+
+    // 2. TaskGroup::wait helps: nested wait on a one-worker pool
+    pass &= finishes([] {
+        ThreadPool pool(1);
+        std::atomic<int> ran{ 0 };
+        std::promise<void> finished;
+        pool.submit([&] {
+            TaskGroup group(pool);
+            for (int i = 0; i < 16; ++i)
+                group.run([&] { ran.fetch_add(1); });
+            group.wait();                           // the only worker: must run them
+            finished.set_value();
+        });
+        finished.get_future().wait();
+        return ran.load() == 16;
+    }, "TaskGroup::wait inside the only worker runs its jobs");
+
+    // ...and an outside waiter runs jobs while the worker is blocked
+    pass &= finishes([] {
+        ThreadPool pool(1);
+        std::promise<void> release, started;
+        std::shared_future<void> released = release.get_future().share();
+        pool.submit([released, &started] {
+            started.set_value();
+            released.wait();
+        });
+        started.get_future().wait();                // the worker is held
+        TaskGroup group(pool);
+        std::vector<std::thread::id> ranOn(8);
+        for (std::size_t i = 0; i < ranOn.size(); ++i)
+            group.run([&ranOn, i] { ranOn[i] = std::this_thread::get_id(); });
+        group.wait();
+        release.set_value();
+        return std::all_of(ranOn.begin(), ranOn.end(),
+                           [](std::thread::id id) { return id == std::this_thread::get_id(); });
+    }, "TaskGroup::wait runs jobs on the waiting thread");
+
+    // 3. Chunks are adjacent and cover every record
+    bool covered = true;
+    for (std::size_t total : { std::size_t{ 0 }, std::size_t{ 1 }, SCAN_MIN_PARALLEL - 1, SCAN_MIN_PARALLEL,
+                               SCAN_MIN_PARALLEL + 1, SCAN_CHUNK_RECORDS * 40 - 1, SCAN_CHUNK_RECORDS * 40 + 1 })
+    {
+        for (std::size_t workers : { 1, 3, 8, 64 })
+        {
+            std::size_t next = 0;
+            for (const ScanChunk &chunk : splitRecords(total, workers))
+            {
+                covered &= chunk.first == next && chunk.count > 0 && chunk.count <= SCAN_CHUNK_RECORDS;
+                next = chunk.first + chunk.count;
+            }
+            covered &= next == total;
+        }
+    }
+    pass &= expect(covered, "chunks adjacent and complete");
+
+    // 4. Exactly once across chunk edges
+    for (std::size_t records : { SCAN_MIN_PARALLEL - 1, SCAN_MIN_PARALLEL * 5 + 37, SCAN_CHUNK_RECORDS * 3 + 1 })
+    {
+        for (bool header : { false, true })
+        {
+            writeFile("records.dat", records, header);
+            pass &= expect(scanOnce("records.dat", records),
+                           std::to_string(records) + " records" + (header ? " after a header" : "") +
+                           ": each visited once");
+        }
+    }
+
+    // 5. Reads that fail are reported, not dropped
+    std::vector<unsigned char> buf;
+    std::filesystem::create_directory("unreadable.dat");
+    pass &= expect(!readChunk("unreadable.dat", REC, 0, ScanChunk{ 0, 10 }, buf) && buf.empty(),
+                   "unreadable chunk fails");
+    pass &= expect(!readChunk("missing.dat", REC, 0, ScanChunk{ 0, 10 }, buf), "missing file fails");
+    writeFile("records.dat", 100, true);
+    pass &= expect(readChunk("records.dat", REC, FILE_HEADER_BYTES, ScanChunk{ 90, 20 }, buf) &&
+                   buf.size() == 10 * REC, "chunk the file ends inside keeps its whole records");
+    std::size_t none = 0;
+    pass &= expect(!parallelScan("records.dat", REC + 8, none,
+                                 [](std::size_t &n, std::size_t, const unsigned char *) { ++n; },
+                                 [](std::size_t &into, std::size_t &&from) { into += from; }),
+                   "scan with an unreadable header fails");
+
+    // Timing: a full-file count against one thread reading the same file
+    const std::size_t BIG = 2000000;
+    writeFile("big.dat", BIG, true);
+    auto start = std::chrono::steady_clock::now();
+    std::size_t counted = 0;
+    bool scanned = parallelScan("big.dat", REC, counted,
+        [](std::size_t &n, std::size_t, const unsigned char *bytes) { n += bytes[REC - 1] == 7; },
+        [](std::size_t &into, std::size_t &&from) { into += from; });
+    double parallelSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::size_t serial = 0;
+    std::vector<unsigned char> all;
+    if (readChunk("big.dat", REC, FILE_HEADER_BYTES, ScanChunk{ 0, BIG }, all))
+    {
+        for (std::size_t i = 0; i < BIG; ++i)
+            serial += all[i * REC + REC - 1] == 7;
+    }
+    double serialSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    pass &= expect(scanned && counted == BIG / 256 + (BIG % 256 > 7) && counted == serial, "parallel count matches");
+    std::cout << "Count of " << BIG << " records: " << parallelSecs * 1e3 << " ms on " << scanPool().size()
+              << " workers, " << serialSecs * 1e3 << " ms on one (x" << serialSecs / parallelSecs << ")\n";
+
+    return finish("ParallelScan", pass);
+}
@@ -0,0 +1,91 @@
+// ---------------------------------------------------------------------------
+// testPartitions.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks partitioned reservation storage:
+//     1. Switching to PARTITIONED splits reservations.dat by sailing and
+//        drops cancelled rows.
+//     2. Bookings, duplicates, check-in, cancellation (swap-delete) and
+//        counts work on one partition file.
+//     3. Deleting a sailing unlinks its partition and catalog entry.
+//
+//   Runs inside ../data/partitions_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FileIO_Reservations.h"
+#include "FileIO_Sailings.h"
+#include "ReservationPartitions.h"
+#include "TestSupport.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+int main()
+{
+    if (!enterTestDir("../data/partitions_test"))
+        return 1;
+
+    // 1. Flat file, then migrate
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    const char *sailings[] = { "YVR:29:14", "NAN:01:08", "vic:02:10" };
+    for (const char *id : sailings)
+    {
+        FileIO_Sailings::writeSailing(id, "Queen", 100.0f, 200.0f);
+        for (int i = 0; i < 20; ++i)
+            FileIO_Reservations::writeReservation("P" + std::to_string(i), id);
+    }
+    FileIO_Reservations::deleteReservation("P0", "NAN:01:08");
+
+    FileIO_Reservations::setStorageMode(ReservationStorage::PARTITIONED);
+    bool pass = expect(!fs::exists("reservations.dat") && fs::exists("reservations.dat.migrated"),
+                       "flat file set aside");
+    pass &= expect(fs::exists(ReservationPartitions::partitionPath("YVR:29:14")), "partition created");
+    pass &= expect(fs::exists("reservations/VIC-02-10.dat"), "partition named by upper-cased ID");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:29:14") == 20, "rows moved");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("NAN:01:08") == 19, "dead row dropped");
+    std::unordered_map<std::string, int> counts;
+    pass &= expect(FileIO_Reservations::countReservationsBySailing(counts) && counts.size() == 3,
+                   "catalog lists 3 sailings");
+
+    // 2. One-partition operations
+    pass &= expect(!FileIO_Reservations::writeReservation("p5", "YVR:29:14"), "duplicate rejected");
+    pass &= expect(FileIO_Reservations::writeReservation("NEW1", "YVR:29:14"), "booking added");
+    pass &= expect(FileIO_Reservations::reservationExists("NEW1", "YVR:29:14"), "booking visible");
+    pass &= expect(FileIO_Reservations::writeCheckin("NEW1", "YVR:29:14"), "check-in");
+
+    auto bytes = fs::file_size(ReservationPartitions::partitionPath("YVR:29:14"));
+    pass &= expect(FileIO_Reservations::deleteReservation("P3", "yvr:29:14"), "cancel (any case)");
+    pass &= expect(fs::file_size(ReservationPartitions::partitionPath("YVR:29:14")) == bytes - sizeof(ReservationRec),
+                   "swap-delete shrinks partition");
+    pass &= expect(!FileIO_Reservations::reservationExists("P3", "YVR:29:14"), "cancelled row gone");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:29:14") == 20, "count by file size");
+
+    std::string license;
+    SailingID id;
+    bool checkedIn = false, sawCheckin = false;
+    int rows = 0;
+    FileIO_Reservations::reset();
+    while (FileIO_Reservations::getNextReservation(license, id, checkedIn))
+    {
+        ++rows;
+        sawCheckin |= (license == "NEW1" && checkedIn);
+    }
+    pass &= expect(rows == 20 + 19 + 20 && sawCheckin, "sequential read covers every partition");
+
+    // 3. Sailing delete cascades by unlinking
+    pass &= expect(FileIO_Sailings::deleteSailing("NAN:01:08"), "sailing deleted");
+    pass &= expect(!fs::exists(ReservationPartitions::partitionPath("NAN:01:08")), "partition unlinked");
+    pass &= expect(FileIO_Reservations::countReservationsBySailing(counts) && counts.count("NAN:01:08") == 0,
+                   "catalog entry removed");
+    pass &= expect(FileIO_Reservations::countReservationsForSailing("YVR:29:14") == 20, "other partitions intact");
+
+    return finish("Partitions", pass);
+}
@@ -0,0 +1,308 @@
+// ---------------------------------------------------------------------------
+// testReplica.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks log-shipping replicas. The primary is driven by separate
+//   processes (this program re-run with a step name), as terminals would:
+//     1. Seeding copies the data set, turns the primary's log on and
+//        starts the follower at the end of it.
+//     2. A follower refuses updates, reports its lag, and catchUp()
+//        brings it level with the primary; re-applying the same records
+//        changes nothing.
+//     3. ferryd in the follower answers updates READ_ONLY, applies new
+//        primary changes on its own and reports zero lag once level.
+//     4. Processes changing one sailing at once log the changes in the
+//        order they were made, so the follower ends where the primary did.
+//     5. An update whose log record cannot be written reports failure and
+//        leaves no partial record.
+//     6. Checkpoints trim the log up to the slowest listed replica, keep
+//        LSNs, drop removed replicas from the list and refuse a position
+//        trimmed away.
+//     7. A process that has updated with logging off logs its next update
+//        once another process creates the log.
+//
+//   Runs inside ../data/replica_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FerryClient.h"
+#include "FerryServer.h"
+#include "MutationLog.h"
+#include "Replica.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <spawn.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+extern char **environ;
+
+// ---------------------------------------------------------------------------
+// Primary steps, each in its own process
+// ---------------------------------------------------------------------------
+static constexpr int SPACE_STEPS = 20;    // adjustments per racing process
+
+static int primaryStep(const std::string &step)
+{
+    std::error_code ec;
+    fs::current_path("primary", ec);
+    if (ec)
+        return 1;
+    StorageBackend &store = StorageBackend::current();
+    bool ok = true;
+
+    if (step == "seed")
+    {
+        ok &= store.writeVessel("Spirit", 120, 240);
+        ok &= store.writeSailing("VIC:01:08", "Spirit", 120, 240);
+        ok &= store.writeSailing("VIC:01:10", "Spirit", 120, 240);
+        for (int i = 0; i < 3; ++i)
+        {
+            ok &= store.writeVehicle(VehicleRecord{ "CAR" + std::to_string(i), "6045550000", 5, 1 });
+            ok &= store.writeReservation("CAR" + std::to_string(i), "VIC:01:08");
+        }
+        ok &= store.writeVehicle(VehicleRecord{ "GONE", "6045550000", 5, 1 });
+        ok &= Replica::seed("../follower");
+    }
+    else if (step == "update")              // 8 log records
+    {
+        ok &= store.writeVehicle(VehicleRecord{ "NEW1", "6045551111", 6, 2 });
+        ok &= store.writeReservation("NEW1", "VIC:01:08");
+        ok &= store.checkinReservation("CAR0", "VIC:01:08");
+        ok &= store.deleteReservation("CAR1", "VIC:01:08");
+        ok &= store.setRemainingSpace("VIC:01:08", 100, 200);
+        ok &= store.writeSailing("NAN:02:09", "Spirit", 120, 240);
+        ok &= store.deleteSailing("VIC:01:10");
+        ok &= store.deleteVehicle("GONE");
+    }
+    else if (step == "book")
+    {
+        ok &= store.writeVehicle(VehicleRecord{ "LATE", "6045552222", 5, 1 });
+        ok &= store.writeReservation("LATE", "NAN:02:09");
+    }
+    else if (step == "space")               // run by several processes at once
+    {
+        float hcl = 0, lcl = 0;
+        for (int i = 0; i < SPACE_STEPS; ++i)
+            ok &= store.adjustRemainingSpace("NAN:02:09", -1.0f, 0.0f, hcl, lcl);
+    }
+    else if (step == "seed2")
+        ok = Replica::seed("../follower2");
+    else if (step == "checkpoint")
+        ok = Replica::checkpoint(1) >= 0;
+    else if (step == "quiet")               // logging turned on under a running process
+    {
+        fs::create_directories("../quiet", ec);
+        fs::current_path("../quiet", ec);
+        ok = !ec && store.writeVehicle(VehicleRecord{ "Q1", "6045550000", 5, 1 });
+        pid_t pid = ::fork();
+        if (pid == 0)
+            std::_Exit(MutationLog::create() ? 0 : 1);
+        int status = 0;
+        ok &= pid > 0 && ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        ok &= store.writeVehicle(VehicleRecord{ "Q2", "6045550000", 5, 1 }) &&
+              MutationLog::lastLsn(MutationLog::LOG_FILE) == 1;
+    }
+    else if (step == "logfail")             // the log cannot grow
+    {
+        struct stat st{};
+        ::stat(MutationLog::LOG_FILE, &st);
+        struct rlimit limit{ static_cast<rlim_t>(st.st_size), static_cast<rlim_t>(st.st_size) };
+        std::signal(SIGXFSZ, SIG_IGN);
+        ok = ::setrlimit(RLIMIT_FSIZE, &limit) == 0 &&
+             !store.setRemainingSpace("VIC:01:08", 90, 190);     // in place: only the log grows
+    }
+    else
+        ok = false;
+
+    store.close();
+    return ok ? 0 : 1;
+}
+
+static bool runPrimary(const std::string &dataDir, const char *step)
+{
+    std::string self = fs::read_symlink("/proc/self/exe").string();
+    std::string flag = "--primary";
+    char *argv[] = { self.data(), flag.data(), const_cast<char*>(dataDir.c_str()), const_cast<char*>(step), nullptr };
+    pid_t pid;
+    int status = 0;
+    return posix_spawn(&pid, self.c_str(), nullptr, nullptr, argv, environ) == 0 &&
+           ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void rewindPosition(const std::string &primaryDir, std::uint64_t lsn = 0)
+{
+    std::ofstream out(Replica::POSITION_FILE, std::ios::trunc);
+    out << "primary " << primaryDir << "\nlsn " << lsn << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::error_code ec;
+    if (argc == 4 && std::strcmp(argv[1], "--primary") == 0)
+    {
+        fs::current_path(argv[2], ec);
+        return ec ? 1 : primaryStep(argv[3]);
+    }
+
+    if (!enterTestDir("../data/replica_test") || !fs::create_directories("primary", ec))
+        return 1;
+    std::string dataDir = fs::current_path().string();
+    std::string primaryDir = dataDir + "/primary";
+
+    // 1. Seed
+    bool pass = expect(runPrimary(dataDir, "seed"), "primary seeded a follower");
+    pass &= expect(fs::exists(primaryDir + "/" + MutationLog::LOG_FILE), "primary log turned on");
+    pass &= expect(fs::exists(dataDir + "/follower/vehicles.dat"), "data set copied");
+    fs::current_path(dataDir + "/follower", ec);
+    if (ec)
+    {
+        std::cerr << "ERROR: cannot enter follower directory\n";
+        return 1;
+    }
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    StorageBackend &store = StorageBackend::current();
+    ReplicaStatus status = Replica::status();
+    pass &= expect(Replica::isFollower() && status.follower && status.appliedLsn == status.primaryLsn,
+                   "follower starts level");
+    pass &= expect(store.reservationExists("CAR1", "VIC:01:08") && store.vehicleExists("GONE"), "seeded rows present");
+
+    // 2. Lag, refusal, apply, re-apply
+    pass &= expect(runPrimary(dataDir, "update"), "primary updated");
+    status = Replica::status();
+    pass &= expect(status.primaryLsn == status.appliedLsn + 8 && status.lagSeconds > 0.0, "lag reported");
+    pass &= expect(!store.writeVehicle(VehicleRecord{ "NOPE", "6045550000", 5, 1 }) && !store.vehicleExists("NOPE"),
+                   "follower refuses updates");
+
+    pass &= expect(Replica::catchUp() == 8, "eight records applied");
+    auto level = [&] {
+        Sailingrec space{};
+        return store.vehicleExists("NEW1") && !store.vehicleExists("GONE") &&
+               store.reservationExists("NEW1", "VIC:01:08") && !store.reservationExists("CAR1", "VIC:01:08") &&
+               store.countReservations("VIC:01:08") == 3 &&
+               store.sailingExists("NAN:02:09") && !store.sailingExists("VIC:01:10") &&
+               store.findSailing("VIC:01:08", space) && space.remainingHCL == 100 && space.remainingLCL == 200;
+    };
+    pass &= expect(level(), "follower matches the primary");
+    status = Replica::status();
+    pass &= expect(status.appliedLsn == status.primaryLsn && status.lagSeconds == 0.0, "no lag once level");
+
+    rewindPosition(primaryDir);
+    long again = Replica::catchUp(Replica::APPLY_BATCH);
+    pass &= expect(again == static_cast<long>(Replica::status().primaryLsn) && level(), "re-apply changes nothing");
+
+    // 3. ferryd as a follower
+    FerryServer server("ferryd.sock", 2);
+    std::thread serving([&] { server.run(); });
+    FerryClient client;
+    for (int i = 0; i < 200 && !client.connect("ferryd.sock"); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pass &= expect(client.isConnected(), "client connected");
+
+    std::vector<Proto::ResponseRec> replies;
+    Proto::RequestRec del = FerryClient::makeRequest(Proto::OpCode::RESERVATION_DELETE);
+    std::memcpy(del.license, "NEW1", 4);
+    std::memcpy(del.sailingID, "VIC:01:08", 9);
+    pass &= expect(client.call({ del }, replies) && replies.size() == 1 &&
+                   replies[0].status == static_cast<std::uint8_t>(Proto::Status::READ_ONLY), "update answered READ_ONLY");
+
+    pass &= expect(runPrimary(dataDir, "book"), "primary booked");
+    long behind = -1;
+    double seconds = -1.0;
+    bool caught = false;
+    for (int i = 0; i < 200 && !caught; ++i)
+    {
+        caught = client.replicaLag(behind, seconds) && behind == 0 && client.reservationExists("LATE", "NAN:02:09");
+        if (!caught)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    pass &= expect(caught && seconds == 0.0, "ferryd applied the new booking");
+
+    client.disconnect();
+    server.requestStop();
+    serving.join();
+
+    // 4. Processes adjusting one sailing at once log in the order they wrote
+    std::vector<std::thread> racers;
+    std::vector<char> raced(4, 0);
+    for (std::size_t p = 0; p < raced.size(); ++p)
+        racers.emplace_back([&, p] { raced[p] = runPrimary(dataDir, "space"); });
+    for (auto &t : racers)
+        t.join();
+    std::vector<MutationRec> records;
+    std::string primaryLog = primaryDir + "/" + MutationLog::LOG_FILE;
+    bool ordered = MutationLog::read(primaryLog, 0, 1u << 20, records);
+    float last = 120.0f;
+    int steps = 0;
+    for (const MutationRec &rec : records)
+    {
+        if (rec.op != static_cast<std::uint8_t>(MutationOp::SAILING_SPACE) ||
+            MutationLog::field(rec.sailingID) != "NAN:02:09")
+            continue;
+        ordered &= rec.hcl == last - 1.0f;
+        last = rec.hcl;
+        ++steps;
+    }
+    pass &= expect(std::count(raced.begin(), raced.end(), 1) == 4 && ordered &&
+                   steps == 4 * SPACE_STEPS, "log order is write order across processes");
+    while (Replica::catchUp() > 0)
+        ;
+    Sailingrec space{};
+    pass &= expect(store.findSailing("NAN:02:09", space) && space.remainingHCL == 120.0f - 4 * SPACE_STEPS,
+                   "follower ends where the primary did");
+
+    // 5. A record that cannot be appended fails the update and leaves the log whole
+    std::uint64_t before = MutationLog::lastLsn(primaryLog);
+    pass &= expect(runPrimary(dataDir, "logfail"), "update reported the failed append");
+    pass &= expect(MutationLog::lastLsn(primaryLog) == before &&
+                   fs::file_size(primaryLog) == before * sizeof(MutationRec), "log left whole");
+
+    // 6. Checkpoints trim the log to the slowest replica
+    std::uint64_t end = MutationLog::lastLsn(primaryLog);
+    pass &= expect(runPrimary(dataDir, "checkpoint") && MutationLog::baseLsn(primaryLog) == end &&
+                   MutationLog::lastLsn(primaryLog) == end && fs::file_size(primaryLog) == sizeof(MutationRec),
+                   "level replica: whole log trimmed");
+    pass &= expect(runPrimary(dataDir, "space") && Replica::catchUp() == SPACE_STEPS &&
+                   Replica::status().appliedLsn == end + SPACE_STEPS, "trimmed log applied by LSN");
+
+    pass &= expect(runPrimary(dataDir, "seed2") && runPrimary(dataDir, "space"), "second replica seeded");
+    pass &= expect(Replica::catchUp() == SPACE_STEPS && runPrimary(dataDir, "checkpoint") &&
+                   MutationLog::baseLsn(primaryLog) == end + SPACE_STEPS &&
+                   MutationLog::lastLsn(primaryLog) == end + 2 * SPACE_STEPS, "lagging replica keeps its records");
+    fs::remove_all(dataDir + "/follower2", ec);
+    pass &= expect(runPrimary(dataDir, "checkpoint") && MutationLog::baseLsn(primaryLog) == end + 2 * SPACE_STEPS,
+                   "removed replica no longer holds the log");
+    std::ifstream list(primaryDir + "/" + Replica::REPLICAS_FILE);
+    std::string listed((std::istreambuf_iterator<char>(list)), std::istreambuf_iterator<char>());
+    pass &= expect(listed == dataDir + "/follower\n", "removed replica unlisted");
+
+    rewindPosition(primaryDir, end);
+    pass &= expect(Replica::catchUp() == -1, "position before the trim refused");
+    rewindPosition(primaryDir, end + 2 * SPACE_STEPS);
+    pass &= expect(Replica::catchUp() == 0 && store.findSailing("NAN:02:09", space) && space.remainingHCL == 0.0f,
+                   "follower level after checkpoints");
+
+    // 7. A process that found no log sees one created by another
+    pass &= expect(runPrimary(dataDir, "quiet"), "update after the log appeared is logged");
+
+    return finish("Replica", pass);
+}
@@ -0,0 +1,116 @@
+// ---------------------------------------------------------------------------
+// testRoundTrip.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks round-trip / multi-leg bookings (BookingTransaction):
+//     1. A new vehicle is registered and booked out and back, and the space
+//        of both legs reaches sailings.dat.
+//     2. A journey with a full leg, or a leg the vehicle already holds,
+//        changes nothing on any leg: no reservation, vehicle or space.
+//     3. Unknown and repeated legs are refused, naming the leg.
+//     4. Several vehicles over several legs commit together.
+//   Also prints the time to commit a round trip.
+//
+//   Runs inside ../data/roundtrip_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BookingTransaction.h"
+#include "CapacityTable.h"
+#include "FileIO_Reservations.h"
+#include "Reservation.h"
+#include "StorageBackend.h"
+#include "TestSupport.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace FerrySys;
+
+static BookingError book(const VehicleRecord &v, const std::vector<SailingID> &legs, SailingID &failedLeg)
+{
+    BookingError error = BookingError::NONE;
+    Reservation::multiLegReservation(v, legs, error, failedLeg);
+    return error;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/roundtrip_test"))
+        return 1;
+    FileIO_Reservations::setStorageMode(ReservationStorage::FLAT);
+    StorageBackend &store = StorageBackend::current();
+    store.open();
+    CapacityTable::clear();
+
+    bool pass = store.writeVessel("Spirit", 40, 60);
+    pass &= store.writeVessel("Big", 2000, 2000);
+    for (const char *id : { "VIC:01:08", "NAN:01:18", "VIC:02:08" })
+        pass &= store.writeSailing(id, "Spirit", 40.0f, 60.0f);
+    pass &= store.writeSailing("NAN:02:18", "Spirit", 0.0f, 3.0f);
+    for (const char *id : { "VIC:05:08", "NAN:05:18" })
+        pass &= store.writeSailing(id, "Big", 2000.0f, 2000.0f);
+
+    // 1. New 5 m vehicle out and back (5.5 m of LCL on each leg)
+    SailingID failed;
+    pass &= expect(book(vehicle("CAR1", 5, 1), { "VIC:01:08", "NAN:01:18" }, failed) == BookingError::NONE &&
+                   failed.empty(), "round trip booked");
+    pass &= expect(store.vehicleExists("CAR1") && store.reservationExists("CAR1", "VIC:01:08") &&
+                   store.reservationExists("CAR1", "NAN:01:18"), "vehicle registered, both legs reserved");
+    pass &= expect(spaceIs(store, "VIC:01:08", 40.0f, 54.5f) && spaceIs(store, "NAN:01:18", 40.0f, 54.5f),
+                   "space of both legs persisted");
+
+    // 2. Return leg full: the outbound space is released again
+    pass &= expect(book(vehicle("CAR1", 5, 1), { "VIC:02:08", "NAN:02:18" }, failed) == BookingError::SAILING_FULL &&
+                   failed == "NAN:02:18", "full return leg refused and named");
+    float hcl = 0, lcl = 0;
+    pass &= expect(!store.reservationExists("CAR1", "VIC:02:08") && store.countReservations("VIC:02:08") == 0 &&
+                   CapacityTable::remaining("VIC:02:08", hcl, lcl) && hcl == 40.0f && lcl == 60.0f &&
+                   spaceIs(store, "VIC:02:08", 40.0f, 60.0f), "outbound space released");
+    pass &= expect(book(vehicle("NEW1", 5, 1), { "VIC:02:08", "NAN:02:18" }, failed) == BookingError::SAILING_FULL &&
+                   !store.vehicleExists("NEW1"), "new vehicle not kept after a full leg");
+
+    // A leg already held: the other leg is not booked either
+    pass &= expect(book(vehicle("CAR1", 5, 1), { "VIC:02:08", "NAN:01:18" }, failed) == BookingError::ALREADY_BOOKED &&
+                   failed == "NAN:01:18", "already-held leg refused");
+    pass &= expect(store.countReservations("VIC:02:08") == 0 && store.countReservations("NAN:01:18") == 1 &&
+                   CapacityTable::remaining("VIC:02:08", hcl, lcl) && lcl == 60.0f &&
+                   CapacityTable::remaining("NAN:01:18", hcl, lcl) && lcl == 54.5f, "no leg changed");
+
+    // 3. Unknown and repeated legs
+    pass &= expect(book(vehicle("CAR1", 5, 1), { "VIC:02:08", "XYZ:01:01" }, failed) ==
+                   BookingError::UNKNOWN_SAILING && failed == "XYZ:01:01", "unknown leg refused and named");
+    pass &= expect(CapacityTable::remaining("VIC:02:08", hcl, lcl) && lcl == 60.0f, "space before the unknown leg released");
+    pass &= expect(book(vehicle("CAR1", 5, 1), { "VIC:02:08", "vic:02:08" }, failed) ==
+                   BookingError::DUPLICATE_VEHICLE, "repeated leg refused");
+    pass &= expect(book(vehicle("CAR1", 5, 1), {}, failed) == BookingError::EMPTY, "no legs refused");
+
+    // 4. Two vehicles, three legs, one commit; the stored CAR1 is used as is
+    BookingTransaction journey;
+    journey.add(vehicle("CAR1", 30, 3), "VIC:02:08");           // stored: 5 m, low
+    journey.add(vehicle("VAN1", 6, 3), "VIC:02:08");
+    journey.add(vehicle("VAN1", 6, 3), "NAN:01:18");
+    pass &= expect(journey.size() == 3 && journey.commit(), "mixed journey booked");
+    pass &= expect(spaceIs(store, "VIC:02:08", 33.5f, 54.5f) && spaceIs(store, "NAN:01:18", 33.5f, 54.5f),
+                   "each leg charged for its own vehicles");
+
+    // Timing: round trips for 200 new vehicles
+    const int TRIPS = 200;
+    auto start = std::chrono::steady_clock::now();
+    bool all = true;
+    for (int i = 0; i < TRIPS; ++i)
+        all &= book(vehicle("RT" + std::to_string(1000 + i), 4, 1), { "VIC:05:08", "NAN:05:18" }, failed) ==
+               BookingError::NONE;
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    pass &= expect(all && store.countReservations("VIC:05:08") == TRIPS && store.countReservations("NAN:05:18") == TRIPS,
+                   "every round trip booked");
+
+    std::cout << "Round trip committed in " << secs * 1e3 / TRIPS << " ms\n";
+    store.close();
+
+    return finish("RoundTrip", pass);
+}
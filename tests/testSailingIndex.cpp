@@ -0,0 +1,109 @@
+// ---------------------------------------------------------------------------
+// testSailingIndex.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the sailings.idx B+tree:
+//     1. Inserts in random order (with leaf and root splits) keep every
+//        sailing findable, and city/day range scans come back in
+//        (day, hour) order.
+//     2. A bulk rebuild gives the same answers.
+//     3. Deleted sailings disappear; compaction rebuilds the index.
+//
+//   Runs inside ../data/sailingindex_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "Compaction.h"
+#include "FileIO_Sailings.h"
+#include "SailingIndex.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FerrySys;
+
+static std::string sailingID(int city, int day, int hour)
+{
+    char id[16];
+    std::snprintf(id, sizeof(id), "%c%cX:%02d:%02d", 'A' + city, 'A' + city, day, hour);
+    return id;
+}
+
+// Every sailing findable; the C-city range on day 7 complete and ordered
+static bool checkAll(const std::vector<std::string> &ids, const std::string &label)
+{
+    bool pass = true;
+    Sailingrec rec{};
+    for (const auto &id : ids)
+    {
+        if (!FileIO_Sailings::findSailing(id, rec) || id != rec.id)
+        {
+            pass = expect(false, label + ": find " + id);
+            break;
+        }
+    }
+
+    std::vector<Sailingrec> day7 = FileIO_Sailings::sailingsToCity("CCX", "07");
+    pass &= expect(day7.size() == 8, label + ": CCX day 07 has 8 sailings");
+    for (std::size_t i = 0; i < day7.size(); ++i)
+        pass &= expect(day7[i].id == sailingID(2, 7, static_cast<int>(i) * 3), label + ": range order");
+
+    pass &= expect(FileIO_Sailings::sailingsToCity("CCX", "").size() == 28 * 8, label + ": whole route");
+    pass &= expect(FileIO_Sailings::sailingsToCity("ZZX", "07").empty(), label + ": unknown city");
+    pass &= expect(!FileIO_Sailings::Sailingexist("CCX:07:01"), label + ": missing hour");
+    return pass;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/sailingindex_test"))
+        return 1;
+
+    // 10 routes x 28 days x 8 departures, written in random order
+    std::vector<std::string> ids;
+    for (int city = 0; city < 10; ++city)
+        for (int day = 1; day <= 28; ++day)
+            for (int hour = 0; hour < 24; hour += 3)
+                ids.push_back(sailingID(city, day, hour));
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(276));
+
+    // 1. Insert path (index exists before the first write)
+    bool pass = expect(SailingIndex::build(), "empty build");
+    for (const auto &id : ids)
+        FileIO_Sailings::writeSailing(id, "Queen", 100.0f, 200.0f);
+    auto idxBytes = fs::file_size(SailingIndex::INDEX_FILE);
+    pass &= expect(idxBytes > 4 * SailingIndex::PAGE_BYTES, "inserts split pages");
+    pass &= checkAll(ids, "inserted");
+
+    // 2. Bulk build
+    SailingIndex::invalidate();
+    pass &= expect(!fs::exists(SailingIndex::INDEX_FILE), "invalidate removes file");
+    pass &= checkAll(ids, "rebuilt");
+    pass &= expect(fs::exists(SailingIndex::INDEX_FILE), "lookup rebuilt the file");
+
+    // 3. Deletes and compaction
+    std::vector<SailingID> removed;
+    FileIO_Sailings::deleteSailing("CCX:07:03");
+    FileIO_Sailings::deleteSailingsToCity("AAX", removed);
+    pass &= expect(!FileIO_Sailings::Sailingexist("CCX:07:03"), "deleted sailing gone");
+    pass &= expect(FileIO_Sailings::sailingsToCity("CCX", "07").size() == 7, "range skips deleted");
+    pass &= expect(FileIO_Sailings::sailingsToCity("AAX", "").empty(), "deleted route gone");
+
+    Compactor::compact(Table::SAILINGS);
+    pass &= expect(FileIO_Sailings::Sailingexist("CCX:07:06"), "found after compaction");
+    pass &= expect(FileIO_Sailings::setRemainingSpace("JJX:28:21", 1.0f, 2.0f), "update through index");
+    float hcl = 0, lcl = 0;
+    FileIO_Sailings::getRemainingSpace("JJX:28:21", hcl, lcl);
+    pass &= expect(hcl == 1.0f && lcl == 2.0f, "update landed on the right record");
+
+    return finish("Sailing index", pass);
+}
@@ -0,0 +1,192 @@
+// ---------------------------------------------------------------------------
+// testSailingTable.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the in-memory sailing table:
+//     1. The vectorized ID scan finds every row of columns of every length
+//        (including the tails past a multiple of four) and nothing for
+//        near misses.
+//     2. Lookups, space updates, deletes and the report agree with
+//        sailings.dat, and repeated lookups open no file.
+//     3. Another process's in-place space update is seen on the next
+//        lookup, even when this process writes through straight after
+//        it; a record changed outside FileIO is seen after forget().
+//     4. Processes updating one sailing's space at once lose no update.
+//   Also prints lookups per second.
+//
+//   Runs inside ../data/sailingtable_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "BinaryFileOps.hpp"
+#include "FileIO_Sailings.h"
+#include "Metrics.h"
+#include "SailingTable.h"
+#include "TestSupport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace FerrySys;
+
+static std::string sailingID(int n)
+{
+    char id[16];
+    std::snprintf(id, sizeof(id), "%c%cX:%02d:%02d", 'A' + n / 600, 'A' + (n / 24) % 25, n % 28 + 1, n % 24);
+    return id;
+}
+
+// Live records of sailings.dat, straight from the file
+static std::vector<Sailingrec> fileRows()
+{
+    std::ifstream in("sailings.dat", std::ios::binary);
+    skipHeader(in);
+    std::vector<Sailingrec> rows;
+    Sailingrec rec{};
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+    {
+        if (rec.status != REC_DEAD)
+            rows.push_back(rec);
+    }
+    return rows;
+}
+
+int main()
+{
+    // 1. Scan over packed columns
+    bool pass = true;
+    struct alignas(16) ID { char bytes[16]; };
+    for (std::size_t count = 0; count <= 37; ++count)
+    {
+        std::vector<ID> ids(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::string id = sailingID(static_cast<int>(i));
+            std::memset(ids[i].bytes, 0, sizeof(ids[i].bytes));
+            std::memcpy(ids[i].bytes, id.data(), id.size());
+        }
+        const char *col = count ? ids.front().bytes : nullptr;
+        bool found = true;
+        for (std::size_t i = 0; i < count; ++i)
+            found &= SailingTable::scan(col, count, SailingID(sailingID(static_cast<int>(i)))) == i;
+        std::string last = count ? sailingID(static_cast<int>(count - 1)) : "AAX:01:00";
+        bool missed = SailingTable::scan(col, count, SailingID(last.substr(0, 8))) == count &&
+                      SailingTable::scan(col, count, SailingID(last + "0")) == count &&
+                      SailingTable::scan(col, count, SailingID("ZZZ:99:99")) == count;
+        pass &= expect(found && missed, "scan of " + std::to_string(count) + " IDs");
+    }
+
+    if (!enterTestDir("../data/sailingtable_test"))
+        return 1;
+
+    // 2. Agreement with the file
+    const int SAILINGS = 1000;
+    for (int i = 0; i < SAILINGS; ++i)
+        FileIO_Sailings::writeSailing(sailingID(i), "Vessel" + std::to_string(i % 7), 100.0f + i, 200.0f + i);
+
+    bool all = true;
+    for (int i = 0; i < SAILINGS; ++i)
+    {
+        Sailingrec rec{};
+        all &= FileIO_Sailings::findSailing(sailingID(i), rec) && rec.remainingHCL == 100.0f + i &&
+               std::string(rec.VesselName) == "Vessel" + std::to_string(i % 7);
+    }
+    pass &= expect(all, "every sailing found");
+
+    pass &= expect(FileIO_Sailings::setRemainingSpace(sailingID(5), 1.5f, 2.5f), "space set");
+    pass &= expect(FileIO_Sailings::updateSailingSpace(sailingID(6), 5.0f, 1.0f, -1), "space updated");
+    std::vector<SailingID> removed;
+    FileIO_Sailings::deleteSailings({ sailingID(7), sailingID(999) }, removed);
+    float hcl = 0, lcl = 0;
+    pass &= expect(FileIO_Sailings::getRemainingSpace(sailingID(5), hcl, lcl) && hcl == 1.5f && lcl == 2.5f,
+                   "space read back");
+    pass &= expect(FileIO_Sailings::getRemainingSpace(sailingID(6), hcl, lcl) && lcl == 206.0f - 5.5f,
+                   "update read back");
+    pass &= expect(!FileIO_Sailings::Sailingexist(sailingID(7)) && !FileIO_Sailings::Sailingexist(sailingID(999)) &&
+                   FileIO_Sailings::Sailingexist(sailingID(8)), "deleted sailings gone");
+
+    std::vector<Sailingrec> report = FileIO_Sailings::Sailingreport();
+    std::vector<Sailingrec> onFile = fileRows();
+    bool same = report.size() == onFile.size();
+    for (std::size_t i = 0; same && i < report.size(); ++i)
+        same = std::strcmp(report[i].id, onFile[i].id) == 0 && report[i].remainingHCL == onFile[i].remainingHCL &&
+               report[i].remainingLCL == onFile[i].remainingLCL;
+    pass &= expect(same && report.size() == SAILINGS - 2, "report matches the file, in order");
+
+    const int LOOKUPS = 200000;
+    std::uint64_t opens = Metrics::snapshot().counter(Counter::FILE_OPENS);
+    auto start = std::chrono::steady_clock::now();
+    int hits = 0;
+    for (int i = 0; i < LOOKUPS; ++i)
+        hits += FileIO_Sailings::Sailingexist(sailingID(i % SAILINGS)) ? 1 : 0;
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    pass &= expect(hits == LOOKUPS - 2 * (LOOKUPS / SAILINGS), "lookup hits");
+    pass &= expect(Metrics::snapshot().counter(Counter::FILE_OPENS) == opens, "lookups open no file");
+    std::cout << "Sailingexist over " << SAILINGS << " sailings: "
+              << static_cast<long long>(LOOKUPS / secs) << " lookups/s\n";
+
+    // 3. Changes the table did not make: another process's (same size,
+    //    maybe the same mtime tick), then ours, then one outside FileIO
+    pid_t child = ::fork();
+    if (child == 0)
+        std::_Exit(FileIO_Sailings::setRemainingSpace(sailingID(10), 42.0f, 43.0f) ? 0 : 1);
+    int status = 1;
+    ::waitpid(child, &status, 0);
+    pass &= expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child updated space");
+    pass &= expect(FileIO_Sailings::setRemainingSpace(sailingID(11), 44.0f, 45.0f), "own update");
+    pass &= expect(FileIO_Sailings::getRemainingSpace(sailingID(10), hcl, lcl) && hcl == 42.0f && lcl == 43.0f &&
+                   FileIO_Sailings::getRemainingSpace(sailingID(11), hcl, lcl) && hcl == 44.0f,
+                   "other process's update seen");
+
+    {
+        std::fstream file("sailings.dat", std::ios::binary | std::ios::in | std::ios::out);
+        std::size_t base = skipHeader(file);
+        Sailingrec rec{};
+        file.seekg(static_cast<std::streamoff>(base + 10 * sizeof(rec)));
+        file.read(reinterpret_cast<char*>(&rec), sizeof(rec));
+        rec.remainingHCL = 46.0f;
+        file.seekp(static_cast<std::streamoff>(base + 10 * sizeof(rec)));
+        file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    }
+    SailingTable::forget();
+    pass &= expect(FileIO_Sailings::getRemainingSpace(sailingID(10), hcl, lcl) && hcl == 46.0f,
+                   "outside change seen after forget()");
+
+    // 4. Concurrent read-modify-writes of one record: 1200 cars of 5.5 m
+    //    from 9000 m of LCL, in four processes
+    const int PROCESSES = 4, CARS = 300;
+    pass &= expect(FileIO_Sailings::setRemainingSpace(sailingID(12), 0.0f, 9000.0f), "space set for the race");
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; ++p)
+    {
+        pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            bool ok = true;
+            for (int c = 0; c < CARS; ++c)
+                ok &= FileIO_Sailings::updateSailingSpace(sailingID(12), 5.0f, 1.0f, -1);
+            std::_Exit(ok ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    bool updated = true;
+    for (pid_t pid : children)
+    {
+        ::waitpid(pid, &status, 0);
+        updated &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    pass &= expect(updated, "every process's updates succeeded");
+    pass &= expect(FileIO_Sailings::getRemainingSpace(sailingID(12), hcl, lcl) &&
+                   lcl == 9000.0f - PROCESSES * CARS * 5.5f, "no update lost: " + std::to_string(lcl));
+
+    return finish("SailingTable", pass);
+}
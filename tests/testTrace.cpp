@@ -0,0 +1,76 @@
+// ---------------------------------------------------------------------------
+// testTrace.cpp
+// CMPT 276 – Assignment 4
+//
+// PURPOSE
+//   Checks the trace-span writer:
+//     1. Spans from FileIO calls and nested sub-spans reach the JSON file.
+//     2. A full ring keeps only its newest RING_EVENTS spans.
+//     3. The output is a complete trace-event document.
+//
+//   Runs inside ../data/trace_test (relative to build/).
+//
+// EXIT CODE: 0 = PASS, 1 = FAIL
+// ---------------------------------------------------------------------------
+
+#include "FileIO_Reservations.h"
+#include "TestSupport.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace FerrySys;
+
+static std::size_t countOf(const std::string &text, const std::string &needle)
+{
+    std::size_t n = 0;
+    for (std::size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+        ++n;
+    return n;
+}
+
+int main()
+{
+    if (!enterTestDir("../data/trace_test"))
+        return 1;
+
+    Trace::start("trace.json");
+
+    FileIO_Reservations::writeReservation("ABC123", "YVR:29:14");
+    FileIO_Reservations::writeReservation("ABC123", "YVR:29:14");    // duplicate
+    FileIO_Reservations::deleteReservation("ABC123", "YVR:29:14");
+
+    // Overflow the ring
+    for (std::size_t i = 0; i < Trace::RING_EVENTS + 100; ++i)
+    {
+        FERRY_TRACE_SPAN("test::filler");
+    }
+
+    bool pass = expect(Trace::flush(), "flush wrote the file");
+
+    std::ifstream in("trace.json");
+    std::stringstream buf;
+    buf << in.rdbuf();
+    std::string json = buf.str();
+
+    pass &= expect(json.rfind("{\"displayTimeUnit\"", 0) == 0, "document header");
+    pass &= expect(json.size() > 4 && json.compare(json.size() - 4, 4, "\n]}\n") == 0, "document closed");
+    pass &= expect(countOf(json, "\"ph\":\"X\"") == Trace::RING_EVENTS, "ring keeps newest RING_EVENTS spans");
+    pass &= expect(countOf(json, "test::filler") == Trace::RING_EVENTS, "older spans overwritten");
+
+    // Early spans were pushed out; re-run the FileIO calls and flush again
+    FileIO_Reservations::writeReservation("ABC123", "YVR:29:14");
+    FileIO_Reservations::deleteReservation("ABC123", "YVR:29:14");
+    Trace::flush();
+    std::ifstream again("trace.json");
+    buf.str("");
+    buf << again.rdbuf();
+    json = buf.str();
+    pass &= expect(json.find("FileIO_Reservations::writeReservation/duplicateScan") != std::string::npos, "sub-span recorded");
+    pass &= expect(json.find("\"FileIO_Reservations::deleteReservation\"") != std::string::npos, "delete span recorded");
+
+    return finish("Trace", pass);
+}